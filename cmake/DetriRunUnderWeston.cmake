@@ -0,0 +1,41 @@
+# Runs TEST_BINARY against a private headless weston instance.
+# Usage: cmake -DWESTON=<weston> -DTEST_BINARY=<binary> -P DetriRunUnderWeston.cmake
+
+if (NOT WESTON OR NOT TEST_BINARY)
+    message(FATAL_ERROR "DetriRunUnderWeston.cmake requires -DWESTON=<path> and -DTEST_BINARY=<path>")
+endif()
+
+string(RANDOM LENGTH 8 _detri_suffix)
+set(_detri_socket "detri-test-${_detri_suffix}")
+set(_detri_runtime_dir "${CMAKE_CURRENT_BINARY_DIR}/weston-runtime-${_detri_suffix}")
+file(MAKE_DIRECTORY "${_detri_runtime_dir}")
+file(CHMOD "${_detri_runtime_dir}" DIRECTORY_PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE)
+
+set(_detri_script [=[
+"$WESTON" --backend=headless-backend.so --socket="$SOCKET" --idle-time=0 >"$XDG_RUNTIME_DIR/weston.log" 2>&1 &
+weston_pid=$!
+for attempt in $(seq 100); do
+    [ -S "$XDG_RUNTIME_DIR/$SOCKET" ] && break
+    sleep 0.05
+done
+WAYLAND_DISPLAY="$SOCKET" "$TEST_BINARY"
+result=$?
+kill "$weston_pid" 2>/dev/null
+wait "$weston_pid" 2>/dev/null
+exit $result
+]=])
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E env
+        "WESTON=${WESTON}"
+        "TEST_BINARY=${TEST_BINARY}"
+        "SOCKET=${_detri_socket}"
+        "XDG_RUNTIME_DIR=${_detri_runtime_dir}"
+        sh -c "${_detri_script}"
+    RESULT_VARIABLE _detri_result
+)
+file(REMOVE_RECURSE "${_detri_runtime_dir}")
+
+if (NOT _detri_result EQUAL 0)
+    message(FATAL_ERROR "${TEST_BINARY} failed under weston with exit code ${_detri_result}")
+endif()
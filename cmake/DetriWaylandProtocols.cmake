@@ -0,0 +1,51 @@
+include_guard(GLOBAL)
+
+# Generates client glue for the given wayland-protocols XML files and adds it to TARGET.
+# PROTOCOLS entries are paths relative to the wayland-protocols pkgdatadir.
+function(detri_add_wayland_protocols)
+    set(options)
+    set(one_value_args TARGET)
+    set(multi_value_args PROTOCOLS)
+    cmake_parse_arguments(DWP "${options}" "${one_value_args}" "${multi_value_args}" ${ARGN})
+
+    if (NOT DWP_TARGET)
+        message(FATAL_ERROR "detri_add_wayland_protocols requires TARGET <target>")
+    endif()
+
+    find_package(PkgConfig REQUIRED)
+    pkg_get_variable(_detri_protocols_dir wayland-protocols pkgdatadir)
+    pkg_get_variable(_detri_scanner wayland-scanner wayland_scanner)
+    if (NOT _detri_scanner)
+        find_program(_detri_scanner wayland-scanner)
+    endif()
+    if (NOT _detri_protocols_dir OR NOT _detri_scanner)
+        message(FATAL_ERROR "detri_add_wayland_protocols requires wayland-protocols and wayland-scanner")
+    endif()
+
+    enable_language(C)
+    set(_detri_output_dir "${CMAKE_CURRENT_BINARY_DIR}/wayland-protocols")
+    file(MAKE_DIRECTORY "${_detri_output_dir}")
+
+    foreach (_detri_protocol IN LISTS DWP_PROTOCOLS)
+        set(_detri_xml "${_detri_protocols_dir}/${_detri_protocol}")
+        get_filename_component(_detri_name "${_detri_protocol}" NAME_WE)
+        set(_detri_header "${_detri_output_dir}/${_detri_name}-client-protocol.h")
+        set(_detri_source "${_detri_output_dir}/${_detri_name}-protocol.c")
+
+        add_custom_command(
+            OUTPUT "${_detri_header}"
+            COMMAND "${_detri_scanner}" client-header "${_detri_xml}" "${_detri_header}"
+            DEPENDS "${_detri_xml}"
+            VERBATIM
+        )
+        add_custom_command(
+            OUTPUT "${_detri_source}"
+            COMMAND "${_detri_scanner}" private-code "${_detri_xml}" "${_detri_source}"
+            DEPENDS "${_detri_xml}"
+            VERBATIM
+        )
+        target_sources(${DWP_TARGET} PRIVATE "${_detri_header}" "${_detri_source}")
+    endforeach()
+
+    target_include_directories(${DWP_TARGET} PRIVATE "${_detri_output_dir}")
+endfunction()
@@ -0,0 +1,213 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "detri/async_io.hpp"
+#include "detri/platform.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Streams 64 KiB chunks from random offsets of a 64 MiB file, the way a texture streamer pulls mips out of a pak,
+// either one blocking pread at a time or through async_io with up to 32 reads in flight. Reports throughput plus the
+// median and 99th percentile of each read's submit-to-completion latency. The file sits in the page cache after the
+// first pass, so this measures per-read overhead rather than the disk.
+namespace
+{
+    constexpr std::size_t file_size = 64 * 1024 * 1024;
+    constexpr std::size_t chunk_size = 64 * 1024;
+    constexpr std::size_t reads_per_pass = 1024;
+    constexpr std::uint32_t queue_depth = 32;
+
+    const std::filesystem::path& bench_file()
+    {
+        static const std::filesystem::path path = [] {
+            auto file_path = std::filesystem::temp_directory_path() / "detri_async_io_bench.bin";
+            std::ofstream file{file_path, std::ios::binary | std::ios::trunc};
+            std::vector<char> block(1024 * 1024);
+            for (std::size_t i = 0; i < block.size(); ++i)
+            {
+                block[i] = static_cast<char>(i * 13);
+            }
+            for (std::size_t written = 0; written < file_size; written += block.size())
+            {
+                file.write(block.data(), static_cast<std::streamsize>(block.size()));
+            }
+            return file_path;
+        }();
+        return path;
+    }
+
+    const std::vector<std::uint64_t>& read_offsets()
+    {
+        static const std::vector<std::uint64_t> offsets = [] {
+            std::vector<std::uint64_t> values(reads_per_pass);
+            std::mt19937_64 random{42};
+            std::uniform_int_distribution<std::uint64_t> chunk{0, file_size / chunk_size - 1};
+            for (auto& value : values)
+            {
+                value = chunk(random) * chunk_size;
+            }
+            return values;
+        }();
+        return offsets;
+    }
+
+    void report_latency(benchmark::State& state, std::vector<detri::platform_clock::duration>& latencies)
+    {
+        if (latencies.empty())
+        {
+            return;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        const auto at = [&latencies](const double fraction) {
+            const auto index = static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1));
+            return std::chrono::duration<double, std::micro>(latencies[index]).count();
+        };
+        state.counters["p50_us"] = at(0.50);
+        state.counters["p99_us"] = at(0.99);
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * reads_per_pass * chunk_size));
+    }
+
+    // The blocking baseline: pread, or ReadFile with an explicit offset on Windows.
+    class blocking_file
+    {
+    public:
+        explicit blocking_file(const std::filesystem::path& path)
+        {
+#ifdef _WIN32
+            m_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+            m_handle = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+        }
+
+        ~blocking_file()
+        {
+#ifdef _WIN32
+            CloseHandle(m_handle);
+#else
+            close(m_handle);
+#endif
+        }
+
+        blocking_file(const blocking_file&) = delete;
+
+        blocking_file& operator=(const blocking_file&) = delete;
+
+        std::size_t read_at(const std::uint64_t offset, std::byte* buffer, const std::size_t size) const noexcept
+        {
+#ifdef _WIN32
+            OVERLAPPED position{};
+            position.Offset = static_cast<DWORD>(offset);
+            position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD transferred = 0;
+            ReadFile(m_handle, buffer, static_cast<DWORD>(size), &transferred, &position);
+            return transferred;
+#else
+            const ssize_t result = pread(m_handle, buffer, size, static_cast<off_t>(offset));
+            return result < 0 ? 0 : static_cast<std::size_t>(result);
+#endif
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE m_handle;
+#else
+        int m_handle;
+#endif
+    };
+
+    void blocking_pread(benchmark::State& state)
+    {
+        const blocking_file file{bench_file()};
+        const auto& offsets = read_offsets();
+        std::vector<std::byte> buffer(chunk_size);
+        std::vector<detri::platform_clock::duration> latencies;
+        latencies.reserve(reads_per_pass * 64);
+
+        for (auto _ : state)
+        {
+            for (const std::uint64_t offset : offsets)
+            {
+                const auto start = detri::platform_clock::now();
+                benchmark::DoNotOptimize(file.read_at(offset, buffer.data(), buffer.size()));
+                latencies.push_back(detri::platform_clock::now() - start);
+            }
+        }
+        report_latency(state, latencies);
+    }
+    BENCHMARK(blocking_pread)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    void async_reads(benchmark::State& state, const detri::async_io_backend backend)
+    {
+        auto io = detri::async_io::create({.backend = backend, .queue_depth = queue_depth});
+        state.SetLabel(io.backend() == detri::async_io_backend::thread_pool ? "thread_pool" : "native");
+
+        const auto file = io.open(bench_file());
+        const auto& offsets = read_offsets();
+        // One buffer per queue slot; a slot is reused as soon as its read is reaped.
+        std::vector<std::byte> buffers(queue_depth * chunk_size);
+        std::vector<std::uint32_t> free_slots;
+        std::array<detri::platform_clock::time_point, queue_depth> submitted{};
+        std::array<detri::async_read_completion, queue_depth> completions{};
+        std::vector<detri::platform_clock::duration> latencies;
+        latencies.reserve(reads_per_pass * 64);
+
+        for (auto _ : state)
+        {
+            free_slots.clear();
+            for (std::uint32_t slot = 0; slot < queue_depth; ++slot)
+            {
+                free_slots.push_back(slot);
+            }
+
+            std::size_t next = 0;
+            std::size_t done = 0;
+            std::vector<detri::async_read> batch;
+            while (done < offsets.size())
+            {
+                batch.clear();
+                while (next < offsets.size() && !free_slots.empty())
+                {
+                    const std::uint32_t slot = free_slots.back();
+                    free_slots.pop_back();
+                    batch.push_back({
+                        .file = &file,
+                        .offset = offsets[next++],
+                        .buffer = std::span{buffers}.subspan(slot * chunk_size, chunk_size),
+                        .user_data = slot
+                    });
+                }
+                const auto now = detri::platform_clock::now();
+                for (const auto& read : batch)
+                {
+                    submitted[read.user_data] = now;
+                }
+                io.submit(batch);
+
+                const std::size_t count = io.wait(completions, std::chrono::seconds{1});
+                const auto finished = detri::platform_clock::now();
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const auto slot = static_cast<std::uint32_t>(completions[i].user_data);
+                    latencies.push_back(finished - submitted[slot]);
+                    free_slots.push_back(slot);
+                }
+                done += count;
+            }
+        }
+        report_latency(state, latencies);
+    }
+    BENCHMARK_CAPTURE(async_reads, native, detri::async_io_backend::automatic)->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK_CAPTURE(async_reads, thread_pool, detri::async_io_backend::thread_pool)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,146 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "detri/event_queue.hpp"
+
+// The queue every backend publishes into: a frame's worth of mixed input pushed and popped on one thread, the same
+// stream handed across threads the way a threaded pump does, and a drag's worth of mouse moves with coalescing off
+// and on. Events carry a fixed timestamp so the clock stays out of the numbers.
+namespace
+{
+    constexpr std::size_t batch_size = 256;
+
+    const std::vector<detri::event>& frame_batch()
+    {
+        static const std::vector<detri::event> batch = [] {
+            const detri::platform_clock::time_point stamp{std::chrono::seconds{1}};
+            std::vector<detri::event> values;
+            values.reserve(batch_size);
+            for (std::size_t i = 0; values.size() < batch_size; ++i)
+            {
+                const auto offset = static_cast<std::int32_t>(i);
+                values.emplace_back(detri::mouse_move_event{.x = offset, .y = offset, .timestamp = stamp});
+                values.emplace_back(detri::mouse_delta_event{.dx = 1, .dy = -1, .timestamp = stamp});
+                values.emplace_back(detri::key_event{.value = detri::key::w, .pressed = i % 2 == 0, .timestamp = stamp});
+                values.emplace_back(detri::mouse_button_event{.pressed = i % 2 == 0, .x = offset, .y = offset, .timestamp = stamp});
+            }
+            return values;
+        }();
+        return batch;
+    }
+
+    void push_pop(benchmark::State& state)
+    {
+        const auto& batch = frame_batch();
+        detri::event_queue queue{1024};
+        detri::event out;
+        for (auto _ : state)
+        {
+            for (const auto& value : batch)
+            {
+                queue.push(value);
+            }
+            while (queue.try_pop(out))
+            {
+                benchmark::DoNotOptimize(out);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch.size()));
+    }
+    BENCHMARK(push_pop);
+
+    // Same work as push_pop, drained with one claim per call.
+    void push_pop_many(benchmark::State& state)
+    {
+        const auto& batch = frame_batch();
+        detri::event_queue queue{1024};
+        std::array<detri::event, 64> out{};
+        for (auto _ : state)
+        {
+            for (const auto& value : batch)
+            {
+                queue.push(value);
+            }
+            while (queue.try_pop_many(out) != 0)
+            {
+                benchmark::DoNotOptimize(out.data());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch.size()));
+    }
+    BENCHMARK(push_pop_many);
+
+    // One producer thread pushes 64 batches while this thread drains. Reports what it received per second; the
+    // producer never waits, so a slow consumer shows up as dropped events rather than a stalled producer.
+    void cross_thread(benchmark::State& state)
+    {
+        constexpr std::size_t batches = 64;
+        const auto& batch = frame_batch();
+        detri::event_queue queue{1024};
+        std::array<detri::event, 64> out{};
+        std::int64_t received = 0;
+        for (auto _ : state)
+        {
+            std::atomic<bool> done{false};
+            std::thread producer{[&] {
+                for (std::size_t i = 0; i < batches; ++i)
+                {
+                    for (const auto& value : batch)
+                    {
+                        queue.push(value);
+                    }
+                }
+                done.store(true, std::memory_order_release);
+            }};
+
+            for (;;)
+            {
+                const bool finished = done.load(std::memory_order_acquire);
+                std::size_t count = 0;
+                while ((count = queue.try_pop_many(out)) != 0)
+                {
+                    received += static_cast<std::int64_t>(count);
+                }
+                if (finished)
+                {
+                    break;
+                }
+            }
+            producer.join();
+        }
+        state.SetItemsProcessed(received);
+        state.counters["dropped"] = benchmark::Counter(static_cast<double>(queue.stats().dropped), benchmark::Counter::kAvgIterations);
+    }
+    BENCHMARK(cross_thread)->UseRealTime();
+
+    // A fast drag: a batch of mouse moves, flushed and drained once per pump. With coalescing on it reaches the
+    // consumer as a single event.
+    void mouse_drag(benchmark::State& state, const bool coalescing)
+    {
+        const detri::platform_clock::time_point stamp{std::chrono::seconds{1}};
+        detri::event_queue queue{1024};
+        queue.set_coalescing(coalescing);
+        std::array<detri::event, 64> out{};
+        for (auto _ : state)
+        {
+            for (std::int32_t i = 0; i < static_cast<std::int32_t>(batch_size); ++i)
+            {
+                queue.push(detri::mouse_move_event{.x = i, .y = i, .timestamp = stamp});
+            }
+            queue.flush();
+            while (queue.try_pop_many(out) != 0)
+            {
+                benchmark::DoNotOptimize(out.data());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch_size));
+    }
+    BENCHMARK_CAPTURE(mouse_drag, uncoalesced, false);
+    BENCHMARK_CAPTURE(mouse_drag, coalesced, true);
+}
@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "detri/input_recording.hpp"
+
+// Writes and replays a 64k-event session of mixed mouse and key input, one event at a time and in batches. Replays
+// are immediate, so this is decode cost out of a warm mapping, the ceiling for a regression run fed through replay.
+namespace
+{
+    constexpr std::size_t session_size = 64 * 1024;
+
+    const std::vector<detri::event>& session()
+    {
+        static const std::vector<detri::event> events = [] {
+            std::vector<detri::event> values;
+            values.reserve(session_size);
+            detri::platform_clock::time_point stamp{std::chrono::seconds{1}};
+            for (std::size_t i = 0; values.size() < session_size; ++i)
+            {
+                const auto offset = static_cast<std::int32_t>(i);
+                stamp += std::chrono::microseconds{250};
+                values.emplace_back(detri::mouse_move_event{.x = offset, .y = offset, .timestamp = stamp});
+                values.emplace_back(detri::mouse_delta_event{.dx = 1, .dy = -1, .timestamp = stamp});
+                values.emplace_back(detri::key_event{.value = detri::key::w, .pressed = i % 2 == 0, .timestamp = stamp});
+                values.emplace_back(detri::mouse_button_event{.pressed = i % 2 == 0, .x = offset, .y = offset, .timestamp = stamp});
+            }
+            return values;
+        }();
+        return events;
+    }
+
+    const std::filesystem::path& session_file()
+    {
+        static const std::filesystem::path path = [] {
+            auto file_path = std::filesystem::temp_directory_path() / "detri_input_recording_bench.bin";
+            auto recorder = detri::input_recorder::create(file_path);
+            recorder.record(session());
+            return file_path;
+        }();
+        return path;
+    }
+
+    void record(benchmark::State& state)
+    {
+        const auto& events = session();
+        const auto path = std::filesystem::temp_directory_path() / "detri_input_recording_bench_out.bin";
+        for (auto _ : state)
+        {
+            auto recorder = detri::input_recorder::create(path);
+            for (const auto& value : events)
+            {
+                recorder.record(value);
+            }
+            recorder.flush();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(events.size()));
+    }
+    BENCHMARK(record)->Unit(benchmark::kMillisecond);
+
+    void replay_next(benchmark::State& state)
+    {
+        auto replayer = detri::input_replayer::open(session_file());
+        for (auto _ : state)
+        {
+            replayer.rewind();
+            while (const auto value = replayer.next())
+            {
+                benchmark::DoNotOptimize(*value);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(session_size));
+    }
+    BENCHMARK(replay_next)->Unit(benchmark::kMillisecond);
+
+    // Same work as replay_next, the way drain_events() takes it.
+    void replay_next_many(benchmark::State& state)
+    {
+        auto replayer = detri::input_replayer::open(session_file());
+        std::array<detri::event, 256> out{};
+        for (auto _ : state)
+        {
+            replayer.rewind();
+            while (replayer.next_many(out) != 0)
+            {
+                benchmark::DoNotOptimize(out.data());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(session_size));
+    }
+    BENCHMARK(replay_next_many)->Unit(benchmark::kMillisecond);
+}
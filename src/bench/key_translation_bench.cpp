@@ -0,0 +1,377 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "detri/key_translation.hpp"
+
+// Compares the table-driven translation against the switch it replaced, over a shuffled stream of the keys a game
+// actually sees, so the branch predictor gets no help from ordering.
+namespace
+{
+    struct win32_key_message
+    {
+        std::uint64_t wparam;
+        std::int64_t lparam;
+    };
+
+    constexpr std::int64_t win32_lparam(const std::uint32_t scancode, const bool extended)
+    {
+        return static_cast<std::int64_t>(scancode << 16) | (extended ? 1LL << 24 : 0);
+    }
+
+    // The switch window_win32.cpp used before the tables, with the VK_ names spelled out.
+    detri::key switch_translate(const std::uint64_t wparam) noexcept
+    {
+        switch (wparam)
+        {
+            case 0x1B:
+                return detri::key::escape;
+            case 0x0D:
+                return detri::key::enter;
+            case 0x09:
+                return detri::key::tab;
+            case 0x08:
+                return detri::key::backspace;
+            case 0x20:
+                return detri::key::space;
+            case 0x25:
+                return detri::key::left;
+            case 0x27:
+                return detri::key::right;
+            case 0x26:
+                return detri::key::up;
+            case 0x28:
+                return detri::key::down;
+            case 0xA2:
+                return detri::key::left_control;
+            case 0xA3:
+                return detri::key::right_control;
+            case 0x11:
+                return detri::key::left_control;
+            case 0xA0:
+                return detri::key::left_shift;
+            case 0xA1:
+                return detri::key::right_shift;
+            case 'A':
+                return detri::key::a;
+            case 'B':
+                return detri::key::b;
+            case 'C':
+                return detri::key::c;
+            case 'D':
+                return detri::key::d;
+            case 'E':
+                return detri::key::e;
+            case 'F':
+                return detri::key::f;
+            case 'G':
+                return detri::key::g;
+            case 'H':
+                return detri::key::h;
+            case 'I':
+                return detri::key::i;
+            case 'J':
+                return detri::key::j;
+            case 'K':
+                return detri::key::k;
+            case 'L':
+                return detri::key::l;
+            case 'M':
+                return detri::key::m;
+            case 'N':
+                return detri::key::n;
+            case 'O':
+                return detri::key::o;
+            case 'P':
+                return detri::key::p;
+            case 'Q':
+                return detri::key::q;
+            case 'R':
+                return detri::key::r;
+            case 'S':
+                return detri::key::s;
+            case 'T':
+                return detri::key::t;
+            case 'U':
+                return detri::key::u;
+            case 'V':
+                return detri::key::v;
+            case 'W':
+                return detri::key::w;
+            case 'X':
+                return detri::key::x;
+            case 'Y':
+                return detri::key::y;
+            case 'Z':
+                return detri::key::z;
+            case '0':
+                return detri::key::zero;
+            case '1':
+                return detri::key::one;
+            case '2':
+                return detri::key::two;
+            case '3':
+                return detri::key::three;
+            case '4':
+                return detri::key::four;
+            case '5':
+                return detri::key::five;
+            case '6':
+                return detri::key::six;
+            case '7':
+                return detri::key::seven;
+            case '8':
+                return detri::key::eight;
+            case '9':
+                return detri::key::nine;
+            case 0x70:
+                return detri::key::f1;
+            case 0x71:
+                return detri::key::f2;
+            case 0x72:
+                return detri::key::f3;
+            case 0x73:
+                return detri::key::f4;
+            case 0x74:
+                return detri::key::f5;
+            case 0x75:
+                return detri::key::f6;
+            case 0x76:
+                return detri::key::f7;
+            case 0x77:
+                return detri::key::f8;
+            case 0x78:
+                return detri::key::f9;
+            case 0x79:
+                return detri::key::f10;
+            case 0x7a:
+                return detri::key::f11;
+            case 0x7b:
+                return detri::key::f12;
+            default:
+                return detri::key::unknown;
+        }
+    }
+
+    // The keysym switch the X11 backend used before the tables, with the XK_ names spelled out.
+    detri::key x11_switch_translate(const std::uint32_t keysym) noexcept
+    {
+        if (keysym >= 'a' && keysym <= 'z')
+        {
+            return static_cast<detri::key>(static_cast<std::uint32_t>(detri::key::a) + (keysym - 'a'));
+        }
+        if (keysym >= '0' && keysym <= '9')
+        {
+            return static_cast<detri::key>(static_cast<std::uint32_t>(detri::key::zero) + (keysym - '0'));
+        }
+        if (keysym >= 0xFFBE && keysym <= 0xFFC9)
+        {
+            return static_cast<detri::key>(static_cast<std::uint32_t>(detri::key::f1) + (keysym - 0xFFBE));
+        }
+
+        switch (keysym)
+        {
+            case 0xFF1B:
+                return detri::key::escape;
+            case 0xFF0D:
+                return detri::key::enter;
+            case 0xFF09:
+                return detri::key::tab;
+            case 0xFF08:
+                return detri::key::backspace;
+            case ' ':
+                return detri::key::space;
+            case 0xFF51:
+                return detri::key::left;
+            case 0xFF53:
+                return detri::key::right;
+            case 0xFF52:
+                return detri::key::up;
+            case 0xFF54:
+                return detri::key::down;
+            case 0xFF55:
+                return detri::key::page_up;
+            case 0xFF56:
+                return detri::key::page_down;
+            case 0xFF50:
+                return detri::key::home;
+            case 0xFF57:
+                return detri::key::end;
+            case 0xFF63:
+                return detri::key::insert;
+            case 0xFFFF:
+                return detri::key::delete_;
+            case 0xFFE1:
+                return detri::key::left_shift;
+            case 0xFFE2:
+                return detri::key::right_shift;
+            case 0xFFE3:
+                return detri::key::left_control;
+            case 0xFFE4:
+                return detri::key::right_control;
+            case 0xFFE9:
+                return detri::key::left_alt;
+            case 0xFFEA:
+                return detri::key::right_alt;
+            case 0xFFEB:
+                return detri::key::left_system;
+            case 0xFFEC:
+                return detri::key::right_system;
+            default:
+                return detri::key::unknown;
+        }
+    }
+
+    std::vector<win32_key_message> make_win32_stream()
+    {
+        const std::array<win32_key_message, 16> alphabet{{
+            {'W', win32_lparam(0x11, false)},
+            {'A', win32_lparam(0x1E, false)},
+            {'S', win32_lparam(0x1F, false)},
+            {'D', win32_lparam(0x20, false)},
+            {'Q', win32_lparam(0x10, false)},
+            {'E', win32_lparam(0x12, false)},
+            {'R', win32_lparam(0x13, false)},
+            {'1', win32_lparam(0x02, false)},
+            {0x20, win32_lparam(0x39, false)},
+            {0x10, win32_lparam(0x2A, false)},
+            {0x11, win32_lparam(0x1D, false)},
+            {0x12, win32_lparam(0x38, false)},
+            {0x1B, win32_lparam(0x01, false)},
+            {0x25, win32_lparam(0x4B, true)},
+            {0x0D, win32_lparam(0x1C, false)},
+            {0x70, win32_lparam(0x3B, false)},
+        }};
+
+        std::mt19937 random{42};
+        std::uniform_int_distribution<std::size_t> pick{0, alphabet.size() - 1};
+        std::vector<win32_key_message> stream(4096);
+        for (auto& message : stream)
+        {
+            message = alphabet[pick(random)];
+        }
+        return stream;
+    }
+
+    std::vector<std::uint32_t> make_codes(const std::vector<std::uint32_t>& alphabet)
+    {
+        std::mt19937 random{42};
+        std::uniform_int_distribution<std::size_t> pick{0, alphabet.size() - 1};
+        std::vector<std::uint32_t> stream(4096);
+        for (auto& code : stream)
+        {
+            code = alphabet[pick(random)];
+        }
+        return stream;
+    }
+
+    std::vector<std::uint32_t> make_keysym_stream()
+    {
+        return make_codes({'w', 'a', 's', 'd', 'q', 'e', '1', ' ', 0xFFE1, 0xFFE3, 0xFFE9, 0xFF1B, 0xFF51, 0xFF0D, 0xFFBE,
+                           0xFFC9});
+    }
+
+    void win32_switch(benchmark::State& state)
+    {
+        const auto stream = make_win32_stream();
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            for (const auto& message : stream)
+            {
+                sum += static_cast<std::uint32_t>(switch_translate(message.wparam));
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+    }
+    BENCHMARK(win32_switch);
+
+    // Same work as win32_switch: one lookup by virtual key.
+    void win32_virtual_key_table(benchmark::State& state)
+    {
+        const auto stream = make_win32_stream();
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            for (const auto& message : stream)
+            {
+                sum += static_cast<std::uint32_t>(
+                    detri::key_translation::from_win32_virtual_key(static_cast<std::uint32_t>(message.wparam)));
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+    }
+    BENCHMARK(win32_virtual_key_table);
+
+    // The full translation, which also resolves sides and keypad keys from the scancode. Still slower than
+    // win32_switch, which cannot tell sides apart: about 1.1-1.5x on an x86 VM, against 2.7x when every key also
+    // loaded its scancode. The five ambiguous keys in this stream are what remains of the difference.
+    void win32_table(benchmark::State& state)
+    {
+        const auto stream = make_win32_stream();
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            for (const auto& message : stream)
+            {
+                sum += static_cast<std::uint32_t>(detri::key_translation::from_win32_message(message.wparam, message.lparam));
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+    }
+    BENCHMARK(win32_table);
+
+    void x11_keysym_switch(benchmark::State& state)
+    {
+        const auto stream = make_keysym_stream();
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            for (const auto keysym : stream)
+            {
+                sum += static_cast<std::uint32_t>(x11_switch_translate(keysym));
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+    }
+    BENCHMARK(x11_keysym_switch);
+
+    void x11_keysym_table(benchmark::State& state)
+    {
+        const auto stream = make_keysym_stream();
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            for (const auto keysym : stream)
+            {
+                sum += static_cast<std::uint32_t>(detri::key_translation::from_x11_keysym(keysym));
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+    }
+    BENCHMARK(x11_keysym_table);
+
+    void evdev_table(benchmark::State& state)
+    {
+        const auto stream = make_codes({17, 30, 31, 32, 16, 18, 2, 57, 42, 29, 56, 1, 105, 28, 59, 71});
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            for (const auto code : stream)
+            {
+                sum += static_cast<std::uint32_t>(detri::key_translation::from_evdev_code(code));
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+    }
+    BENCHMARK(evdev_table);
+}
@@ -0,0 +1,331 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "detri/platform.hpp"
+#include "detri/unicode.hpp"
+#include "detri/unicode_kernels.hpp"
+
+#ifndef _WIN32
+#include <iconv.h>
+#endif
+
+// Every kernel set this CPU runs, against the OS's own converter (MultiByteToWideChar and WideCharToMultiByte on
+// Windows, glibc's iconv elsewhere), over a megabyte each of three kinds of text: an asset path list with the odd
+// non-ASCII directory, a JSON asset manifest, and CJK prose with ASCII punctuation. Rates are in UTF-8 bytes whichever
+// way a conversion goes, so the directions compare.
+namespace
+{
+    constexpr std::size_t corpus_size = 1 << 20;
+
+    struct corpus
+    {
+        std::string utf8;
+        std::u16string utf16;
+        std::u32string utf32;
+    };
+
+    constexpr std::array<std::string_view, 3> corpus_names {"paths", "manifest", "cjk"};
+
+    std::string path_list(std::mt19937& random)
+    {
+        constexpr std::array<std::string_view, 10> directories {
+            "textures", "meshes", "materials", "audio/sfx", "levels/forest_02", "ui/fonts", "shaders/include",
+            "d\xC3\xA9" "cor", "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E",
+            "\xD1\x8D\xD1\x81\xD0\xBA\xD0\xB8\xD0\xB7\xD1\x8B",
+        };
+        constexpr std::array<std::string_view, 6> names {
+            "rock_cliff_albedo", "oak_trunk_normal", "footstep_gravel", "character_rig", "grass_blade", "door_hinge"};
+        constexpr std::array<std::string_view, 5> extensions {".ktx2", ".mesh", ".ogg", ".mat", ".hlsl"};
+
+        std::string text;
+        while (text.size() < corpus_size)
+        {
+            text += "assets/";
+            text += directories[random() % directories.size()];
+            text += '/';
+            text += names[random() % names.size()];
+            text += '_' + std::to_string(random() % 100);
+            text += extensions[random() % extensions.size()];
+            text += '\n';
+        }
+        return text;
+    }
+
+    std::string manifest(std::mt19937& random)
+    {
+        std::string text = "[\n";
+        while (text.size() < corpus_size)
+        {
+            std::array<char, 33> hash {};
+            for (std::size_t i = 0; i + 1 < hash.size(); ++i)
+            {
+                hash[i] = "0123456789abcdef"[random() % 16];
+            }
+            text += "  {\"path\": \"assets/textures/terrain_" + std::to_string(random() % 10000) + ".ktx2\", ";
+            text += "\"hash\": \"" + std::string{hash.data()} + "\", ";
+            text += "\"size\": " + std::to_string(random() % 10'000'000) + ", ";
+            text += random() % 8 == 0 ? "\"label\": \"Gel\xC3\xA4nde \xE2\x80\x93 Nordhang\"},\n"
+                                      : "\"label\": \"\"},\n";
+        }
+        return text + "]\n";
+    }
+
+    std::string cjk_prose(std::mt19937& random)
+    {
+        std::string text;
+        while (text.size() < corpus_size)
+        {
+            const auto code_point = static_cast<char32_t>(0x4E00 + random() % 0x5200);
+            text += static_cast<char>(0xE0 | code_point >> 12);
+            text += static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+            text += static_cast<char>(0x80 | (code_point & 0x3F));
+            if (random() % 16 == 0)
+            {
+                text += random() % 2 == 0 ? ", " : ". ";
+            }
+        }
+        return text;
+    }
+
+    const corpus& corpus_named(const std::string_view name)
+    {
+        static const std::array<corpus, corpus_names.size()> corpora = [] {
+            std::mt19937 random{2024};
+            std::array<corpus, corpus_names.size()> built;
+            built[0].utf8 = path_list(random);
+            built[1].utf8 = manifest(random);
+            built[2].utf8 = cjk_prose(random);
+            for (corpus& text : built)
+            {
+                text.utf16 = detri::to_utf16(text.utf8);
+                text.utf32 = detri::to_utf32(text.utf8);
+            }
+            return built;
+        }();
+        for (std::size_t i = 0; i < corpus_names.size(); ++i)
+        {
+            if (corpus_names[i] == name)
+            {
+                return corpora[i];
+            }
+        }
+        return corpora[0];
+    }
+
+    void set_bytes_processed(benchmark::State& state, const corpus& text)
+    {
+        state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(text.utf8.size()));
+    }
+
+    void validate_utf8(benchmark::State& state, const detri::unicode_kernels* kernels, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(detri::valid_utf8(*kernels, text.utf8));
+        }
+        set_bytes_processed(state, text);
+    }
+
+    void utf8_to_utf16(benchmark::State& state, const detri::unicode_kernels* kernels, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        std::u16string out(text.utf8.size(), u'\0');
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(detri::utf8_to_utf16(*kernels, text.utf8, out));
+            benchmark::ClobberMemory();
+        }
+        set_bytes_processed(state, text);
+    }
+
+    void utf8_to_utf32(benchmark::State& state, const detri::unicode_kernels* kernels, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        std::u32string out(text.utf8.size(), U'\0');
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(detri::utf8_to_utf32(*kernels, text.utf8, out));
+            benchmark::ClobberMemory();
+        }
+        set_bytes_processed(state, text);
+    }
+
+    void utf16_to_utf8(benchmark::State& state, const detri::unicode_kernels* kernels, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        std::string out(text.utf8.size(), '\0');
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(detri::utf16_to_utf8(*kernels, text.utf16, out));
+            benchmark::ClobberMemory();
+        }
+        set_bytes_processed(state, text);
+    }
+
+    void utf32_to_utf8(benchmark::State& state, const detri::unicode_kernels* kernels, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        std::string out(text.utf8.size(), '\0');
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(detri::utf32_to_utf8(*kernels, text.utf32, out));
+            benchmark::ClobberMemory();
+        }
+        set_bytes_processed(state, text);
+    }
+
+#ifdef _WIN32
+    // Counting the output is the one way to have Windows validate without converting.
+    void os_validate_utf8(benchmark::State& state, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.utf8.data(),
+                                                         static_cast<int>(text.utf8.size()), nullptr, 0));
+        }
+        set_bytes_processed(state, text);
+    }
+
+    void os_utf8_to_utf16(benchmark::State& state, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        std::wstring out(text.utf8.size(), L'\0');
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, text.utf8.data(),
+                                                         static_cast<int>(text.utf8.size()), out.data(),
+                                                         static_cast<int>(out.size())));
+            benchmark::ClobberMemory();
+        }
+        set_bytes_processed(state, text);
+    }
+
+    void os_utf16_to_utf8(benchmark::State& state, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        std::string out(text.utf8.size(), '\0');
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS,
+                                                         reinterpret_cast<const wchar_t*>(text.utf16.data()),
+                                                         static_cast<int>(text.utf16.size()), out.data(),
+                                                         static_cast<int>(out.size()), nullptr, nullptr));
+            benchmark::ClobberMemory();
+        }
+        set_bytes_processed(state, text);
+    }
+#else
+    // One conversion descriptor per benchmark, reset before every pass.
+    std::size_t iconv_convert(const iconv_t converter, const void* const in, std::size_t in_bytes, void* const out,
+                              const std::size_t out_bytes)
+    {
+        iconv(converter, nullptr, nullptr, nullptr, nullptr);
+        char* in_cursor = const_cast<char*>(static_cast<const char*>(in));
+        char* out_cursor = static_cast<char*>(out);
+        std::size_t out_left = out_bytes;
+        iconv(converter, &in_cursor, &in_bytes, &out_cursor, &out_left);
+        return out_bytes - out_left;
+    }
+
+    template <typename From, typename To>
+    void os_convert(benchmark::State& state, const char* const to_encoding, const char* const from_encoding,
+                    const std::basic_string<From>& in, const corpus& text)
+    {
+        const iconv_t converter = iconv_open(to_encoding, from_encoding);
+        if (converter == reinterpret_cast<iconv_t>(-1))
+        {
+            state.SkipWithError("iconv has no converter between these encodings");
+            return;
+        }
+        std::basic_string<To> out(text.utf8.size(), To{});
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(iconv_convert(converter, in.data(), in.size() * sizeof(From), out.data(),
+                                                   out.size() * sizeof(To)));
+            benchmark::ClobberMemory();
+        }
+        iconv_close(converter);
+        set_bytes_processed(state, text);
+    }
+
+    void os_utf8_to_utf16(benchmark::State& state, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        os_convert<char, char16_t>(state, "UTF-16LE", "UTF-8", text.utf8, text);
+    }
+
+    void os_utf8_to_utf32(benchmark::State& state, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        os_convert<char, char32_t>(state, "UTF-32LE", "UTF-8", text.utf8, text);
+    }
+
+    void os_utf16_to_utf8(benchmark::State& state, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        os_convert<char16_t, char>(state, "UTF-8", "UTF-16LE", text.utf16, text);
+    }
+
+    void os_utf32_to_utf8(benchmark::State& state, const std::string_view name)
+    {
+        const corpus& text = corpus_named(name);
+        os_convert<char32_t, char>(state, "UTF-8", "UTF-32LE", text.utf32, text);
+    }
+#endif
+
+    // Registered at startup rather than with BENCHMARK_CAPTURE, so only the kernel sets this CPU runs show up.
+    // Names read operation/corpus/kernels, e.g. utf8_to_utf16/paths/avx2 against utf8_to_utf16/paths/os.
+    [[maybe_unused]] const bool g_registered = [] {
+        using kernel_benchmark = void (*)(benchmark::State&, const detri::unicode_kernels*, std::string_view);
+        using os_benchmark = void (*)(benchmark::State&, std::string_view);
+        struct operation
+        {
+            const char* name;
+            kernel_benchmark kernels;
+            os_benchmark os;
+        };
+
+#ifdef _WIN32
+        const std::array<operation, 5> operations {{
+            {"validate_utf8", validate_utf8, os_validate_utf8},
+            {"utf8_to_utf16", utf8_to_utf16, os_utf8_to_utf16},
+            {"utf8_to_utf32", utf8_to_utf32, nullptr},
+            {"utf16_to_utf8", utf16_to_utf8, os_utf16_to_utf8},
+            {"utf32_to_utf8", utf32_to_utf8, nullptr},
+        }};
+#else
+        const std::array<operation, 5> operations {{
+            {"validate_utf8", validate_utf8, nullptr},
+            {"utf8_to_utf16", utf8_to_utf16, os_utf8_to_utf16},
+            {"utf8_to_utf32", utf8_to_utf32, os_utf8_to_utf32},
+            {"utf16_to_utf8", utf16_to_utf8, os_utf16_to_utf8},
+            {"utf32_to_utf8", utf32_to_utf8, os_utf32_to_utf8},
+        }};
+#endif
+
+        for (const operation& op : operations)
+        {
+            for (const std::string_view corpus : corpus_names)
+            {
+                const std::string prefix = std::string{op.name} + '/' + std::string{corpus} + '/';
+                for (const detri::unicode_kernels* kernels : detri::supported_unicode_kernels())
+                {
+                    benchmark::RegisterBenchmark((prefix + std::string{kernels->name}).c_str(), op.kernels, kernels,
+                                                 corpus);
+                }
+                if (op.os != nullptr)
+                {
+                    benchmark::RegisterBenchmark((prefix + "os").c_str(), op.os, corpus);
+                }
+            }
+        }
+        return true;
+    }();
+}
@@ -0,0 +1,180 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "detri/input_recording.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/window.hpp"
+
+// What a frame pays to get input out of a window on whichever backend the library was built with. An idle pump is
+// the floor. A replay feeds a 16k-event session through poll_event() and drain_events() on any backend, each call
+// pumping the OS as it would in a game loop. On headless, injected events also take the path live input does. Without
+// a display to connect to, the window benchmarks report an error and the rest still run.
+namespace
+{
+    constexpr std::size_t session_size = 16 * 1024;
+    constexpr std::size_t batch_size = 256;
+
+    std::optional<detri::window> open_window(benchmark::State& state)
+    {
+        try
+        {
+            return detri::window::create("detri_platform_bench", 640, 480);
+        }
+        catch (const detri::except::window_error& error)
+        {
+            state.SkipWithError(error.what());
+            return std::nullopt;
+        }
+    }
+
+    // Runs of seven mouse moves between key presses and releases, as a hand on the mouse produces.
+    std::vector<detri::event> make_events(const std::size_t count)
+    {
+        std::vector<detri::event> values;
+        values.reserve(count + 1);
+        detri::platform_clock::time_point stamp{std::chrono::seconds{1}};
+        for (std::size_t i = 0; values.size() < count; ++i)
+        {
+            const auto offset = static_cast<std::int32_t>(i);
+            stamp += std::chrono::microseconds{250};
+            values.emplace_back(detri::mouse_move_event{.x = offset, .y = offset, .timestamp = stamp});
+            if (i % 8 == 7)
+            {
+                values.emplace_back(detri::key_event{.value = detri::key::w, .pressed = i % 16 == 7, .timestamp = stamp});
+            }
+        }
+        values.resize(count);
+        return values;
+    }
+
+    const std::filesystem::path& session_file()
+    {
+        static const std::filesystem::path path = [] {
+            auto file_path = std::filesystem::temp_directory_path() / "detri_window_bench.bin";
+            auto recorder = detri::input_recorder::create(file_path);
+            recorder.record(make_events(session_size));
+            return file_path;
+        }();
+        return path;
+    }
+
+    void idle_pump(benchmark::State& state)
+    {
+        auto win = open_window(state);
+        if (!win.has_value())
+        {
+            return;
+        }
+        while (win->poll_event().has_value())
+        {
+        }
+
+        for (auto _ : state)
+        {
+            win->pump_messages();
+        }
+    }
+    BENCHMARK(idle_pump);
+
+    void poll_event_replayed(benchmark::State& state)
+    {
+        auto win = open_window(state);
+        if (!win.has_value())
+        {
+            return;
+        }
+        auto replayer = detri::input_replayer::open(session_file());
+        win->replay_input(&replayer);
+        for (auto _ : state)
+        {
+            replayer.rewind();
+            while (!replayer.finished())
+            {
+                benchmark::DoNotOptimize(win->poll_event());
+            }
+        }
+        win->replay_input(nullptr);
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(session_size));
+    }
+    BENCHMARK(poll_event_replayed)->Unit(benchmark::kMicrosecond);
+
+    // Same work as poll_event_replayed, one pump per batch.
+    void drain_events_replayed(benchmark::State& state)
+    {
+        auto win = open_window(state);
+        if (!win.has_value())
+        {
+            return;
+        }
+        auto replayer = detri::input_replayer::open(session_file());
+        win->replay_input(&replayer);
+        std::array<detri::event, batch_size> out{};
+        for (auto _ : state)
+        {
+            replayer.rewind();
+            while (!replayer.finished())
+            {
+                benchmark::DoNotOptimize(win->drain_events(out));
+            }
+        }
+        win->replay_input(nullptr);
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(session_size));
+    }
+    BENCHMARK(drain_events_replayed)->Unit(benchmark::kMicrosecond);
+
+#ifdef DETRI_PLATFORM_HEADLESS
+    // A frame of injected input through the live queue and out of poll_event(), coalescing as configured. The count
+    // is of events injected, so the coalesced variant shows what merging saves per event the OS delivered.
+    void poll_event_injected(benchmark::State& state, const bool coalescing)
+    {
+        auto win = open_window(state);
+        if (!win.has_value())
+        {
+            return;
+        }
+        win->set_event_coalescing(coalescing);
+        const auto batch = make_events(batch_size);
+        for (auto _ : state)
+        {
+            for (const auto& value : batch)
+            {
+                win->inject_event(value);
+            }
+            while (const auto value = win->poll_event())
+            {
+                benchmark::DoNotOptimize(*value);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch.size()));
+    }
+    BENCHMARK_CAPTURE(poll_event_injected, uncoalesced, false);
+    BENCHMARK_CAPTURE(poll_event_injected, coalesced, true);
+
+    void drain_events_injected(benchmark::State& state)
+    {
+        auto win = open_window(state);
+        if (!win.has_value())
+        {
+            return;
+        }
+        const auto batch = make_events(batch_size);
+        std::array<detri::event, batch_size> out{};
+        for (auto _ : state)
+        {
+            for (const auto& value : batch)
+            {
+                win->inject_event(value);
+            }
+            benchmark::DoNotOptimize(win->drain_events(out));
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch.size()));
+    }
+    BENCHMARK(drain_events_injected);
+#endif
+}
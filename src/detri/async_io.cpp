@@ -0,0 +1,283 @@
+#include "detri/async_io.hpp"
+#include "detri/async_io_engine.hpp"
+#include "detri/high_resolution_timer.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace detri
+{
+    namespace
+    {
+        class thread_pool_engine final : public async_io::engine
+        {
+        public:
+            explicit thread_pool_engine(const async_io_options& options)
+                : m_queue_depth(options.queue_depth)
+            {
+                const std::uint32_t workers = options.worker_threads != 0 ? options.worker_threads
+                                                                          : std::min(4U, processor_count());
+                m_workers.reserve(workers);
+                for (std::uint32_t i = 0; i < workers; ++i)
+                {
+                    m_workers.emplace_back([this] { run_worker(); });
+                }
+            }
+
+            ~thread_pool_engine() override
+            {
+                {
+                    std::lock_guard lock{m_mutex};
+                    m_stopping = true;
+                }
+                m_work_ready.notify_all();
+                // Workers drain the queue before exiting, so every caller buffer has been written by the time they
+                // are joined.
+                for (auto& worker : m_workers)
+                {
+                    worker.join();
+                }
+            }
+
+            [[nodiscard]] async_io_backend backend() const noexcept override
+            {
+                return async_io_backend::thread_pool;
+            }
+
+            void attach(const async_file::impl&) override
+            {
+            }
+
+            std::size_t submit(const std::span<const async_read> reads) override
+            {
+                std::size_t accepted = 0;
+                {
+                    std::lock_guard lock{m_mutex};
+                    accepted = std::min(reads.size(), m_queue_depth - std::min<std::size_t>(m_queue_depth, m_in_flight));
+                    m_pending.insert(m_pending.end(), reads.begin(), reads.begin() + static_cast<std::ptrdiff_t>(accepted));
+                    m_in_flight += accepted;
+                }
+                if (accepted == 1)
+                {
+                    m_work_ready.notify_one();
+                }
+                else if (accepted > 1)
+                {
+                    m_work_ready.notify_all();
+                }
+                return accepted;
+            }
+
+            std::size_t poll(const std::span<async_read_completion> out) override
+            {
+                // Re-arm before looking so a completion that lands in between signals again instead of being lost.
+                m_signal.reset();
+                std::lock_guard lock{m_mutex};
+                return take_completed(out);
+            }
+
+            std::size_t wait(const std::span<async_read_completion> out, const platform_clock::duration timeout) override
+            {
+                m_signal.reset();
+                // wait_for() would overflow adding duration::max() to the clock, so wait forever explicitly.
+                const auto deadline = deadline_after(timeout);
+                const auto ready = [this] {
+                    return !m_completed.empty() || m_in_flight == 0;
+                };
+                std::unique_lock lock{m_mutex};
+                if (deadline == platform_clock::time_point::max())
+                {
+                    m_completion_ready.wait(lock, ready);
+                }
+                else
+                {
+                    m_completion_ready.wait_until(lock, deadline, ready);
+                }
+                return take_completed(out);
+            }
+
+            [[nodiscard]] std::size_t in_flight() const noexcept override
+            {
+                std::lock_guard lock{m_mutex};
+                return m_in_flight;
+            }
+
+            [[nodiscard]] async_io_wait_handle wait_handle() const noexcept override
+            {
+                return m_signal.handle();
+            }
+
+        private:
+            void run_worker()
+            {
+                std::unique_lock lock{m_mutex};
+                while (true)
+                {
+                    m_work_ready.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+                    if (m_pending.empty())
+                    {
+                        return;
+                    }
+
+                    const async_read read = m_pending.front();
+                    m_pending.pop_front();
+                    lock.unlock();
+
+                    const auto buffer = read.buffer.first(std::min(read.buffer.size(), max_async_read_size));
+                    std::error_code error;
+                    const std::size_t bytes_read = read_native_file(file_of(read), read.offset, buffer, error);
+
+                    lock.lock();
+                    m_completed.push_back({.user_data = read.user_data, .bytes_read = bytes_read, .error = error});
+                    m_signal.notify();
+                    m_completion_ready.notify_one();
+                }
+            }
+
+            std::size_t take_completed(const std::span<async_read_completion> out)
+            {
+                const std::size_t count = std::min(out.size(), m_completed.size());
+                std::copy_n(m_completed.begin(), count, out.begin());
+                m_completed.erase(m_completed.begin(), m_completed.begin() + static_cast<std::ptrdiff_t>(count));
+                m_in_flight -= count;
+                return count;
+            }
+
+            std::size_t m_queue_depth;
+            mutable std::mutex m_mutex;
+            std::condition_variable m_work_ready;
+            std::condition_variable m_completion_ready;
+            std::deque<async_read> m_pending;
+            std::deque<async_read_completion> m_completed;
+            std::size_t m_in_flight {};
+            bool m_stopping {false};
+            completion_signal m_signal;
+            std::vector<std::thread> m_workers;
+        };
+    }
+
+    std::unique_ptr<async_io::engine> make_thread_pool_engine(const async_io_options& options)
+    {
+        return std::make_unique<thread_pool_engine>(options);
+    }
+
+    async_file::async_file(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    async_file::~async_file() = default;
+
+    async_file::async_file(async_file&&) noexcept = default;
+
+    async_file& async_file::operator=(async_file&&) noexcept = default;
+
+    std::uint64_t async_file::size() const noexcept
+    {
+        return m_impl == nullptr ? 0 : m_impl->size;
+    }
+
+    async_io::async_io(std::unique_ptr<engine>&& engine) noexcept
+        : m_engine(std::move(engine))
+    {
+    }
+
+    async_io async_io::create(const async_io_options& options)
+    {
+        if (options.queue_depth == 0)
+        {
+            throw except::async_io_error{"Async I/O queue depth must be greater than zero."};
+        }
+
+        switch (options.backend)
+        {
+            case async_io_backend::automatic:
+                if (auto native = make_native_engine(options))
+                {
+                    return async_io{std::move(native)};
+                }
+                return async_io{make_thread_pool_engine(options)};
+            case async_io_backend::io_uring:
+            case async_io_backend::overlapped:
+            {
+                auto native = make_native_engine(options);
+                if (native == nullptr || native->backend() != options.backend)
+                {
+                    throw except::async_io_error{options.backend == async_io_backend::io_uring
+                                                     ? "io_uring is not available on this system."
+                                                     : "Overlapped I/O is not available on this system."};
+                }
+                return async_io{std::move(native)};
+            }
+            case async_io_backend::thread_pool:
+                return async_io{make_thread_pool_engine(options)};
+        }
+        throw except::async_io_error{"Unknown async I/O backend."};
+    }
+
+    async_io::~async_io() = default;
+
+    async_io::async_io(async_io&&) noexcept = default;
+
+    async_io& async_io::operator=(async_io&&) noexcept = default;
+
+    async_file async_io::open(const std::filesystem::path& path)
+    {
+        if (m_engine == nullptr)
+        {
+            throw except::async_io_error{"Cannot open a file through a moved-from async_io."};
+        }
+
+        auto file = open_native_file(path);
+        m_engine->attach(*file);
+        return async_file{std::move(file)};
+    }
+
+    std::size_t async_io::submit(const std::span<const async_read> reads)
+    {
+        if (m_engine == nullptr)
+        {
+            throw except::async_io_error{"Cannot submit reads to a moved-from async_io."};
+        }
+
+        for (const auto& read : reads)
+        {
+            if (read.file == nullptr || read.file->m_impl == nullptr)
+            {
+                throw except::async_io_error{"Async read submitted without an open file."};
+            }
+        }
+        return m_engine->submit(reads);
+    }
+
+    std::size_t async_io::poll(const std::span<async_read_completion> out)
+    {
+        return out.empty() || m_engine == nullptr ? 0 : m_engine->poll(out);
+    }
+
+    std::size_t async_io::wait(const std::span<async_read_completion> out, const platform_clock::duration timeout)
+    {
+        return out.empty() || m_engine == nullptr ? 0 : m_engine->wait(out, timeout);
+    }
+
+    std::size_t async_io::in_flight() const noexcept
+    {
+        return m_engine == nullptr ? 0 : m_engine->in_flight();
+    }
+
+    async_io_backend async_io::backend() const noexcept
+    {
+        return m_engine == nullptr ? async_io_backend::automatic : m_engine->backend();
+    }
+
+    async_io_wait_handle async_io::wait_handle() const noexcept
+    {
+        return m_engine == nullptr ? invalid_wait_handle : m_engine->wait_handle();
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <system_error>
+
+#include "detri/platform.hpp"
+
+namespace detri
+{
+    enum class async_io_backend
+    {
+        // io_uring on Linux or overlapped I/O on Windows, falling back to thread_pool where the kernel refuses it
+        // (old kernels, seccomp-filtered containers).
+        automatic,
+        io_uring,
+        overlapped,
+        // Blocking reads on a small pool of worker threads. Works everywhere.
+        thread_pool
+    };
+
+    struct async_io_options
+    {
+        async_io_backend backend {async_io_backend::automatic};
+        // Most reads in flight at once, counting completions that have not been reaped yet.
+        std::uint32_t queue_depth {128};
+        // Workers for the thread_pool backend. 0 picks min(4, processor_count()).
+        std::uint32_t worker_threads {};
+    };
+
+    // What wait_handle() returns: an eventfd on Linux, an event HANDLE on Windows.
+    using async_io_wait_handle = native_wait_handle;
+
+    // A file opened for asynchronous reads through the async_io that opened it. Keep it open until its reads have
+    // completed; on Windows closing it cancels them.
+    class async_file
+    {
+    public:
+        async_file() = delete;
+
+        ~async_file();
+
+        async_file(async_file&&) noexcept;
+
+        async_file& operator=(async_file&&) noexcept;
+
+        // Size when the file was opened.
+        [[nodiscard]] std::uint64_t size() const noexcept;
+
+        struct impl;
+
+    private:
+        friend class async_io;
+
+        explicit async_file(std::unique_ptr<impl>&& impl) noexcept;
+
+        std::unique_ptr<impl> m_impl;
+    };
+
+    struct async_read
+    {
+        const async_file* file {};
+        std::uint64_t offset {};
+        // Caller-owned, and must stay alive until the read's completion has been reaped. A single read transfers at
+        // most 2 GiB - 4 KiB (the Linux per-call limit, applied everywhere); larger buffers come back short.
+        std::span<std::byte> buffer;
+        // Handed back untouched in the completion.
+        std::uint64_t user_data {};
+    };
+
+    struct async_read_completion
+    {
+        std::uint64_t user_data {};
+        // Less than the buffer size at the end of the file, 0 at or past it.
+        std::size_t bytes_read {};
+        std::error_code error;
+    };
+
+    // Batched asynchronous file reads. One thread submits and reaps; completions come back in whatever order the
+    // device finishes them. A moved-from async_io has no backend: open() and submit() throw except::async_io_error,
+    // and the rest report nothing in flight.
+    class async_io
+    {
+    public:
+        // Throws except::async_io_error if an explicitly requested backend is unavailable on this machine.
+        static async_io create(const async_io_options& options = {});
+
+        async_io() = delete;
+
+        // Blocks until every submitted read has finished, so no buffer is written to after this returns.
+        ~async_io();
+
+        async_io(async_io&&) noexcept;
+
+        async_io& operator=(async_io&&) noexcept;
+
+        // Throws except::async_io_error if the file cannot be opened.
+        [[nodiscard]] async_file open(const std::filesystem::path& path);
+
+        // Queues as many of reads as the queue depth allows and returns how many were taken. Per-read failures
+        // arrive as completions; throws except::async_io_error only if the submission itself fails.
+        std::size_t submit(std::span<const async_read> reads);
+
+        // Reaps finished reads into out without blocking. Returns how many were written.
+        std::size_t poll(std::span<async_read_completion> out);
+
+        // Like poll(), but waits up to timeout for the first completion. Returns 0 straight away when nothing is in
+        // flight.
+        std::size_t wait(std::span<async_read_completion> out, platform_clock::duration timeout);
+
+        // Submitted reads whose completions have not been reaped yet.
+        [[nodiscard]] std::size_t in_flight() const noexcept;
+
+        [[nodiscard]] async_io_backend backend() const noexcept;
+
+        // Becomes readable (Linux) or signaled (Windows) when completions are waiting, so it can sit in the same
+        // wait as the window's input, e.g. through window::wait_any(). Call poll() until it returns 0 after a wakeup;
+        // poll() re-arms it.
+        [[nodiscard]] async_io_wait_handle wait_handle() const noexcept;
+
+        class engine;
+
+    private:
+        explicit async_io(std::unique_ptr<engine>&& engine) noexcept;
+
+        std::unique_ptr<engine> m_engine;
+    };
+}
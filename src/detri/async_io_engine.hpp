@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <system_error>
+
+#include "detri/async_io.hpp"
+#include "detri/platform.hpp"
+
+namespace detri
+{
+    // The most a single read transfers. Linux caps read() and io_uring reads at this (MAX_RW_COUNT) and ReadFile
+    // takes a DWORD, so every backend clamps to the same value.
+    inline constexpr std::size_t max_async_read_size = 0x7FFF'F000;
+
+#ifdef _WIN32
+    using native_file = HANDLE;
+#else
+    using native_file = int;
+#endif
+
+    struct async_file::impl
+    {
+        impl(native_file handle, std::uint64_t size) noexcept;
+
+        ~impl();
+
+        impl(const impl&) = delete;
+
+        impl& operator=(const impl&) = delete;
+
+        native_file handle;
+        std::uint64_t size {};
+    };
+
+    // One backend of async_io. Only ever driven from the thread that owns the async_io.
+    class async_io::engine
+    {
+    public:
+        virtual ~engine() = default;
+
+        [[nodiscard]] virtual async_io_backend backend() const noexcept = 0;
+
+        // Called once for every file opened through the owning async_io, before any read is submitted against it.
+        virtual void attach(const async_file::impl& file) = 0;
+
+        virtual std::size_t submit(std::span<const async_read> reads) = 0;
+
+        virtual std::size_t poll(std::span<async_read_completion> out) = 0;
+
+        virtual std::size_t wait(std::span<async_read_completion> out, platform_clock::duration timeout) = 0;
+
+        [[nodiscard]] virtual std::size_t in_flight() const noexcept = 0;
+
+        [[nodiscard]] virtual async_io_wait_handle wait_handle() const noexcept = 0;
+
+    protected:
+        // async_io has already checked that every submitted read names an open file.
+        [[nodiscard]] static const async_file::impl& file_of(const async_read& read) noexcept
+        {
+            return *read.file->m_impl;
+        }
+    };
+
+    // Auto-reset notification behind async_io::wait_handle() for engines the kernel does not signal by itself.
+    class completion_signal
+    {
+    public:
+        completion_signal();
+
+        ~completion_signal();
+
+        completion_signal(const completion_signal&) = delete;
+
+        completion_signal& operator=(const completion_signal&) = delete;
+
+        void notify() noexcept;
+
+        void reset() noexcept;
+
+        [[nodiscard]] async_io_wait_handle handle() const noexcept
+        {
+            return m_handle;
+        }
+
+    private:
+        async_io_wait_handle m_handle;
+    };
+
+    // async_io_linux.cpp / async_io_win32.cpp.
+    std::unique_ptr<async_file::impl> open_native_file(const std::filesystem::path& path);
+
+    // Blocking positional read for the thread pool. Returns the bytes read; 0 with no error at end of file.
+    std::size_t read_native_file(const async_file::impl& file, std::uint64_t offset, std::span<std::byte> buffer,
+                                 std::error_code& error) noexcept;
+
+    // The OS's own asynchronous backend, or nullptr if the running kernel does not offer it.
+    std::unique_ptr<async_io::engine> make_native_engine(const async_io_options& options);
+
+    // async_io.cpp.
+    std::unique_ptr<async_io::engine> make_thread_pool_engine(const async_io_options& options);
+}
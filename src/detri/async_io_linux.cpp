@@ -0,0 +1,439 @@
+#include "detri/async_io_engine.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define DETRI_HAS_IO_URING 1
+#endif
+
+namespace detri
+{
+    namespace
+    {
+        std::error_code last_error() noexcept
+        {
+            return {errno, std::system_category()};
+        }
+
+        timespec to_timespec(const platform_clock::duration value) noexcept
+        {
+            const auto clamped = std::max(value, platform_clock::duration::zero());
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(clamped);
+            return timespec{
+                .tv_sec = static_cast<time_t>(seconds.count()),
+                .tv_nsec = static_cast<long>((clamped - seconds).count())
+            };
+        }
+
+        // Blocks until fd is readable or timeout passes.
+        void wait_readable(const int fd, const platform_clock::duration timeout) noexcept
+        {
+            pollfd entry{.fd = fd, .events = POLLIN, .revents = 0};
+            const timespec limit = to_timespec(timeout);
+            while (ppoll(&entry, 1, &limit, nullptr) < 0 && errno == EINTR)
+            {
+            }
+        }
+
+#ifdef DETRI_HAS_IO_URING
+        int io_uring_setup(const unsigned entries, io_uring_params* params) noexcept
+        {
+            return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        int io_uring_enter(const int ring, const unsigned to_submit, const unsigned min_complete,
+                           const unsigned flags) noexcept
+        {
+            return static_cast<int>(syscall(__NR_io_uring_enter, ring, to_submit, min_complete, flags, nullptr, 0));
+        }
+
+        int io_uring_register(const int ring, const unsigned opcode, const void* arg, const unsigned count) noexcept
+        {
+            return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, count));
+        }
+
+        // The ring indices are shared with the kernel, which reads and writes them concurrently.
+        unsigned load_acquire(const unsigned* value) noexcept
+        {
+            return std::atomic_ref{*const_cast<unsigned*>(value)}.load(std::memory_order_acquire);
+        }
+
+        void store_release(unsigned* value, const unsigned next) noexcept
+        {
+            std::atomic_ref{*value}.store(next, std::memory_order_release);
+        }
+
+        class io_uring_engine final : public async_io::engine
+        {
+        public:
+            // Returns nullptr if the kernel refuses io_uring or lacks IORING_OP_READ (before 5.6).
+            static std::unique_ptr<io_uring_engine> create(const async_io_options& options)
+            {
+                auto engine = std::unique_ptr<io_uring_engine>{new io_uring_engine{options.queue_depth}};
+                return engine->setup() ? std::move(engine) : nullptr;
+            }
+
+            ~io_uring_engine() override
+            {
+                // The kernel keeps writing into caller buffers until each read completes, so wait them all out
+                // rather than letting the ring teardown race the caller freeing them.
+                std::array<async_read_completion, 64> discard{};
+                while (m_ring >= 0 && m_in_flight != 0)
+                {
+                    if (wait(discard, std::chrono::seconds{1}) == 0 && m_submitted == 0)
+                    {
+                        break;
+                    }
+                }
+
+                if (m_sqes != nullptr)
+                {
+                    munmap(m_sqes, m_sqes_size);
+                }
+                if (m_cq_ring != nullptr && m_cq_ring != m_sq_ring)
+                {
+                    munmap(m_cq_ring, m_cq_ring_size);
+                }
+                if (m_sq_ring != nullptr)
+                {
+                    munmap(m_sq_ring, m_sq_ring_size);
+                }
+                if (m_ring >= 0)
+                {
+                    close(m_ring);
+                }
+                if (m_event >= 0)
+                {
+                    close(m_event);
+                }
+            }
+
+            [[nodiscard]] async_io_backend backend() const noexcept override
+            {
+                return async_io_backend::io_uring;
+            }
+
+            void attach(const async_file::impl&) override
+            {
+            }
+
+            std::size_t submit(const std::span<const async_read> reads) override
+            {
+                const std::size_t accepted = std::min<std::size_t>(reads.size(), m_queue_depth - m_in_flight);
+                unsigned tail = *m_sq_tail;
+                for (std::size_t i = 0; i < accepted; ++i)
+                {
+                    const auto& read = reads[i];
+                    io_uring_sqe& sqe = m_sqes[tail & *m_sq_mask];
+                    std::memset(&sqe, 0, sizeof(sqe));
+                    sqe.opcode = IORING_OP_READ;
+                    sqe.fd = file_of(read).handle;
+                    sqe.off = read.offset;
+                    sqe.addr = reinterpret_cast<std::uint64_t>(read.buffer.data());
+                    sqe.len = static_cast<std::uint32_t>(std::min(read.buffer.size(), max_async_read_size));
+                    sqe.user_data = read.user_data;
+                    ++tail;
+                }
+                store_release(m_sq_tail, tail);
+                m_in_flight += accepted;
+                m_unsubmitted += static_cast<unsigned>(accepted);
+
+                // One syscall for the whole batch.
+                while (m_unsubmitted != 0)
+                {
+                    const int consumed = io_uring_enter(m_ring, m_unsubmitted, 0, 0);
+                    if (consumed < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+                        // EAGAIN/EBUSY mean the kernel is short on resources for now; the entries stay in the ring
+                        // and go out with the next submit() or wait().
+                        if (errno == EAGAIN || errno == EBUSY)
+                        {
+                            break;
+                        }
+                        throw except::async_io_error{"io_uring_enter failed: " + last_error().message()};
+                    }
+                    m_unsubmitted -= static_cast<unsigned>(consumed);
+                    m_submitted += static_cast<unsigned>(consumed);
+                }
+                return accepted;
+            }
+
+            std::size_t poll(const std::span<async_read_completion> out) override
+            {
+                // Re-arm before reaping so a completion that lands in between signals again instead of being lost.
+                std::uint64_t count = 0;
+                while (read(m_event, &count, sizeof(count)) < 0 && errno == EINTR)
+                {
+                }
+                return reap(out);
+            }
+
+            std::size_t wait(const std::span<async_read_completion> out, const platform_clock::duration timeout) override
+            {
+                if (m_unsubmitted != 0)
+                {
+                    const int consumed = io_uring_enter(m_ring, m_unsubmitted, 0, 0);
+                    if (consumed > 0)
+                    {
+                        m_unsubmitted -= static_cast<unsigned>(consumed);
+                        m_submitted += static_cast<unsigned>(consumed);
+                    }
+                }
+
+                std::size_t count = poll(out);
+                if (count == 0 && m_in_flight != 0)
+                {
+                    wait_readable(m_event, timeout);
+                    count = poll(out);
+                }
+                return count;
+            }
+
+            [[nodiscard]] std::size_t in_flight() const noexcept override
+            {
+                return m_in_flight;
+            }
+
+            [[nodiscard]] async_io_wait_handle wait_handle() const noexcept override
+            {
+                return m_event;
+            }
+
+        private:
+            explicit io_uring_engine(const std::uint32_t queue_depth) noexcept
+                : m_queue_depth(queue_depth)
+            {
+            }
+
+            bool setup()
+            {
+                io_uring_params params{};
+                m_ring = io_uring_setup(m_queue_depth, &params);
+                if (m_ring < 0)
+                {
+                    return false;
+                }
+                // The kernel may round the ring up but never down; the completion ring is at least as large, so
+                // capping in-flight reads at queue_depth also rules out completion overflow.
+                if (params.sq_entries < m_queue_depth || params.cq_entries < m_queue_depth)
+                {
+                    return false;
+                }
+
+                m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                {
+                    m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+                }
+
+                m_sq_ring = map(m_sq_ring_size, IORING_OFF_SQ_RING);
+                if (m_sq_ring == nullptr)
+                {
+                    return false;
+                }
+                m_cq_ring = single_mmap ? m_sq_ring : map(m_cq_ring_size, IORING_OFF_CQ_RING);
+                m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                m_sqes = static_cast<io_uring_sqe*>(map(m_sqes_size, IORING_OFF_SQES));
+                if (m_cq_ring == nullptr || m_sqes == nullptr)
+                {
+                    return false;
+                }
+
+                auto* sq = static_cast<std::byte*>(m_sq_ring);
+                auto* cq = static_cast<std::byte*>(m_cq_ring);
+                m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                // Submission slots map one-to-one onto array entries, so the indirection table is filled once.
+                auto* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                for (unsigned i = 0; i < params.sq_entries; ++i)
+                {
+                    array[i] = i;
+                }
+
+                return supports_read() && register_event();
+            }
+
+            void* map(const std::size_t size, const off_t offset) const noexcept
+            {
+                void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, offset);
+                return address == MAP_FAILED ? nullptr : address;
+            }
+
+            bool supports_read() const
+            {
+                std::vector<std::byte> storage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+                auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+                if (io_uring_register(m_ring, IORING_REGISTER_PROBE, probe, 256) < 0)
+                {
+                    return false;
+                }
+                return probe->last_op >= IORING_OP_READ &&
+                       (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+            }
+
+            bool register_event()
+            {
+                m_event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                return m_event >= 0 && io_uring_register(m_ring, IORING_REGISTER_EVENTFD, &m_event, 1) == 0;
+            }
+
+            std::size_t reap(const std::span<async_read_completion> out) noexcept
+            {
+                unsigned head = *m_cq_head;
+                const unsigned tail = load_acquire(m_cq_tail);
+                std::size_t count = 0;
+                for (; head != tail && count < out.size(); ++head, ++count)
+                {
+                    const io_uring_cqe& cqe = m_cqes[head & *m_cq_mask];
+                    out[count] = async_read_completion{
+                        .user_data = cqe.user_data,
+                        .bytes_read = cqe.res > 0 ? static_cast<std::size_t>(cqe.res) : 0,
+                        .error = cqe.res < 0 ? std::error_code{-cqe.res, std::system_category()} : std::error_code{}
+                    };
+                }
+                store_release(m_cq_head, head);
+                m_in_flight -= count;
+                m_submitted -= static_cast<unsigned>(count);
+                return count;
+            }
+
+            std::uint32_t m_queue_depth;
+            int m_ring {-1};
+            int m_event {-1};
+            void* m_sq_ring {};
+            void* m_cq_ring {};
+            std::size_t m_sq_ring_size {};
+            std::size_t m_cq_ring_size {};
+            io_uring_sqe* m_sqes {};
+            std::size_t m_sqes_size {};
+            unsigned* m_sq_tail {};
+            unsigned* m_sq_mask {};
+            unsigned* m_cq_head {};
+            unsigned* m_cq_tail {};
+            unsigned* m_cq_mask {};
+            io_uring_cqe* m_cqes {};
+            std::size_t m_in_flight {};
+            // Queued in the ring but not yet handed to the kernel, and handed over but not yet reaped.
+            unsigned m_unsubmitted {};
+            unsigned m_submitted {};
+        };
+#endif
+    }
+
+    async_file::impl::impl(const native_file handle, const std::uint64_t size) noexcept
+        : handle(handle), size(size)
+    {
+    }
+
+    async_file::impl::~impl()
+    {
+        close(handle);
+    }
+
+    completion_signal::completion_signal()
+        : m_handle(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    {
+        if (m_handle < 0)
+        {
+            throw except::async_io_error{"Failed to create eventfd: " + last_error().message()};
+        }
+    }
+
+    completion_signal::~completion_signal()
+    {
+        close(m_handle);
+    }
+
+    void completion_signal::notify() noexcept
+    {
+        const std::uint64_t one = 1;
+        while (write(m_handle, &one, sizeof(one)) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    void completion_signal::reset() noexcept
+    {
+        std::uint64_t count = 0;
+        while (read(m_handle, &count, sizeof(count)) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    std::unique_ptr<async_file::impl> open_native_file(const std::filesystem::path& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw except::async_io_error{"Failed to open '" + path.string() + "': " + last_error().message()};
+        }
+
+        struct stat status{};
+        if (fstat(fd, &status) != 0)
+        {
+            const auto error = last_error();
+            close(fd);
+            throw except::async_io_error{"Failed to stat '" + path.string() + "': " + error.message()};
+        }
+
+        return std::make_unique<async_file::impl>(fd, static_cast<std::uint64_t>(status.st_size));
+    }
+
+    std::size_t read_native_file(const async_file::impl& file, const std::uint64_t offset,
+                                 const std::span<std::byte> buffer, std::error_code& error) noexcept
+    {
+        while (true)
+        {
+            const ssize_t result = pread(file.handle, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+            if (result >= 0)
+            {
+                return static_cast<std::size_t>(result);
+            }
+            if (errno != EINTR)
+            {
+                error = last_error();
+                return 0;
+            }
+        }
+    }
+
+    std::unique_ptr<async_io::engine> make_native_engine([[maybe_unused]] const async_io_options& options)
+    {
+#ifdef DETRI_HAS_IO_URING
+        if (options.backend == async_io_backend::automatic || options.backend == async_io_backend::io_uring)
+        {
+            return io_uring_engine::create(options);
+        }
+#endif
+        return nullptr;
+    }
+}
@@ -0,0 +1,367 @@
+#include "detri/async_io_engine.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace detri
+{
+    namespace
+    {
+        std::error_code error_from(const DWORD code) noexcept
+        {
+            return {static_cast<int>(code), std::system_category()};
+        }
+
+        DWORD to_milliseconds(const platform_clock::duration value) noexcept
+        {
+            // Round up so a short timeout still waits rather than degenerating into a poll.
+            const auto milliseconds = std::chrono::ceil<std::chrono::milliseconds>(std::max(value, platform_clock::duration::zero()));
+            return static_cast<DWORD>(std::min<std::int64_t>(milliseconds.count(), INFINITE - 1));
+        }
+
+        OVERLAPPED overlapped_at(const std::uint64_t offset, const HANDLE event) noexcept
+        {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            overlapped.hEvent = event;
+            return overlapped;
+        }
+
+        class iocp_engine final : public async_io::engine
+        {
+        public:
+            static std::unique_ptr<iocp_engine> create(const async_io_options& options)
+            {
+                auto engine = std::unique_ptr<iocp_engine>{new iocp_engine{options.queue_depth}};
+                engine->m_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+                // Manual-reset: every OVERLAPPED carries it, so the kernel sets it on each completion alongside the
+                // packet it queues to the port, and poll() resets it.
+                engine->m_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+                if (engine->m_port == nullptr || engine->m_event == nullptr)
+                {
+                    return nullptr;
+                }
+                return engine;
+            }
+
+            ~iocp_engine() override
+            {
+                // Pending reads still own their OVERLAPPED slots and caller buffers; wait them out.
+                while (m_port != nullptr && m_in_kernel != 0)
+                {
+                    dequeue(INFINITE);
+                }
+
+                if (m_event != nullptr)
+                {
+                    CloseHandle(m_event);
+                }
+                if (m_port != nullptr)
+                {
+                    CloseHandle(m_port);
+                }
+            }
+
+            [[nodiscard]] async_io_backend backend() const noexcept override
+            {
+                return async_io_backend::overlapped;
+            }
+
+            void attach(const async_file::impl& file) override
+            {
+                if (CreateIoCompletionPort(file.handle, m_port, 0, 0) == nullptr)
+                {
+                    throw except::async_io_error{"Failed to associate file with the I/O completion port. Windows error code: " +
+                                                 std::to_string(GetLastError())};
+                }
+            }
+
+            std::size_t submit(const std::span<const async_read> reads) override
+            {
+                const std::size_t accepted = std::min<std::size_t>(reads.size(), m_queue_depth - m_in_flight);
+                for (std::size_t i = 0; i < accepted; ++i)
+                {
+                    const auto& read = reads[i];
+                    const std::uint32_t index = m_free.back();
+                    m_free.pop_back();
+
+                    pending_read& slot = m_slots[index];
+                    slot.overlapped = overlapped_at(read.offset, m_event);
+                    slot.file = file_of(read).handle;
+                    slot.user_data = read.user_data;
+
+                    const auto length = static_cast<DWORD>(std::min(read.buffer.size(), max_async_read_size));
+                    ++m_in_flight;
+                    // A read that completes straight away still queues its packet to the port, so only outright
+                    // failures are handled here.
+                    if (!ReadFile(slot.file, read.buffer.data(), length, nullptr, &slot.overlapped))
+                    {
+                        const DWORD error = GetLastError();
+                        if (error != ERROR_IO_PENDING)
+                        {
+                            m_ready.push_back(async_read_completion{
+                                .user_data = read.user_data,
+                                .bytes_read = 0,
+                                .error = error == ERROR_HANDLE_EOF ? std::error_code{} : error_from(error)
+                            });
+                            m_free.push_back(index);
+                            continue;
+                        }
+                    }
+                    ++m_in_kernel;
+                }
+
+                // ReadFile resets the event as each read starts, which can swallow the signal of a read that finished
+                // earlier. Pull whatever is already on the port into m_ready and re-signal for it.
+                if (accepted != 0)
+                {
+                    dequeue(0);
+                    if (!m_ready.empty())
+                    {
+                        SetEvent(m_event);
+                    }
+                }
+                return accepted;
+            }
+
+            std::size_t poll(const std::span<async_read_completion> out) override
+            {
+                // Re-arm before reaping so a completion that lands in between signals again instead of being lost.
+                ResetEvent(m_event);
+                if (m_ready.size() < out.size())
+                {
+                    dequeue(0);
+                }
+                return take_ready(out);
+            }
+
+            std::size_t wait(const std::span<async_read_completion> out, const platform_clock::duration timeout) override
+            {
+                ResetEvent(m_event);
+                if (m_ready.empty())
+                {
+                    dequeue(0);
+                }
+                if (m_ready.empty() && m_in_kernel != 0)
+                {
+                    dequeue(to_milliseconds(timeout));
+                }
+                return take_ready(out);
+            }
+
+            [[nodiscard]] std::size_t in_flight() const noexcept override
+            {
+                return m_in_flight;
+            }
+
+            [[nodiscard]] async_io_wait_handle wait_handle() const noexcept override
+            {
+                return m_event;
+            }
+
+        private:
+            struct pending_read
+            {
+                OVERLAPPED overlapped;
+                HANDLE file;
+                std::uint64_t user_data;
+            };
+
+            explicit iocp_engine(const std::uint32_t queue_depth)
+                : m_queue_depth(queue_depth), m_slots(std::make_unique<pending_read[]>(queue_depth)),
+                  m_entries(std::min<std::uint32_t>(queue_depth, 64))
+            {
+                m_free.reserve(queue_depth);
+                for (std::uint32_t i = queue_depth; i > 0; --i)
+                {
+                    m_free.push_back(i - 1);
+                }
+            }
+
+            // Moves finished packets off the port into m_ready, waiting up to timeout for the first one.
+            void dequeue(const DWORD timeout)
+            {
+                if (m_in_kernel == 0)
+                {
+                    return;
+                }
+
+                ULONG removed = 0;
+                const auto wanted = static_cast<ULONG>(std::min(m_in_kernel, m_entries.size()));
+                if (!GetQueuedCompletionStatusEx(m_port, m_entries.data(), wanted, &removed, timeout, FALSE))
+                {
+                    return;
+                }
+                for (ULONG i = 0; i < removed; ++i)
+                {
+                    m_ready.push_back(complete(m_entries[i]));
+                }
+            }
+
+            async_read_completion complete(const OVERLAPPED_ENTRY& entry) noexcept
+            {
+                auto* slot = reinterpret_cast<pending_read*>(entry.lpOverlapped);
+                async_read_completion completion{
+                    .user_data = slot->user_data,
+                    .bytes_read = entry.dwNumberOfBytesTransferred,
+                    .error = {}
+                };
+
+                // The request is already done, so this only translates its final status into a Win32 error.
+                DWORD transferred = 0;
+                if (!GetOverlappedResult(slot->file, &slot->overlapped, &transferred, FALSE))
+                {
+                    const DWORD error = GetLastError();
+                    if (error != ERROR_HANDLE_EOF)
+                    {
+                        completion.error = error_from(error);
+                    }
+                }
+
+                m_free.push_back(static_cast<std::uint32_t>(slot - m_slots.get()));
+                --m_in_kernel;
+                return completion;
+            }
+
+            std::size_t take_ready(const std::span<async_read_completion> out)
+            {
+                const std::size_t count = std::min(out.size(), m_ready.size());
+                std::copy_n(m_ready.begin(), count, out.begin());
+                m_ready.erase(m_ready.begin(), m_ready.begin() + static_cast<std::ptrdiff_t>(count));
+                m_in_flight -= count;
+                return count;
+            }
+
+            std::uint32_t m_queue_depth;
+            HANDLE m_port {};
+            HANDLE m_event {};
+            std::unique_ptr<pending_read[]> m_slots;
+            std::vector<std::uint32_t> m_free;
+            std::vector<OVERLAPPED_ENTRY> m_entries;
+            // Finished reads not handed out yet, including ones ReadFile rejected outright.
+            std::deque<async_read_completion> m_ready;
+            std::size_t m_in_flight {};
+            std::size_t m_in_kernel {};
+        };
+    }
+
+    async_file::impl::impl(const native_file handle, const std::uint64_t size) noexcept
+        : handle(handle), size(size)
+    {
+    }
+
+    async_file::impl::~impl()
+    {
+        CloseHandle(handle);
+    }
+
+    completion_signal::completion_signal()
+        : m_handle(CreateEventW(nullptr, FALSE, FALSE, nullptr))
+    {
+        if (m_handle == nullptr)
+        {
+            throw except::async_io_error{"Failed to create completion event. Windows error code: " +
+                                         std::to_string(GetLastError())};
+        }
+    }
+
+    completion_signal::~completion_signal()
+    {
+        CloseHandle(m_handle);
+    }
+
+    void completion_signal::notify() noexcept
+    {
+        SetEvent(m_handle);
+    }
+
+    void completion_signal::reset() noexcept
+    {
+        ResetEvent(m_handle);
+    }
+
+    std::unique_ptr<async_file::impl> open_native_file(const std::filesystem::path& path)
+    {
+        const HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            throw except::async_io_error{"Failed to open '" + path.string() + "'. Windows error code: " +
+                                         std::to_string(GetLastError())};
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(handle, &size))
+        {
+            const DWORD error = GetLastError();
+            CloseHandle(handle);
+            throw except::async_io_error{"Failed to query the size of '" + path.string() + "'. Windows error code: " +
+                                         std::to_string(error)};
+        }
+
+        return std::make_unique<async_file::impl>(handle, static_cast<std::uint64_t>(size.QuadPart));
+    }
+
+    std::size_t read_native_file(const async_file::impl& file, const std::uint64_t offset,
+                                 const std::span<std::byte> buffer, std::error_code& error) noexcept
+    {
+        // The handle is opened for overlapped I/O, so even a blocking read goes through an OVERLAPPED. Each worker
+        // keeps its own event for it.
+        struct worker_event
+        {
+            HANDLE handle {CreateEventW(nullptr, TRUE, FALSE, nullptr)};
+
+            ~worker_event()
+            {
+                if (handle != nullptr)
+                {
+                    CloseHandle(handle);
+                }
+            }
+        };
+        thread_local const worker_event event;
+        if (event.handle == nullptr)
+        {
+            error = error_from(GetLastError());
+            return 0;
+        }
+        OVERLAPPED overlapped = overlapped_at(offset, event.handle);
+
+        DWORD transferred = 0;
+        if (!ReadFile(file.handle, buffer.data(), static_cast<DWORD>(buffer.size()), nullptr, &overlapped) &&
+            GetLastError() != ERROR_IO_PENDING)
+        {
+            const DWORD code = GetLastError();
+            if (code != ERROR_HANDLE_EOF)
+            {
+                error = error_from(code);
+            }
+            return 0;
+        }
+        if (!GetOverlappedResult(file.handle, &overlapped, &transferred, TRUE))
+        {
+            const DWORD code = GetLastError();
+            if (code != ERROR_HANDLE_EOF)
+            {
+                error = error_from(code);
+            }
+            return 0;
+        }
+        return transferred;
+    }
+
+    std::unique_ptr<async_io::engine> make_native_engine(const async_io_options& options)
+    {
+        if (options.backend == async_io_backend::automatic || options.backend == async_io_backend::overlapped)
+        {
+            return iocp_engine::create(options);
+        }
+        return nullptr;
+    }
+}
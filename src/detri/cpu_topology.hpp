@@ -0,0 +1,87 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace detri
+{
+    // A logical processor as the OS numbers it: processor group and index within the group on Windows, group 0 and
+    // the CPU number on Linux.
+    struct logical_processor
+    {
+        std::uint16_t group {};
+        std::uint32_t number {};
+
+        auto operator<=>(const logical_processor&) const = default;
+    };
+
+    struct cpu_core
+    {
+        std::uint32_t package {};
+        std::uint32_t numa_node {};
+        // The core's SMT siblings, lowest first. One entry on cores without SMT.
+        std::vector<logical_processor> logical_processors;
+    };
+
+    enum class cpu_cache_kind
+    {
+        unified, instruction, data
+    };
+
+    struct cpu_cache
+    {
+        std::uint32_t level {};
+        cpu_cache_kind kind {cpu_cache_kind::unified};
+        std::uint64_t size {};
+        std::uint32_t line_size {};
+        // Every logical processor that shares this cache instance.
+        std::vector<logical_processor> shared_by;
+    };
+
+    struct numa_node
+    {
+        std::uint32_t id {};
+        std::vector<logical_processor> logical_processors;
+    };
+
+    // How the machine's online logical processors are grouped into physical cores, packages, caches and NUMA nodes.
+    // Describes the machine, not the process: processor_count() is what the process may actually use.
+    struct cpu_topology
+    {
+        // Throws except::platform_exception if the OS does not describe its processors.
+        static cpu_topology query();
+
+        std::vector<cpu_core> cores;
+        std::uint32_t package_count {};
+        // One entry per cache instance, sorted by level.
+        std::vector<cpu_cache> caches;
+        std::vector<numa_node> numa_nodes;
+        // Coherency granule of the L1 data cache; the stride to pad shared atomics to.
+        std::uint32_t cache_line_size {64};
+
+        [[nodiscard]] std::size_t logical_processor_count() const noexcept
+        {
+            std::size_t count = 0;
+            for (const auto& core : cores)
+            {
+                count += core.logical_processors.size();
+            }
+            return count;
+        }
+    };
+
+    enum class thread_priority
+    {
+        lowest, below_normal, normal, above_normal, highest
+    };
+
+    // Restricts the calling thread to processors. On Windows they must all be in one processor group. Throws
+    // except::platform_exception if the OS rejects the set.
+    void set_current_thread_affinity(std::span<const logical_processor> processors);
+
+    // Windows thread priority levels; nice values 10, 5, 0, -5 and -10 on Linux, where raising the priority above
+    // normal needs CAP_SYS_NICE. Throws except::platform_exception if the OS refuses.
+    void set_current_thread_priority(thread_priority priority);
+}
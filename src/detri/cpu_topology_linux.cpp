@@ -0,0 +1,311 @@
+#include "detri/cpu_topology.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace detri
+{
+    namespace
+    {
+        const std::string sysfs_cpu = "/sys/devices/system/cpu/";
+        const std::string sysfs_node = "/sys/devices/system/node";
+
+        std::optional<std::string> read_line(const std::string& path)
+        {
+            std::ifstream file{path};
+            std::string line;
+            if (!std::getline(file, line))
+            {
+                return std::nullopt;
+            }
+            return line;
+        }
+
+        template <typename T>
+        std::optional<T> read_number(const std::string& path)
+        {
+            std::ifstream file{path};
+            T value{};
+            if (!(file >> value))
+            {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        // Parses the kernel's cpulist format, e.g. "0-3,8,10-11".
+        std::vector<std::uint32_t> parse_cpu_list(const std::string& list)
+        {
+            std::vector<std::uint32_t> cpus;
+            std::stringstream stream{list};
+            std::string range;
+            while (std::getline(stream, range, ','))
+            {
+                if (range.empty())
+                {
+                    continue;
+                }
+                const auto dash = range.find('-');
+                const auto first = static_cast<std::uint32_t>(std::stoul(range.substr(0, dash)));
+                const auto last = dash == std::string::npos ? first
+                                                            : static_cast<std::uint32_t>(std::stoul(range.substr(dash + 1)));
+                for (std::uint32_t cpu = first; cpu <= last; ++cpu)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            return cpus;
+        }
+
+        std::vector<logical_processor> to_processors(const std::vector<std::uint32_t>& cpus)
+        {
+            std::vector<logical_processor> processors;
+            processors.reserve(cpus.size());
+            for (const std::uint32_t cpu : cpus)
+            {
+                processors.push_back({.group = 0, .number = cpu});
+            }
+            return processors;
+        }
+
+        // "32K", "1024K", "8M" as found in cache/index*/size.
+        std::uint64_t parse_size(const std::string& text)
+        {
+            std::uint64_t value = std::stoull(text);
+            switch (text.empty() ? '\0' : text.back())
+            {
+                case 'K':
+                    value *= 1024;
+                    break;
+                case 'M':
+                    value *= 1024 * 1024;
+                    break;
+                case 'G':
+                    value *= 1024 * 1024 * 1024;
+                    break;
+                default:
+                    break;
+            }
+            return value;
+        }
+
+        std::optional<cpu_cache_kind> parse_cache_kind(const std::string& type)
+        {
+            if (type == "Data")
+            {
+                return cpu_cache_kind::data;
+            }
+            if (type == "Instruction")
+            {
+                return cpu_cache_kind::instruction;
+            }
+            if (type == "Unified")
+            {
+                return cpu_cache_kind::unified;
+            }
+            return std::nullopt;
+        }
+
+        int to_nice(const thread_priority priority) noexcept
+        {
+            switch (priority)
+            {
+                case thread_priority::lowest:
+                    return 10;
+                case thread_priority::below_normal:
+                    return 5;
+                case thread_priority::normal:
+                    return 0;
+                case thread_priority::above_normal:
+                    return -5;
+                case thread_priority::highest:
+                    return -10;
+            }
+            return 0;
+        }
+    }
+
+    cpu_topology cpu_topology::query()
+    {
+        const auto online_list = read_line(sysfs_cpu + "online");
+        if (!online_list.has_value())
+        {
+            throw except::platform_exception{"Failed to read the online CPU list from sysfs."};
+        }
+
+        std::vector<std::uint32_t> online;
+        try
+        {
+            online = parse_cpu_list(*online_list);
+        }
+        catch (const std::exception&)
+        {
+            throw except::platform_exception{"Malformed online CPU list '" + *online_list + "'."};
+        }
+        if (online.empty())
+        {
+            throw except::platform_exception{"OS reported zero logical processors."};
+        }
+        const auto is_online = [&online](const std::uint32_t cpu) {
+            return std::binary_search(online.begin(), online.end(), cpu);
+        };
+
+        cpu_topology topology;
+
+        // Packages are renumbered densely in the order they are first seen; the raw ids can have gaps.
+        std::map<int, std::uint32_t> packages;
+        std::map<std::uint32_t, std::uint32_t> node_of_cpu;
+        // Node ids can have gaps, so list the directory rather than counting up.
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator{sysfs_node, error})
+        {
+            const std::string name = entry.path().filename().string();
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+                !std::all_of(name.begin() + 4, name.end(), [](const char c) { return c >= '0' && c <= '9'; }))
+            {
+                continue;
+            }
+
+            const auto node = static_cast<std::uint32_t>(std::stoul(name.substr(4)));
+            numa_node entry_node{.id = node, .logical_processors = {}};
+            for (const std::uint32_t cpu : parse_cpu_list(read_line(entry.path().string() + "/cpulist").value_or("")))
+            {
+                if (is_online(cpu))
+                {
+                    entry_node.logical_processors.push_back({.group = 0, .number = cpu});
+                    node_of_cpu[cpu] = node;
+                }
+            }
+            topology.numa_nodes.push_back(std::move(entry_node));
+        }
+        std::sort(topology.numa_nodes.begin(), topology.numa_nodes.end(), [](const numa_node& left, const numa_node& right) {
+            return left.id < right.id;
+        });
+        if (topology.numa_nodes.empty())
+        {
+            // Kernels built without NUMA support have no node directory; the whole machine is one node.
+            topology.numa_nodes.push_back({.id = 0, .logical_processors = to_processors(online)});
+        }
+
+        std::map<std::tuple<std::uint32_t, int, std::string>, std::size_t> seen_caches;
+        for (const std::uint32_t cpu : online)
+        {
+            const std::string directory = sysfs_cpu + "cpu" + std::to_string(cpu) + "/";
+
+            // A core is listed once, by its lowest online SMT sibling.
+            std::vector<std::uint32_t> siblings = parse_cpu_list(
+                read_line(directory + "topology/thread_siblings_list").value_or(std::to_string(cpu)));
+            std::erase_if(siblings, [&is_online](const std::uint32_t sibling) { return !is_online(sibling); });
+            if (siblings.empty() || siblings.front() == cpu)
+            {
+                const int package_id = read_number<int>(directory + "topology/physical_package_id").value_or(0);
+                const auto package = packages.try_emplace(package_id, static_cast<std::uint32_t>(packages.size())).first;
+                topology.cores.push_back(cpu_core{
+                    .package = package->second,
+                    .numa_node = node_of_cpu.contains(cpu) ? node_of_cpu[cpu] : 0,
+                    .logical_processors = to_processors(siblings.empty() ? std::vector{cpu} : siblings)
+                });
+            }
+
+            for (std::uint32_t index = 0; std::filesystem::exists(directory + "cache/index" + std::to_string(index)); ++index)
+            {
+                const std::string cache = directory + "cache/index" + std::to_string(index) + "/";
+                const auto level = read_number<std::uint32_t>(cache + "level");
+                const auto kind = parse_cache_kind(read_line(cache + "type").value_or(""));
+                const auto shared = read_line(cache + "shared_cpu_list");
+                if (!level.has_value() || !kind.has_value() || !shared.has_value())
+                {
+                    continue;
+                }
+
+                // Every CPU sharing a cache lists it; keep one entry per instance.
+                const auto key = std::tuple{*level, static_cast<int>(*kind), *shared};
+                if (seen_caches.contains(key))
+                {
+                    continue;
+                }
+                seen_caches.emplace(key, topology.caches.size());
+
+                std::vector<std::uint32_t> sharers = parse_cpu_list(*shared);
+                std::erase_if(sharers, [&is_online](const std::uint32_t sharer) { return !is_online(sharer); });
+                const auto line_size = read_number<std::uint32_t>(cache + "coherency_line_size").value_or(0);
+                topology.caches.push_back(cpu_cache{
+                    .level = *level,
+                    .kind = *kind,
+                    .size = parse_size(read_line(cache + "size").value_or("0")),
+                    .line_size = line_size,
+                    .shared_by = to_processors(sharers)
+                });
+                if (*level == 1 && *kind != cpu_cache_kind::instruction && line_size != 0)
+                {
+                    topology.cache_line_size = line_size;
+                }
+            }
+        }
+
+        std::stable_sort(topology.caches.begin(), topology.caches.end(), [](const cpu_cache& left, const cpu_cache& right) {
+            return left.level < right.level;
+        });
+        topology.package_count = static_cast<std::uint32_t>(std::max<std::size_t>(packages.size(), 1));
+        return topology;
+    }
+
+    void set_current_thread_affinity(const std::span<const logical_processor> processors)
+    {
+        if (processors.empty())
+        {
+            throw except::platform_exception{"Thread affinity needs at least one logical processor."};
+        }
+
+        std::uint32_t highest = 0;
+        for (const auto& processor : processors)
+        {
+            highest = std::max(highest, processor.number);
+        }
+
+        const std::size_t cpus = std::max<std::size_t>(CPU_SETSIZE, highest + 1);
+        cpu_set_t* set = CPU_ALLOC(cpus);
+        if (set == nullptr)
+        {
+            throw except::platform_exception{"Failed to allocate a CPU set."};
+        }
+        const std::size_t size = CPU_ALLOC_SIZE(cpus);
+        CPU_ZERO_S(size, set);
+        for (const auto& processor : processors)
+        {
+            CPU_SET_S(processor.number, size, set);
+        }
+
+        const int result = sched_setaffinity(0, size, set);
+        const int error = errno;
+        CPU_FREE(set);
+        if (result != 0)
+        {
+            throw except::platform_exception{"Failed to set thread affinity: " + std::string{std::strerror(error)}};
+        }
+    }
+
+    void set_current_thread_priority(const thread_priority priority)
+    {
+        // Linux keeps a nice value per thread; PRIO_PROCESS with a thread id addresses just that thread.
+        const auto thread = static_cast<id_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, thread, to_nice(priority)) != 0)
+        {
+            throw except::platform_exception{"Failed to set thread priority: " + std::string{std::strerror(errno)}};
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#include "detri/cpu_topology.hpp"
+#include "detri/platform.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <string>
+
+namespace detri
+{
+    namespace
+    {
+        std::vector<logical_processor> to_processors(const GROUP_AFFINITY& affinity)
+        {
+            std::vector<logical_processor> processors;
+            for (KAFFINITY mask = affinity.Mask; mask != 0; mask &= mask - 1)
+            {
+                processors.push_back({
+                    .group = affinity.Group,
+                    .number = static_cast<std::uint32_t>(std::countr_zero(mask))
+                });
+            }
+            return processors;
+        }
+
+        bool contains(const GROUP_AFFINITY& affinity, const logical_processor& processor) noexcept
+        {
+            return affinity.Group == processor.group && processor.number < 64 &&
+                   (affinity.Mask & (KAFFINITY{1} << processor.number)) != 0;
+        }
+
+        int to_windows_priority(const thread_priority priority) noexcept
+        {
+            switch (priority)
+            {
+                case thread_priority::lowest:
+                    return THREAD_PRIORITY_LOWEST;
+                case thread_priority::below_normal:
+                    return THREAD_PRIORITY_BELOW_NORMAL;
+                case thread_priority::normal:
+                    return THREAD_PRIORITY_NORMAL;
+                case thread_priority::above_normal:
+                    return THREAD_PRIORITY_ABOVE_NORMAL;
+                case thread_priority::highest:
+                    return THREAD_PRIORITY_HIGHEST;
+            }
+            return THREAD_PRIORITY_NORMAL;
+        }
+    }
+
+    cpu_topology cpu_topology::query()
+    {
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+        std::vector<std::byte> storage(length);
+        if (length == 0 || !GetLogicalProcessorInformationEx(
+                RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(storage.data()), &length))
+        {
+            throw except::platform_exception{"GetLogicalProcessorInformationEx failed. Windows error code: " +
+                                             std::to_string(GetLastError())};
+        }
+
+        cpu_topology topology;
+        std::vector<std::vector<GROUP_AFFINITY>> packages;
+        std::vector<GROUP_AFFINITY> node_masks;
+
+        // Records are variable-length; each carries its own size.
+        for (DWORD offset = 0; offset < length;)
+        {
+            const auto& info = *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(storage.data() + offset);
+            offset += info.Size;
+
+            switch (info.Relationship)
+            {
+                case RelationProcessorCore:
+                {
+                    // A core never spans processor groups, so its siblings are all in the first mask.
+                    cpu_core core;
+                    core.logical_processors = to_processors(info.Processor.GroupMask[0]);
+                    if (!core.logical_processors.empty())
+                    {
+                        topology.cores.push_back(std::move(core));
+                    }
+                    break;
+                }
+                case RelationProcessorPackage:
+                {
+                    // A package can span several groups on machines with more than 64 logical processors.
+                    std::vector<GROUP_AFFINITY> masks(info.Processor.GroupMask, info.Processor.GroupMask + info.Processor.GroupCount);
+                    packages.push_back(std::move(masks));
+                    break;
+                }
+                case RelationCache:
+                {
+                    if (info.Cache.Type == CacheTrace)
+                    {
+                        break;
+                    }
+                    topology.caches.push_back(cpu_cache{
+                        .level = info.Cache.Level,
+                        .kind = info.Cache.Type == CacheData          ? cpu_cache_kind::data
+                                : info.Cache.Type == CacheInstruction ? cpu_cache_kind::instruction
+                                                                      : cpu_cache_kind::unified,
+                        .size = info.Cache.CacheSize,
+                        .line_size = info.Cache.LineSize,
+                        .shared_by = to_processors(info.Cache.GroupMask)
+                    });
+                    if (info.Cache.Level == 1 && info.Cache.Type != CacheInstruction && info.Cache.LineSize != 0)
+                    {
+                        topology.cache_line_size = info.Cache.LineSize;
+                    }
+                    break;
+                }
+                case RelationNumaNode:
+                {
+                    topology.numa_nodes.push_back(numa_node{
+                        .id = info.NumaNode.NodeNumber,
+                        .logical_processors = to_processors(info.NumaNode.GroupMask)
+                    });
+                    node_masks.push_back(info.NumaNode.GroupMask);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        if (topology.cores.empty())
+        {
+            throw except::platform_exception{"OS reported zero processor cores."};
+        }
+
+        for (auto& core : topology.cores)
+        {
+            const logical_processor& first = core.logical_processors.front();
+            for (std::size_t package = 0; package < packages.size(); ++package)
+            {
+                if (std::ranges::any_of(packages[package], [&first](const GROUP_AFFINITY& mask) { return contains(mask, first); }))
+                {
+                    core.package = static_cast<std::uint32_t>(package);
+                    break;
+                }
+            }
+            for (std::size_t node = 0; node < node_masks.size(); ++node)
+            {
+                if (contains(node_masks[node], first))
+                {
+                    core.numa_node = topology.numa_nodes[node].id;
+                    break;
+                }
+            }
+        }
+
+        std::stable_sort(topology.caches.begin(), topology.caches.end(), [](const cpu_cache& left, const cpu_cache& right) {
+            return left.level < right.level;
+        });
+        topology.package_count = static_cast<std::uint32_t>(std::max<std::size_t>(packages.size(), 1));
+        return topology;
+    }
+
+    void set_current_thread_affinity(const std::span<const logical_processor> processors)
+    {
+        if (processors.empty())
+        {
+            throw except::platform_exception{"Thread affinity needs at least one logical processor."};
+        }
+
+        GROUP_AFFINITY affinity{};
+        affinity.Group = processors.front().group;
+        for (const auto& processor : processors)
+        {
+            if (processor.group != affinity.Group || processor.number >= 64)
+            {
+                throw except::platform_exception{"Thread affinity on Windows must stay within one processor group."};
+            }
+            affinity.Mask |= KAFFINITY{1} << processor.number;
+        }
+
+        if (!SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr))
+        {
+            throw except::platform_exception{"Failed to set thread affinity. Windows error code: " +
+                                             std::to_string(GetLastError())};
+        }
+    }
+
+    void set_current_thread_priority(const thread_priority priority)
+    {
+        if (!SetThreadPriority(GetCurrentThread(), to_windows_priority(priority)))
+        {
+            throw except::platform_exception{"Failed to set thread priority. Windows error code: " +
+                                             std::to_string(GetLastError())};
+        }
+    }
+}
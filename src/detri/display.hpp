@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "detri/platform.hpp"
+
+namespace detri
+{
+    // A monitor as the window system sees it. width and height are the resolution of its current mode in pixels, as
+    // it is oriented on the desk; x and y place it on the desktop, which Wayland lays out in logical units.
+    struct display_info
+    {
+        // Tells displays apart across enumerations while they stay connected.
+        std::uint64_t id {};
+        std::string name;
+        std::int32_t x {};
+        std::int32_t y {};
+        std::uint32_t width {};
+        std::uint32_t height {};
+        // Of the current mode, in hertz and exact where the OS reports it as a fraction (59.94, not 60). 0 when the OS
+        // does not say.
+        double refresh_rate {};
+        // Pixels per unit of window::size() that content should be rendered at: DPI / 96 on Windows and X11, the
+        // output's buffer scale on Wayland.
+        float scale {1.0f};
+        bool primary {};
+        // The display can present HDR, and whether it currently does. Only Windows reports either.
+        bool hdr_supported {};
+        bool hdr_enabled {};
+
+        // One refresh period, for frame_pacer_options::frame_time. Zero if refresh_rate is unknown.
+        [[nodiscard]] platform_clock::duration refresh_interval() const noexcept
+        {
+            if (refresh_rate <= 0.0)
+            {
+                return platform_clock::duration::zero();
+            }
+            const std::chrono::duration<double> seconds{1.0 / refresh_rate};
+            return std::chrono::duration_cast<platform_clock::duration>(seconds);
+        }
+    };
+
+    // Every active display, the primary one first. Throws except::window_error if the window system cannot be reached.
+    std::vector<display_info> enumerate_displays();
+}
@@ -0,0 +1,68 @@
+#include "detri/event_consumer.hpp"
+
+namespace detri
+{
+    namespace
+    {
+        // keyboard_state::consume(), except that every held key is dropped at each focus_lost_event, so a key pressed
+        // again later in the same batch still counts as down.
+        void consume_keys(keyboard_state& keyboard, const std::span<const event> batch, const bool queue_empty) noexcept
+        {
+            std::size_t first = 0;
+            for (std::size_t i = 0; i < batch.size(); ++i)
+            {
+                if (std::holds_alternative<focus_lost_event>(batch[i]))
+                {
+                    keyboard.consume(batch.subspan(first, i - first), false);
+                    keyboard.release_all();
+                    first = i + 1;
+                }
+            }
+            keyboard.consume(batch.subspan(first), queue_empty);
+        }
+    }
+
+    std::optional<event> event_consumer::poll(event_queue& live)
+    {
+        std::optional<event> value;
+        if (replayer != nullptr)
+        {
+            value = replayer->next();
+        }
+        if (!value.has_value())
+        {
+            value = live.pop();
+        }
+
+        const auto handed_out = value.has_value() ? std::span<const event>{&*value, 1} : std::span<const event>{};
+        consume_keys(keyboard, handed_out, !value.has_value());
+        if (recorder != nullptr && value.has_value())
+        {
+            recorder->record(*value);
+        }
+        return value;
+    }
+
+    std::size_t event_consumer::drain(event_queue& live, const std::span<event> out)
+    {
+        std::size_t count = replayer != nullptr ? replayer->next_many(out) : 0;
+        count += live.try_pop_many(out.subspan(count));
+
+        consume_keys(keyboard, out.first(count), count < out.size());
+        if (recorder != nullptr && count != 0)
+        {
+            recorder->record(out.first(count));
+        }
+        return count;
+    }
+
+    platform_clock::time_point event_consumer::ready_at(const event_queue& live) const noexcept
+    {
+        if (!live.empty())
+        {
+            return platform_clock::time_point::min();
+        }
+        const auto due = replayer != nullptr ? replayer->next_due() : std::nullopt;
+        return due.value_or(platform_clock::time_point::max());
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+
+#include "detri/event_queue.hpp"
+#include "detri/input_recording.hpp"
+#include "detri/keyboard_state.hpp"
+
+namespace detri
+{
+    // What every backend does with events on their way out of poll_event()/drain_events(): replayed events go ahead
+    // of live ones, the keyboard state follows along, and an attached recorder gets a copy. Lives on the consuming
+    // thread only.
+    struct event_consumer
+    {
+        keyboard_state keyboard;
+        input_recorder* recorder {};
+        input_replayer* replayer {};
+
+        std::optional<event> poll(event_queue& live);
+
+        std::size_t drain(event_queue& live, std::span<event> out);
+
+        // The earliest poll() can return something: time_point::min() if it already can, the next replayed event's
+        // due time, or time_point::max() if only new live input will do. Lets a backend bound its wait on the OS.
+        [[nodiscard]] platform_clock::time_point ready_at(const event_queue& live) const noexcept;
+    };
+}
@@ -0,0 +1,275 @@
+#include "detri/event_queue.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/thread_counters.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <thread>
+
+namespace detri
+{
+    namespace
+    {
+        bool is_mergeable(const event& value) noexcept
+        {
+            return std::holds_alternative<mouse_move_event>(value) || std::holds_alternative<resize_event>(value) ||
+                   std::holds_alternative<mouse_delta_event>(value);
+        }
+
+        // Folds incoming into target when both describe the same continuous quantity. Positions and sizes keep the
+        // latest value; relative motion is summed so no distance is lost.
+        bool try_merge(event& target, const event& incoming) noexcept
+        {
+            if (target.index() != incoming.index())
+            {
+                return false;
+            }
+
+            if (auto* delta = std::get_if<mouse_delta_event>(&target))
+            {
+                const auto& next = std::get<mouse_delta_event>(incoming);
+                delta->dx += next.dx;
+                delta->dy += next.dy;
+                delta->timestamp = next.timestamp;
+                return true;
+            }
+            if (std::holds_alternative<mouse_move_event>(target) || std::holds_alternative<resize_event>(target))
+            {
+                target = incoming;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    event_queue::event_queue(const std::size_t capacity, const event_overflow_policy policy)
+        : m_policy(policy)
+    {
+        if (capacity == 0)
+        {
+            throw except::platform_exception{"Event queue capacity must be greater than zero."};
+        }
+
+        const std::size_t rounded = std::bit_ceil(capacity);
+        m_slots = std::make_unique<slot[]>(rounded);
+        m_mask = rounded - 1;
+        for (std::size_t i = 0; i < rounded; ++i)
+        {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    event_queue::~event_queue() = default;
+
+    void event_queue::push(const event& value)
+    {
+        if constexpr (instrumentation_enabled)
+        {
+            m_pushed.store(m_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            count_event(value.index());
+        }
+
+        if (m_held.has_value())
+        {
+            if (try_merge(*m_held, value))
+            {
+                m_coalesced.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            publish_held();
+        }
+
+        if (m_coalescing.load(std::memory_order_relaxed) && is_mergeable(value))
+        {
+            m_held = value;
+            return;
+        }
+
+        if (try_publish(value))
+        {
+            return;
+        }
+
+        if (m_policy == event_overflow_policy::coalesce)
+        {
+            m_held = value;
+            return;
+        }
+
+        retire_oldest();
+        (void)try_publish(value);
+    }
+
+    void event_queue::flush()
+    {
+        if (m_held.has_value())
+        {
+            publish_held();
+        }
+    }
+
+    void event_queue::set_coalescing(const bool enabled) noexcept
+    {
+        m_coalescing.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool event_queue::coalescing() const noexcept
+    {
+        return m_coalescing.load(std::memory_order_relaxed);
+    }
+
+    std::optional<event> event_queue::pop()
+    {
+        event value;
+        if (!try_pop(value))
+        {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    bool event_queue::try_pop(event& out)
+    {
+        return claim_oldest(&out);
+    }
+
+    std::size_t event_queue::try_pop_many(const std::span<event> out)
+    {
+        std::size_t position = m_head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            std::size_t ready = 0;
+            while (ready < out.size() &&
+                   m_slots[(position + ready) & m_mask].sequence.load(std::memory_order_acquire) == position + ready + 1)
+            {
+                ++ready;
+            }
+            if (ready == 0)
+            {
+                // Either empty, or the producer retired the slot we looked at; only the latter is worth a retry.
+                if (m_head.load(std::memory_order_relaxed) == position)
+                {
+                    return 0;
+                }
+                position = m_head.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (m_head.compare_exchange_weak(position, position + ready, std::memory_order_relaxed))
+            {
+                for (std::size_t i = 0; i < ready; ++i)
+                {
+                    slot& current = m_slots[(position + i) & m_mask];
+                    out[i] = current.value;
+                    current.sequence.store(position + i + m_mask + 1, std::memory_order_release);
+                }
+                return ready;
+            }
+        }
+    }
+
+    bool event_queue::empty() const noexcept
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t event_queue::capacity() const noexcept
+    {
+        return m_mask + 1;
+    }
+
+    event_overflow_policy event_queue::policy() const noexcept
+    {
+        return m_policy;
+    }
+
+    event_queue_stats event_queue::stats() const noexcept
+    {
+        return {
+            .dropped = m_dropped.load(std::memory_order_relaxed),
+            .coalesced = m_coalesced.load(std::memory_order_relaxed),
+            .pushed = m_pushed.load(std::memory_order_relaxed),
+            .high_water = m_high_water.load(std::memory_order_relaxed)
+        };
+    }
+
+    void event_queue::publish_held()
+    {
+        if (!try_publish(*m_held))
+        {
+            retire_oldest();
+            (void)try_publish(*m_held);
+        }
+        m_held.reset();
+    }
+
+    bool event_queue::try_publish(const event& value)
+    {
+        const std::size_t position = m_tail.load(std::memory_order_relaxed);
+        slot& target = m_slots[position & m_mask];
+        for (;;)
+        {
+            if (target.sequence.load(std::memory_order_acquire) == position)
+            {
+                target.value = value;
+                target.sequence.store(position + 1, std::memory_order_release);
+                m_tail.store(position + 1, std::memory_order_release);
+                if constexpr (instrumentation_enabled)
+                {
+                    const std::uint64_t depth = position + 1 - m_head.load(std::memory_order_relaxed);
+                    if (depth > m_high_water.load(std::memory_order_relaxed))
+                    {
+                        m_high_water.store(depth, std::memory_order_relaxed);
+                    }
+                    note_queue_depth(depth);
+                }
+                return true;
+            }
+
+            // The slot is still owned by the previous lap. Either the ring is genuinely full, or the consumer has
+            // claimed the slot and is copying out of it; the latter finishes in a handful of instructions.
+            if (position - m_head.load(std::memory_order_acquire) > m_mask)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void event_queue::retire_oldest()
+    {
+        if (claim_oldest(nullptr))
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool event_queue::claim_oldest(event* out)
+    {
+        std::size_t position = m_head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            slot& current = m_slots[position & m_mask];
+            const std::size_t sequence = current.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (difference < 0)
+            {
+                return false;
+            }
+            if (difference > 0)
+            {
+                position = m_head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                if (out != nullptr)
+                {
+                    *out = current.value;
+                }
+                current.sequence.store(position + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+}
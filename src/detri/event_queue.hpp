@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "detri/platform_event.hpp"
+
+namespace detri
+{
+    // What a full event_queue does with the next event.
+    enum class event_overflow_policy : uint32_t
+    {
+        // Discard the oldest queued event to make room.
+        drop_oldest,
+        // Hold the event that did not fit back instead of publishing it, and merge later mouse_move/resize/mouse_delta
+        // events of the same type into it. It is published by the next push() that cannot be merged, retiring the
+        // oldest entry if the queue is still full, or by flush(); until then the consumer does not see it, so the last
+        // event of a burst arrives one flush late. See also event_queue::set_coalescing().
+        coalesce
+    };
+
+    struct event_queue_stats
+    {
+        std::uint64_t dropped {};
+        std::uint64_t coalesced {};
+        // Only counted in builds with DETRI_PLATFORM_INSTRUMENTATION: every event pushed, before coalescing, and the
+        // most events the queue has held at once.
+        std::uint64_t pushed {};
+        std::uint64_t high_water {};
+    };
+
+    // Fixed-capacity ring of events, allocated once up front. One thread may push while another pops. The producer
+    // may also retire the oldest entry on overflow, which is why the consumer side claims slots with a CAS rather than
+    // a plain store.
+    class event_queue
+    {
+    public:
+        // capacity is rounded up to the next power of two.
+        explicit event_queue(std::size_t capacity, event_overflow_policy policy = event_overflow_policy::drop_oldest);
+
+        ~event_queue();
+
+        event_queue(const event_queue&) = delete;
+
+        event_queue& operator=(const event_queue&) = delete;
+
+        // Producer side.
+        void push(const event& value);
+
+        // Producer side. Publishes an event held back for coalescing. Call once the current batch of OS messages
+        // has been translated.
+        void flush();
+
+        // When enabled, runs of consecutive mouse_move/resize events collapse into the latest one and runs of
+        // mouse_delta events are summed, whether or not the queue is full. Merges are counted in stats().coalesced.
+        void set_coalescing(bool enabled) noexcept;
+
+        [[nodiscard]] bool coalescing() const noexcept;
+
+        // Consumer side.
+        std::optional<event> pop();
+
+        // Consumer side.
+        bool try_pop(event& out);
+
+        // Consumer side. Moves up to out.size() events into out, claiming them with a single CAS, and returns how
+        // many were written.
+        std::size_t try_pop_many(std::span<event> out);
+
+        [[nodiscard]] bool empty() const noexcept;
+
+        [[nodiscard]] std::size_t capacity() const noexcept;
+
+        [[nodiscard]] event_overflow_policy policy() const noexcept;
+
+        [[nodiscard]] event_queue_stats stats() const noexcept;
+
+    private:
+        struct slot
+        {
+            std::atomic<std::size_t> sequence;
+            event value;
+        };
+
+        bool try_publish(const event& value);
+
+        void retire_oldest();
+
+        void publish_held();
+
+        // Claims the oldest published slot. Both the consumer and the overflowing producer go through here.
+        bool claim_oldest(event* out);
+
+        std::unique_ptr<slot[]> m_slots;
+        std::size_t m_mask {};
+        event_overflow_policy m_policy {event_overflow_policy::drop_oldest};
+
+        alignas(64) std::atomic<std::size_t> m_head {0};
+        alignas(64) std::atomic<std::size_t> m_tail {0};
+
+        // Only the producer touches m_held. The counters are written by the producer and may be read from anywhere.
+        std::optional<event> m_held;
+        std::atomic<bool> m_coalescing {false};
+        std::atomic<std::uint64_t> m_dropped {0};
+        std::atomic<std::uint64_t> m_coalesced {0};
+        std::atomic<std::uint64_t> m_pushed {0};
+        std::atomic<std::uint64_t> m_high_water {0};
+    };
+}
@@ -0,0 +1,181 @@
+#include "detri/frame_pacer.hpp"
+#include "detri/high_resolution_timer.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+namespace detri
+{
+    namespace
+    {
+        constexpr platform_clock::duration default_spin_threshold = std::chrono::microseconds{200};
+        constexpr platform_clock::duration max_spin_threshold = std::chrono::milliseconds{4};
+
+        // Tells the core we are spinning: frees execution resources for an SMT sibling and saves power, without the
+        // trip into the scheduler std::this_thread::yield() takes.
+        void cpu_relax() noexcept
+        {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#elif defined(_M_ARM64)
+            __yield();
+#elif defined(__aarch64__) || defined(__arm__)
+            __asm__ __volatile__("yield");
+#endif
+        }
+
+        // The OS timer plus what it has shown about its own lateness.
+        struct precise_sleeper
+        {
+            explicit precise_sleeper(const platform_clock::duration spin_floor)
+                : spin_floor(spin_floor), spin_threshold(spin_floor)
+            {
+            }
+
+            high_resolution_timer timer;
+            platform_clock::duration spin_floor;
+            platform_clock::duration spin_threshold;
+
+            void sleep_until(const platform_clock::time_point deadline)
+            {
+                auto now = platform_clock::now();
+                const auto wake = deadline - spin_threshold;
+                if (wake > now)
+                {
+                    timer.sleep_until(wake);
+                    now = platform_clock::now();
+
+                    // Jump straight up to an oversleep with a quarter on top so the next deadline is not missed, and
+                    // decay back towards the floor by a sixteenth per sleep while the timer keeps time.
+                    const auto oversleep = now - wake;
+                    spin_threshold -= (spin_threshold - spin_floor) / 16;
+                    spin_threshold = std::clamp(oversleep + oversleep / 4, spin_threshold,
+                                                std::max(spin_threshold, max_spin_threshold));
+                }
+
+                while (now < deadline)
+                {
+                    cpu_relax();
+                    now = platform_clock::now();
+                }
+            }
+        };
+
+        precise_sleeper& thread_sleeper()
+        {
+            thread_local precise_sleeper sleeper{default_spin_threshold};
+            return sleeper;
+        }
+
+        void check_frame_time(const platform_clock::duration value)
+        {
+            if (value <= platform_clock::duration::zero())
+            {
+                throw except::platform_exception{"Frame time must be greater than zero."};
+            }
+        }
+    } // namespace
+
+    void precise_sleep_until(const platform_clock::time_point deadline)
+    {
+        if (deadline > platform_clock::now())
+        {
+            thread_sleeper().sleep_until(deadline);
+        }
+    }
+
+    void precise_sleep_for(const platform_clock::duration duration)
+    {
+        precise_sleep_until(deadline_after(duration));
+    }
+
+    struct frame_pacer::impl
+    {
+        explicit impl(const frame_pacer_options& options)
+            : sleeper(std::max(options.spin_threshold, platform_clock::duration::zero())),
+              frame_time(options.frame_time),
+              next(platform_clock::now() + options.frame_time)
+        {
+        }
+
+        precise_sleeper sleeper;
+        platform_clock::duration frame_time;
+        platform_clock::time_point next;
+        platform_clock::duration lateness {};
+        std::uint64_t missed {};
+    };
+
+    frame_pacer::frame_pacer(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    frame_pacer frame_pacer::create(const frame_pacer_options& options)
+    {
+        check_frame_time(options.frame_time);
+        return frame_pacer{std::make_unique<impl>(options)};
+    }
+
+    frame_pacer::~frame_pacer() = default;
+
+    frame_pacer::frame_pacer(frame_pacer&&) noexcept = default;
+
+    frame_pacer& frame_pacer::operator=(frame_pacer&&) noexcept = default;
+
+    platform_clock::time_point frame_pacer::wait()
+    {
+        auto& state = *m_impl;
+        const auto now = platform_clock::now();
+        if (now > state.next)
+        {
+            state.missed += static_cast<std::uint64_t>((now - state.next) / state.frame_time) + 1;
+            state.lateness = now - state.next;
+            state.next = now + state.frame_time;
+            return now;
+        }
+
+        state.sleeper.sleep_until(state.next);
+        const auto boundary = state.next;
+        state.lateness = platform_clock::now() - boundary;
+        state.next += state.frame_time;
+        return boundary;
+    }
+
+    platform_clock::time_point frame_pacer::next_frame() const noexcept
+    {
+        return m_impl->next;
+    }
+
+    platform_clock::duration frame_pacer::frame_time() const noexcept
+    {
+        return m_impl->frame_time;
+    }
+
+    void frame_pacer::set_frame_time(const platform_clock::duration value)
+    {
+        check_frame_time(value);
+        m_impl->next += value - m_impl->frame_time;
+        m_impl->frame_time = value;
+    }
+
+    void frame_pacer::reset() noexcept
+    {
+        m_impl->next = platform_clock::now() + m_impl->frame_time;
+    }
+
+    platform_clock::duration frame_pacer::last_lateness() const noexcept
+    {
+        return m_impl->lateness;
+    }
+
+    std::uint64_t frame_pacer::missed_frames() const noexcept
+    {
+        return m_impl->missed;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "detri/platform.hpp"
+
+namespace detri
+{
+    // Blocks the calling thread until deadline to within a few microseconds: an OS high-resolution timer sleeps
+    // through all but the last stretch and the remainder is spun. Returns straight away for a deadline already past.
+    void precise_sleep_until(platform_clock::time_point deadline);
+
+    void precise_sleep_for(platform_clock::duration duration);
+
+    struct frame_pacer_options
+    {
+        platform_clock::duration frame_time {std::chrono::nanoseconds{16'666'667}};
+        // How long before a deadline the pacer stops sleeping and starts spinning. A floor: it grows on its own when
+        // the OS timer wakes later than this, up to 4 ms.
+        platform_clock::duration spin_threshold {std::chrono::microseconds{200}};
+    };
+
+    // Holds a loop to a fixed frame time. wait() sleeps until the next frame boundary on a high-resolution waitable
+    // timer on Windows and clock_nanosleep on Linux, then spins the tail, so frames start within tens of
+    // microseconds of their deadline. Boundaries follow each other at exactly frame_time, so jitter in one frame does
+    // not push the later ones back. Lives on one thread.
+    class frame_pacer
+    {
+    public:
+        // Starts the schedule: the first wait() returns one frame time from now. Throws except::platform_exception if
+        // frame_time is not positive or the OS has no timer to give.
+        static frame_pacer create(const frame_pacer_options& options = {});
+
+        frame_pacer() = delete;
+
+        ~frame_pacer();
+
+        frame_pacer(frame_pacer&&) noexcept;
+
+        frame_pacer& operator=(frame_pacer&&) noexcept;
+
+        // Sleeps until the next frame boundary and returns it. A frame that overran its boundary returns straight
+        // away and restarts the schedule from now, rather than bursting through the missed frames to catch up.
+        platform_clock::time_point wait();
+
+        // When the next wait() returns, barring an overrun. Useful as the deadline for
+        // window::wait_for_events_or_timeout().
+        [[nodiscard]] platform_clock::time_point next_frame() const noexcept;
+
+        [[nodiscard]] platform_clock::duration frame_time() const noexcept;
+
+        // The frame in progress ends value after the previous boundary. Throws except::platform_exception if value is
+        // not positive.
+        void set_frame_time(platform_clock::duration value);
+
+        // Restarts the schedule so the next boundary is one frame time from now, e.g. after a pause.
+        void reset() noexcept;
+
+        // How far past its boundary the last wait() returned.
+        [[nodiscard]] platform_clock::duration last_lateness() const noexcept;
+
+        // Boundaries skipped because a frame overran them.
+        [[nodiscard]] std::uint64_t missed_frames() const noexcept;
+
+    private:
+        struct impl;
+
+        explicit frame_pacer(std::unique_ptr<impl>&& impl) noexcept;
+
+        std::unique_ptr<impl> m_impl;
+    };
+}
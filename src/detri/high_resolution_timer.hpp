@@ -0,0 +1,67 @@
+#pragma once
+
+// Internal to the platform library: the OS sleep primitives frame_pacer and the window backends' event waits share.
+
+#include <cstddef>
+#include <optional>
+#include <span>
+
+#include "detri/platform.hpp"
+
+namespace detri
+{
+    // now + timeout, saturating at time_point::max(), which every wait below treats as forever.
+    inline platform_clock::time_point deadline_after(const platform_clock::duration timeout) noexcept
+    {
+        const auto now = platform_clock::now();
+        if (timeout <= platform_clock::duration::zero())
+        {
+            return now;
+        }
+        return timeout >= platform_clock::time_point::max() - now ? platform_clock::time_point::max() : now + timeout;
+    }
+
+    // Blocks the calling thread until an absolute platform_clock deadline. Never wakes early; how late it wakes is
+    // up to the scheduler, typically tens of microseconds on Linux and under a millisecond on Windows 10 1803+.
+    class high_resolution_timer
+    {
+    public:
+        // Throws except::platform_exception if the OS has no timer to give.
+        high_resolution_timer();
+
+        ~high_resolution_timer();
+
+        high_resolution_timer(const high_resolution_timer&) = delete;
+
+        high_resolution_timer& operator=(const high_resolution_timer&) = delete;
+
+        void sleep_until(platform_clock::time_point deadline);
+
+#ifdef _WIN32
+        // Starts the timer so handle() is signaled at deadline, for callers that wait on it next to other handles.
+        void arm(platform_clock::time_point deadline);
+
+        [[nodiscard]] HANDLE handle() const noexcept
+        {
+            return m_timer;
+        }
+
+    private:
+        HANDLE m_timer {};
+#endif
+    };
+
+#ifdef _WIN32
+    // Waits until one of objects is signaled, or with messages set, input reaches the calling thread's message queue,
+    // or deadline passes. Returns the index of the first signaled object, objects.size() for messages, nothing at the
+    // deadline. timer times the wait, so it lands as precisely as a sleep does. Throws except::platform_exception for
+    // more objects than one wait takes or if the wait itself fails.
+    std::optional<std::size_t> wait_objects(std::span<const HANDLE> objects, platform_clock::time_point deadline,
+                                            high_resolution_timer& timer, bool messages);
+#else
+    // Waits until one of fds has something to read or deadline passes, and returns the index of the first that does.
+    // A descriptor that is closed or hung up counts as readable, so its owner finds out on the next read. Throws
+    // except::platform_exception if the wait itself fails.
+    std::optional<std::size_t> wait_readable(std::span<const int> fds, platform_clock::time_point deadline);
+#endif
+}
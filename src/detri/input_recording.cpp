@@ -0,0 +1,442 @@
+#include "detri/input_recording.hpp"
+#include "detri/mapped_file.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace detri
+{
+    namespace
+    {
+        // Records are written in host byte order; a log is meant to be replayed on the kind of machine that made it.
+        constexpr std::array<char, 8> log_magic{'D', 'T', 'R', 'I', 'I', 'N', 'P', 'T'};
+        constexpr std::uint32_t log_version = 1;
+        constexpr std::size_t header_size = 16;
+
+        // Type index, then the nanosecond offset from the first recorded event, then the payload.
+        constexpr std::size_t record_prefix_size = 1 + sizeof(std::int64_t);
+        constexpr std::size_t max_payload_size = 1 + 1 + 2 * sizeof(std::int32_t);
+        constexpr std::size_t max_record_size = record_prefix_size + max_payload_size;
+
+        template <typename T>
+        void put(std::byte*& cursor, const T value) noexcept
+        {
+            std::memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+        }
+
+        template <typename T>
+        T take(const std::byte*& cursor) noexcept
+        {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+
+        constexpr std::size_t payload_size(const std::size_t index) noexcept
+        {
+            constexpr std::array<std::size_t, std::variant_size_v<event>> sizes{
+                0,  // close_event
+                8,  // resize_event
+                0,  // resize_begin_event
+                0,  // resize_end_event
+                2,  // key_event
+                10, // mouse_button_event
+                8,  // mouse_move_event
+                8,  // mouse_delta_event
+                4,  // dpi_changed_event
+                0,  // display_changed_event
+                0   // focus_lost_event
+            };
+            return sizes[index];
+        }
+
+        std::size_t encode(const event& value, const std::int64_t offset, std::byte* out) noexcept
+        {
+            std::byte* cursor = out;
+            put(cursor, static_cast<std::uint8_t>(value.index()));
+            put(cursor, offset);
+            std::visit([&cursor](const auto& alternative) {
+                using type = std::decay_t<decltype(alternative)>;
+                if constexpr (std::is_same_v<type, resize_event>)
+                {
+                    put(cursor, alternative.width);
+                    put(cursor, alternative.height);
+                }
+                else if constexpr (std::is_same_v<type, key_event>)
+                {
+                    put(cursor, static_cast<std::uint8_t>(alternative.value));
+                    put(cursor, static_cast<std::uint8_t>(alternative.pressed | alternative.repeated << 1));
+                }
+                else if constexpr (std::is_same_v<type, mouse_button_event>)
+                {
+                    put(cursor, static_cast<std::uint8_t>(alternative.button));
+                    put(cursor, static_cast<std::uint8_t>(alternative.pressed));
+                    put(cursor, alternative.x);
+                    put(cursor, alternative.y);
+                }
+                else if constexpr (std::is_same_v<type, mouse_move_event>)
+                {
+                    put(cursor, alternative.x);
+                    put(cursor, alternative.y);
+                }
+                else if constexpr (std::is_same_v<type, mouse_delta_event>)
+                {
+                    put(cursor, alternative.dx);
+                    put(cursor, alternative.dy);
+                }
+                else if constexpr (std::is_same_v<type, dpi_changed_event>)
+                {
+                    put(cursor, alternative.scale);
+                }
+            }, value);
+            return static_cast<std::size_t>(cursor - out);
+        }
+
+        // Decodes the record at the front of bytes. Returns its size, or 0 if the record is cut short or unknown,
+        // which is how a log from a session that crashed mid-write ends.
+        std::size_t decode(const std::span<const std::byte> bytes, event& out, std::int64_t& offset) noexcept
+        {
+            if (bytes.size() < record_prefix_size)
+            {
+                return 0;
+            }
+
+            const std::byte* cursor = bytes.data();
+            const auto index = take<std::uint8_t>(cursor);
+            if (index >= std::variant_size_v<event> || bytes.size() < record_prefix_size + payload_size(index))
+            {
+                return 0;
+            }
+            offset = take<std::int64_t>(cursor);
+
+            switch (index)
+            {
+                case 0:
+                    out = close_event{};
+                    break;
+                case 1:
+                {
+                    const auto width = take<std::uint32_t>(cursor);
+                    const auto height = take<std::uint32_t>(cursor);
+                    out = resize_event{.width = width, .height = height};
+                    break;
+                }
+                case 2:
+                    out = resize_begin_event{};
+                    break;
+                case 3:
+                    out = resize_end_event{};
+                    break;
+                case 4:
+                {
+                    const auto value = take<std::uint8_t>(cursor);
+                    const auto flags = take<std::uint8_t>(cursor);
+                    out = key_event{
+                        .value = static_cast<key>(value),
+                        .pressed = (flags & 1U) != 0,
+                        .repeated = (flags & 2U) != 0
+                    };
+                    break;
+                }
+                case 5:
+                {
+                    const auto button = take<std::uint8_t>(cursor);
+                    const auto pressed = take<std::uint8_t>(cursor);
+                    const auto x = take<std::int32_t>(cursor);
+                    const auto y = take<std::int32_t>(cursor);
+                    out = mouse_button_event{
+                        .button = static_cast<mouse_button>(button),
+                        .pressed = pressed != 0,
+                        .x = x,
+                        .y = y
+                    };
+                    break;
+                }
+                case 6:
+                {
+                    const auto x = take<std::int32_t>(cursor);
+                    const auto y = take<std::int32_t>(cursor);
+                    out = mouse_move_event{.x = x, .y = y};
+                    break;
+                }
+                case 7:
+                {
+                    const auto dx = take<std::int32_t>(cursor);
+                    const auto dy = take<std::int32_t>(cursor);
+                    out = mouse_delta_event{.dx = dx, .dy = dy};
+                    break;
+                }
+                case 8:
+                    out = dpi_changed_event{.scale = take<float>(cursor)};
+                    break;
+                case 9:
+                    out = display_changed_event{};
+                    break;
+                case 10:
+                    out = focus_lost_event{};
+                    break;
+                default:
+                    return 0;
+            }
+            return record_prefix_size + payload_size(index);
+        }
+    }
+
+    struct input_recorder::impl
+    {
+        std::ofstream file;
+        std::optional<platform_clock::time_point> base;
+        std::uint64_t recorded {};
+    };
+
+    input_recorder::input_recorder(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    input_recorder input_recorder::create(const std::filesystem::path& path)
+    {
+        auto impl = std::make_unique<input_recorder::impl>();
+        impl->file.open(path, std::ios::binary | std::ios::trunc);
+        if (!impl->file)
+        {
+            throw except::input_recording_error{"Failed to create input log '" + path.string() + "'."};
+        }
+
+        std::array<std::byte, header_size> header{};
+        std::byte* cursor = header.data();
+        std::memcpy(cursor, log_magic.data(), log_magic.size());
+        cursor += log_magic.size();
+        put(cursor, log_version);
+        impl->file.write(reinterpret_cast<const char*>(header.data()), header.size());
+        if (!impl->file)
+        {
+            throw except::input_recording_error{"Failed to write input log header to '" + path.string() + "'."};
+        }
+
+        return input_recorder{std::move(impl)};
+    }
+
+    input_recorder::~input_recorder()
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->file.flush();
+        }
+    }
+
+    input_recorder::input_recorder(input_recorder&&) noexcept = default;
+
+    input_recorder& input_recorder::operator=(input_recorder&&) noexcept = default;
+
+    void input_recorder::record(const event& value)
+    {
+        record(std::span<const event>{&value, 1});
+    }
+
+    void input_recorder::record(const std::span<const event> values)
+    {
+        if (m_impl == nullptr)
+        {
+            throw except::input_recording_error{"Cannot record into a moved-from input_recorder."};
+        }
+
+        std::array<std::byte, max_record_size> record{};
+        for (const auto& value : values)
+        {
+            const auto timestamp = event_timestamp(value);
+            if (!m_impl->base.has_value())
+            {
+                m_impl->base = timestamp;
+            }
+            const auto offset = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp - *m_impl->base).count();
+            const std::size_t size = encode(value, offset, record.data());
+            m_impl->file.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(size));
+        }
+
+        if (!m_impl->file)
+        {
+            throw except::input_recording_error{"Failed to write to input log."};
+        }
+        m_impl->recorded += values.size();
+    }
+
+    void input_recorder::flush()
+    {
+        if (m_impl != nullptr && !m_impl->file.flush())
+        {
+            throw except::input_recording_error{"Failed to flush input log."};
+        }
+    }
+
+    std::uint64_t input_recorder::recorded() const noexcept
+    {
+        return m_impl == nullptr ? 0 : m_impl->recorded;
+    }
+
+    struct input_replayer::impl
+    {
+        impl(mapped_file&& mapping, const replay_pacing pacing) noexcept
+            : mapping(std::move(mapping)), pacing(pacing)
+        {
+        }
+
+        mapped_file mapping;
+        replay_pacing pacing {replay_pacing::immediate};
+        std::size_t position {header_size};
+        std::optional<platform_clock::time_point> start;
+        std::uint64_t replayed {};
+
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept
+        {
+            return mapping.bytes();
+        }
+
+        [[nodiscard]] std::optional<platform_clock::time_point> due() const noexcept
+        {
+            event ignored;
+            std::int64_t offset = 0;
+            if (decode(bytes().subspan(std::min(position, mapping.size())), ignored, offset) == 0)
+            {
+                return std::nullopt;
+            }
+            // The time base is only set by the first event handed out, so until then the first one is due at once.
+            if (pacing == replay_pacing::immediate || !start.has_value())
+            {
+                return platform_clock::time_point::min();
+            }
+            return *start + std::chrono::duration_cast<platform_clock::duration>(std::chrono::nanoseconds{offset});
+        }
+
+        // Decodes the next record into out if it is due at now.
+        bool next_due(event& out, const platform_clock::time_point now) noexcept
+        {
+            const auto remaining = bytes().subspan(std::min(position, mapping.size()));
+            std::int64_t offset = 0;
+            const std::size_t size = decode(remaining, out, offset);
+            if (size == 0)
+            {
+                position = mapping.size();
+                return false;
+            }
+
+            if (!start.has_value())
+            {
+                start = now;
+            }
+            const auto due = *start + std::chrono::duration_cast<platform_clock::duration>(std::chrono::nanoseconds{offset});
+            if (pacing == replay_pacing::recorded && now < due)
+            {
+                return false;
+            }
+
+            set_event_timestamp(out, due);
+            position += size;
+            ++replayed;
+            return true;
+        }
+    };
+
+    input_replayer::input_replayer(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    input_replayer input_replayer::open(const std::filesystem::path& path, const replay_pacing pacing)
+    {
+        auto mapping = [&path] {
+            try
+            {
+                // Replay walks the log front to back exactly once, so let the kernel read ahead aggressively.
+                return mapped_file::open(path, {.hint = mapped_access_hint::sequential});
+            }
+            catch (const except::mapped_file_error& error)
+            {
+                throw except::input_recording_error{"Failed to map input log '" + path.string() + "': " + error.what()};
+            }
+        }();
+        if (mapping.size() < header_size)
+        {
+            throw except::input_recording_error{"'" + path.string() + "' is not an input log."};
+        }
+
+        auto impl = std::make_unique<input_replayer::impl>(std::move(mapping), pacing);
+        const std::byte* cursor = impl->bytes().data();
+        if (std::memcmp(cursor, log_magic.data(), log_magic.size()) != 0)
+        {
+            throw except::input_recording_error{"'" + path.string() + "' is not an input log."};
+        }
+        cursor += log_magic.size();
+        if (const auto version = take<std::uint32_t>(cursor); version != log_version)
+        {
+            throw except::input_recording_error{"Input log '" + path.string() + "' has unsupported version " +
+                                                std::to_string(version) + "."};
+        }
+
+        return input_replayer{std::move(impl)};
+    }
+
+    input_replayer::~input_replayer() = default;
+
+    input_replayer::input_replayer(input_replayer&&) noexcept = default;
+
+    input_replayer& input_replayer::operator=(input_replayer&&) noexcept = default;
+
+    std::optional<event> input_replayer::next()
+    {
+        event value;
+        if (m_impl == nullptr || !m_impl->next_due(value, platform_clock::now()))
+        {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::size_t input_replayer::next_many(const std::span<event> out)
+    {
+        if (m_impl == nullptr)
+        {
+            return 0;
+        }
+
+        const auto now = platform_clock::now();
+        std::size_t count = 0;
+        while (count < out.size() && m_impl->next_due(out[count], now))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    bool input_replayer::finished() const noexcept
+    {
+        return m_impl == nullptr || m_impl->position >= m_impl->mapping.size();
+    }
+
+    std::optional<platform_clock::time_point> input_replayer::next_due() const noexcept
+    {
+        return m_impl == nullptr ? std::nullopt : m_impl->due();
+    }
+
+    std::uint64_t input_replayer::replayed() const noexcept
+    {
+        return m_impl == nullptr ? 0 : m_impl->replayed;
+    }
+
+    void input_replayer::rewind() noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->position = header_size;
+            m_impl->start.reset();
+            m_impl->replayed = 0;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "detri/platform_event.hpp"
+
+namespace detri
+{
+    // Streams events into a compact binary log: a 16-byte header, then one record per event holding its type, its
+    // timestamp relative to the first recorded event and only the fields that type carries. Attach one to a window
+    // with window::record_input() to capture everything poll_event()/drain_events() hand out.
+    class input_recorder
+    {
+    public:
+        // Creates path, or truncates it if it exists.
+        static input_recorder create(const std::filesystem::path& path);
+
+        input_recorder() = delete;
+
+        ~input_recorder();
+
+        input_recorder(input_recorder&&) noexcept;
+
+        input_recorder& operator=(input_recorder&&) noexcept;
+
+        void record(const event& value);
+
+        void record(std::span<const event> values);
+
+        // Pushes buffered records to the file. Also happens on destruction.
+        void flush();
+
+        [[nodiscard]] std::uint64_t recorded() const noexcept;
+
+    private:
+        struct impl;
+
+        explicit input_recorder(std::unique_ptr<impl>&& impl) noexcept;
+
+        std::unique_ptr<impl> m_impl;
+    };
+
+    enum class replay_pacing
+    {
+        // Hand out every recorded event as soon as it is asked for. For deterministic regression runs.
+        immediate,
+        // Hold each event back until as much time has passed since the replay started as had passed in the recording.
+        recorded
+    };
+
+    // Plays back a log written by input_recorder. The file is memory-mapped and records are decoded straight out of
+    // the mapping, so a session of any length replays without being read into memory. Timestamps are rebased onto
+    // the moment the first event is handed out, keeping the recorded spacing. Attach one to a window with
+    // window::replay_input().
+    class input_replayer
+    {
+    public:
+        static input_replayer open(const std::filesystem::path& path, replay_pacing pacing = replay_pacing::immediate);
+
+        input_replayer() = delete;
+
+        ~input_replayer();
+
+        input_replayer(input_replayer&&) noexcept;
+
+        input_replayer& operator=(input_replayer&&) noexcept;
+
+        // The next event that is due, or nothing if the log is exhausted or, with replay_pacing::recorded, the next
+        // event is not due yet.
+        std::optional<event> next();
+
+        // Writes up to out.size() due events into out and returns how many were written.
+        std::size_t next_many(std::span<event> out);
+
+        [[nodiscard]] bool finished() const noexcept;
+
+        // When next() will hand out the next event: time_point::min() if it already would, nothing once finished.
+        [[nodiscard]] std::optional<platform_clock::time_point> next_due() const noexcept;
+
+        [[nodiscard]] std::uint64_t replayed() const noexcept;
+
+        // Starts over from the first record with a fresh time base.
+        void rewind() noexcept;
+
+    private:
+        struct impl;
+
+        explicit input_replayer(std::unique_ptr<impl>&& impl) noexcept;
+
+        std::unique_ptr<impl> m_impl;
+    };
+}
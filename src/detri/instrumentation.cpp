@@ -0,0 +1,183 @@
+#include "detri/instrumentation.hpp"
+#include "detri/thread_counters.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace detri
+{
+#ifdef DETRI_PLATFORM_INSTRUMENTATION
+    namespace
+    {
+        std::atomic<counter_block*> g_blocks {nullptr};
+
+        void clear(counter_block& block) noexcept
+        {
+            for (auto& section : block.sections)
+            {
+                for (auto& bucket : section.buckets)
+                {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+                section.count.store(0, std::memory_order_relaxed);
+                section.total.store(0, std::memory_order_relaxed);
+                section.longest.store(0, std::memory_order_relaxed);
+            }
+            for (auto& count : block.events)
+            {
+                count.store(0, std::memory_order_relaxed);
+            }
+            block.queue_high_water.store(0, std::memory_order_relaxed);
+        }
+
+        // Blocks are never deleted, so readers need no lock to know a block is still there. A thread claims one an
+        // exited thread freed before allocating, so threads that come and go, like threaded-pump windows, do not
+        // grow the list.
+        counter_block* register_block()
+        {
+            const auto self = std::this_thread::get_id();
+            for (auto* block = g_blocks.load(std::memory_order_acquire); block != nullptr; block = block->next)
+            {
+                std::thread::id free{};
+                if (block->owner.compare_exchange_strong(free, self, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return block;
+                }
+            }
+
+            auto* block = new counter_block{};
+            block->owner.store(self, std::memory_order_relaxed);
+            block->next = g_blocks.load(std::memory_order_relaxed);
+            while (!g_blocks.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+            return block;
+        }
+
+        // Holds the thread's block and frees it, cleared, when the thread exits.
+        class block_lease
+        {
+        public:
+            block_lease()
+                : m_block(register_block())
+            {
+            }
+
+            ~block_lease()
+            {
+                clear(*m_block);
+                m_block->owner.store(std::thread::id{}, std::memory_order_release);
+            }
+
+            block_lease(const block_lease&) = delete;
+
+            block_lease& operator=(const block_lease&) = delete;
+
+            counter_block& block() const noexcept
+            {
+                return *m_block;
+            }
+
+        private:
+            counter_block* m_block;
+        };
+
+        duration_histogram read(const counter_block::histogram& source) noexcept
+        {
+            duration_histogram result;
+            for (std::size_t i = 0; i < result.buckets.size(); ++i)
+            {
+                result.buckets[i] = source.buckets[i].load(std::memory_order_relaxed);
+            }
+            result.count = source.count.load(std::memory_order_relaxed);
+            result.total = platform_clock::duration{source.total.load(std::memory_order_relaxed)};
+            result.longest = platform_clock::duration{source.longest.load(std::memory_order_relaxed)};
+            return result;
+        }
+
+        platform_counters read(const counter_block& block, const std::thread::id owner) noexcept
+        {
+            platform_counters result;
+            result.thread = owner;
+            result.pump = read(block.sections[static_cast<std::size_t>(timed_section::pump)]);
+            result.os = read(block.sections[static_cast<std::size_t>(timed_section::os)]);
+            result.message_hook = read(block.sections[static_cast<std::size_t>(timed_section::message_hook)]);
+            for (std::size_t i = 0; i < result.events.size(); ++i)
+            {
+                result.events[i] = block.events[i].load(std::memory_order_relaxed);
+            }
+            result.queue_high_water = block.queue_high_water.load(std::memory_order_relaxed);
+            return result;
+        }
+    } // namespace
+
+    counter_block& thread_counter_block() noexcept
+    {
+        thread_local const block_lease lease;
+        return lease.block();
+    }
+
+    void record_duration(counter_block::histogram& target, const platform_clock::duration value) noexcept
+    {
+        const auto microseconds = static_cast<std::uint64_t>(std::max<platform_clock::rep>(value.count(), 0) / 1000);
+        const auto bucket = std::min<std::size_t>(std::bit_width(microseconds), duration_histogram::bucket_count - 1);
+        add_to(target.buckets[bucket], 1);
+        add_to(target.count, 1);
+        target.total.store(target.total.load(std::memory_order_relaxed) + value.count(), std::memory_order_relaxed);
+        if (value.count() > target.longest.load(std::memory_order_relaxed))
+        {
+            target.longest.store(value.count(), std::memory_order_relaxed);
+        }
+    }
+
+    platform_counters thread_counters() noexcept
+    {
+        return read(thread_counter_block(), std::this_thread::get_id());
+    }
+
+    std::size_t read_counters(const std::span<platform_counters> out) noexcept
+    {
+        // The list runs newest first; count it once so entries can be written oldest first. Threads registering
+        // meanwhile go in front of head and are left for the next call, and free blocks are skipped. A thread that
+        // exits or claims a block between the two passes leaves its slot as it was or is missed until the next call.
+        const auto* const head = g_blocks.load(std::memory_order_acquire);
+        std::size_t threads = 0;
+        for (const auto* block = head; block != nullptr; block = block->next)
+        {
+            threads += block->owner.load(std::memory_order_relaxed) != std::thread::id{} ? 1 : 0;
+        }
+
+        std::size_t index = threads;
+        for (const auto* block = head; block != nullptr && index != 0; block = block->next)
+        {
+            const auto owner = block->owner.load(std::memory_order_acquire);
+            if (owner != std::thread::id{} && --index < out.size())
+            {
+                out[index] = read(*block, owner);
+            }
+        }
+        return threads;
+    }
+
+    void reset_thread_counters() noexcept
+    {
+        clear(thread_counter_block());
+    }
+#else
+    platform_counters thread_counters() noexcept
+    {
+        platform_counters result;
+        result.thread = std::this_thread::get_id();
+        return result;
+    }
+
+    std::size_t read_counters(std::span<platform_counters>) noexcept
+    {
+        return 0;
+    }
+
+    void reset_thread_counters() noexcept
+    {
+    }
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <variant>
+
+#include "detri/platform.hpp"
+#include "detri/platform_event.hpp"
+
+namespace detri
+{
+    // Whether the library was built with DETRI_PLATFORM_INSTRUMENTATION. Without it nothing is recorded, the hot paths
+    // carry no trace of the counters, and every function below reports zeros.
+#ifdef DETRI_PLATFORM_INSTRUMENTATION
+    inline constexpr bool instrumentation_enabled = true;
+#else
+    inline constexpr bool instrumentation_enabled = false;
+#endif
+
+    // Durations bucketed by powers of two: bucket 0 counts those under 1 us, bucket i those in [2^(i-1), 2^i) us, and
+    // the last everything from about 16 ms up.
+    struct duration_histogram
+    {
+        static constexpr std::size_t bucket_count = 16;
+
+        std::array<std::uint64_t, bucket_count> buckets {};
+        std::uint64_t count {};
+        platform_clock::duration total {};
+        platform_clock::duration longest {};
+    };
+
+    // What one thread has recorded since it started or last reset. A pump's own work is roughly pump minus os minus
+    // message_hook; the sections overlap a little where the OS calls back into the window procedure.
+    struct platform_counters
+    {
+        std::thread::id thread;
+        // Every pump_messages(), or for a threaded Win32 window, every batch its pump thread handles.
+        duration_histogram pump;
+        // Inside the OS while pumping: PeekMessageW and DefWindowProcW, which runs the modal size/move loop, on
+        // Windows; reading the display connection on xcb and Wayland.
+        duration_histogram os;
+        // Inside native message hooks (Win32).
+        duration_histogram message_hook;
+        // Events queued by type, indexed like event::index(), counted before coalescing.
+        std::array<std::uint64_t, std::variant_size_v<event>> events {};
+        // The most events any queue this thread produces into has held at once.
+        std::uint64_t queue_high_water {};
+    };
+
+    // The calling thread's counters.
+    [[nodiscard]] platform_counters thread_counters() noexcept;
+
+    // The counters of every live thread that has recorded anything, one entry each. Writes as many as fit into out and
+    // returns how many threads there are. Lock-free and allocation-free, so a profiler can call it from any thread
+    // every frame. A thread's entry goes when the thread exits and its storage is reused by the next thread to record,
+    // so read what a short-lived thread recorded before it ends.
+    std::size_t read_counters(std::span<platform_counters> out) noexcept;
+
+    // Zeroes the calling thread's counters, e.g. at the start of each frame. Only a thread's own counters can be reset,
+    // since it is their only writer.
+    void reset_thread_counters() noexcept;
+}
@@ -0,0 +1,517 @@
+#include "detri/job_system.hpp"
+#include "detri/cpu_topology.hpp"
+#include "detri/platform.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/work_stealing_deque.hpp"
+
+#include <atomic>
+#include <bit>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace detri
+{
+    struct job_handle::job
+    {
+        std::function<void()> work;
+        // One for the scheduler until the job has run, one per handle.
+        std::atomic<std::uint32_t> references {2};
+        // Unfinished jobs this one runs after, plus one while spawn_job() is still wiring it up.
+        std::atomic<std::uint32_t> blockers {1};
+        std::atomic<std::uint32_t> waiters {0};
+        std::atomic<bool> finished {false};
+        std::mutex dependents_mutex;
+        std::vector<job*> dependents;
+        std::exception_ptr error;
+    };
+
+    namespace
+    {
+        using job = job_handle::job;
+
+        void release(job* value) noexcept
+        {
+            if (value != nullptr && value->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete value;
+            }
+        }
+
+        // Polls for work this many times, yielding in between, before a thread goes to sleep. Keeps fork/join
+        // latency down without burning a core when the system is idle.
+        constexpr int idle_spins = 64;
+
+#ifdef _WIN32
+        // Windows schedules a thread inside a single processor group of at most 64 logical processors, and before
+        // Windows 11 every thread of a process starts in the same one. Deal workers out across all groups in
+        // proportion to their size, letting the OS place each one freely within its group.
+        std::vector<GROUP_AFFINITY> processor_groups()
+        {
+            DWORD length = 0;
+            GetLogicalProcessorInformationEx(RelationGroup, nullptr, &length);
+            std::vector<std::byte> storage(length);
+            auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(storage.data());
+            std::vector<GROUP_AFFINITY> groups;
+            if (length == 0 || !GetLogicalProcessorInformationEx(RelationGroup, info, &length))
+            {
+                return groups;
+            }
+
+            for (WORD group = 0; group < info->Group.ActiveGroupCount; ++group)
+            {
+                GROUP_AFFINITY affinity{};
+                affinity.Group = group;
+                affinity.Mask = info->Group.GroupInfo[group].ActiveProcessorMask;
+                if (affinity.Mask != 0)
+                {
+                    groups.push_back(affinity);
+                }
+            }
+            return groups;
+        }
+
+        void assign_processor_group(std::thread& worker, const std::uint32_t index,
+                                    const std::vector<GROUP_AFFINITY>& groups) noexcept
+        {
+            std::uint32_t total = 0;
+            for (const auto& group : groups)
+            {
+                total += static_cast<std::uint32_t>(std::popcount(group.Mask));
+            }
+            if (groups.size() < 2 || total == 0)
+            {
+                return;
+            }
+
+            std::uint32_t slot = index % total;
+            for (const auto& group : groups)
+            {
+                const auto size = static_cast<std::uint32_t>(std::popcount(group.Mask));
+                if (slot < size)
+                {
+                    SetThreadGroupAffinity(worker.native_handle(), &group, nullptr);
+                    return;
+                }
+                slot -= size;
+            }
+        }
+#endif
+    }
+
+    struct job_system::impl
+    {
+        struct worker
+        {
+            work_stealing_deque<job> deque;
+            std::thread thread;
+        };
+
+        explicit impl(const std::uint32_t count)
+            : workers(count)
+        {
+        }
+
+        std::vector<worker> workers;
+        std::mutex injection_mutex;
+        std::deque<job*> injection;
+        std::atomic<std::size_t> injected {0};
+        // Spawned jobs that have not finished, including continuations still waiting on their dependencies.
+        std::atomic<std::size_t> outstanding {0};
+        // Bumped whenever there is something new to look at; sleeping threads wait for it to change.
+        std::atomic<std::uint32_t> epoch {0};
+        std::atomic<std::uint32_t> sleepers {0};
+        std::atomic<bool> stopping {false};
+
+        // Which worker of which system the current thread is, if any.
+        struct context
+        {
+            impl* owner {};
+            std::uint32_t index {};
+            std::uint32_t random {0x9E37'79B9};
+        };
+        static thread_local context current;
+
+        void schedule(job* value)
+        {
+            if (current.owner == this)
+            {
+                workers[current.index].deque.push(value);
+            }
+            else
+            {
+                std::lock_guard lock{injection_mutex};
+                injection.push_back(value);
+                injected.fetch_add(1, std::memory_order_relaxed);
+            }
+            wake_one();
+        }
+
+        void wake_one() noexcept
+        {
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+            if (sleepers.load(std::memory_order_seq_cst) != 0)
+            {
+                epoch.notify_one();
+            }
+        }
+
+        void wake_all() noexcept
+        {
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+            epoch.notify_all();
+        }
+
+        // Lets the workers finish what is queued and joins them. Must run before the impl is destroyed, whether by
+        // ~job_system or by assigning another job_system over this one.
+        void stop() noexcept
+        {
+            stopping.store(true, std::memory_order_release);
+            wake_all();
+            for (auto& worker : workers)
+            {
+                worker.thread.join();
+            }
+        }
+
+        job* find_job() noexcept
+        {
+            const bool is_worker = current.owner == this;
+            if (is_worker)
+            {
+                if (job* value = workers[current.index].deque.pop())
+                {
+                    return value;
+                }
+            }
+
+            if (injected.load(std::memory_order_relaxed) != 0)
+            {
+                std::lock_guard lock{injection_mutex};
+                if (!injection.empty())
+                {
+                    job* value = injection.front();
+                    injection.pop_front();
+                    injected.fetch_sub(1, std::memory_order_relaxed);
+                    return value;
+                }
+            }
+
+            // Start at a random victim so thieves spread out instead of all hitting worker 0.
+            std::uint32_t& random = current.random;
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            const auto count = static_cast<std::uint32_t>(workers.size());
+            const std::uint32_t start = random % count;
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                const std::uint32_t victim = (start + i) % count;
+                if (is_worker && victim == current.index)
+                {
+                    continue;
+                }
+                if (job* value = workers[victim].deque.steal())
+                {
+                    return value;
+                }
+            }
+            return nullptr;
+        }
+
+        [[nodiscard]] bool has_work() const noexcept
+        {
+            if (injected.load(std::memory_order_relaxed) != 0)
+            {
+                return true;
+            }
+            for (const auto& entry : workers)
+            {
+                if (!entry.deque.empty())
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Sleeps until new work is published or something that could flip done() happens.
+        template <typename Done>
+        void idle(Done&& done) noexcept
+        {
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            const std::uint32_t seen = epoch.load(std::memory_order_seq_cst);
+            if (!has_work() && !done())
+            {
+                epoch.wait(seen, std::memory_order_seq_cst);
+            }
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        void run(job* value) noexcept
+        {
+            try
+            {
+                value->work();
+            }
+            catch (...)
+            {
+                value->error = std::current_exception();
+            }
+            // Drop the captures now rather than when the last handle goes.
+            value->work = nullptr;
+
+            std::vector<job*> dependents;
+            {
+                std::lock_guard lock{value->dependents_mutex};
+                value->finished.store(true, std::memory_order_seq_cst);
+                dependents.swap(value->dependents);
+            }
+            for (job* dependent : dependents)
+            {
+                if (dependent->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    schedule(dependent);
+                }
+            }
+            if (value->waiters.load(std::memory_order_seq_cst) != 0)
+            {
+                wake_all();
+            }
+
+            if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1 && stopping.load(std::memory_order_relaxed))
+            {
+                wake_all();
+            }
+            release(value);
+        }
+
+        // Runs jobs until done() is true. Used by wait() on any thread and by the workers themselves.
+        template <typename Done>
+        void help_until(Done&& done) noexcept
+        {
+            while (!done())
+            {
+                bool ran = false;
+                for (int spin = 0; spin < idle_spins && !done(); ++spin)
+                {
+                    if (job* value = find_job())
+                    {
+                        run(value);
+                        ran = true;
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+                if (!ran && !done())
+                {
+                    idle(done);
+                }
+            }
+        }
+
+        void run_worker(const std::uint32_t index, const std::vector<logical_processor>& core) noexcept
+        {
+            if (!core.empty())
+            {
+                try
+                {
+                    set_current_thread_affinity(core);
+                }
+                catch (const except::platform_exception&)
+                {
+                    // Outside the process's allowed set; leave the worker unpinned rather than fail.
+                }
+            }
+            current = context{.owner = this, .index = index, .random = index * 2654435761U + 1};
+            help_until([this] {
+                return stopping.load(std::memory_order_acquire) && outstanding.load(std::memory_order_acquire) == 0;
+            });
+            current = context{};
+        }
+    };
+
+    thread_local job_system::impl::context job_system::impl::current {};
+
+    job_handle::job_handle(job* value) noexcept
+        : m_job(value)
+    {
+    }
+
+    job_handle::~job_handle()
+    {
+        release(m_job);
+    }
+
+    job_handle::job_handle(const job_handle& other) noexcept
+        : m_job(other.m_job)
+    {
+        if (m_job != nullptr)
+        {
+            m_job->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    job_handle& job_handle::operator=(const job_handle& other) noexcept
+    {
+        if (this != &other)
+        {
+            job_handle copy{other};
+            std::swap(m_job, copy.m_job);
+        }
+        return *this;
+    }
+
+    job_handle::job_handle(job_handle&& other) noexcept
+        : m_job(std::exchange(other.m_job, nullptr))
+    {
+    }
+
+    job_handle& job_handle::operator=(job_handle&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release(std::exchange(m_job, std::exchange(other.m_job, nullptr)));
+        }
+        return *this;
+    }
+
+    bool job_handle::done() const noexcept
+    {
+        return m_job == nullptr || m_job->finished.load(std::memory_order_acquire);
+    }
+
+    job_system::job_system(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    job_system job_system::create(const job_system_options& options)
+    {
+        std::vector<cpu_core> cores;
+        if (options.pin_to_physical_cores)
+        {
+            cores = cpu_topology::query().cores;
+        }
+        const std::uint32_t count = options.worker_count != 0 ? options.worker_count
+                                    : cores.empty()          ? processor_count()
+                                                             : static_cast<std::uint32_t>(cores.size());
+        auto impl = std::make_unique<job_system::impl>(count);
+
+#ifdef _WIN32
+        const auto groups = processor_groups();
+#endif
+        try
+        {
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                auto& worker = impl->workers[i];
+                auto core = cores.empty() ? std::vector<logical_processor>{} : cores[i % cores.size()].logical_processors;
+                worker.thread = std::thread{[state = impl.get(), i, core = std::move(core)] { state->run_worker(i, core); }};
+#ifdef _WIN32
+                if (cores.empty())
+                {
+                    assign_processor_group(worker.thread, i, groups);
+                }
+#endif
+            }
+        }
+        catch (const std::system_error& error)
+        {
+            impl->stopping.store(true, std::memory_order_release);
+            impl->wake_all();
+            for (auto& worker : impl->workers)
+            {
+                if (worker.thread.joinable())
+                {
+                    worker.thread.join();
+                }
+            }
+            throw except::platform_exception{"Failed to start job system worker: " + std::string{error.what()}};
+        }
+
+        return job_system{std::move(impl)};
+    }
+
+    job_system::~job_system()
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->stop();
+        }
+    }
+
+    job_system::job_system(job_system&&) noexcept = default;
+
+    job_system& job_system::operator=(job_system&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_impl != nullptr)
+            {
+                m_impl->stop();
+            }
+            m_impl = std::move(other.m_impl);
+        }
+        return *this;
+    }
+
+    std::uint32_t job_system::worker_count() const noexcept
+    {
+        return m_impl == nullptr ? 0 : static_cast<std::uint32_t>(m_impl->workers.size());
+    }
+
+    job_handle job_system::spawn_job(std::function<void()>&& work, const std::span<const job_handle> after)
+    {
+        auto* value = new job;
+        value->work = std::move(work);
+        m_impl->outstanding.fetch_add(1, std::memory_order_relaxed);
+
+        for (const auto& dependency : after)
+        {
+            job* other = dependency.m_job;
+            if (other == nullptr)
+            {
+                continue;
+            }
+            std::lock_guard lock{other->dependents_mutex};
+            if (!other->finished.load(std::memory_order_relaxed))
+            {
+                value->blockers.fetch_add(1, std::memory_order_relaxed);
+                other->dependents.push_back(value);
+            }
+        }
+
+        if (value->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            m_impl->schedule(value);
+        }
+        return job_handle{value};
+    }
+
+    void job_system::join(const job_handle& job) noexcept
+    {
+        if (job.m_job == nullptr)
+        {
+            return;
+        }
+
+        auto* value = job.m_job;
+        value->waiters.fetch_add(1, std::memory_order_seq_cst);
+        m_impl->help_until([value] { return value->finished.load(std::memory_order_seq_cst); });
+        value->waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void job_system::wait(const job_handle& job)
+    {
+        join(job);
+        if (job.m_job != nullptr && job.m_job->error != nullptr)
+        {
+            std::rethrow_exception(job.m_job->error);
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace detri
+{
+    struct job_system_options
+    {
+        // 0 starts one worker per logical processor the process may run on (processor_count()), or one per physical
+        // core with pin_to_physical_cores.
+        std::uint32_t worker_count {};
+        // Restrict each worker to the SMT siblings of its own physical core (see cpu_topology), so no two workers
+        // compete for one core's execution units.
+        bool pin_to_physical_cores {false};
+    };
+
+    // Shared reference to a spawned job. Cheap to copy; the job itself is freed once it has run and the last handle is
+    // gone.
+    class job_handle
+    {
+    public:
+        job_handle() = default;
+
+        ~job_handle();
+
+        job_handle(const job_handle& other) noexcept;
+
+        job_handle& operator=(const job_handle& other) noexcept;
+
+        job_handle(job_handle&& other) noexcept;
+
+        job_handle& operator=(job_handle&& other) noexcept;
+
+        [[nodiscard]] bool valid() const noexcept
+        {
+            return m_job != nullptr;
+        }
+
+        // True once the job has run. Handles that were never assigned count as done.
+        [[nodiscard]] bool done() const noexcept;
+
+        struct job;
+
+    private:
+        friend class job_system;
+
+        explicit job_handle(job* value) noexcept;
+
+        job* m_job {};
+    };
+
+    // Work-stealing task scheduler. Every worker owns a Chase-Lev deque: jobs spawned from inside a job go onto the
+    // spawning worker's deque and run LIFO, idle workers steal the oldest job from someone else. Jobs spawned from
+    // other threads go through a shared injection queue. On Windows workers are spread across every processor group,
+    // so machines with more than 64 logical processors are used in full.
+    class job_system
+    {
+    public:
+        // Throws except::platform_exception if the workers cannot be started.
+        static job_system create(const job_system_options& options = {});
+
+        job_system() = delete;
+
+        // Runs every job that has been spawned, then stops the workers.
+        ~job_system();
+
+        job_system(job_system&&) noexcept;
+
+        job_system& operator=(job_system&&) noexcept;
+
+        [[nodiscard]] std::uint32_t worker_count() const noexcept;
+
+        template <typename Function>
+        job_handle spawn(Function&& function)
+        {
+            return spawn_job(std::function<void()>{std::forward<Function>(function)}, {});
+        }
+
+        // Continuation: function becomes runnable once every job in after has finished, without a thread blocking on
+        // them in the meantime.
+        template <typename Function>
+        job_handle spawn_after(const std::span<const job_handle> after, Function&& function)
+        {
+            return spawn_job(std::function<void()>{std::forward<Function>(function)}, after);
+        }
+
+        template <typename Function>
+        job_handle spawn_after(const std::initializer_list<job_handle> after, Function&& function)
+        {
+            return spawn_after(std::span<const job_handle>{after.begin(), after.size()}, std::forward<Function>(function));
+        }
+
+        // Blocks until job has run, running other jobs on the calling thread in the meantime, so a job can fork
+        // children and wait for them without tying up its worker. Rethrows anything the job threw.
+        void wait(const job_handle& job);
+
+        // Calls function(first, last) over disjoint subranges of [begin, end) no longer than grain, split in halves so
+        // idle workers steal large pieces first. Returns once the whole range is done; rethrows the first exception
+        // a subrange threw.
+        template <typename Function>
+        void parallel_for(const std::size_t begin, const std::size_t end, const std::size_t grain, Function&& function)
+        {
+            const std::size_t limit = std::max<std::size_t>(grain, 1);
+            if (end <= begin)
+            {
+                return;
+            }
+            if (end - begin <= limit)
+            {
+                function(begin, end);
+                return;
+            }
+
+            const std::size_t middle = begin + (end - begin) / 2;
+            const job_handle upper = spawn([this, middle, end, limit, &function] {
+                parallel_for(middle, end, limit, function);
+            });
+            try
+            {
+                parallel_for(begin, middle, limit, function);
+            }
+            catch (...)
+            {
+                // upper still refers to function; it must finish before the exception leaves this frame.
+                join(upper);
+                throw;
+            }
+            wait(upper);
+        }
+
+        struct impl;
+
+    private:
+        explicit job_system(std::unique_ptr<impl>&& impl) noexcept;
+
+        job_handle spawn_job(std::function<void()>&& work, std::span<const job_handle> after);
+
+        // wait() without rethrowing.
+        void join(const job_handle& job) noexcept;
+
+        std::unique_ptr<impl> m_impl;
+    };
+}
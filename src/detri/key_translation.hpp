@@ -0,0 +1,296 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+#include "detri/platform_event.hpp"
+
+// Compile-time lookup tables from the native key codes of each backend to detri::key. Translation is an indexed load;
+// codes are spelled out numerically so every table builds on every platform, which lets the benchmarks cover them
+// all from one machine.
+namespace detri::key_translation
+{
+    namespace detail
+    {
+        using key_mapping = std::pair<std::uint32_t, key>;
+
+        // Entries are stored as bytes so every table fits in a few cache lines.
+        template <std::size_t Size>
+        using key_table = std::array<std::uint8_t, Size>;
+
+        static_assert(static_cast<std::uint32_t>(key::unknown) <= 0xFF, "detri::key no longer fits the byte tables");
+
+        // Picks fallback where primary is unknown, using a mask rather than a branch: which of the two applies is
+        // exactly what a random key stream makes unpredictable.
+        constexpr key select_known(const key primary, const key fallback) noexcept
+        {
+            const auto first = static_cast<std::uint32_t>(primary);
+            const std::uint32_t mask = 0U - static_cast<std::uint32_t>(primary == key::unknown);
+            return static_cast<key>((first & ~mask) | (static_cast<std::uint32_t>(fallback) & mask));
+        }
+
+        template <std::size_t Size>
+        constexpr key_table<Size> make_table(const std::initializer_list<key_mapping> mappings)
+        {
+            key_table<Size> table{};
+            table.fill(static_cast<std::uint8_t>(key::unknown));
+            for (const auto& [code, value] : mappings)
+            {
+                table[code] = static_cast<std::uint8_t>(value);
+            }
+            return table;
+        }
+
+        // Maps count consecutive codes starting at first_code onto consecutive keys starting at first_key.
+        template <std::size_t Size>
+        constexpr key_table<Size> with_run(key_table<Size> table, const std::uint32_t first_code, const key first_key,
+                                           const std::uint32_t count)
+        {
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                table[first_code + i] = static_cast<std::uint8_t>(static_cast<std::uint32_t>(first_key) + i);
+            }
+            return table;
+        }
+
+        // Win32 virtual-key codes. Keys whose virtual-key code does not say which physical key was hit are left
+        // unknown here and resolved from the scancode instead: VK_SHIFT/VK_CONTROL/VK_MENU carry no side, and with
+        // NumLock off the keypad reports the same codes as the navigation cluster.
+        inline constexpr key_table<256> win32_virtual_keys = [] {
+            auto table = make_table<256>({
+                {0x08, key::backspace},       // VK_BACK
+                {0x09, key::tab},             // VK_TAB
+                {0x1B, key::escape},          // VK_ESCAPE
+                {0x20, key::space},           // VK_SPACE
+                {0x5B, key::left_system},     // VK_LWIN
+                {0x5C, key::right_system},    // VK_RWIN
+                {0x60, key::numpad_0},        // VK_NUMPAD0
+                {0x61, key::numpad_1},
+                {0x62, key::numpad_2},
+                {0x63, key::numpad_3},
+                {0x64, key::numpad_4},
+                {0x65, key::numpad_5},
+                {0x66, key::numpad_6},
+                {0x67, key::numpad_7},
+                {0x68, key::numpad_8},
+                {0x69, key::numpad_9},
+                {0x6A, key::numpad_multiply}, // VK_MULTIPLY
+                {0x6B, key::numpad_add},      // VK_ADD
+                {0x6D, key::numpad_subtract}, // VK_SUBTRACT
+                {0x6E, key::numpad_decimal},  // VK_DECIMAL
+                {0x6F, key::numpad_divide},   // VK_DIVIDE
+                {0xA0, key::left_shift},      // VK_LSHIFT
+                {0xA1, key::right_shift},     // VK_RSHIFT
+                {0xA2, key::left_control},    // VK_LCONTROL
+                {0xA3, key::right_control},   // VK_RCONTROL
+                {0xA4, key::left_alt},        // VK_LMENU
+                {0xA5, key::right_alt},       // VK_RMENU
+            });
+            table = with_run(table, 'A', key::a, 26);
+            table = with_run(table, '0', key::zero, 10);
+            return with_run(table, 0x70 /* VK_F1 */, key::f1, 12);
+        }();
+
+        // Set 1 scancodes as reported in bits 16-23 of a key message's lParam, indexed by scancode | extended << 8.
+        inline constexpr key_table<512> win32_scancodes = make_table<512>({
+            {0x01, key::escape},
+            {0x0E, key::backspace},
+            {0x0F, key::tab},
+            {0x1C, key::enter},
+            {0x1D, key::left_control},
+            {0x2A, key::left_shift},
+            {0x36, key::right_shift},
+            {0x37, key::numpad_multiply},
+            {0x38, key::left_alt},
+            {0x39, key::space},
+            {0x47, key::numpad_7},
+            {0x48, key::numpad_8},
+            {0x49, key::numpad_9},
+            {0x4A, key::numpad_subtract},
+            {0x4B, key::numpad_4},
+            {0x4C, key::numpad_5},
+            {0x4D, key::numpad_6},
+            {0x4E, key::numpad_add},
+            {0x4F, key::numpad_1},
+            {0x50, key::numpad_2},
+            {0x51, key::numpad_3},
+            {0x52, key::numpad_0},
+            {0x53, key::numpad_decimal},
+            {0x100 | 0x1C, key::numpad_enter},
+            {0x100 | 0x1D, key::right_control},
+            {0x100 | 0x35, key::numpad_divide},
+            {0x100 | 0x38, key::right_alt},
+            {0x100 | 0x47, key::home},
+            {0x100 | 0x48, key::up},
+            {0x100 | 0x49, key::page_up},
+            {0x100 | 0x4B, key::left},
+            {0x100 | 0x4D, key::right},
+            {0x100 | 0x4F, key::end},
+            {0x100 | 0x50, key::down},
+            {0x100 | 0x51, key::page_down},
+            {0x100 | 0x52, key::insert},
+            {0x100 | 0x53, key::delete_},
+            {0x100 | 0x5B, key::left_system},
+            {0x100 | 0x5C, key::right_system},
+        });
+
+        // X11/xkb keysyms, one 256-entry row per keysym page: Latin-1 (0x00xx), the function-key page (0xFFxx), and a
+        // row of unknowns every other page lands on. The keypad's NumLock-off aliases (KP_Home and friends) are left
+        // unknown so the evdev code decides.
+        constexpr key_table<768> make_x11_keysyms()
+        {
+            auto latin1 = make_table<256>({{0x20, key::space}});
+            latin1 = with_run(latin1, 'a', key::a, 26);
+            latin1 = with_run(latin1, 'A', key::a, 26);
+            latin1 = with_run(latin1, '0', key::zero, 10);
+            auto function = make_table<256>({
+                {0x08, key::backspace},       // XK_BackSpace
+                {0x09, key::tab},             // XK_Tab
+                {0x0D, key::enter},           // XK_Return
+                {0x1B, key::escape},          // XK_Escape
+                {0x50, key::home},            // XK_Home
+                {0x51, key::left},            // XK_Left
+                {0x52, key::up},              // XK_Up
+                {0x53, key::right},           // XK_Right
+                {0x54, key::down},            // XK_Down
+                {0x55, key::page_up},         // XK_Page_Up
+                {0x56, key::page_down},       // XK_Page_Down
+                {0x57, key::end},             // XK_End
+                {0x63, key::insert},          // XK_Insert
+                {0x8D, key::numpad_enter},    // XK_KP_Enter
+                {0xAA, key::numpad_multiply}, // XK_KP_Multiply
+                {0xAB, key::numpad_add},      // XK_KP_Add
+                {0xAD, key::numpad_subtract}, // XK_KP_Subtract
+                {0xAE, key::numpad_decimal},  // XK_KP_Decimal
+                {0xAF, key::numpad_divide},   // XK_KP_Divide
+                {0xB0, key::numpad_0},        // XK_KP_0
+                {0xB1, key::numpad_1},
+                {0xB2, key::numpad_2},
+                {0xB3, key::numpad_3},
+                {0xB4, key::numpad_4},
+                {0xB5, key::numpad_5},
+                {0xB6, key::numpad_6},
+                {0xB7, key::numpad_7},
+                {0xB8, key::numpad_8},
+                {0xB9, key::numpad_9},
+                {0xE1, key::left_shift},      // XK_Shift_L
+                {0xE2, key::right_shift},     // XK_Shift_R
+                {0xE3, key::left_control},    // XK_Control_L
+                {0xE4, key::right_control},   // XK_Control_R
+                {0xE9, key::left_alt},        // XK_Alt_L
+                {0xEA, key::right_alt},       // XK_Alt_R
+                {0xEB, key::left_system},     // XK_Super_L
+                {0xEC, key::right_system},    // XK_Super_R
+                {0xFF, key::delete_},         // XK_Delete
+            });
+            function = with_run(function, 0xBE /* XK_F1 */, key::f1, 12);
+
+            key_table<768> table{};
+            table.fill(static_cast<std::uint8_t>(key::unknown));
+            for (std::size_t i = 0; i < 256; ++i)
+            {
+                table[i] = latin1[i];
+                table[256 + i] = function[i];
+            }
+            return table;
+        }
+
+        inline constexpr key_table<768> x11_keysyms = make_x11_keysyms();
+
+        // Linux evdev codes (KEY_* in linux/input-event-codes.h), as delivered by wl_keyboard and, offset by 8, as X
+        // keycodes. Positional, so it names the US-layout key in that spot.
+        inline constexpr key_table<256> evdev_codes = [] {
+            auto table = make_table<256>({
+                {1, key::escape},
+                {2, key::one}, {3, key::two}, {4, key::three}, {5, key::four}, {6, key::five},
+                {7, key::six}, {8, key::seven}, {9, key::eight}, {10, key::nine}, {11, key::zero},
+                {14, key::backspace},
+                {15, key::tab},
+                {16, key::q}, {17, key::w}, {18, key::e}, {19, key::r}, {20, key::t},
+                {21, key::y}, {22, key::u}, {23, key::i}, {24, key::o}, {25, key::p},
+                {28, key::enter},
+                {29, key::left_control},
+                {30, key::a}, {31, key::s}, {32, key::d}, {33, key::f}, {34, key::g},
+                {35, key::h}, {36, key::j}, {37, key::k}, {38, key::l},
+                {42, key::left_shift},
+                {44, key::z}, {45, key::x}, {46, key::c}, {47, key::v}, {48, key::b}, {49, key::n}, {50, key::m},
+                {54, key::right_shift},
+                {55, key::numpad_multiply},
+                {56, key::left_alt},
+                {57, key::space},
+                {71, key::numpad_7}, {72, key::numpad_8}, {73, key::numpad_9},
+                {74, key::numpad_subtract},
+                {75, key::numpad_4}, {76, key::numpad_5}, {77, key::numpad_6},
+                {78, key::numpad_add},
+                {79, key::numpad_1}, {80, key::numpad_2}, {81, key::numpad_3},
+                {82, key::numpad_0},
+                {83, key::numpad_decimal},
+                {87, key::f11}, {88, key::f12},
+                {96, key::numpad_enter},
+                {97, key::right_control},
+                {98, key::numpad_divide},
+                {100, key::right_alt},
+                {102, key::home},
+                {103, key::up},
+                {104, key::page_up},
+                {105, key::left},
+                {106, key::right},
+                {107, key::end},
+                {108, key::down},
+                {109, key::page_down},
+                {110, key::insert},
+                {111, key::delete_},
+                {125, key::left_system},
+                {126, key::right_system},
+            });
+            return with_run(table, 59 /* KEY_F1 */, key::f1, 10);
+        }();
+    }
+
+    [[nodiscard]] constexpr key from_win32_virtual_key(const std::uint32_t virtual_key) noexcept
+    {
+        return static_cast<key>(detail::win32_virtual_keys[virtual_key & 0xFF]);
+    }
+
+    [[nodiscard]] constexpr key from_win32_scancode(const std::uint32_t scancode, const bool extended) noexcept
+    {
+        return static_cast<key>(detail::win32_scancodes[(scancode & 0xFF) | (static_cast<std::uint32_t>(extended) << 8)]);
+    }
+
+    // Translates a WM_KEYDOWN/WM_KEYUP pair of wParam and lParam. The virtual key decides wherever it is unambiguous,
+    // so letters follow the active layout; only the keys it leaves unknown, sides and the keypad, go on to the
+    // scancode. Bits 16-24 of lParam are the scancode and extended flag already laid out as the table index.
+    [[nodiscard]] constexpr key from_win32_message(const std::uint64_t wparam, const std::int64_t lparam) noexcept
+    {
+        const key by_virtual_key = from_win32_virtual_key(static_cast<std::uint32_t>(wparam));
+        if (by_virtual_key != key::unknown)
+        {
+            return by_virtual_key;
+        }
+        return static_cast<key>(detail::win32_scancodes[(static_cast<std::uint64_t>(lparam) >> 16) & 0x1FF]);
+    }
+
+    [[nodiscard]] constexpr key from_evdev_code(const std::uint32_t code) noexcept
+    {
+        return code > 0xFF ? key::unknown : static_cast<key>(detail::evdev_codes[code & 0xFF]);
+    }
+
+    [[nodiscard]] constexpr key from_x11_keysym(const std::uint32_t keysym) noexcept
+    {
+        const std::uint32_t page = keysym >> 8;
+        const std::size_t row = static_cast<std::size_t>(page == 0xFF) | static_cast<std::size_t>(page != 0x00 && page != 0xFF) << 1;
+        return static_cast<key>(detail::x11_keysyms[row * 256 + (keysym & 0xFF)]);
+    }
+
+    // Translates an X11/Wayland key: the keysym first so letters follow the layout, then the evdev code for keys whose
+    // keysym depends on NumLock or that the keysym table does not name.
+    [[nodiscard]] constexpr key from_x11_keysym(const std::uint32_t keysym, const std::uint32_t evdev_code) noexcept
+    {
+        const key by_keysym = from_x11_keysym(keysym);
+        const key by_code = from_evdev_code(evdev_code);
+        return detail::select_known(by_keysym, by_code);
+    }
+}
@@ -0,0 +1,50 @@
+#include "detri/keyboard_state.hpp"
+
+namespace detri
+{
+    void keyboard_state::consume(const std::span<const event> batch, const bool queue_empty) noexcept
+    {
+        if (m_frame_complete)
+        {
+            m_pressed.reset();
+            m_released.reset();
+            m_frame_complete = false;
+        }
+
+        for (const auto& value : batch)
+        {
+            const auto* key_change = std::get_if<key_event>(&value);
+            if (key_change == nullptr || key_change->value == key::unknown)
+            {
+                continue;
+            }
+
+            const auto index = static_cast<std::size_t>(key_change->value);
+            if (key_change->pressed)
+            {
+                // Auto-repeat keeps the key held but is not a new press.
+                if (!key_change->repeated || !m_down.test(index))
+                {
+                    m_pressed.set(index);
+                }
+                m_down.set(index);
+            }
+            else
+            {
+                if (m_down.test(index))
+                {
+                    m_released.set(index);
+                }
+                m_down.reset(index);
+            }
+        }
+
+        m_frame_complete = queue_empty;
+    }
+
+    void keyboard_state::release_all() noexcept
+    {
+        m_released |= m_down;
+        m_down.reset();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <span>
+
+#include "detri/platform_event.hpp"
+
+namespace detri
+{
+    // Which keys are held, and which went down or up during the current frame, packed one bit per detri::key. A
+    // plain value type: copy it to hand a consistent snapshot to another thread.
+    class keyboard_state
+    {
+    public:
+        static constexpr std::size_t key_count = static_cast<std::size_t>(key::unknown);
+
+        [[nodiscard]] bool is_down(const key value) const noexcept
+        {
+            return value != key::unknown && m_down.test(static_cast<std::size_t>(value));
+        }
+
+        // True if the key went down at least once this frame, even if it has been released again since.
+        [[nodiscard]] bool was_pressed(const key value) const noexcept
+        {
+            return value != key::unknown && m_pressed.test(static_cast<std::size_t>(value));
+        }
+
+        [[nodiscard]] bool was_released(const key value) const noexcept
+        {
+            return value != key::unknown && m_released.test(static_cast<std::size_t>(value));
+        }
+
+        [[nodiscard]] bool any_down() const noexcept
+        {
+            return m_down.any();
+        }
+
+        // Folds a batch of events handed out by the window into the state. A frame runs from the first batch after
+        // the queue was last found empty up to and including the batch that empties it again, which lines up with a
+        // `while (auto event = win.poll_event())` loop or a for_each_event() call.
+        void consume(std::span<const event> batch, bool queue_empty) noexcept;
+
+        // Drops every held key, as when focus is lost and the matching releases will never arrive. The window does
+        // this itself as it hands out a focus_lost_event.
+        void release_all() noexcept;
+
+    private:
+        std::bitset<key_count> m_down;
+        std::bitset<key_count> m_pressed;
+        std::bitset<key_count> m_released;
+        bool m_frame_complete {true};
+    };
+}
@@ -0,0 +1,258 @@
+#include "detri/mapped_file.hpp"
+#include "detri/platform.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <mio/mmap.hpp>
+
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace detri
+{
+    namespace
+    {
+        void advise_range(const std::byte* address, const std::size_t length, const mapped_access_hint hint) noexcept
+        {
+            if (address == nullptr || length == 0)
+            {
+                return;
+            }
+
+            // The mapping itself starts on a page boundary, so rounding down never leaves it.
+            const std::uintptr_t page = mio::page_size();
+            const auto begin = reinterpret_cast<std::uintptr_t>(address) / page * page;
+            const auto end = reinterpret_cast<std::uintptr_t>(address) + length;
+
+#ifdef _WIN32
+            if (hint == mapped_access_hint::sequential || hint == mapped_access_hint::will_need)
+            {
+                WIN32_MEMORY_RANGE_ENTRY range{
+                    .VirtualAddress = reinterpret_cast<void*>(begin),
+                    .NumberOfBytes = static_cast<SIZE_T>(end - begin)
+                };
+                PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            }
+#else
+            int advice = MADV_NORMAL;
+            switch (hint)
+            {
+                case mapped_access_hint::normal:
+                    advice = MADV_NORMAL;
+                    break;
+                case mapped_access_hint::sequential:
+                    advice = MADV_SEQUENTIAL;
+                    break;
+                case mapped_access_hint::random:
+                    advice = MADV_RANDOM;
+                    break;
+                case mapped_access_hint::will_need:
+                    advice = MADV_WILLNEED;
+                    break;
+            }
+            (void)madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+#endif
+        }
+
+        void request_huge_pages([[maybe_unused]] const std::byte* address, [[maybe_unused]] const std::size_t length) noexcept
+        {
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+            if (address != nullptr && length != 0)
+            {
+                const std::uintptr_t page = mio::page_size();
+                const auto begin = reinterpret_cast<std::uintptr_t>(address) / page * page;
+                (void)madvise(reinterpret_cast<void*>(begin), reinterpret_cast<std::uintptr_t>(address) + length - begin,
+                              MADV_HUGEPAGE);
+            }
+#endif
+        }
+
+        std::string describe(const std::filesystem::path& path)
+        {
+            return "'" + path.string() + "'";
+        }
+    }
+
+    mapped_file_view::mapped_file_view(std::byte* data, const std::size_t size, const std::uint64_t file_offset,
+                                       const bool writable) noexcept
+        : m_data(data), m_size(size), m_file_offset(file_offset), m_writable(writable)
+    {
+    }
+
+    mapped_file_view mapped_file_view::subview(const std::uint64_t offset, const std::uint64_t length) const
+    {
+        if (offset > m_size || length > m_size - offset)
+        {
+            throw except::mapped_file_error{"Mapped view range " + std::to_string(offset) + "+" + std::to_string(length) +
+                                            " is outside a view of " + std::to_string(m_size) + " bytes."};
+        }
+        return {m_data + offset, static_cast<std::size_t>(length), m_file_offset + offset, m_writable};
+    }
+
+    void mapped_file_view::advise(const mapped_access_hint hint) const noexcept
+    {
+        advise_range(m_data, m_size, hint);
+    }
+
+    struct mapped_file::impl
+    {
+        mio::basic_mmap_source<std::byte> read_only;
+        mio::basic_mmap_sink<std::byte> read_write;
+        mapped_file_access access {mapped_file_access::read_only};
+        std::uint64_t file_offset {};
+
+        [[nodiscard]] std::byte* data() noexcept
+        {
+            return access == mapped_file_access::read_write ? read_write.data()
+                                                            : const_cast<std::byte*>(read_only.data());
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return access == mapped_file_access::read_write ? read_write.size() : read_only.size();
+        }
+    };
+
+    mapped_file::mapped_file(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    mapped_file mapped_file::open(const std::filesystem::path& path, const mapped_file_options& options)
+    {
+        std::error_code error;
+        const std::uint64_t file_size = std::filesystem::file_size(path, error);
+        if (error)
+        {
+            throw except::mapped_file_error{"Failed to open " + describe(path) + ": " + error.message()};
+        }
+        if (options.offset > file_size || options.length > file_size - options.offset)
+        {
+            throw except::mapped_file_error{"Requested range is outside " + describe(path) + " (" +
+                                            std::to_string(file_size) + " bytes)."};
+        }
+
+        auto impl = std::make_unique<mapped_file::impl>();
+        impl->access = options.access;
+        impl->file_offset = options.offset;
+
+        // Nothing to map, and mmap rejects a zero length.
+        const std::uint64_t length = options.length == 0 ? file_size - options.offset : options.length;
+        if (length != 0)
+        {
+            const auto offset = static_cast<std::size_t>(options.offset);
+            const auto mapped_length = static_cast<std::size_t>(length);
+            if (options.access == mapped_file_access::read_write)
+            {
+                impl->read_write.map(path.native(), offset, mapped_length, error);
+            }
+            else
+            {
+                impl->read_only.map(path.native(), offset, mapped_length, error);
+            }
+            if (error)
+            {
+                throw except::mapped_file_error{"Failed to map " + describe(path) + ": " + error.message()};
+            }
+        }
+
+        if (options.huge_pages)
+        {
+            request_huge_pages(impl->data(), impl->size());
+        }
+        if (options.hint != mapped_access_hint::normal)
+        {
+            advise_range(impl->data(), impl->size(), options.hint);
+        }
+
+        return mapped_file{std::move(impl)};
+    }
+
+    mapped_file mapped_file::create(const std::filesystem::path& path, const std::uint64_t size,
+                                    const mapped_file_options& options)
+    {
+        {
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            if (!file)
+            {
+                throw except::mapped_file_error{"Failed to create " + describe(path) + "."};
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::resize_file(path, size, error);
+        if (error)
+        {
+            throw except::mapped_file_error{"Failed to size " + describe(path) + ": " + error.message()};
+        }
+
+        auto read_write = options;
+        read_write.access = mapped_file_access::read_write;
+        return open(path, read_write);
+    }
+
+    mapped_file::~mapped_file() = default;
+
+    mapped_file::mapped_file(mapped_file&&) noexcept = default;
+
+    mapped_file& mapped_file::operator=(mapped_file&&) noexcept = default;
+
+    mapped_file_view mapped_file::view() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return {m_impl->data(), m_impl->size(), m_impl->file_offset, m_impl->access == mapped_file_access::read_write};
+    }
+
+    mapped_file_view mapped_file::view(const std::uint64_t offset, const std::uint64_t length) const
+    {
+        return view().subview(offset, length);
+    }
+
+    std::span<const std::byte> mapped_file::bytes() const noexcept
+    {
+        return view().bytes();
+    }
+
+    std::size_t mapped_file::size() const noexcept
+    {
+        return m_impl == nullptr ? 0 : m_impl->size();
+    }
+
+    mapped_file_access mapped_file::access() const noexcept
+    {
+        return m_impl == nullptr ? mapped_file_access::read_only : m_impl->access;
+    }
+
+    void mapped_file::advise(const mapped_access_hint hint) const noexcept
+    {
+        view().advise(hint);
+    }
+
+    void mapped_file::flush()
+    {
+        if (m_impl == nullptr || m_impl->access != mapped_file_access::read_write || !m_impl->read_write.is_mapped())
+        {
+            return;
+        }
+
+        std::error_code error;
+        m_impl->read_write.sync(error);
+        if (error)
+        {
+            throw except::mapped_file_error{"Failed to flush mapped file: " + error.message()};
+        }
+    }
+
+    std::size_t mapped_file::page_size() noexcept
+    {
+        return mio::page_size();
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace detri
+{
+    enum class mapped_file_access
+    {
+        read_only, read_write
+    };
+
+    // Tells the OS how a mapped range is about to be read. madvise on Linux; on Windows sequential and will_need
+    // prefetch the range with PrefetchVirtualMemory and the others are no-ops.
+    enum class mapped_access_hint
+    {
+        normal, sequential, random, will_need
+    };
+
+    struct mapped_file_options
+    {
+        mapped_file_access access {mapped_file_access::read_only};
+        // Byte range of the file to map. length 0 maps to the end of the file. The offset does not need to be
+        // page-aligned; the mapping is widened down to the page boundary behind the scenes.
+        std::uint64_t offset {};
+        std::uint64_t length {};
+        mapped_access_hint hint {mapped_access_hint::normal};
+        // Ask for transparent huge pages on the mapping (MADV_HUGEPAGE). Best effort: only takes effect where the
+        // kernel supports huge pages for file-backed memory, and is ignored on Windows, which only offers large
+        // pages for pagefile-backed sections.
+        bool huge_pages {false};
+    };
+
+    // Non-owning window into a mapped_file. Valid for as long as the mapped_file it came from.
+    class mapped_file_view
+    {
+    public:
+        mapped_file_view() = default;
+
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept
+        {
+            return {m_data, m_size};
+        }
+
+        // Empty unless the file was mapped read_write.
+        [[nodiscard]] std::span<std::byte> writable_bytes() const noexcept
+        {
+            return m_writable ? std::span<std::byte>{m_data, m_size} : std::span<std::byte>{};
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        // Offset of the view from the start of the file.
+        [[nodiscard]] std::uint64_t file_offset() const noexcept
+        {
+            return m_file_offset;
+        }
+
+        // Throws except::mapped_file_error if the range does not fit inside this view.
+        [[nodiscard]] mapped_file_view subview(std::uint64_t offset, std::uint64_t length) const;
+
+        // Applies to every page the view touches, so neighbouring data on the first and last page is advised too.
+        void advise(mapped_access_hint hint) const noexcept;
+
+    private:
+        friend class mapped_file;
+
+        mapped_file_view(std::byte* data, std::size_t size, std::uint64_t file_offset, bool writable) noexcept;
+
+        std::byte* m_data {};
+        std::size_t m_size {};
+        std::uint64_t m_file_offset {};
+        bool m_writable {};
+    };
+
+    // A file, or a range of one, mapped into the address space. Pages are read in on first touch, so opening a large
+    // pak costs nothing up front and reads go straight to the page cache without a copy through a user buffer.
+    class mapped_file
+    {
+    public:
+        static mapped_file open(const std::filesystem::path& path, const mapped_file_options& options = {});
+
+        // Creates path, or truncates it, at size bytes and maps it read_write. options.access is ignored.
+        static mapped_file create(const std::filesystem::path& path, std::uint64_t size,
+                                  const mapped_file_options& options = {});
+
+        mapped_file() = delete;
+
+        ~mapped_file();
+
+        mapped_file(mapped_file&&) noexcept;
+
+        mapped_file& operator=(mapped_file&&) noexcept;
+
+        // The whole mapped range.
+        [[nodiscard]] mapped_file_view view() const noexcept;
+
+        // offset is relative to the start of the mapped range. Throws except::mapped_file_error if the range does not
+        // fit.
+        [[nodiscard]] mapped_file_view view(std::uint64_t offset, std::uint64_t length) const;
+
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        [[nodiscard]] mapped_file_access access() const noexcept;
+
+        void advise(mapped_access_hint hint) const noexcept;
+
+        // Writes dirty pages back to the file. Does nothing for read_only mappings.
+        void flush();
+
+        [[nodiscard]] static std::size_t page_size() noexcept;
+
+    private:
+        struct impl;
+
+        explicit mapped_file(std::unique_ptr<impl>&& impl) noexcept;
+
+        std::unique_ptr<impl> m_impl;
+    };
+}
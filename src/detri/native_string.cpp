@@ -0,0 +1,30 @@
+#include "detri/native_string.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/unicode.hpp"
+
+#include <cstring>
+
+namespace detri
+{
+    native_string::native_string(const std::string_view text)
+    {
+        if (text.size() >= inline_capacity)
+        {
+            m_heap = std::make_unique_for_overwrite<native_char[]>(text.size() + 1);
+        }
+        m_data = m_heap != nullptr ? m_heap.get() : m_inline.data();
+
+#ifdef _WIN32
+        // UTF-16 never takes more units than UTF-8 takes bytes.
+        m_size = utf8_to_utf16(text, {reinterpret_cast<char16_t*>(m_data), text.size()});
+#else
+        if (!valid_utf8(text))
+        {
+            throw except::string_conversion_error{"Couldn't convert text: it is not valid UTF-8."};
+        }
+        std::memcpy(m_data, text.data(), text.size());
+        m_size = text.size();
+#endif
+        m_data[m_size] = native_char{};
+    }
+}
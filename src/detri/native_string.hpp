@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace detri
+{
+    // What the OS takes text in: UTF-16 on Windows, UTF-8 everywhere else.
+#ifdef _WIN32
+    using native_char = wchar_t;
+#else
+    using native_char = char;
+#endif
+
+    // A NUL-terminated copy of UTF-8 text in the OS's encoding, for handing titles, names and paths to the OS. Text
+    // shorter than inline_capacity code units is held inside the object, so converting the usual title on the stack
+    // never touches the heap; longer text costs one allocation. Validated and converted by the vector kernels behind
+    // detri/unicode.hpp. Throws except::string_conversion_error if text is not valid UTF-8.
+    class native_string
+    {
+    public:
+        static constexpr std::size_t inline_capacity = 256;
+
+        explicit native_string(std::string_view text);
+
+        native_string(const native_string&) = delete;
+
+        native_string& operator=(const native_string&) = delete;
+
+        [[nodiscard]] const native_char* c_str() const noexcept
+        {
+            return m_data;
+        }
+
+        // In code units, without the terminator.
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] std::basic_string_view<native_char> view() const noexcept
+        {
+            return {m_data, m_size};
+        }
+
+    private:
+        std::unique_ptr<native_char[]> m_heap;
+        native_char* m_data {};
+        std::size_t m_size {};
+        // Left uninitialized: only the converted prefix and its terminator are ever read.
+        std::array<native_char, inline_capacity> m_inline;
+    };
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 
 #ifdef _WIN32
@@ -12,7 +14,36 @@
 
 namespace detri
 {
+#ifdef _WIN32
+    // Into a fresh std::wstring; native_string converts without allocating. Throws except::string_conversion_error
+    // if str is not valid UTF-8.
     std::wstring to_wstring(const std::string& str);
+#endif
 
+    // Something a thread can block on next to the OS's own waits: an object HANDLE on Windows, a file descriptor to
+    // poll for readability elsewhere.
+#ifdef _WIN32
+    using native_wait_handle = HANDLE;
+    inline const native_wait_handle invalid_wait_handle = nullptr;
+#else
+    using native_wait_handle = int;
+    inline constexpr native_wait_handle invalid_wait_handle = -1;
+#endif
+
+    // Logical processors this process can run on. Windows counts every processor group; Linux counts the affinity
+    // mask and caps it at the cgroup CPU quota, rounded up, so a container limited to 2.5 CPUs reports 3.
     uint32_t processor_count();
+
+    // Monotonic, high-resolution clock that every event timestamp is expressed in. Backed by QueryPerformanceCounter
+    // on Windows and CLOCK_MONOTONIC elsewhere, so it is directly comparable with the OS input timestamps we rebase.
+    struct platform_clock
+    {
+        using rep = std::int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<platform_clock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept;
+    };
 }
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <variant>
 
+#include "detri/platform.hpp"
+
 namespace detri
 {
     enum class key : uint32_t
@@ -10,7 +12,9 @@ namespace detri
         escape, enter, tab, backspace, space, left, right, up, down, page_up, page_down, home, end, insert, delete_, a, b, c,
         d, e, f, g, h, i, j, k, l, m, n, o, p, q, r, s, t, u, v, w, x, y, z, zero, one, two, three, four, five, six,
         seven, eight, nine, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, left_shift, left_control, left_alt,
-        left_system, right_shift, right_control, right_alt, right_system, unknown
+        left_system, right_shift, right_control, right_alt, right_system, numpad_0, numpad_1, numpad_2, numpad_3,
+        numpad_4, numpad_5, numpad_6, numpad_7, numpad_8, numpad_9, numpad_add, numpad_subtract, numpad_multiply,
+        numpad_divide, numpad_decimal, numpad_enter, unknown
     };
 
     enum class mouse_button : uint32_t
@@ -22,6 +26,7 @@ namespace detri
         key value {key::unknown};
         bool pressed {};
         bool repeated {};
+        platform_clock::time_point timestamp {};
     };
 
     struct mouse_button_event {
@@ -29,26 +34,58 @@ namespace detri
         bool pressed {};
         std::int32_t x {};
         std::int32_t y {};
+        platform_clock::time_point timestamp {};
     };
 
     struct mouse_move_event {
         std::int32_t x {};
         std::int32_t y {};
+        platform_clock::time_point timestamp {};
     };
 
     struct mouse_delta_event {
         std::int32_t dx {};
         std::int32_t dy {};
+        platform_clock::time_point timestamp {};
     };
 
-    struct close_event {};
+    struct close_event
+    {
+        platform_clock::time_point timestamp {};
+    };
     struct resize_event
     {
         uint32_t width{};
         uint32_t height{};
+        platform_clock::time_point timestamp {};
+    };
+    struct resize_begin_event
+    {
+        platform_clock::time_point timestamp {};
+    };
+    struct resize_end_event
+    {
+        platform_clock::time_point timestamp {};
+    };
+    // The window now renders at a different scale, typically because it moved to another display. A resize_event
+    // follows if the OS resized the window to keep its apparent size.
+    struct dpi_changed_event
+    {
+        float scale {1.0f};
+        platform_clock::time_point timestamp {};
+    };
+    // A display was connected, disconnected or changed mode. enumerate_displays() has the new layout.
+    struct display_changed_event
+    {
+        platform_clock::time_point timestamp {};
+    };
+
+    // The window lost keyboard focus, e.g. to alt-tab. Keys still held will not report their release to it, so
+    // window::keyboard() drops them as this event is handed out.
+    struct focus_lost_event
+    {
+        platform_clock::time_point timestamp {};
     };
-    struct resize_begin_event {};
-    struct resize_end_event {};
 
     using event = std::variant<
         close_event,
@@ -58,5 +95,19 @@ namespace detri
         key_event,
         mouse_button_event,
         mouse_move_event,
-        mouse_delta_event>;
+        mouse_delta_event,
+        dpi_changed_event,
+        display_changed_event,
+        focus_lost_event>;
+
+    // When the OS reported the event, as close to its arrival as the backend can tell.
+    inline platform_clock::time_point event_timestamp(const event& value) noexcept
+    {
+        return std::visit([](const auto& alternative) { return alternative.timestamp; }, value);
+    }
+
+    inline void set_event_timestamp(event& value, const platform_clock::time_point timestamp) noexcept
+    {
+        std::visit([timestamp](auto& alternative) { alternative.timestamp = timestamp; }, value);
+    }
 }
@@ -7,4 +7,7 @@ namespace detri::except
     DETRI_EXCEPTION_BASE(platform_exception, "Window Exception")
     DETRI_EXCEPTION(platform_exception, string_conversion_error, "String Conversion Error")
     DETRI_EXCEPTION(platform_exception, window_error, "Window Error")
+    DETRI_EXCEPTION(platform_exception, input_recording_error, "Input Recording Error")
+    DETRI_EXCEPTION(platform_exception, mapped_file_error, "Mapped File Error")
+    DETRI_EXCEPTION(platform_exception, async_io_error, "Async I/O Error")
 }
\ No newline at end of file
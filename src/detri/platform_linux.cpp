@@ -0,0 +1,245 @@
+#include "detri/high_resolution_timer.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/platform.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace detri
+{
+    namespace
+    {
+        timespec to_timespec(const platform_clock::duration value) noexcept
+        {
+            const auto count = std::max<platform_clock::rep>(value.count(), 0);
+            return timespec{
+                .tv_sec = static_cast<time_t>(count / 1'000'000'000),
+                .tv_nsec = static_cast<long>(count % 1'000'000'000)
+            };
+        }
+
+        // Logical processors in the affinity mask, so taskset/cpusets are honoured. Grows the mask past the
+        // 1024 CPUs cpu_set_t covers if the kernel needs more.
+        std::optional<std::uint32_t> affinity_count()
+        {
+            for (std::size_t cpus = CPU_SETSIZE; cpus <= 64 * 1024; cpus *= 2)
+            {
+                cpu_set_t* set = CPU_ALLOC(cpus);
+                if (set == nullptr)
+                {
+                    return std::nullopt;
+                }
+                const std::size_t size = CPU_ALLOC_SIZE(cpus);
+                CPU_ZERO_S(size, set);
+                if (sched_getaffinity(0, size, set) == 0)
+                {
+                    const int count = CPU_COUNT_S(size, set);
+                    CPU_FREE(set);
+                    return count > 0 ? std::optional{static_cast<std::uint32_t>(count)} : std::nullopt;
+                }
+                CPU_FREE(set);
+                if (errno != EINVAL)
+                {
+                    return std::nullopt;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // Quota / period, in CPUs, or nothing if the group is unlimited or the files are missing.
+        std::optional<double> cgroup_v2_limit(const std::string& directory)
+        {
+            std::ifstream file{directory + "/cpu.max"};
+            std::string quota;
+            double period = 0;
+            if (!(file >> quota >> period) || quota == "max" || period <= 0)
+            {
+                return std::nullopt;
+            }
+            const double value = std::strtod(quota.c_str(), nullptr);
+            return value > 0 ? std::optional{value / period} : std::nullopt;
+        }
+
+        std::optional<double> cgroup_v1_limit(const std::string& directory)
+        {
+            std::ifstream quota_file{directory + "/cpu.cfs_quota_us"};
+            std::ifstream period_file{directory + "/cpu.cfs_period_us"};
+            double quota = 0;
+            double period = 0;
+            if (!(quota_file >> quota) || !(period_file >> period) || quota <= 0 || period <= 0)
+            {
+                return std::nullopt;
+            }
+            return quota / period;
+        }
+
+        // The tightest CPU bandwidth limit between the process's cgroup and the root, as containers and systemd
+        // slices set it. The cgroup path from /proc/self/cgroup is looked up under the usual mount points; inside
+        // a container with its own cgroup namespace that path is "/", which maps to the container's own limit.
+        std::optional<double> cgroup_cpu_limit()
+        {
+            std::ifstream membership{"/proc/self/cgroup"};
+            std::optional<double> limit;
+            const auto tighten = [&limit](const std::optional<double> value) {
+                if (value.has_value() && (!limit.has_value() || *value < *limit))
+                {
+                    limit = value;
+                }
+            };
+
+            std::string line;
+            while (std::getline(membership, line))
+            {
+                // hierarchy-id:controllers:path
+                const auto first = line.find(':');
+                const auto second = line.find(':', first + 1);
+                if (first == std::string::npos || second == std::string::npos)
+                {
+                    continue;
+                }
+                const std::string controllers = line.substr(first + 1, second - first - 1);
+                std::string path = line.substr(second + 1);
+
+                std::string root;
+                bool unified = false;
+                if (line.compare(0, first, "0") == 0 && controllers.empty())
+                {
+                    root = "/sys/fs/cgroup";
+                    unified = true;
+                }
+                else
+                {
+                    std::stringstream list{controllers};
+                    std::string controller;
+                    bool has_cpu = false;
+                    while (std::getline(list, controller, ','))
+                    {
+                        has_cpu = has_cpu || controller == "cpu";
+                    }
+                    if (!has_cpu)
+                    {
+                        continue;
+                    }
+                    root = "/sys/fs/cgroup/" + controllers;
+                }
+
+                // Walk up to the mount root; any ancestor can be the one that carries the limit.
+                while (true)
+                {
+                    const std::string directory = root + (path == "/" ? "" : path);
+                    tighten(unified ? cgroup_v2_limit(directory) : cgroup_v1_limit(directory));
+                    if (path.empty() || path == "/")
+                    {
+                        break;
+                    }
+                    const auto slash = path.find_last_of('/');
+                    path = slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+                }
+            }
+            return limit;
+        }
+    }
+
+    uint32_t processor_count() {
+        std::uint32_t count = 0;
+        if (const auto affinity = affinity_count())
+        {
+            count = *affinity;
+        }
+        else
+        {
+            const long online = sysconf(_SC_NPROCESSORS_ONLN);
+            count = online > 0 ? static_cast<std::uint32_t>(online) : 0;
+        }
+
+        if (count == 0)
+        {
+            throw except::platform_exception{"OS reported zero logical processors."};
+        }
+
+        if (const auto limit = cgroup_cpu_limit())
+        {
+            count = std::min(count, std::max(1U, static_cast<std::uint32_t>(std::ceil(*limit))));
+        }
+        return count;
+    }
+
+    platform_clock::time_point platform_clock::now() noexcept
+    {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return time_point{duration{static_cast<rep>(now.tv_sec) * 1'000'000'000 + now.tv_nsec}};
+    }
+
+    // clock_nanosleep needs no handle; the class only exists for the Windows timer.
+    high_resolution_timer::high_resolution_timer() = default;
+
+    high_resolution_timer::~high_resolution_timer() = default;
+
+    void high_resolution_timer::sleep_until(const platform_clock::time_point deadline)
+    {
+        // platform_clock is CLOCK_MONOTONIC, so the deadline converts as is. An absolute sleep interrupted by a signal
+        // resumes without drifting.
+        const timespec until = to_timespec(deadline.time_since_epoch());
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, nullptr) == EINTR)
+        {
+        }
+    }
+
+    std::optional<std::size_t> wait_readable(const std::span<const int> fds, const platform_clock::time_point deadline)
+    {
+        // A window wait watches one or two descriptors; only a long handle list needs the heap.
+        std::array<pollfd, 8> inline_descriptors{};
+        std::vector<pollfd> heap_descriptors;
+        if (fds.size() > inline_descriptors.size())
+        {
+            heap_descriptors.resize(fds.size());
+        }
+        const std::span<pollfd> descriptors = heap_descriptors.empty()
+                                                  ? std::span{inline_descriptors}.first(fds.size())
+                                                  : std::span<pollfd>{heap_descriptors};
+        for (std::size_t i = 0; i < fds.size(); ++i)
+        {
+            descriptors[i] = {.fd = fds[i], .events = POLLIN, .revents = 0};
+        }
+
+        for (;;)
+        {
+            // ppoll rather than poll: its timeout is in nanoseconds instead of whole milliseconds.
+            const bool forever = deadline == platform_clock::time_point::max();
+            const timespec timeout = to_timespec(forever ? platform_clock::duration{} : deadline - platform_clock::now());
+            const int result = ppoll(descriptors.data(), descriptors.size(), forever ? nullptr : &timeout, nullptr);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result < 0)
+            {
+                throw except::platform_exception{"ppoll failed: " + std::string{std::strerror(errno)}};
+            }
+
+            for (std::size_t i = 0; i < descriptors.size(); ++i)
+            {
+                if ((descriptors[i].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL)) != 0)
+                {
+                    return i;
+                }
+            }
+            return std::nullopt;
+        }
+    }
+}
@@ -1,54 +1,158 @@
+#include "detri/high_resolution_timer.hpp"
+#include "detri/native_string.hpp"
 #include "detri/platform_exceptions.hpp"
 #include "detri/platform.hpp"
 
+#include <algorithm>
+#include <array>
+
+// Windows 10 1803+; older SDKs lack the define.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 namespace detri
 {
     std::wstring to_wstring(const std::string& str)
     {
-        if (str.empty())
+        const native_string converted{str};
+        return std::wstring{converted.view()};
+    }
+
+    uint32_t processor_count() {
+        const WORD group_count = GetActiveProcessorGroupCount();
+        if (group_count == 0)
         {
-            return {};
+            throw except::platform_exception{"OS reported zero processor groups."};
         }
-        std::wstring wstr;
 
-        const int required_size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0);
+        std::uint32_t total = 0;
+        for (WORD group = 0; group < group_count; ++group)
+        {
+            const DWORD count = GetActiveProcessorCount(group);
+            total += static_cast<std::uint32_t>(count);
+        }
 
-        if (required_size == 0)
+        if (total == 0)
         {
-            throw except::string_conversion_error{"Couldn't convert UTF-8 to UTF-16. Windows error code: " + std::to_string(GetLastError())};
+            throw except::platform_exception{"OS reported zero logical processors."};
         }
 
-        wstr.resize(required_size);
+        return total;
+    }
 
-        int converted_size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &wstr[0], required_size);
+    platform_clock::time_point platform_clock::now() noexcept
+    {
+        static const LONGLONG frequency = [] {
+            LARGE_INTEGER value{};
+            QueryPerformanceFrequency(&value);
+            return value.QuadPart;
+        }();
+
+        LARGE_INTEGER counter{};
+        QueryPerformanceCounter(&counter);
+
+        // Split the conversion so counter * 1e9 cannot overflow on long uptimes.
+        const LONGLONG seconds = counter.QuadPart / frequency;
+        const LONGLONG remainder = counter.QuadPart % frequency;
+        return time_point{duration{seconds * 1'000'000'000 + remainder * 1'000'000'000 / frequency}};
+    }
 
-        if (converted_size == 0)
+    high_resolution_timer::high_resolution_timer()
+    {
+        // A high-resolution timer fires off the hardware timer instead of the next scheduler tick, which is 15.6 ms
+        // unless someone raised the global timer resolution. Older Windows rejects the flag.
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (m_timer == nullptr)
+        {
+            m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+        if (m_timer == nullptr)
         {
-            throw except::string_conversion_error{"Couldn't convert UTF-8 to UTF-16. Windows error code: " + std::to_string(GetLastError())};
+            throw except::platform_exception{"Failed to create a waitable timer. Windows error code: " +
+                                             std::to_string(GetLastError())};
         }
+    }
 
-        return wstr;
+    high_resolution_timer::~high_resolution_timer()
+    {
+        CloseHandle(m_timer);
     }
 
-    uint32_t processor_count() {
-        const WORD group_count = GetActiveProcessorGroupCount();
-        if (group_count == 0)
+    void high_resolution_timer::arm(const platform_clock::time_point deadline)
+    {
+        // Relative due times are negative, in 100 ns units. Round up so the timer never fires early.
+        const auto remaining = std::max(deadline - platform_clock::now(), platform_clock::duration{});
+        LARGE_INTEGER due{};
+        due.QuadPart = -(static_cast<LONGLONG>(remaining.count() / 100) + 1);
+        if (!SetWaitableTimerEx(m_timer, &due, 0, nullptr, nullptr, nullptr, 0))
         {
-            throw except::platform_exception{"OS reported zero processor groups."};
+            throw except::platform_exception{"Failed to arm a waitable timer. Windows error code: " +
+                                             std::to_string(GetLastError())};
         }
+    }
 
-        std::uint32_t total = 0;
-        for (WORD group = 0; group < group_count; ++group)
+    void high_resolution_timer::sleep_until(const platform_clock::time_point deadline)
+    {
+        if (deadline <= platform_clock::now())
         {
-            const DWORD count = GetActiveProcessorCount(group);
-            total += static_cast<std::uint32_t>(count);
+            return;
         }
+        arm(deadline);
+        WaitForSingleObject(m_timer, INFINITE);
+    }
 
-        if (total == 0)
+    std::optional<std::size_t> wait_objects(const std::span<const HANDLE> objects, const platform_clock::time_point deadline,
+                                            high_resolution_timer& timer, const bool messages)
+    {
+        // One slot goes to the timer; MsgWaitForMultipleObjectsEx keeps another for the message queue.
+        const std::size_t limit = MAXIMUM_WAIT_OBJECTS - 1 - (messages ? 1 : 0);
+        if (objects.size() > limit)
         {
-            throw except::platform_exception{"OS reported zero logical processors."};
+            throw except::platform_exception{"Cannot wait on more than " + std::to_string(limit) + " handles at once."};
         }
 
-        return total;
+        std::array<HANDLE, MAXIMUM_WAIT_OBJECTS> all{};
+        std::copy(objects.begin(), objects.end(), all.begin());
+        auto count = static_cast<DWORD>(objects.size());
+
+        // A deadline already past polls once instead of arming the timer.
+        DWORD timeout = INFINITE;
+        if (deadline <= platform_clock::now())
+        {
+            timeout = 0;
+        }
+        else if (deadline != platform_clock::time_point::max())
+        {
+            timer.arm(deadline);
+            all[count++] = timer.handle();
+        }
+        if (count == 0 && !messages)
+        {
+            return std::nullopt;
+        }
+
+        // MWMO_INPUTAVAILABLE also wakes for messages that arrived before the call but were not looked at yet.
+        const DWORD result = messages ? MsgWaitForMultipleObjectsEx(count, all.data(), timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE)
+                                      : WaitForMultipleObjects(count, all.data(), FALSE, timeout);
+        if (result == WAIT_FAILED)
+        {
+            throw except::platform_exception{"Failed to wait on handles. Windows error code: " +
+                                             std::to_string(GetLastError())};
+        }
+        if (result == WAIT_TIMEOUT)
+        {
+            return std::nullopt;
+        }
+
+        // An abandoned mutex still wakes the wait; its owner finds out when it looks.
+        const std::size_t index = result >= WAIT_ABANDONED_0 && result < WAIT_ABANDONED_0 + count
+                                      ? result - WAIT_ABANDONED_0
+                                      : result - WAIT_OBJECT_0;
+        if (index < objects.size() || (messages && index == count))
+        {
+            return std::min<std::size_t>(index, objects.size());
+        }
+        return std::nullopt;
     }
 }
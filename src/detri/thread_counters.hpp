@@ -0,0 +1,114 @@
+#pragma once
+
+// Internal to the platform library: how the hot paths record into the calling thread's counters. Without
+// DETRI_PLATFORM_INSTRUMENTATION everything here is an empty inline function and compiles away.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "detri/instrumentation.hpp"
+
+namespace detri
+{
+    enum class timed_section : std::uint8_t
+    {
+        pump, os, message_hook
+    };
+
+#ifdef DETRI_PLATFORM_INSTRUMENTATION
+    // One thread's counters. The owning thread is their only writer and updates them with a relaxed load and store
+    // rather than a read-modify-write; any thread may read them.
+    struct counter_block
+    {
+        struct histogram
+        {
+            std::array<std::atomic<std::uint64_t>, duration_histogram::bucket_count> buckets {};
+            std::atomic<std::uint64_t> count {};
+            std::atomic<platform_clock::rep> total {};
+            std::atomic<platform_clock::rep> longest {};
+            // Only the owner touches this: nested sections of one kind are timed once, by the outermost.
+            std::uint32_t depth {};
+        };
+
+        // The thread recording into the block, or a default id while the block is free for the next thread to claim.
+        std::atomic<std::thread::id> owner;
+        std::array<histogram, 3> sections;
+        std::array<std::atomic<std::uint64_t>, std::variant_size_v<event>> events {};
+        std::atomic<std::uint64_t> queue_high_water {};
+        // Blocks are pushed onto a list that is never unlinked from, so readers walk it without locks. A thread that
+        // exits frees its block for reuse rather than deleting it.
+        counter_block* next {};
+    };
+
+    counter_block& thread_counter_block() noexcept;
+
+    void record_duration(counter_block::histogram& target, platform_clock::duration value) noexcept;
+
+    inline void add_to(std::atomic<std::uint64_t>& counter, const std::uint64_t amount) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    inline void count_event(const std::size_t index) noexcept
+    {
+        add_to(thread_counter_block().events[index], 1);
+    }
+
+    inline void note_queue_depth(const std::uint64_t depth) noexcept
+    {
+        auto& high_water = thread_counter_block().queue_high_water;
+        if (depth > high_water.load(std::memory_order_relaxed))
+        {
+            high_water.store(depth, std::memory_order_relaxed);
+        }
+    }
+
+    // Times its own lifetime into the calling thread's histogram for section.
+    class section_timer
+    {
+    public:
+        explicit section_timer(const timed_section section) noexcept
+            : m_histogram(thread_counter_block().sections[static_cast<std::size_t>(section)])
+            , m_start(m_histogram.depth++ == 0 ? platform_clock::now() : platform_clock::time_point{})
+        {
+        }
+
+        ~section_timer()
+        {
+            if (--m_histogram.depth == 0)
+            {
+                record_duration(m_histogram, platform_clock::now() - m_start);
+            }
+        }
+
+        section_timer(const section_timer&) = delete;
+
+        section_timer& operator=(const section_timer&) = delete;
+
+    private:
+        counter_block::histogram& m_histogram;
+        platform_clock::time_point m_start;
+    };
+#else
+    inline void count_event(std::size_t) noexcept
+    {
+    }
+
+    inline void note_queue_depth(std::uint64_t) noexcept
+    {
+    }
+
+    class section_timer
+    {
+    public:
+        explicit section_timer(timed_section) noexcept
+        {
+        }
+
+        section_timer(const section_timer&) = delete;
+
+        section_timer& operator=(const section_timer&) = delete;
+    };
+#endif
+}
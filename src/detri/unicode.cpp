@@ -0,0 +1,501 @@
+#include "detri/unicode.hpp"
+#include "detri/unicode_kernels.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+namespace detri
+{
+    namespace
+    {
+        struct decoded
+        {
+            char32_t code_point {};
+            // Zero if the sequence is malformed.
+            std::size_t length {};
+        };
+
+        decoded decode_utf8(const unsigned char* bytes, const std::size_t available) noexcept
+        {
+            const char32_t lead = bytes[0];
+            if (lead < 0x80)
+            {
+                return {lead, 1};
+            }
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                if (available < 2 || (bytes[1] & 0xC0) != 0x80)
+                {
+                    return {};
+                }
+                return {(lead & 0x1F) << 6 | (bytes[1] & 0x3Fu), 2};
+            }
+            if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                const unsigned low = lead == 0xE0 ? 0xA0 : 0x80;
+                const unsigned high = lead == 0xED ? 0x9F : 0xBF;
+                if (available < 3 || bytes[1] < low || bytes[1] > high || (bytes[2] & 0xC0) != 0x80)
+                {
+                    return {};
+                }
+                return {(lead & 0x0F) << 12 | (bytes[1] & 0x3Fu) << 6 | (bytes[2] & 0x3Fu), 3};
+            }
+            if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                const unsigned low = lead == 0xF0 ? 0x90 : 0x80;
+                const unsigned high = lead == 0xF4 ? 0x8F : 0xBF;
+                if (available < 4 || bytes[1] < low || bytes[1] > high || (bytes[2] & 0xC0) != 0x80 ||
+                    (bytes[3] & 0xC0) != 0x80)
+                {
+                    return {};
+                }
+                return {(lead & 0x07) << 18 | (bytes[1] & 0x3Fu) << 12 | (bytes[2] & 0x3Fu) << 6 | (bytes[3] & 0x3Fu),
+                        4};
+            }
+            return {};
+        }
+
+        [[noreturn]] void throw_malformed(const char* encoding)
+        {
+            throw except::string_conversion_error{std::string{"Couldn't convert text: it is not valid "} + encoding +
+                                                  "."};
+        }
+
+        [[noreturn]] void throw_too_small()
+        {
+            throw except::string_conversion_error{"Couldn't convert text: the output buffer is too small."};
+        }
+
+        // Encodes a code point already known to be valid, after checking it fits.
+        void encode_utf8(const char32_t code_point, const std::span<char> out, std::size_t& written)
+        {
+            const std::size_t length = code_point < 0x80 ? 1 : code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+            if (out.size() - written < length)
+            {
+                throw_too_small();
+            }
+            char* const bytes = out.data() + written;
+            switch (length)
+            {
+                case 1:
+                    bytes[0] = static_cast<char>(code_point);
+                    break;
+                case 2:
+                    bytes[0] = static_cast<char>(0xC0 | code_point >> 6);
+                    bytes[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+                    break;
+                case 3:
+                    bytes[0] = static_cast<char>(0xE0 | code_point >> 12);
+                    bytes[1] = static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+                    bytes[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+                    break;
+                default:
+                    bytes[0] = static_cast<char>(0xF0 | code_point >> 18);
+                    bytes[1] = static_cast<char>(0x80 | (code_point >> 12 & 0x3F));
+                    bytes[2] = static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+                    bytes[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+                    break;
+            }
+            written += length;
+        }
+
+        bool is_surrogate(const char32_t unit) noexcept
+        {
+            return unit - 0xD800 < 0x800;
+        }
+
+        // Eight bytes at a time: the portable stand-in for a vector, for the kernels below.
+        constexpr std::size_t word_size = sizeof(std::uint64_t);
+
+        std::uint64_t load_word(const void* bytes) noexcept
+        {
+            std::uint64_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            return word;
+        }
+
+        bool ascii_word(const std::uint64_t word) noexcept
+        {
+            return (word & 0x8080'8080'8080'8080) == 0;
+        }
+
+        bool scalar_validate_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(text);
+            std::size_t i = 0;
+            while (i < size)
+            {
+                if (size - i >= word_size && ascii_word(load_word(bytes + i)))
+                {
+                    i += word_size;
+                    continue;
+                }
+                const std::size_t length = decode_utf8(bytes + i, size - i).length;
+                if (length == 0)
+                {
+                    return false;
+                }
+                i += length;
+            }
+            return true;
+        }
+
+        utf8_counts scalar_count_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            return count_utf8_tail(text, size, {});
+        }
+
+        template <typename Unit>
+        std::size_t scalar_widen_ascii(const char* const text, const std::size_t size, Unit* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= word_size && ascii_word(load_word(text + i)); i += word_size)
+            {
+                for (std::size_t k = 0; k < word_size; ++k)
+                {
+                    out[i + k] = static_cast<Unit>(text[i + k]);
+                }
+            }
+            return widen_ascii_tail(text, size, out, i);
+        }
+
+        template <typename Unit>
+        std::size_t scalar_narrow_ascii(const Unit* const text, const std::size_t size, char* const out) noexcept
+        {
+            return narrow_ascii_tail(text, size, out, 0);
+        }
+
+        std::size_t scalar_find_surrogate(const char16_t* const text, const std::size_t size) noexcept
+        {
+            return find_surrogate_tail(text, size, 0);
+        }
+
+        constexpr unicode_kernels scalar_kernels {
+            .name = "scalar",
+            .validate_utf8 = scalar_validate_utf8,
+            .count_utf8 = scalar_count_utf8,
+            .widen_ascii16 = scalar_widen_ascii<char16_t>,
+            .widen_ascii32 = scalar_widen_ascii<char32_t>,
+            .narrow_ascii16 = scalar_narrow_ascii<char16_t>,
+            .narrow_ascii32 = scalar_narrow_ascii<char32_t>,
+            .find_surrogate = scalar_find_surrogate,
+        };
+
+        template <typename Unit>
+        std::size_t utf8_to(const unicode_kernels& kernels, const std::string_view text, const std::span<Unit> out)
+        {
+            constexpr bool utf16 = std::is_same_v<Unit, char16_t>;
+            const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+            std::size_t read = 0;
+            std::size_t written = 0;
+            while (read < text.size())
+            {
+                // ASCII maps one to one, so the kernel may go as far as the shorter of the two.
+                const std::size_t room = std::min(text.size() - read, out.size() - written);
+                std::size_t ascii;
+                if constexpr (utf16)
+                {
+                    ascii = kernels.widen_ascii16(text.data() + read, room, out.data() + written);
+                }
+                else
+                {
+                    ascii = kernels.widen_ascii32(text.data() + read, room, out.data() + written);
+                }
+                read += ascii;
+                written += ascii;
+                // The kernel only stops short of ASCII when out is full.
+                if (read < text.size() && bytes[read] < 0x80)
+                {
+                    throw_too_small();
+                }
+
+                while (read < text.size() && bytes[read] >= 0x80)
+                {
+                    const decoded sequence = decode_utf8(bytes + read, text.size() - read);
+                    if (sequence.length == 0)
+                    {
+                        throw_malformed("UTF-8");
+                    }
+                    const bool pair = utf16 && sequence.code_point >= 0x10000;
+                    if (out.size() - written < (pair ? 2u : 1u))
+                    {
+                        throw_too_small();
+                    }
+                    if (pair)
+                    {
+                        out[written++] = static_cast<Unit>(0xD800 + ((sequence.code_point - 0x10000) >> 10));
+                        out[written++] = static_cast<Unit>(0xDC00 + (sequence.code_point & 0x3FF));
+                    }
+                    else
+                    {
+                        out[written++] = static_cast<Unit>(sequence.code_point);
+                    }
+                    read += sequence.length;
+                }
+            }
+            return written;
+        }
+
+        const unicode_kernels& active_kernels() noexcept
+        {
+            static const unicode_kernels& active = *supported_unicode_kernels().back();
+            return active;
+        }
+    } // namespace
+
+    const unicode_kernels& scalar_unicode_kernels() noexcept
+    {
+        return scalar_kernels;
+    }
+
+    std::span<const unicode_kernels* const> supported_unicode_kernels() noexcept
+    {
+        struct kernel_list
+        {
+            std::array<const unicode_kernels*, 3> kernels {};
+            std::size_t count {};
+
+            void add(const unicode_kernels* const candidate) noexcept
+            {
+                if (candidate != nullptr)
+                {
+                    kernels[count++] = candidate;
+                }
+            }
+        };
+
+        static const kernel_list supported = [] {
+            kernel_list list;
+            list.add(&scalar_kernels);
+#if defined(DETRI_UNICODE_X86)
+            list.add(sse41_unicode_kernels());
+            list.add(avx2_unicode_kernels());
+#elif defined(DETRI_UNICODE_NEON)
+            list.add(neon_unicode_kernels());
+#endif
+            return list;
+        }();
+        return {supported.kernels.data(), supported.count};
+    }
+
+    bool valid_utf8(const unicode_kernels& kernels, const std::string_view text) noexcept
+    {
+        return kernels.validate_utf8(text.data(), text.size());
+    }
+
+    bool valid_utf16(const unicode_kernels& kernels, const std::u16string_view text) noexcept
+    {
+        std::size_t i = 0;
+        while (i < text.size())
+        {
+            i += kernels.find_surrogate(text.data() + i, text.size() - i);
+            if (i == text.size())
+            {
+                break;
+            }
+            if (text[i] > 0xDBFF || i + 1 == text.size() || text[i + 1] - 0xDC00u >= 0x400)
+            {
+                return false;
+            }
+            i += 2;
+        }
+        return true;
+    }
+
+    std::size_t utf16_length(const unicode_kernels& kernels, const std::string_view utf8) noexcept
+    {
+        const utf8_counts counts = kernels.count_utf8(utf8.data(), utf8.size());
+        return counts.code_points + counts.four_byte;
+    }
+
+    std::size_t utf32_length(const unicode_kernels& kernels, const std::string_view utf8) noexcept
+    {
+        return kernels.count_utf8(utf8.data(), utf8.size()).code_points;
+    }
+
+    std::size_t utf8_to_utf16(const unicode_kernels& kernels, const std::string_view text,
+                              const std::span<char16_t> out)
+    {
+        return utf8_to(kernels, text, out);
+    }
+
+    std::size_t utf8_to_utf32(const unicode_kernels& kernels, const std::string_view text,
+                              const std::span<char32_t> out)
+    {
+        return utf8_to(kernels, text, out);
+    }
+
+    std::size_t utf16_to_utf8(const unicode_kernels& kernels, const std::u16string_view text, const std::span<char> out)
+    {
+        std::size_t read = 0;
+        std::size_t written = 0;
+        while (read < text.size())
+        {
+            const std::size_t room = std::min(text.size() - read, out.size() - written);
+            const std::size_t ascii = kernels.narrow_ascii16(text.data() + read, room, out.data() + written);
+            read += ascii;
+            written += ascii;
+            if (read < text.size() && text[read] < 0x80)
+            {
+                throw_too_small();
+            }
+
+            while (read < text.size() && text[read] >= 0x80)
+            {
+                char32_t code_point = text[read];
+                if (!is_surrogate(code_point))
+                {
+                    ++read;
+                }
+                else if (code_point <= 0xDBFF && read + 1 < text.size() && text[read + 1] - 0xDC00u < 0x400)
+                {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (text[read + 1] - 0xDC00u);
+                    read += 2;
+                }
+                else
+                {
+                    throw_malformed("UTF-16");
+                }
+                encode_utf8(code_point, out, written);
+            }
+        }
+        return written;
+    }
+
+    std::size_t utf32_to_utf8(const unicode_kernels& kernels, const std::u32string_view text, const std::span<char> out)
+    {
+        std::size_t read = 0;
+        std::size_t written = 0;
+        while (read < text.size())
+        {
+            const std::size_t room = std::min(text.size() - read, out.size() - written);
+            const std::size_t ascii = kernels.narrow_ascii32(text.data() + read, room, out.data() + written);
+            read += ascii;
+            written += ascii;
+            if (read < text.size() && text[read] < 0x80)
+            {
+                throw_too_small();
+            }
+
+            for (; read < text.size() && text[read] >= 0x80; ++read)
+            {
+                if (text[read] > 0x10FFFF || is_surrogate(text[read]))
+                {
+                    throw_malformed("UTF-32");
+                }
+                encode_utf8(text[read], out, written);
+            }
+        }
+        return written;
+    }
+
+    bool valid_utf8(const std::string_view text) noexcept
+    {
+        return valid_utf8(active_kernels(), text);
+    }
+
+    bool valid_utf16(const std::u16string_view text) noexcept
+    {
+        return valid_utf16(active_kernels(), text);
+    }
+
+    bool valid_utf32(const std::u32string_view text) noexcept
+    {
+        // Branch-free, so the compiler vectorizes it on its own.
+        bool malformed = false;
+        for (const char32_t code_point : text)
+        {
+            malformed |= (code_point > 0x10FFFF) | is_surrogate(code_point);
+        }
+        return !malformed;
+    }
+
+    std::size_t utf16_length(const std::string_view utf8) noexcept
+    {
+        return utf16_length(active_kernels(), utf8);
+    }
+
+    std::size_t utf32_length(const std::string_view utf8) noexcept
+    {
+        return utf32_length(active_kernels(), utf8);
+    }
+
+    std::size_t utf8_length(const std::u16string_view utf16) noexcept
+    {
+        // A surrogate counts two bytes, so a pair counts the four its code point takes.
+        std::size_t length = 0;
+        for (const char16_t unit : utf16)
+        {
+            length += 1 + (unit >= 0x80) + (unit >= 0x800 && !is_surrogate(unit));
+        }
+        return length;
+    }
+
+    std::size_t utf8_length(const std::u32string_view utf32) noexcept
+    {
+        std::size_t length = 0;
+        for (const char32_t code_point : utf32)
+        {
+            length += 1 + (code_point >= 0x80) + (code_point >= 0x800) + (code_point >= 0x10000);
+        }
+        return length;
+    }
+
+    std::size_t utf8_to_utf16(const std::string_view text, const std::span<char16_t> out)
+    {
+        return utf8_to_utf16(active_kernels(), text, out);
+    }
+
+    std::size_t utf8_to_utf32(const std::string_view text, const std::span<char32_t> out)
+    {
+        return utf8_to_utf32(active_kernels(), text, out);
+    }
+
+    std::size_t utf16_to_utf8(const std::u16string_view text, const std::span<char> out)
+    {
+        return utf16_to_utf8(active_kernels(), text, out);
+    }
+
+    std::size_t utf32_to_utf8(const std::u32string_view text, const std::span<char> out)
+    {
+        return utf32_to_utf8(active_kernels(), text, out);
+    }
+
+    // Malformed text makes the lengths meaningless, but the conversion then throws at the first malformed code unit,
+    // and everything before it was counted exactly.
+    std::u16string to_utf16(const std::string_view text)
+    {
+        std::u16string converted(utf16_length(text), u'\0');
+        utf8_to_utf16(text, converted);
+        return converted;
+    }
+
+    std::u32string to_utf32(const std::string_view text)
+    {
+        std::u32string converted(utf32_length(text), U'\0');
+        utf8_to_utf32(text, converted);
+        return converted;
+    }
+
+    std::string to_utf8(const std::u16string_view text)
+    {
+        std::string converted(utf8_length(text), '\0');
+        utf16_to_utf8(text, converted);
+        return converted;
+    }
+
+    std::string to_utf8(const std::u32string_view text)
+    {
+        std::string converted(utf8_length(text), '\0');
+        utf32_to_utf8(text, converted);
+        return converted;
+    }
+
+    std::string_view unicode_instruction_set() noexcept
+    {
+        return active_kernels().name;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Validation and conversion between UTF-8, UTF-16 and UTF-32, for text on its way into and out of the OS: titles,
+// paths, manifests. Well-formed means what the OS converters accept: no overlong forms, no surrogates in UTF-8 or
+// UTF-32, no unpaired surrogates in UTF-16 and nothing past U+10FFFF. Every function runs on AVX2, SSE4.1 or NEON when
+// the CPU has it, picked once on first use, and on a portable scalar path otherwise.
+namespace detri
+{
+    [[nodiscard]] bool valid_utf8(std::string_view text) noexcept;
+
+    [[nodiscard]] bool valid_utf16(std::u16string_view text) noexcept;
+
+    [[nodiscard]] bool valid_utf32(std::u32string_view text) noexcept;
+
+    // How many code units well-formed text takes in another encoding, to size the output of the conversions below
+    // exactly. Malformed text gets a meaningless count.
+    [[nodiscard]] std::size_t utf16_length(std::string_view utf8) noexcept;
+
+    [[nodiscard]] std::size_t utf32_length(std::string_view utf8) noexcept;
+
+    [[nodiscard]] std::size_t utf8_length(std::u16string_view utf16) noexcept;
+
+    [[nodiscard]] std::size_t utf8_length(std::u32string_view utf32) noexcept;
+
+    // Convert text into out and return the number of code units written. Besides the exact lengths above, out is
+    // always big enough at text.size() units from UTF-8, 3 * text.size() bytes from UTF-16 and 4 * text.size() bytes
+    // from UTF-32. Throw except::string_conversion_error if text is malformed or out is too small, leaving a partial
+    // conversion in out.
+    std::size_t utf8_to_utf16(std::string_view text, std::span<char16_t> out);
+
+    std::size_t utf8_to_utf32(std::string_view text, std::span<char32_t> out);
+
+    std::size_t utf16_to_utf8(std::u16string_view text, std::span<char> out);
+
+    std::size_t utf32_to_utf8(std::u32string_view text, std::span<char> out);
+
+    // The conversions above into a fresh string.
+    std::u16string to_utf16(std::string_view text);
+
+    std::u32string to_utf32(std::string_view text);
+
+    std::string to_utf8(std::u16string_view text);
+
+    std::string to_utf8(std::u32string_view text);
+
+    // What the functions above run on: "avx2", "sse4.1", "neon" or "scalar".
+    [[nodiscard]] std::string_view unicode_instruction_set() noexcept;
+}
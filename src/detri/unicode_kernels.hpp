@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "detri/unicode.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DETRI_UNICODE_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DETRI_UNICODE_NEON
+#endif
+
+namespace detri
+{
+    struct utf8_counts
+    {
+        std::size_t code_points {};
+        // Lead bytes of four-byte sequences, each of which takes a surrogate pair in UTF-16.
+        std::size_t four_byte {};
+    };
+
+    // The vector loops behind detri/unicode.hpp for one instruction set. The ASCII loops convert the leading ASCII of
+    // text and return how many code units that was; a block that ends the run is still stored whole, so size must not
+    // exceed the room in out. The drivers in unicode.cpp convert everything else one code point at a time.
+    struct unicode_kernels
+    {
+        std::string_view name;
+        bool (*validate_utf8)(const char* text, std::size_t size) noexcept;
+        // Over well-formed UTF-8.
+        utf8_counts (*count_utf8)(const char* text, std::size_t size) noexcept;
+        std::size_t (*widen_ascii16)(const char* text, std::size_t size, char16_t* out) noexcept;
+        std::size_t (*widen_ascii32)(const char* text, std::size_t size, char32_t* out) noexcept;
+        std::size_t (*narrow_ascii16)(const char16_t* text, std::size_t size, char* out) noexcept;
+        std::size_t (*narrow_ascii32)(const char32_t* text, std::size_t size, char* out) noexcept;
+        // Where the first surrogate in text is, or size.
+        std::size_t (*find_surrogate)(const char16_t* text, std::size_t size) noexcept;
+    };
+
+    // What is left once the vector loop has less than a block to work with, shared by every kernel set.
+    template <typename Unit>
+    std::size_t widen_ascii_tail(const char* const text, const std::size_t size, Unit* const out,
+                                 std::size_t i) noexcept
+    {
+        for (; i < size && static_cast<unsigned char>(text[i]) < 0x80; ++i)
+        {
+            out[i] = static_cast<Unit>(text[i]);
+        }
+        return i;
+    }
+
+    template <typename Unit>
+    std::size_t narrow_ascii_tail(const Unit* const text, const std::size_t size, char* const out,
+                                  std::size_t i) noexcept
+    {
+        for (; i < size && text[i] < 0x80; ++i)
+        {
+            out[i] = static_cast<char>(text[i]);
+        }
+        return i;
+    }
+
+    inline std::size_t find_surrogate_tail(const char16_t* const text, const std::size_t size, std::size_t i) noexcept
+    {
+        while (i < size && (text[i] & 0xF800) != 0xD800)
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    inline utf8_counts count_utf8_tail(const char* const text, const std::size_t size, utf8_counts counts) noexcept
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto byte = static_cast<unsigned char>(text[i]);
+            counts.code_points += (byte & 0xC0) != 0x80;
+            counts.four_byte += byte >= 0xF0;
+        }
+        return counts;
+    }
+
+    const unicode_kernels& scalar_unicode_kernels() noexcept;
+
+    // nullptr when the CPU lacks the instruction set.
+#ifdef DETRI_UNICODE_X86
+    const unicode_kernels* sse41_unicode_kernels() noexcept;
+
+    const unicode_kernels* avx2_unicode_kernels() noexcept;
+#endif
+#ifdef DETRI_UNICODE_NEON
+    const unicode_kernels* neon_unicode_kernels() noexcept;
+#endif
+
+    // Every kernel set this CPU can run, scalar first. The public functions use the last.
+    std::span<const unicode_kernels* const> supported_unicode_kernels() noexcept;
+
+    // The public functions on a given kernel set, so tests and benchmarks can hold them against each other.
+    [[nodiscard]] bool valid_utf8(const unicode_kernels& kernels, std::string_view text) noexcept;
+
+    [[nodiscard]] bool valid_utf16(const unicode_kernels& kernels, std::u16string_view text) noexcept;
+
+    [[nodiscard]] std::size_t utf16_length(const unicode_kernels& kernels, std::string_view utf8) noexcept;
+
+    [[nodiscard]] std::size_t utf32_length(const unicode_kernels& kernels, std::string_view utf8) noexcept;
+
+    std::size_t utf8_to_utf16(const unicode_kernels& kernels, std::string_view text, std::span<char16_t> out);
+
+    std::size_t utf8_to_utf32(const unicode_kernels& kernels, std::string_view text, std::span<char32_t> out);
+
+    std::size_t utf16_to_utf8(const unicode_kernels& kernels, std::u16string_view text, std::span<char> out);
+
+    std::size_t utf32_to_utf8(const unicode_kernels& kernels, std::u32string_view text, std::span<char> out);
+
+    // Keiser and Lemire's UTF-8 validation ("Validating UTF-8 In Less Than One Instruction Per Byte", 2021), shared by
+    // the vector kernels. Three 16-entry nibble lookups, on the high and low nibble of each byte's predecessor and the
+    // high nibble of the byte itself, flag every malformed pair of adjacent bytes; a saturating subtract on the bytes
+    // two and three back finds where a third or fourth continuation byte is due.
+    namespace utf8_lookup
+    {
+        inline constexpr std::uint8_t too_short = 1 << 0;
+        inline constexpr std::uint8_t too_long = 1 << 1;
+        inline constexpr std::uint8_t overlong_3 = 1 << 2;
+        inline constexpr std::uint8_t too_large = 1 << 3;
+        inline constexpr std::uint8_t surrogate = 1 << 4;
+        inline constexpr std::uint8_t overlong_2 = 1 << 5;
+        inline constexpr std::uint8_t too_large_1000 = 1 << 6;
+        inline constexpr std::uint8_t overlong_4 = 1 << 6;
+        inline constexpr std::uint8_t two_continuations = 1 << 7;
+        inline constexpr std::uint8_t carry = too_short | too_long | two_continuations;
+
+        alignas(16) inline constexpr std::array<std::uint8_t, 16> byte_1_high {
+            // ASCII
+            too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+            // Continuation
+            two_continuations, two_continuations, two_continuations, two_continuations,
+            // 1100, 1101: two-byte leads
+            too_short | overlong_2,
+            too_short,
+            // 1110: three-byte leads
+            too_short | overlong_3 | surrogate,
+            // 1111: four-byte leads
+            too_short | too_large | too_large_1000 | overlong_4,
+        };
+
+        alignas(16) inline constexpr std::array<std::uint8_t, 16> byte_1_low {
+            carry | overlong_3 | overlong_2 | overlong_4,
+            carry | overlong_2,
+            carry,
+            carry,
+            carry | too_large,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000 | surrogate,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+        };
+
+        alignas(16) inline constexpr std::array<std::uint8_t, 16> byte_2_high {
+            // ASCII
+            too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+            // 1000, 1001, 101x: continuations
+            too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+            too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+            too_long | overlong_2 | two_continuations | surrogate | too_large,
+            too_long | overlong_2 | two_continuations | surrogate | too_large,
+            // Leads
+            too_short, too_short, too_short, too_short,
+        };
+
+        // A block ends inside a sequence if any of its bytes exceeds these: a four-byte lead among the last three, a
+        // three-byte lead among the last two or any lead last. The 16-byte kernels use the back half.
+        alignas(32) inline constexpr std::array<std::uint8_t, 32> incomplete_limit {
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+        };
+    }
+}
@@ -0,0 +1,208 @@
+#include "detri/unicode_kernels.hpp"
+
+#ifdef DETRI_UNICODE_NEON
+
+#include <bit>
+#include <cstring>
+
+#include <arm_neon.h>
+
+// NEON is part of every AArch64 CPU, so nothing here needs a runtime check.
+namespace detri
+{
+    namespace
+    {
+        uint8x16_t load_bytes(const void* const source) noexcept
+        {
+            return vld1q_u8(static_cast<const std::uint8_t*>(source));
+        }
+
+        struct neon_utf8_state
+        {
+            uint8x16_t previous;
+            uint8x16_t incomplete;
+            uint8x16_t error;
+        };
+
+        void neon_check_utf8(const uint8x16_t input, neon_utf8_state& state) noexcept
+        {
+            if (vmaxvq_u8(input) < 0x80)
+            {
+                state.error = vorrq_u8(state.error, state.incomplete);
+                state.previous = input;
+                return;
+            }
+
+            const uint8x16_t previous_1 = vextq_u8(state.previous, input, 15);
+            const uint8x16_t byte_1_high = vqtbl1q_u8(load_bytes(utf8_lookup::byte_1_high.data()),
+                                                      vshrq_n_u8(previous_1, 4));
+            const uint8x16_t byte_1_low = vqtbl1q_u8(load_bytes(utf8_lookup::byte_1_low.data()),
+                                                     vandq_u8(previous_1, vdupq_n_u8(0x0F)));
+            const uint8x16_t byte_2_high = vqtbl1q_u8(load_bytes(utf8_lookup::byte_2_high.data()),
+                                                      vshrq_n_u8(input, 4));
+            const uint8x16_t special = vandq_u8(vandq_u8(byte_1_high, byte_1_low), byte_2_high);
+
+            const uint8x16_t third = vqsubq_u8(vextq_u8(state.previous, input, 14), vdupq_n_u8(0xE0 - 0x80));
+            const uint8x16_t fourth = vqsubq_u8(vextq_u8(state.previous, input, 13), vdupq_n_u8(0xF0 - 0x80));
+            const uint8x16_t continuation_due = vandq_u8(vorrq_u8(third, fourth), vdupq_n_u8(0x80));
+
+            state.error = vorrq_u8(state.error, veorq_u8(continuation_due, special));
+            state.incomplete = vqsubq_u8(input, load_bytes(utf8_lookup::incomplete_limit.data() + 16));
+            state.previous = input;
+        }
+
+        bool neon_validate_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            neon_utf8_state state {vdupq_n_u8(0), vdupq_n_u8(0), vdupq_n_u8(0)};
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                neon_check_utf8(load_bytes(text + i), state);
+            }
+            if (i < size)
+            {
+                // Padded with NULs, which are ASCII and so end any sequence the tail leaves open.
+                alignas(16) char tail[16] {};
+                std::memcpy(tail, text + i, size - i);
+                neon_check_utf8(load_bytes(tail), state);
+            }
+            return vmaxvq_u8(vorrq_u8(state.error, state.incomplete)) == 0;
+        }
+
+        utf8_counts neon_count_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            utf8_counts counts;
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const uint8x16_t bytes = load_bytes(text + i);
+                // Signed, continuation bytes are -64 and below.
+                const uint8x16_t leads = vcgtq_s8(vreinterpretq_s8_u8(bytes), vdupq_n_s8(-65));
+                const uint8x16_t four_byte = vcgeq_u8(bytes, vdupq_n_u8(0xF0));
+                counts.code_points += vaddvq_u8(vshrq_n_u8(leads, 7));
+                counts.four_byte += vaddvq_u8(vshrq_n_u8(four_byte, 7));
+            }
+            return count_utf8_tail(text + i, size - i, counts);
+        }
+
+        // NEON has no movemask: narrowing each byte of a comparison to four bits leaves a 64-bit mask whose trailing
+        // zeros, over four, index the first set lane. 16 if none is.
+        std::size_t first_lane(const uint8x16_t lanes) noexcept
+        {
+            const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4)), 0);
+            return mask == 0 ? 16 : static_cast<std::size_t>(std::countr_zero(mask)) / 4;
+        }
+
+        std::size_t neon_widen_ascii16(const char* const text, const std::size_t size, char16_t* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const uint8x16_t bytes = load_bytes(text + i);
+                auto* const target = reinterpret_cast<std::uint16_t*>(out + i);
+                vst1q_u16(target, vmovl_u8(vget_low_u8(bytes)));
+                vst1q_u16(target + 8, vmovl_high_u8(bytes));
+                if (vmaxvq_u8(bytes) >= 0x80)
+                {
+                    return i + first_lane(vcgeq_u8(bytes, vdupq_n_u8(0x80)));
+                }
+            }
+            return widen_ascii_tail(text, size, out, i);
+        }
+
+        std::size_t neon_widen_ascii32(const char* const text, const std::size_t size, char32_t* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const uint8x16_t bytes = load_bytes(text + i);
+                const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+                const uint16x8_t high = vmovl_high_u8(bytes);
+                auto* const target = reinterpret_cast<std::uint32_t*>(out + i);
+                vst1q_u32(target, vmovl_u16(vget_low_u16(low)));
+                vst1q_u32(target + 4, vmovl_high_u16(low));
+                vst1q_u32(target + 8, vmovl_u16(vget_low_u16(high)));
+                vst1q_u32(target + 12, vmovl_high_u16(high));
+                if (vmaxvq_u8(bytes) >= 0x80)
+                {
+                    return i + first_lane(vcgeq_u8(bytes, vdupq_n_u8(0x80)));
+                }
+            }
+            return widen_ascii_tail(text, size, out, i);
+        }
+
+        // Saturating narrows turn every unit past ASCII into a byte with the top bit set.
+        std::size_t neon_narrow_ascii16(const char16_t* const text, const std::size_t size, char* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const auto* const source = reinterpret_cast<const std::uint16_t*>(text + i);
+                const uint8x16_t bytes = vcombine_u8(vqmovn_u16(vld1q_u16(source)), vqmovn_u16(vld1q_u16(source + 8)));
+                vst1q_u8(reinterpret_cast<std::uint8_t*>(out + i), bytes);
+                if (vmaxvq_u8(bytes) >= 0x80)
+                {
+                    return i + first_lane(vcgeq_u8(bytes, vdupq_n_u8(0x80)));
+                }
+            }
+            return narrow_ascii_tail(text, size, out, i);
+        }
+
+        std::size_t neon_narrow_ascii32(const char32_t* const text, const std::size_t size, char* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const auto* const source = reinterpret_cast<const std::uint32_t*>(text + i);
+                const uint16x4_t a = vqmovn_u32(vld1q_u32(source));
+                const uint16x4_t b = vqmovn_u32(vld1q_u32(source + 4));
+                const uint16x4_t c = vqmovn_u32(vld1q_u32(source + 8));
+                const uint16x4_t d = vqmovn_u32(vld1q_u32(source + 12));
+                const uint8x16_t bytes = vcombine_u8(vqmovn_u16(vcombine_u16(a, b)), vqmovn_u16(vcombine_u16(c, d)));
+                vst1q_u8(reinterpret_cast<std::uint8_t*>(out + i), bytes);
+                if (vmaxvq_u8(bytes) >= 0x80)
+                {
+                    return i + first_lane(vcgeq_u8(bytes, vdupq_n_u8(0x80)));
+                }
+            }
+            return narrow_ascii_tail(text, size, out, i);
+        }
+
+        std::size_t neon_find_surrogate(const char16_t* const text, const std::size_t size) noexcept
+        {
+            const uint16x8_t mask = vdupq_n_u16(0xF800);
+            const uint16x8_t surrogate = vdupq_n_u16(0xD800);
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const auto* const source = reinterpret_cast<const std::uint16_t*>(text + i);
+                const uint16x8_t low = vceqq_u16(vandq_u16(vld1q_u16(source), mask), surrogate);
+                const uint16x8_t high = vceqq_u16(vandq_u16(vld1q_u16(source + 8), mask), surrogate);
+                const uint8x16_t found = vcombine_u8(vmovn_u16(low), vmovn_u16(high));
+                if (vmaxvq_u8(found) != 0)
+                {
+                    return i + first_lane(found);
+                }
+            }
+            return find_surrogate_tail(text, size, i);
+        }
+
+        constexpr unicode_kernels neon_kernels {
+            .name = "neon",
+            .validate_utf8 = neon_validate_utf8,
+            .count_utf8 = neon_count_utf8,
+            .widen_ascii16 = neon_widen_ascii16,
+            .widen_ascii32 = neon_widen_ascii32,
+            .narrow_ascii16 = neon_narrow_ascii16,
+            .narrow_ascii32 = neon_narrow_ascii32,
+            .find_surrogate = neon_find_surrogate,
+        };
+    } // namespace
+
+    const unicode_kernels* neon_unicode_kernels() noexcept
+    {
+        return &neon_kernels;
+    }
+}
+
+#endif
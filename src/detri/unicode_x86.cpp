@@ -0,0 +1,480 @@
+#include "detri/unicode_kernels.hpp"
+
+#ifdef DETRI_UNICODE_X86
+
+#include <bit>
+#include <cstring>
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Each kernel is compiled for its own instruction set and only ever called once the CPU has been checked for it, so
+// the library itself still runs on any x86-64. MSVC takes the intrinsics without being told.
+#if defined(__GNUC__) || defined(__clang__)
+#define DETRI_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define DETRI_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DETRI_TARGET_SSE41
+#define DETRI_TARGET_AVX2
+#endif
+
+namespace detri
+{
+    namespace
+    {
+        bool cpu_has_sse41() noexcept
+        {
+#ifdef _MSC_VER
+            int registers[4];
+            __cpuid(registers, 1);
+            return (registers[2] & 1 << 19) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.1") != 0;
+#endif
+        }
+
+        // The OS has to save the YMM registers too, which it advertises through XCR0. The builtins check that, and
+        // initialize themselves here because the first call can come from a static initializer.
+        bool cpu_has_avx2() noexcept
+        {
+#ifdef _MSC_VER
+            int registers[4];
+            __cpuid(registers, 0);
+            if (registers[0] < 7)
+            {
+                return false;
+            }
+            __cpuid(registers, 1);
+            const bool os_saves_ymm = (registers[2] & 1 << 27) != 0 && (registers[2] & 1 << 28) != 0 &&
+                                      (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(registers, 7, 0);
+            return os_saves_ymm && (registers[1] & 1 << 5) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+#endif
+        }
+
+        std::size_t set_lanes(const int movemask) noexcept
+        {
+            return static_cast<std::size_t>(std::popcount(static_cast<unsigned>(movemask)));
+        }
+
+        std::size_t first_lane(const int movemask) noexcept
+        {
+            return static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(movemask)));
+        }
+
+        // SSE4.1, 16 bytes a block.
+
+        DETRI_TARGET_SSE41 __m128i sse41_load(const void* const source) noexcept
+        {
+            return _mm_loadu_si128(static_cast<const __m128i*>(source));
+        }
+
+        DETRI_TARGET_SSE41 void sse41_store(void* const target, const __m128i value) noexcept
+        {
+            _mm_storeu_si128(static_cast<__m128i*>(target), value);
+        }
+
+        DETRI_TARGET_SSE41 __m128i sse41_high_nibbles(const __m128i bytes) noexcept
+        {
+            return _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+        }
+
+        struct sse41_utf8_state
+        {
+            __m128i previous;
+            __m128i incomplete;
+            __m128i error;
+        };
+
+        DETRI_TARGET_SSE41 void sse41_check_utf8(const __m128i input, sse41_utf8_state& state) noexcept
+        {
+            if (_mm_movemask_epi8(input) == 0)
+            {
+                state.error = _mm_or_si128(state.error, state.incomplete);
+                state.previous = input;
+                return;
+            }
+
+            const __m128i previous_1 = _mm_alignr_epi8(input, state.previous, 15);
+            const __m128i byte_1_high = _mm_shuffle_epi8(sse41_load(utf8_lookup::byte_1_high.data()),
+                                                         sse41_high_nibbles(previous_1));
+            const __m128i byte_1_low = _mm_shuffle_epi8(sse41_load(utf8_lookup::byte_1_low.data()),
+                                                        _mm_and_si128(previous_1, _mm_set1_epi8(0x0F)));
+            const __m128i byte_2_high = _mm_shuffle_epi8(sse41_load(utf8_lookup::byte_2_high.data()),
+                                                         sse41_high_nibbles(input));
+            const __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+            const __m128i previous_2 = _mm_alignr_epi8(input, state.previous, 14);
+            const __m128i previous_3 = _mm_alignr_epi8(input, state.previous, 13);
+            const __m128i third = _mm_subs_epu8(previous_2, _mm_set1_epi8(0xE0 - 0x80));
+            const __m128i fourth = _mm_subs_epu8(previous_3, _mm_set1_epi8(0xF0 - 0x80));
+            const __m128i continuation_due = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(-0x80));
+
+            state.error = _mm_or_si128(state.error, _mm_xor_si128(continuation_due, special));
+            state.incomplete = _mm_subs_epu8(input, sse41_load(utf8_lookup::incomplete_limit.data() + 16));
+            state.previous = input;
+        }
+
+        DETRI_TARGET_SSE41 bool sse41_validate_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            sse41_utf8_state state {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                sse41_check_utf8(sse41_load(text + i), state);
+            }
+            if (i < size)
+            {
+                // Padded with NULs, which are ASCII and so end any sequence the tail leaves open.
+                alignas(16) char tail[16] {};
+                std::memcpy(tail, text + i, size - i);
+                sse41_check_utf8(sse41_load(tail), state);
+            }
+            const __m128i error = _mm_or_si128(state.error, state.incomplete);
+            return _mm_testz_si128(error, error) != 0;
+        }
+
+        DETRI_TARGET_SSE41 utf8_counts sse41_count_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            utf8_counts counts;
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const __m128i bytes = sse41_load(text + i);
+                // Signed, continuation bytes are -64 and below.
+                const __m128i leads = _mm_cmpgt_epi8(bytes, _mm_set1_epi8(-65));
+                const __m128i four_byte = _mm_cmpeq_epi8(_mm_max_epu8(bytes, _mm_set1_epi8(-16)), bytes);
+                counts.code_points += set_lanes(_mm_movemask_epi8(leads));
+                counts.four_byte += set_lanes(_mm_movemask_epi8(four_byte));
+            }
+            return count_utf8_tail(text + i, size - i, counts);
+        }
+
+        DETRI_TARGET_SSE41 std::size_t sse41_widen_ascii16(const char* const text, const std::size_t size,
+                                                           char16_t* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const __m128i bytes = sse41_load(text + i);
+                sse41_store(out + i, _mm_cvtepu8_epi16(bytes));
+                sse41_store(out + i + 8, _mm_cvtepu8_epi16(_mm_srli_si128(bytes, 8)));
+                if (const int non_ascii = _mm_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return widen_ascii_tail(text, size, out, i);
+        }
+
+        DETRI_TARGET_SSE41 std::size_t sse41_widen_ascii32(const char* const text, const std::size_t size,
+                                                           char32_t* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const __m128i bytes = sse41_load(text + i);
+                sse41_store(out + i, _mm_cvtepu8_epi32(bytes));
+                sse41_store(out + i + 4, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)));
+                sse41_store(out + i + 8, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+                sse41_store(out + i + 12, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12)));
+                if (const int non_ascii = _mm_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return widen_ascii_tail(text, size, out, i);
+        }
+
+        // Clamped to 0xFF before the signed pack, every unit past ASCII packs to a byte with the top bit set.
+        DETRI_TARGET_SSE41 std::size_t sse41_narrow_ascii16(const char16_t* const text, const std::size_t size,
+                                                            char* const out) noexcept
+        {
+            const __m128i clamp = _mm_set1_epi16(0xFF);
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const __m128i low = _mm_min_epu16(sse41_load(text + i), clamp);
+                const __m128i high = _mm_min_epu16(sse41_load(text + i + 8), clamp);
+                const __m128i bytes = _mm_packus_epi16(low, high);
+                sse41_store(out + i, bytes);
+                if (const int non_ascii = _mm_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return narrow_ascii_tail(text, size, out, i);
+        }
+
+        DETRI_TARGET_SSE41 std::size_t sse41_narrow_ascii32(const char32_t* const text, const std::size_t size,
+                                                            char* const out) noexcept
+        {
+            const __m128i clamp = _mm_set1_epi32(0xFF);
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const __m128i a = _mm_min_epu32(sse41_load(text + i), clamp);
+                const __m128i b = _mm_min_epu32(sse41_load(text + i + 4), clamp);
+                const __m128i c = _mm_min_epu32(sse41_load(text + i + 8), clamp);
+                const __m128i d = _mm_min_epu32(sse41_load(text + i + 12), clamp);
+                const __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_packus_epi32(c, d));
+                sse41_store(out + i, bytes);
+                if (const int non_ascii = _mm_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return narrow_ascii_tail(text, size, out, i);
+        }
+
+        DETRI_TARGET_SSE41 std::size_t sse41_find_surrogate(const char16_t* const text, const std::size_t size) noexcept
+        {
+            const __m128i mask = _mm_set1_epi16(static_cast<short>(0xF800));
+            const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+            std::size_t i = 0;
+            for (; size - i >= 16; i += 16)
+            {
+                const __m128i low = _mm_cmpeq_epi16(_mm_and_si128(sse41_load(text + i), mask), surrogate);
+                const __m128i high = _mm_cmpeq_epi16(_mm_and_si128(sse41_load(text + i + 8), mask), surrogate);
+                if (const int found = _mm_movemask_epi8(_mm_packs_epi16(low, high)); found != 0)
+                {
+                    return i + first_lane(found);
+                }
+            }
+            return find_surrogate_tail(text, size, i);
+        }
+
+        constexpr unicode_kernels sse41_kernels {
+            .name = "sse4.1",
+            .validate_utf8 = sse41_validate_utf8,
+            .count_utf8 = sse41_count_utf8,
+            .widen_ascii16 = sse41_widen_ascii16,
+            .widen_ascii32 = sse41_widen_ascii32,
+            .narrow_ascii16 = sse41_narrow_ascii16,
+            .narrow_ascii32 = sse41_narrow_ascii32,
+            .find_surrogate = sse41_find_surrogate,
+        };
+
+        // AVX2, 32 bytes a block.
+
+        DETRI_TARGET_AVX2 __m256i avx2_load(const void* const source) noexcept
+        {
+            return _mm256_loadu_si256(static_cast<const __m256i*>(source));
+        }
+
+        DETRI_TARGET_AVX2 void avx2_store(void* const target, const __m256i value) noexcept
+        {
+            _mm256_storeu_si256(static_cast<__m256i*>(target), value);
+        }
+
+        DETRI_TARGET_AVX2 __m256i avx2_table(const std::array<std::uint8_t, 16>& table) noexcept
+        {
+            return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data())));
+        }
+
+        DETRI_TARGET_AVX2 __m256i avx2_high_nibbles(const __m256i bytes) noexcept
+        {
+            return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+        }
+
+        struct avx2_utf8_state
+        {
+            __m256i previous;
+            __m256i incomplete;
+            __m256i error;
+        };
+
+        DETRI_TARGET_AVX2 void avx2_check_utf8(const __m256i input, avx2_utf8_state& state) noexcept
+        {
+            if (_mm256_movemask_epi8(input) == 0)
+            {
+                state.error = _mm256_or_si256(state.error, state.incomplete);
+                state.previous = input;
+                return;
+            }
+
+            // alignr works within 128-bit lanes, so first line up the previous block's high lane with this one's low.
+            const __m256i straddle = _mm256_permute2x128_si256(state.previous, input, 0x21);
+            const __m256i previous_1 = _mm256_alignr_epi8(input, straddle, 15);
+            const __m256i byte_1_high = _mm256_shuffle_epi8(avx2_table(utf8_lookup::byte_1_high),
+                                                            avx2_high_nibbles(previous_1));
+            const __m256i byte_1_low = _mm256_shuffle_epi8(avx2_table(utf8_lookup::byte_1_low),
+                                                           _mm256_and_si256(previous_1, _mm256_set1_epi8(0x0F)));
+            const __m256i byte_2_high = _mm256_shuffle_epi8(avx2_table(utf8_lookup::byte_2_high),
+                                                            avx2_high_nibbles(input));
+            const __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+            const __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(input, straddle, 14),
+                                                   _mm256_set1_epi8(0xE0 - 0x80));
+            const __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(input, straddle, 13),
+                                                    _mm256_set1_epi8(0xF0 - 0x80));
+            const __m256i continuation_due = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(-0x80));
+
+            state.error = _mm256_or_si256(state.error, _mm256_xor_si256(continuation_due, special));
+            state.incomplete = _mm256_subs_epu8(input, avx2_load(utf8_lookup::incomplete_limit.data()));
+            state.previous = input;
+        }
+
+        DETRI_TARGET_AVX2 bool avx2_validate_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            avx2_utf8_state state {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+            std::size_t i = 0;
+            for (; size - i >= 32; i += 32)
+            {
+                avx2_check_utf8(avx2_load(text + i), state);
+            }
+            if (i < size)
+            {
+                alignas(32) char tail[32] {};
+                std::memcpy(tail, text + i, size - i);
+                avx2_check_utf8(avx2_load(tail), state);
+            }
+            const __m256i error = _mm256_or_si256(state.error, state.incomplete);
+            return _mm256_testz_si256(error, error) != 0;
+        }
+
+        DETRI_TARGET_AVX2 utf8_counts avx2_count_utf8(const char* const text, const std::size_t size) noexcept
+        {
+            utf8_counts counts;
+            std::size_t i = 0;
+            for (; size - i >= 32; i += 32)
+            {
+                const __m256i bytes = avx2_load(text + i);
+                const __m256i leads = _mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(-65));
+                const __m256i four_byte = _mm256_cmpeq_epi8(_mm256_max_epu8(bytes, _mm256_set1_epi8(-16)), bytes);
+                counts.code_points += set_lanes(_mm256_movemask_epi8(leads));
+                counts.four_byte += set_lanes(_mm256_movemask_epi8(four_byte));
+            }
+            return count_utf8_tail(text + i, size - i, counts);
+        }
+
+        DETRI_TARGET_AVX2 std::size_t avx2_widen_ascii16(const char* const text, const std::size_t size,
+                                                         char16_t* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 32; i += 32)
+            {
+                const __m256i bytes = avx2_load(text + i);
+                avx2_store(out + i, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+                avx2_store(out + i + 16, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+                if (const int non_ascii = _mm256_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return widen_ascii_tail(text, size, out, i);
+        }
+
+        DETRI_TARGET_AVX2 std::size_t avx2_widen_ascii32(const char* const text, const std::size_t size,
+                                                         char32_t* const out) noexcept
+        {
+            std::size_t i = 0;
+            for (; size - i >= 32; i += 32)
+            {
+                const __m256i bytes = avx2_load(text + i);
+                const __m128i low = _mm256_castsi256_si128(bytes);
+                const __m128i high = _mm256_extracti128_si256(bytes, 1);
+                avx2_store(out + i, _mm256_cvtepu8_epi32(low));
+                avx2_store(out + i + 8, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+                avx2_store(out + i + 16, _mm256_cvtepu8_epi32(high));
+                avx2_store(out + i + 24, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+                if (const int non_ascii = _mm256_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return widen_ascii_tail(text, size, out, i);
+        }
+
+        DETRI_TARGET_AVX2 std::size_t avx2_narrow_ascii16(const char16_t* const text, const std::size_t size,
+                                                          char* const out) noexcept
+        {
+            const __m256i clamp = _mm256_set1_epi16(0xFF);
+            std::size_t i = 0;
+            for (; size - i >= 32; i += 32)
+            {
+                const __m256i low = _mm256_min_epu16(avx2_load(text + i), clamp);
+                const __m256i high = _mm256_min_epu16(avx2_load(text + i + 16), clamp);
+                // packus interleaves the lanes of its operands; put the quarters back in order.
+                const __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+                avx2_store(out + i, bytes);
+                if (const int non_ascii = _mm256_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return narrow_ascii_tail(text, size, out, i);
+        }
+
+        DETRI_TARGET_AVX2 std::size_t avx2_narrow_ascii32(const char32_t* const text, const std::size_t size,
+                                                          char* const out) noexcept
+        {
+            const __m256i clamp = _mm256_set1_epi32(0xFF);
+            std::size_t i = 0;
+            for (; size - i >= 32; i += 32)
+            {
+                const __m256i a = _mm256_min_epu32(avx2_load(text + i), clamp);
+                const __m256i b = _mm256_min_epu32(avx2_load(text + i + 8), clamp);
+                const __m256i c = _mm256_min_epu32(avx2_load(text + i + 16), clamp);
+                const __m256i d = _mm256_min_epu32(avx2_load(text + i + 24), clamp);
+                // Two lane-wise packs leave four-byte groups in the order a0 b0 c0 d0 a1 b1 c1 d1.
+                const __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(a, b), _mm256_packus_epi32(c, d));
+                const __m256i bytes = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+                avx2_store(out + i, bytes);
+                if (const int non_ascii = _mm256_movemask_epi8(bytes); non_ascii != 0)
+                {
+                    return i + first_lane(non_ascii);
+                }
+            }
+            return narrow_ascii_tail(text, size, out, i);
+        }
+
+        DETRI_TARGET_AVX2 std::size_t avx2_find_surrogate(const char16_t* const text, const std::size_t size) noexcept
+        {
+            const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xF800));
+            const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+            std::size_t i = 0;
+            for (; size - i >= 32; i += 32)
+            {
+                const __m256i low = _mm256_cmpeq_epi16(_mm256_and_si256(avx2_load(text + i), mask), surrogate);
+                const __m256i high = _mm256_cmpeq_epi16(_mm256_and_si256(avx2_load(text + i + 16), mask), surrogate);
+                const __m256i found = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+                if (const int lanes = _mm256_movemask_epi8(found); lanes != 0)
+                {
+                    return i + first_lane(lanes);
+                }
+            }
+            return find_surrogate_tail(text, size, i);
+        }
+
+        constexpr unicode_kernels avx2_kernels {
+            .name = "avx2",
+            .validate_utf8 = avx2_validate_utf8,
+            .count_utf8 = avx2_count_utf8,
+            .widen_ascii16 = avx2_widen_ascii16,
+            .widen_ascii32 = avx2_widen_ascii32,
+            .narrow_ascii16 = avx2_narrow_ascii16,
+            .narrow_ascii32 = avx2_narrow_ascii32,
+            .find_surrogate = avx2_find_surrogate,
+        };
+    } // namespace
+
+    const unicode_kernels* sse41_unicode_kernels() noexcept
+    {
+        return cpu_has_sse41() ? &sse41_kernels : nullptr;
+    }
+
+    const unicode_kernels* avx2_unicode_kernels() noexcept
+    {
+        return cpu_has_avx2() ? &avx2_kernels : nullptr;
+    }
+}
+
+#endif
@@ -1,17 +1,108 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 
+#include "detri/display.hpp"
+#include "detri/event_queue.hpp"
+#include "detri/input_recording.hpp"
+#include "detri/keyboard_state.hpp"
 #include "detri/platform_event.hpp"
 #include "detri/platform.hpp"
 
+#ifdef DETRI_PLATFORM_XCB
+struct xcb_connection_t;
+#endif
+
+#ifdef DETRI_PLATFORM_WAYLAND
+struct wl_display;
+struct wl_surface;
+#endif
+
 namespace detri
 {
+#ifdef DETRI_PLATFORM_WIN32
+    // Returns nonzero to consume the message, the convention ImGui_ImplWin32_WndProcHandler follows.
     using native_message_hook = LRESULT(CALLBACK*)(HWND, UINT, WPARAM, LPARAM);
 
+    // Which window messages a hook is called for: one bit per system message below WM_USER, and one flag covering
+    // everything from WM_USER up (private, WM_APP and registered messages). Default-constructed it matches nothing.
+    struct message_filter
+    {
+        std::array<std::uint64_t, WM_USER / 64> system {};
+        bool user {};
+
+        [[nodiscard]] static constexpr message_filter all() noexcept
+        {
+            message_filter filter;
+            filter.system.fill(~std::uint64_t{0});
+            filter.user = true;
+            return filter;
+        }
+
+        [[nodiscard]] static constexpr message_filter of(const std::initializer_list<UINT> messages) noexcept
+        {
+            message_filter filter;
+            for (const UINT message : messages)
+            {
+                filter.add(message);
+            }
+            return filter;
+        }
+
+        constexpr message_filter& add(const UINT message) noexcept
+        {
+            if (message < WM_USER)
+            {
+                system[message / 64] |= std::uint64_t{1} << (message % 64);
+            }
+            else
+            {
+                user = true;
+            }
+            return *this;
+        }
+
+        // Both ends included, e.g. add_range(WM_MOUSEFIRST, WM_MOUSELAST).
+        constexpr message_filter& add_range(const UINT first, const UINT last) noexcept
+        {
+            for (UINT message = first; message <= last && message < WM_USER; ++message)
+            {
+                add(message);
+            }
+            user = user || last >= WM_USER;
+            return *this;
+        }
+
+        [[nodiscard]] constexpr bool contains(const UINT message) const noexcept
+        {
+            return message < WM_USER ? (system[message / 64] >> (message % 64) & 1) != 0 : user;
+        }
+    };
+
+    using message_hook_id = std::uint64_t;
+
+    // Appends hook to the chain every window procedure runs ahead of its own handling, on whichever thread pumps the
+    // window. It is only called for messages in filter, and a message no hook's filter contains skips the chain for
+    // the price of one bit test. The first hook to return nonzero consumes the message: later hooks and the window
+    // never see it, and the window procedure returns that value. Safe from any thread, including from inside a hook,
+    // and never blocks a pump.
+    message_hook_id add_message_hook(native_message_hook hook, const message_filter& filter = message_filter::all());
+
+    // Takes a hook out of the chain. Once this returns the hook is not running on any other thread and will not be
+    // called again, so whatever it uses may go; a call further up the calling thread's own stack still finishes.
+    // Waits for in-flight calls on other threads, so do not call it while holding something those hooks wait for,
+    // and do not call it from inside a hook while a hook on another pump thread may be removing too: each would wait
+    // for the other to leave. Unknown ids are ignored.
+    void remove_message_hook(message_hook_id id);
+#endif
+
     enum class cursor_mode
     {
         normal, captured_hidden
@@ -23,10 +114,26 @@ namespace detri
         uint32_t height {};
     };
 
+    struct window_options
+    {
+        // Number of events the window can hold between polls. Rounded up to a power of two and allocated once.
+        std::uint32_t event_capacity {1024};
+        event_overflow_policy overflow_policy {event_overflow_policy::drop_oldest};
+        // Start with event coalescing enabled; see window::set_event_coalescing().
+        bool coalesce_events {false};
+        // Create the window on a dedicated thread that runs its message loop and publishes events as they arrive, so
+        // modal size/move loops and slow frames no longer stall either side. pump_messages() becomes a no-op and
+        // poll_event()/drain_events() only read the queue. Win32 only; xcb and Wayland never block inside the OS pump
+        // and ignore it, and headless imitates it so code that mixes threaded and inline windows can be tested.
+        bool threaded_pump {false};
+    };
+
     class window
     {
     public:
-        static window create(const std::string& title, uint32_t width, uint32_t height);
+        // title is UTF-8. Unless it is unusually long it is converted for the OS on the stack; the window itself takes
+        // one allocation besides its event ring.
+        static window create(std::string_view title, uint32_t width, uint32_t height, const window_options& options = {});
 
         window() = delete;
 
@@ -42,19 +149,104 @@ namespace detri
 
         void show() const noexcept;
 
+        // title is UTF-8. Titles shorter than native_string::inline_capacity are converted on the stack, so retitling
+        // every frame does not touch the heap.
+        void set_title(std::string_view title) const;
+
         void pump_messages();
 
+        // Pumps the OS queue and, if nothing is ready to poll, sleeps on it until input arrives or timeout passes, then
+        // pumps again. Returns whether poll_event() has something. An idle loop waiting with a long timeout uses no CPU;
+        // a paced one can wait up to frame_pacer::next_frame(). An attached replay ends the wait when its next event
+        // falls due, and platform_clock::duration::max() waits for input indefinitely. A closed window does not wait.
+        bool wait_for_events_or_timeout(const platform_clock::duration timeout)
+        {
+            return wait_any({}, timeout).has_value();
+        }
+
+        // wait_for_events_or_timeout(), then the oldest event. Nothing if timeout passed first.
+        std::optional<event> wait_event(const platform_clock::duration timeout)
+        {
+            return wait_any({}, timeout).has_value() ? poll_event() : std::nullopt;
+        }
+
+        // Waits until the window has something to poll, one of handles is signaled (Windows) or readable (Linux), or
+        // timeout passes, so one thread can sleep on its window, async_io::wait_handle() and its own descriptors at
+        // once. Returns the index of the first ready handle, handles.size() if the window is ready, or nothing on
+        // timeout. Windows takes up to 62 handles.
+        std::optional<std::size_t> wait_any(std::span<const native_wait_handle> handles, platform_clock::duration timeout);
+
+        // For callers with their own epoll/WaitForMultipleObjects loop: readable or signaled when OS input for the
+        // window arrives. Only input not yet pumped counts, so poll_event() until it comes back empty before waiting.
+        // This is the display connection on xcb and Wayland, shared by every window, and an event set by the pump
+        // thread of a threaded Win32 window. An inline Win32 window's input lands on the calling thread's message
+        // queue, which has no handle; there, and on headless, this is invalid_wait_handle and wait_any() or
+        // MsgWaitForMultipleObjectsEx take its place.
+        [[nodiscard]] native_wait_handle wait_handle() const noexcept;
+
         std::optional<event> poll_event();
 
+        // Pumps the OS queue once, then copies as many queued events as fit into out, oldest first. Returns the
+        // number written. Call again with the remaining capacity if it came back full.
+        std::size_t drain_events(std::span<event> out);
+
+        // Pumps the OS queue once and invokes callback for every event queued at that point, oldest first.
+        template <typename Callback>
+        void for_each_event(Callback&& callback)
+        {
+            std::array<event, 64> batch;
+            std::size_t count = drain_events(batch);
+            while (count != 0)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    callback(batch[i]);
+                }
+                count = count == batch.size() ? drain_queued(batch) : 0;
+            }
+        }
+
         [[nodiscard]] window_size size() const noexcept;
 
+        // Pixels per unit of size() to render the window's content at; dpi_changed_event announces changes. On Wayland
+        // size() is in surface units, so a swapchain needs size() * scale() pixels and a matching
+        // wl_surface_set_buffer_scale(); elsewhere size() already is in pixels and scale() says how much to enlarge UI.
+        [[nodiscard]] float scale() const noexcept;
+
+        // The display the window is mostly on. Throws except::window_error if the window is invalid or the window
+        // system cannot be reached.
+        [[nodiscard]] display_info display() const;
+
+        // Key state as of the events handed out so far, updated as poll_event()/drain_events() return them. Keys held
+        // when a focus_lost_event comes out read as released from then on. Copy it for a snapshot; the reference is
+        // only valid on the thread that polls.
+        [[nodiscard]] const keyboard_state& keyboard() const noexcept;
+
+        // Copies every event poll_event()/drain_events() hand out into recorder, until called again with nullptr. The
+        // recorder must outlive the attachment.
+        void record_input(input_recorder* recorder) noexcept;
+
+        // Hands out the events in replayer through poll_event()/drain_events() ahead of live ones, until called again
+        // with nullptr. Live input keeps flowing behind it so the window can still be closed. The replayer must
+        // outlive the attachment.
+        void replay_input(input_replayer* replayer) noexcept;
+
+        // How many events were dropped because the queue was full, and how many were merged by coalescing.
+        [[nodiscard]] event_queue_stats event_stats() const noexcept;
+
+        // Collapses consecutive mouse_move_event and resize_event entries into the latest value and sums consecutive
+        // mouse_delta_event entries, so a drag or live resize costs one event per pump instead of hundreds.
+        void set_event_coalescing(bool enabled) const noexcept;
+
+        [[nodiscard]] bool event_coalescing() const noexcept;
+
         void set_cursor_mode(cursor_mode mode) const;
 
         [[nodiscard]] cursor_mode get_cursor_mode() const noexcept;
 
         [[nodiscard]] void* native_handle() const noexcept;
 
-#ifdef _WIN32
+#ifdef DETRI_PLATFORM_WIN32
         struct native_win32_handle
         {
             HWND hwnd;
@@ -63,9 +255,59 @@ namespace detri
         [[nodiscard]] native_win32_handle native_win32() const noexcept;
 #endif
 
+#ifdef DETRI_PLATFORM_XCB
+        struct native_xcb_handle
+        {
+            xcb_connection_t* connection;
+            std::uint32_t window;
+        };
+        [[nodiscard]] native_xcb_handle native_xcb() const noexcept;
+#endif
+
+#ifdef DETRI_PLATFORM_WAYLAND
+        struct native_wayland_handle
+        {
+            wl_display* display;
+            wl_surface* surface;
+        };
+        [[nodiscard]] native_wayland_handle native_wayland() const noexcept;
+#endif
+
+#ifdef DETRI_PLATFORM_HEADLESS
+        // What create() or set_title() last set.
+        [[nodiscard]] std::string_view title() const noexcept;
+
+        // Queues an event as if the OS had delivered it. Events come back out of poll_event() in FIFO order. An event
+        // without a timestamp is stamped with platform_clock::now(); a stamped one (e.g. a replay) keeps its own.
+        void inject_event(const event& value);
+
+        // Changes the client size and queues the matching resize_event.
+        void inject_resize(window_size value);
+
+        // Changes the scale and queues the matching dpi_changed_event, as moving to another display would.
+        void inject_scale(float value);
+
+        // Feeds one relative motion packet through the same path native raw input takes: it becomes a
+        // mouse_delta_event only while the cursor is captured_hidden, and is discarded otherwise.
+        void inject_raw_motion(std::int32_t dx, std::int32_t dy);
+#endif
+
     private:
+        friend class window_system;
+
         struct impl;
 
+        // drain_events() without the pump.
+        std::size_t drain_queued(std::span<event> out);
+
+        // What pump_messages() still has to do for this window once another window has pumped the OS queue they share:
+        // publish events held back for coalescing and act on a requested close.
+        void flush_events();
+
+        // Whether the window has a pump thread of its own (a threaded_pump Win32 window), so pumping it does not pump
+        // the OS queue the calling thread's other windows share.
+        [[nodiscard]] bool pumps_on_own_thread() const noexcept;
+
         explicit window(std::unique_ptr<impl>&& impl) noexcept;
 
         std::unique_ptr<impl> m_impl;
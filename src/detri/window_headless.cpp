@@ -0,0 +1,513 @@
+#include "detri/window.hpp"
+#include "detri/event_consumer.hpp"
+#include "detri/high_resolution_timer.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/thread_counters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace detri
+{
+    namespace
+    {
+        struct window_state
+        {
+            explicit window_state(const window_options& options)
+                : events(options.event_capacity, options.overflow_policy)
+                , threaded(options.threaded_pump)
+            {
+                events.set_coalescing(options.coalesce_events);
+            }
+
+            std::string title;
+            window_size client{};
+            float scale{1.0f};
+            bool is_open{true};
+            bool visible{false};
+            bool close_requested{false};
+            cursor_mode cursor{cursor_mode::normal};
+            event_queue events;
+            // Imitates a threaded Win32 window: it has a pump of its own, so its events are published as they are
+            // injected and pump_messages() does nothing for it.
+            bool threaded{false};
+            // Where request_close() posted the close, and the next window in g_posted_closes. Guarded by
+            // g_posted_closes_lock.
+            std::thread::id posted_by;
+            window_state* next_posted{};
+            // Only touched by the thread that consumes events.
+            event_consumer consumer;
+            high_resolution_timer wait_timer;
+        };
+
+        // Stands in for the message queue each thread's inline windows share: request_close() posts to its thread's
+        // and whichever of them pumps next dispatches every close on it, as PostMessageW(WM_CLOSE) and one PeekMessageW
+        // loop do. One list for every thread, so a window moved to another thread and destroyed there still unlinks
+        // itself; the count lets a pump with nothing posted skip the lock.
+        std::mutex g_posted_closes_lock;
+        window_state* g_posted_closes {nullptr};
+        std::atomic<std::size_t> g_posted_close_count {0};
+
+        void post_close(window_state& state)
+        {
+            const std::scoped_lock lock{g_posted_closes_lock};
+            state.close_requested = true;
+            state.posted_by = std::this_thread::get_id();
+            state.next_posted = g_posted_closes;
+            g_posted_closes = &state;
+            g_posted_close_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void unlink_posted_close(window_state& state)
+        {
+            if (g_posted_close_count.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+
+            const std::scoped_lock lock{g_posted_closes_lock};
+            for (window_state** link = &g_posted_closes; *link != nullptr; link = &(*link)->next_posted)
+            {
+                if (*link == &state)
+                {
+                    *link = state.next_posted;
+                    state.next_posted = nullptr;
+                    g_posted_close_count.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        void dispatch_posted_closes()
+        {
+            if (g_posted_close_count.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+
+            const std::scoped_lock lock{g_posted_closes_lock};
+            const auto self = std::this_thread::get_id();
+            for (window_state** link = &g_posted_closes; *link != nullptr;)
+            {
+                auto& state = **link;
+                if (state.posted_by != self)
+                {
+                    link = &state.next_posted;
+                    continue;
+                }
+                *link = state.next_posted;
+                state.next_posted = nullptr;
+                g_posted_close_count.fetch_sub(1, std::memory_order_relaxed);
+                state.close_requested = false;
+                state.is_open = false;
+                state.events.push(close_event{.timestamp = platform_clock::now()});
+            }
+        }
+
+        // Stands in for a monitor so code that sizes and paces itself by the display runs unchanged in tests.
+        display_info headless_display(const float scale)
+        {
+            return {
+                .id = 1,
+                .name = "Headless",
+                .width = 1920,
+                .height = 1080,
+                .refresh_rate = 60.0,
+                .scale = scale,
+                .primary = true
+            };
+        }
+    } // namespace
+
+    std::vector<display_info> enumerate_displays()
+    {
+        return {headless_display(1.0f)};
+    }
+
+    // The state lives inside impl, so a window takes one allocation besides its event ring.
+    struct window::impl
+    {
+        explicit impl(const window_options& options)
+            : state(options)
+        {
+        }
+
+        window_state state;
+    };
+
+    window::window(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    window window::create(const std::string_view title, const std::uint32_t width, const std::uint32_t height,
+                          const window_options& options)
+    {
+        if (width == 0 || height == 0)
+        {
+            throw except::window_error{"Window dimensions must be greater than zero."};
+        }
+
+        auto impl = std::make_unique<window::impl>(options);
+        impl->state.title = title;
+        impl->state.client = {
+            .width = width,
+            .height = height
+        };
+
+        return window{std::move(impl)};
+    }
+
+    window::~window()
+    {
+        if (m_impl != nullptr)
+        {
+            unlink_posted_close(m_impl->state);
+        }
+    }
+
+    window::window(window&&) noexcept = default;
+
+    window& window::operator=(window&& other) noexcept
+    {
+        if (this != &other)
+        {
+            window discarded{std::move(m_impl)};
+            m_impl = std::move(other.m_impl);
+        }
+        return *this;
+    }
+
+    bool window::is_open() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.is_open;
+    }
+
+    void window::request_close() const noexcept
+    {
+        // Mirrors PostMessageW(WM_CLOSE): the close is only observed on the next pump, or at once by a threaded window's
+        // own pump.
+        if (m_impl == nullptr || !m_impl->state.is_open || m_impl->state.close_requested)
+        {
+            return;
+        }
+
+        auto& state = m_impl->state;
+        if (state.threaded)
+        {
+            state.is_open = false;
+            state.events.push(close_event{.timestamp = platform_clock::now()});
+            state.events.flush();
+            return;
+        }
+        post_close(state);
+    }
+
+    void window::show() const noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.visible = true;
+        }
+    }
+
+    void window::set_title(const std::string_view title) const
+    {
+        if (m_impl == nullptr || !m_impl->state.is_open)
+        {
+            throw except::window_error{"Cannot set the title of an invalid window."};
+        }
+
+        // Reuses the string's capacity, as a native window reuses its title buffer.
+        m_impl->state.title.assign(title);
+    }
+
+    std::string_view window::title() const noexcept
+    {
+        return m_impl == nullptr ? std::string_view{} : std::string_view{m_impl->state.title};
+    }
+
+    void window::pump_messages()
+    {
+        if (m_impl != nullptr && m_impl->state.threaded)
+        {
+            return;
+        }
+
+        const section_timer pump_timer{timed_section::pump};
+        dispatch_posted_closes();
+        if (m_impl != nullptr)
+        {
+            m_impl->state.events.flush();
+        }
+    }
+
+    void window::flush_events()
+    {
+        if (m_impl != nullptr && !m_impl->state.threaded)
+        {
+            m_impl->state.events.flush();
+        }
+    }
+
+    bool window::pumps_on_own_thread() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.threaded;
+    }
+
+    std::optional<std::size_t> window::wait_any(const std::span<const native_wait_handle> handles,
+                                                const platform_clock::duration timeout)
+    {
+        const auto deadline = deadline_after(timeout);
+        pump_messages();
+        if (m_impl == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        auto& state = m_impl->state;
+        const auto ready_at = state.consumer.ready_at(state.events);
+        if (ready_at <= platform_clock::now())
+        {
+            return handles.size();
+        }
+
+        // Only the calling thread injects events, so nothing can reach the window while it sleeps: wait for the
+        // handles or until a replayed event falls due, but never indefinitely on the window alone.
+        const auto until = std::min(deadline, ready_at);
+        if (!handles.empty())
+        {
+#ifdef _WIN32
+            const auto ready = wait_objects(handles, until, state.wait_timer, false);
+#else
+            const auto ready = wait_readable(handles, until);
+#endif
+            if (ready.has_value())
+            {
+                return ready;
+            }
+        }
+        else if (until != platform_clock::time_point::max() && state.is_open)
+        {
+            state.wait_timer.sleep_until(until);
+        }
+
+        pump_messages();
+        return state.consumer.ready_at(state.events) <= platform_clock::now() ? std::optional{handles.size()} : std::nullopt;
+    }
+
+    native_wait_handle window::wait_handle() const noexcept
+    {
+        return invalid_wait_handle;
+    }
+
+    std::optional<event> window::poll_event()
+    {
+        pump_messages();
+        if (m_impl == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        return m_impl->state.consumer.poll(m_impl->state.events);
+    }
+
+    std::size_t window::drain_events(const std::span<event> out)
+    {
+        pump_messages();
+        return drain_queued(out);
+    }
+
+    std::size_t window::drain_queued(const std::span<event> out)
+    {
+        if (m_impl == nullptr)
+        {
+            return 0;
+        }
+
+        return m_impl->state.consumer.drain(m_impl->state.events, out);
+    }
+
+    window_size window::size() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return m_impl->state.client;
+    }
+
+    float window::scale() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return 1.0f;
+        }
+
+        return m_impl->state.scale;
+    }
+
+    display_info window::display() const
+    {
+        if (m_impl == nullptr)
+        {
+            throw except::window_error{"Cannot query the display of an invalid window."};
+        }
+
+        return headless_display(m_impl->state.scale);
+    }
+
+    const keyboard_state& window::keyboard() const noexcept
+    {
+        static const keyboard_state released{};
+        if (m_impl == nullptr)
+        {
+            return released;
+        }
+
+        return m_impl->state.consumer.keyboard;
+    }
+
+    void window::record_input(input_recorder* recorder) noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.consumer.recorder = recorder;
+        }
+    }
+
+    void window::replay_input(input_replayer* replayer) noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.consumer.replayer = replayer;
+        }
+    }
+
+    event_queue_stats window::event_stats() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return m_impl->state.events.stats();
+    }
+
+    void window::set_event_coalescing(const bool enabled) const noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.events.set_coalescing(enabled);
+        }
+    }
+
+    bool window::event_coalescing() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.events.coalescing();
+    }
+
+    void window::set_cursor_mode(const cursor_mode mode) const
+    {
+        if (m_impl == nullptr || !m_impl->state.is_open)
+        {
+            throw except::window_error{"Cannot set cursor mode on an invalid window."};
+        }
+
+        m_impl->state.cursor = mode;
+    }
+
+    cursor_mode window::get_cursor_mode() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return cursor_mode::normal;
+        }
+        return m_impl->state.cursor;
+    }
+
+    void* window::native_handle() const noexcept
+    {
+        // There is no OS object behind a headless window.
+        return nullptr;
+    }
+
+    void window::inject_event(const event& value)
+    {
+        if (m_impl == nullptr)
+        {
+            throw except::window_error{"Cannot inject events into an invalid window."};
+        }
+
+        if (std::holds_alternative<close_event>(value))
+        {
+            m_impl->state.is_open = false;
+        }
+        else if (const auto* resize = std::get_if<resize_event>(&value))
+        {
+            m_impl->state.client = {
+                .width = resize->width,
+                .height = resize->height
+            };
+        }
+        else if (const auto* dpi = std::get_if<dpi_changed_event>(&value))
+        {
+            m_impl->state.scale = dpi->scale;
+        }
+
+        if (event_timestamp(value) == platform_clock::time_point{})
+        {
+            event stamped = value;
+            set_event_timestamp(stamped, platform_clock::now());
+            m_impl->state.events.push(stamped);
+        }
+        else
+        {
+            m_impl->state.events.push(value);
+        }
+
+        if (m_impl->state.threaded)
+        {
+            m_impl->state.events.flush();
+        }
+    }
+
+    void window::inject_resize(const window_size value)
+    {
+        inject_event(resize_event{
+            .width = value.width,
+            .height = value.height
+        });
+    }
+
+    void window::inject_scale(const float value)
+    {
+        inject_event(dpi_changed_event{.scale = value});
+    }
+
+    void window::inject_raw_motion(const std::int32_t dx, const std::int32_t dy)
+    {
+        if (m_impl == nullptr)
+        {
+            throw except::window_error{"Cannot inject events into an invalid window."};
+        }
+        if (m_impl->state.cursor != cursor_mode::captured_hidden || (dx == 0 && dy == 0))
+        {
+            return;
+        }
+
+        m_impl->state.events.push(mouse_delta_event{
+            .dx = dx,
+            .dy = dy,
+            .timestamp = platform_clock::now()
+        });
+        if (m_impl->state.threaded)
+        {
+            m_impl->state.events.flush();
+        }
+    }
+} // namespace detri
@@ -0,0 +1,203 @@
+#include "detri/window_system.hpp"
+#include "detri/platform_exceptions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <vector>
+
+namespace detri
+{
+    namespace
+    {
+        // One window's share of a pump: [first, last) in the staging buffer.
+        struct event_run
+        {
+            std::size_t first {};
+            std::size_t last {};
+        };
+    } // namespace
+
+    struct window_system::impl
+    {
+        // A deque keeps every window at a fixed address as more are created, so references from get() stay valid.
+        // Slot i holds window_id i + 1; destroyed slots stay empty so ids are never reused.
+        std::deque<std::optional<window>> windows;
+        std::size_t live {};
+
+        // Events from earlier pumps that have not been handed out yet start at merged[next]. Both buffers keep their
+        // capacity, so a steady frame loop stops allocating after the first few pumps.
+        std::vector<window_event> merged;
+        std::size_t next {};
+        std::vector<window_event> staging;
+        std::vector<event_run> runs;
+        std::array<event, 64> batch;
+
+        window* find(const window_id id) noexcept
+        {
+            const auto index = static_cast<std::size_t>(id) - 1;
+            return index < windows.size() && windows[index].has_value() ? &*windows[index] : nullptr;
+        }
+
+        void collect(window& source, const window_id id)
+        {
+            const std::size_t first = staging.size();
+            std::size_t count = 0;
+            do
+            {
+                count = source.drain_queued(batch);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    staging.push_back({.window = id, .value = batch[i]});
+                }
+            }
+            while (count == batch.size());
+
+            if (staging.size() != first)
+            {
+                runs.push_back({.first = first, .last = staging.size()});
+            }
+        }
+
+        // A k-way merge over the windows' runs rather than a sort: each window's events keep their queue order even
+        // where its timestamps are not monotonic, as with a replay rebased behind live input.
+        void merge()
+        {
+            while (!runs.empty())
+            {
+                const auto oldest = std::min_element(runs.begin(), runs.end(), [this](const event_run& left, const event_run& right) {
+                    return event_timestamp(staging[left.first].value) < event_timestamp(staging[right.first].value);
+                });
+                merged.push_back(std::move(staging[oldest->first]));
+                if (++oldest->first == oldest->last)
+                {
+                    runs.erase(oldest);
+                }
+            }
+            staging.clear();
+        }
+    };
+
+    window_system::window_system(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    window_system window_system::create()
+    {
+        return window_system{std::make_unique<impl>()};
+    }
+
+    window_system::~window_system() = default;
+
+    window_system::window_system(window_system&&) noexcept = default;
+
+    window_system& window_system::operator=(window_system&&) noexcept = default;
+
+    window_id window_system::create_window(const std::string_view title, const std::uint32_t width,
+                                           const std::uint32_t height, const window_options& options)
+    {
+        m_impl->windows.emplace_back(window::create(title, width, height, options));
+        ++m_impl->live;
+        return static_cast<window_id>(m_impl->windows.size());
+    }
+
+    void window_system::destroy_window(const window_id id) noexcept
+    {
+        if (m_impl->find(id) == nullptr)
+        {
+            return;
+        }
+
+        m_impl->windows[static_cast<std::size_t>(id) - 1].reset();
+        --m_impl->live;
+        const auto pending = m_impl->merged.begin() + static_cast<std::ptrdiff_t>(m_impl->next);
+        m_impl->merged.erase(std::remove_if(pending, m_impl->merged.end(), [id](const window_event& value) {
+            return value.window == id;
+        }), m_impl->merged.end());
+    }
+
+    window& window_system::get(const window_id id)
+    {
+        if (window* found = m_impl->find(id))
+        {
+            return *found;
+        }
+        throw except::window_error{"No live window with id " + std::to_string(static_cast<std::uint32_t>(id)) +
+                                   " in this window system."};
+    }
+
+    bool window_system::contains(const window_id id) const noexcept
+    {
+        return m_impl->find(id) != nullptr;
+    }
+
+    std::size_t window_system::window_count() const noexcept
+    {
+        return m_impl->live;
+    }
+
+    void window_system::pump_messages()
+    {
+        auto& state = *m_impl;
+        state.merged.erase(state.merged.begin(), state.merged.begin() + static_cast<std::ptrdiff_t>(state.next));
+        state.next = 0;
+
+        // Every inline window shares the OS queue, so pumping the first dispatches for all of them; the rest only
+        // publish what that pump routed to them. A window with its own pump thread cannot stand in: pumping it leaves
+        // the shared queue alone.
+        bool pumped = false;
+        for (std::size_t i = 0; i < state.windows.size(); ++i)
+        {
+            if (!state.windows[i].has_value())
+            {
+                continue;
+            }
+            if (!pumped && !state.windows[i]->pumps_on_own_thread())
+            {
+                state.windows[i]->pump_messages();
+                pumped = true;
+            }
+            else
+            {
+                state.windows[i]->flush_events();
+            }
+        }
+
+        for (std::size_t i = 0; i < state.windows.size(); ++i)
+        {
+            if (state.windows[i].has_value())
+            {
+                state.collect(*state.windows[i], static_cast<window_id>(i + 1));
+            }
+        }
+        state.merge();
+    }
+
+    std::optional<window_event> window_system::poll_event()
+    {
+        if (m_impl->next == m_impl->merged.size())
+        {
+            pump_messages();
+        }
+        if (m_impl->next == m_impl->merged.size())
+        {
+            return std::nullopt;
+        }
+        return std::move(m_impl->merged[m_impl->next++]);
+    }
+
+    std::size_t window_system::drain_events(const std::span<window_event> out)
+    {
+        if (m_impl->next == m_impl->merged.size())
+        {
+            pump_messages();
+        }
+
+        const std::size_t count = std::min(out.size(), m_impl->merged.size() - m_impl->next);
+        const auto first = m_impl->merged.begin() + static_cast<std::ptrdiff_t>(m_impl->next);
+        std::move(first, first + static_cast<std::ptrdiff_t>(count), out.begin());
+        m_impl->next += count;
+        return count;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "detri/window.hpp"
+
+namespace detri
+{
+    // Names a window within the window_system that created it. Never reused, so a stale id finds nothing.
+    enum class window_id : std::uint32_t
+    {
+    };
+
+    struct window_event
+    {
+        window_id window {};
+        event value;
+    };
+
+    // Owns a set of windows and pumps the OS queue they share once for all of them, instead of once per window's
+    // poll_event(). Their events come out as one stream, ordered by timestamp across windows and in queue order within
+    // one. Each window's keyboard state, recorder and replayer still apply, as of the events pumped into the stream.
+    // Lives on the thread that pumps.
+    class window_system
+    {
+    public:
+        static window_system create();
+
+        window_system() = delete;
+
+        ~window_system();
+
+        window_system(window_system&&) noexcept;
+
+        window_system& operator=(window_system&&) noexcept;
+
+        // Throws except::window_error as window::create() does.
+        window_id create_window(std::string_view title, std::uint32_t width, std::uint32_t height,
+                                const window_options& options = {});
+
+        // Destroys the window. Its events still waiting in the merged stream are discarded.
+        void destroy_window(window_id id) noexcept;
+
+        // The window itself, for everything but polling. Throws except::window_error if id names no live window. The
+        // reference stays valid until the window is destroyed.
+        [[nodiscard]] window& get(window_id id);
+
+        [[nodiscard]] bool contains(window_id id) const noexcept;
+
+        [[nodiscard]] std::size_t window_count() const noexcept;
+
+        // Pumps the OS queue once and merges everything every window has queued since into the stream.
+        void pump_messages();
+
+        // The oldest event in the stream. Pumps first if everything from the last pump has been handed out.
+        std::optional<window_event> poll_event();
+
+        // Pumps if the stream is empty, then copies as many events as fit into out, oldest first. Returns the number
+        // written.
+        std::size_t drain_events(std::span<window_event> out);
+
+    private:
+        struct impl;
+
+        explicit window_system(std::unique_ptr<impl>&& impl) noexcept;
+
+        std::unique_ptr<impl> m_impl;
+    };
+}
@@ -0,0 +1,1313 @@
+#include "detri/window.hpp"
+#include "detri/event_consumer.hpp"
+#include "detri/high_resolution_timer.hpp"
+#include "detri/key_translation.hpp"
+#include "detri/native_string.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/thread_counters.hpp"
+
+#include <linux/input-event-codes.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <wayland-client.h>
+#include <wayland-cursor.h>
+#include <xkbcommon/xkbcommon.h>
+
+#include "pointer-constraints-unstable-v1-client-protocol.h"
+#include "relative-pointer-unstable-v1-client-protocol.h"
+#include "xdg-shell-client-protocol.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace detri
+{
+    namespace
+    {
+        mouse_button map_mouse_button(const std::uint32_t button) noexcept
+        {
+            switch (button)
+            {
+                case BTN_LEFT:
+                    return mouse_button::left;
+                case BTN_RIGHT:
+                    return mouse_button::right;
+                case BTN_MIDDLE:
+                    return mouse_button::middle;
+                case BTN_SIDE:
+                    return mouse_button::x1;
+                case BTN_EXTRA:
+                    return mouse_button::x2;
+                default:
+                    return mouse_button::unknown;
+            }
+        }
+
+        struct window_state
+        {
+            explicit window_state(const window_options& options)
+                : events(options.event_capacity, options.overflow_policy)
+            {
+                events.set_coalescing(options.coalesce_events);
+            }
+
+            wl_surface* surface{};
+            xdg_surface* shell_surface{};
+            xdg_toplevel* toplevel{};
+            zwp_locked_pointer_v1* locked_pointer{};
+            window_size client{};
+            window_size pending_client{};
+            // The outputs the surface is on; its scale is the largest of theirs.
+            std::vector<wl_output*> outputs;
+            float scale{1.0f};
+            std::int32_t pointer_x{};
+            std::int32_t pointer_y{};
+            double delta_remainder_x{};
+            double delta_remainder_y{};
+            bool is_open{true};
+            bool close_requested{false};
+            cursor_mode cursor{cursor_mode::normal};
+            event_queue events;
+            // Only touched by the thread that consumes events.
+            event_consumer consumer;
+        };
+
+        // Output properties arrive one event at a time and take effect together on done.
+        struct output_state
+        {
+            wl_output* output{};
+            std::uint32_t global{};
+            std::int32_t transform{};
+            std::string make_model;
+            std::string description;
+            display_info pending;
+            display_info current;
+            bool done{false};
+        };
+
+        // Every window shares one display connection and seat, mirroring how HWNDs on a thread share one Win32
+        // message queue. Input is routed to whichever surface currently holds pointer or keyboard focus.
+        struct wayland_context
+        {
+            wl_display* display{};
+            wl_registry* registry{};
+            wl_compositor* compositor{};
+            wl_shm* shm{};
+            xdg_wm_base* wm_base{};
+            wl_seat* seat{};
+            wl_pointer* pointer{};
+            wl_keyboard* keyboard{};
+            zwp_relative_pointer_manager_v1* relative_pointer_manager{};
+            zwp_pointer_constraints_v1* pointer_constraints{};
+            zwp_relative_pointer_v1* relative_pointer{};
+            wl_cursor_theme* cursor_theme{};
+            wl_surface* cursor_surface{};
+            xkb_context* xkb{};
+            xkb_keymap* keymap{};
+            std::uint32_t pointer_enter_serial{};
+            window_state* pointer_focus{};
+            window_state* keyboard_focus{};
+            window_state* captured{};
+            // Output listeners hold a pointer to their entry, so entries stay put as outputs come and go.
+            std::vector<std::unique_ptr<output_state>> outputs;
+            // Set while dispatching and acted on once at the end of the pump.
+            bool displays_changed{false};
+            std::unordered_map<wl_surface*, window_state*> windows;
+            std::uint32_t references{};
+        };
+
+        wayland_context g_context;
+
+        window_state* find_window(const wl_surface* surface) noexcept
+        {
+            const auto it = g_context.windows.find(const_cast<wl_surface*>(surface));
+            return it == g_context.windows.end() ? nullptr : it->second;
+        }
+
+        // Compositors stamp input with CLOCK_MONOTONIC, the same clock platform_clock reads. A value from any other
+        // clock, or one older than a second, is replaced by the time we dispatched the event.
+        platform_clock::time_point plausible_timestamp(const platform_clock::time_point stamped) noexcept
+        {
+            const auto now = platform_clock::now();
+            return stamped <= now && now - stamped < std::chrono::seconds{1} ? stamped : now;
+        }
+
+        // Core protocol events carry a wrapping 32-bit millisecond count.
+        platform_clock::time_point compositor_timestamp(const std::uint32_t milliseconds) noexcept
+        {
+            const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(platform_clock::now().time_since_epoch());
+            const std::uint32_t age = static_cast<std::uint32_t>(now.count()) - milliseconds;
+            return plausible_timestamp(platform_clock::time_point{now - std::chrono::milliseconds{age}});
+        }
+
+        void hide_cursor() noexcept
+        {
+            if (g_context.pointer != nullptr)
+            {
+                wl_pointer_set_cursor(g_context.pointer, g_context.pointer_enter_serial, nullptr, 0, 0);
+            }
+        }
+
+        // Wayland has no default cursor image; the client attaches one every time the pointer enters a surface.
+        void show_default_cursor() noexcept
+        {
+            if (g_context.pointer == nullptr || g_context.shm == nullptr)
+            {
+                return;
+            }
+            if (g_context.cursor_theme == nullptr)
+            {
+                g_context.cursor_theme = wl_cursor_theme_load(nullptr, 24, g_context.shm);
+                g_context.cursor_surface = wl_compositor_create_surface(g_context.compositor);
+            }
+
+            wl_cursor* cursor = g_context.cursor_theme == nullptr
+                                    ? nullptr
+                                    : wl_cursor_theme_get_cursor(g_context.cursor_theme, "left_ptr");
+            if (cursor == nullptr || cursor->image_count == 0)
+            {
+                return;
+            }
+
+            wl_cursor_image* image = cursor->images[0];
+            wl_pointer_set_cursor(g_context.pointer, g_context.pointer_enter_serial, g_context.cursor_surface,
+                                  static_cast<std::int32_t>(image->hotspot_x), static_cast<std::int32_t>(image->hotspot_y));
+            wl_surface_attach(g_context.cursor_surface, wl_cursor_image_get_buffer(image), 0, 0);
+            wl_surface_damage(g_context.cursor_surface, 0, 0, static_cast<std::int32_t>(image->width),
+                              static_cast<std::int32_t>(image->height));
+            wl_surface_commit(g_context.cursor_surface);
+        }
+
+        void pointer_enter(void*, wl_pointer*, const std::uint32_t serial, wl_surface* surface, const wl_fixed_t x,
+                           const wl_fixed_t y)
+        {
+            g_context.pointer_enter_serial = serial;
+            g_context.pointer_focus = find_window(surface);
+            if (g_context.pointer_focus == nullptr)
+            {
+                return;
+            }
+
+            g_context.pointer_focus->pointer_x = wl_fixed_to_int(x);
+            g_context.pointer_focus->pointer_y = wl_fixed_to_int(y);
+            if (g_context.pointer_focus->cursor == cursor_mode::captured_hidden)
+            {
+                hide_cursor();
+            }
+            else
+            {
+                show_default_cursor();
+            }
+        }
+
+        void pointer_leave(void*, wl_pointer*, std::uint32_t, wl_surface* surface)
+        {
+            if (g_context.pointer_focus == find_window(surface))
+            {
+                g_context.pointer_focus = nullptr;
+            }
+        }
+
+        void pointer_motion(void*, wl_pointer*, const std::uint32_t time, const wl_fixed_t x, const wl_fixed_t y)
+        {
+            auto* state = g_context.pointer_focus;
+            if (state == nullptr)
+            {
+                return;
+            }
+
+            state->pointer_x = wl_fixed_to_int(x);
+            state->pointer_y = wl_fixed_to_int(y);
+            state->events.push(mouse_move_event{
+                .x = state->pointer_x,
+                .y = state->pointer_y,
+                .timestamp = compositor_timestamp(time)
+            });
+        }
+
+        void pointer_button(void*, wl_pointer*, std::uint32_t, const std::uint32_t time, const std::uint32_t button,
+                            const std::uint32_t button_state)
+        {
+            auto* state = g_context.pointer_focus;
+            const auto mapped = map_mouse_button(button);
+            if (state == nullptr || mapped == mouse_button::unknown)
+            {
+                return;
+            }
+
+            state->events.push(mouse_button_event{
+                .button = mapped,
+                .pressed = button_state == WL_POINTER_BUTTON_STATE_PRESSED,
+                .x = state->pointer_x,
+                .y = state->pointer_y,
+                .timestamp = compositor_timestamp(time)
+            });
+        }
+
+        void pointer_axis(void*, wl_pointer*, std::uint32_t, std::uint32_t, wl_fixed_t)
+        {
+        }
+
+        constexpr wl_pointer_listener pointer_listener{
+            .enter = pointer_enter,
+            .leave = pointer_leave,
+            .motion = pointer_motion,
+            .button = pointer_button,
+            .axis = pointer_axis
+        };
+
+        // Unaccelerated deltas arrive in 24.8 fixed point. The fractional part is carried over so slow, precise
+        // movement is not truncated away between events.
+        void relative_motion(void*, zwp_relative_pointer_v1*, const std::uint32_t utime_hi, const std::uint32_t utime_lo,
+                             wl_fixed_t, wl_fixed_t, const wl_fixed_t dx_unaccel, const wl_fixed_t dy_unaccel)
+        {
+            auto* state = g_context.captured;
+            if (state == nullptr)
+            {
+                return;
+            }
+
+            state->delta_remainder_x += wl_fixed_to_double(dx_unaccel);
+            state->delta_remainder_y += wl_fixed_to_double(dy_unaccel);
+            const double whole_x = std::trunc(state->delta_remainder_x);
+            const double whole_y = std::trunc(state->delta_remainder_y);
+            state->delta_remainder_x -= whole_x;
+            state->delta_remainder_y -= whole_y;
+            if (whole_x != 0.0 || whole_y != 0.0)
+            {
+                const auto microseconds = (static_cast<std::uint64_t>(utime_hi) << 32) | utime_lo;
+                const auto timestamp = plausible_timestamp(platform_clock::time_point{
+                    std::chrono::microseconds{static_cast<std::int64_t>(microseconds)}});
+                state->events.push(mouse_delta_event{
+                    .dx = static_cast<std::int32_t>(whole_x),
+                    .dy = static_cast<std::int32_t>(whole_y),
+                    .timestamp = timestamp
+                });
+            }
+        }
+
+        constexpr zwp_relative_pointer_v1_listener relative_pointer_listener{
+            .relative_motion = relative_motion
+        };
+
+        void keyboard_keymap(void*, wl_keyboard*, const std::uint32_t format, const std::int32_t fd,
+                             const std::uint32_t size)
+        {
+            if (format != WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1)
+            {
+                close(fd);
+                return;
+            }
+
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapping == MAP_FAILED)
+            {
+                return;
+            }
+
+            xkb_keymap* keymap = xkb_keymap_new_from_string(
+                g_context.xkb,
+                static_cast<const char*>(mapping),
+                XKB_KEYMAP_FORMAT_TEXT_V1,
+                XKB_KEYMAP_COMPILE_NO_FLAGS);
+            munmap(mapping, size);
+            if (keymap == nullptr)
+            {
+                return;
+            }
+
+            xkb_keymap_unref(g_context.keymap);
+            g_context.keymap = keymap;
+        }
+
+        void keyboard_enter(void*, wl_keyboard*, std::uint32_t, wl_surface* surface, wl_array*)
+        {
+            g_context.keyboard_focus = find_window(surface);
+        }
+
+        void keyboard_leave(void*, wl_keyboard*, std::uint32_t, wl_surface* surface)
+        {
+            auto* state = find_window(surface);
+            if (state != nullptr)
+            {
+                // Keys still held report their release to the surface that has focus now, not to us.
+                state->events.push(focus_lost_event{.timestamp = platform_clock::now()});
+            }
+            if (g_context.keyboard_focus == state)
+            {
+                g_context.keyboard_focus = nullptr;
+            }
+        }
+
+        void keyboard_key(void*, wl_keyboard*, std::uint32_t, const std::uint32_t time, const std::uint32_t scancode,
+                          const std::uint32_t key_state)
+        {
+            auto* state = g_context.keyboard_focus;
+            if (state == nullptr || g_context.keymap == nullptr)
+            {
+                return;
+            }
+
+            // Level 0 of the first layout gives the unshifted symbol, which is what detri::key names.
+            const xkb_keysym_t* symbols = nullptr;
+            const int count = xkb_keymap_key_get_syms_by_level(g_context.keymap, scancode + 8, 0, 0, &symbols);
+            state->events.push(key_event{
+                .value = key_translation::from_x11_keysym(count > 0 ? symbols[0] : XKB_KEY_NoSymbol, scancode),
+                .pressed = key_state == WL_KEYBOARD_KEY_STATE_PRESSED,
+                .repeated = false,
+                .timestamp = compositor_timestamp(time)
+            });
+        }
+
+        void keyboard_modifiers(void*, wl_keyboard*, std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t,
+                                std::uint32_t)
+        {
+        }
+
+        void keyboard_repeat_info(void*, wl_keyboard*, std::int32_t, std::int32_t)
+        {
+        }
+
+        constexpr wl_keyboard_listener keyboard_listener{
+            .keymap = keyboard_keymap,
+            .enter = keyboard_enter,
+            .leave = keyboard_leave,
+            .key = keyboard_key,
+            .modifiers = keyboard_modifiers,
+            .repeat_info = keyboard_repeat_info
+        };
+
+        void seat_capabilities(void*, wl_seat* seat, const std::uint32_t capabilities)
+        {
+            const bool has_pointer = (capabilities & WL_SEAT_CAPABILITY_POINTER) != 0;
+            if (has_pointer && g_context.pointer == nullptr)
+            {
+                g_context.pointer = wl_seat_get_pointer(seat);
+                wl_pointer_add_listener(g_context.pointer, &pointer_listener, nullptr);
+            }
+            else if (!has_pointer && g_context.pointer != nullptr)
+            {
+                wl_pointer_release(g_context.pointer);
+                g_context.pointer = nullptr;
+                g_context.pointer_focus = nullptr;
+            }
+
+            const bool has_keyboard = (capabilities & WL_SEAT_CAPABILITY_KEYBOARD) != 0;
+            if (has_keyboard && g_context.keyboard == nullptr)
+            {
+                g_context.keyboard = wl_seat_get_keyboard(seat);
+                wl_keyboard_add_listener(g_context.keyboard, &keyboard_listener, nullptr);
+            }
+            else if (!has_keyboard && g_context.keyboard != nullptr)
+            {
+                wl_keyboard_release(g_context.keyboard);
+                g_context.keyboard = nullptr;
+                g_context.keyboard_focus = nullptr;
+            }
+        }
+
+        void seat_name(void*, wl_seat*, const char*)
+        {
+        }
+
+        constexpr wl_seat_listener seat_listener{
+            .capabilities = seat_capabilities,
+            .name = seat_name
+        };
+
+        void wm_base_ping(void*, xdg_wm_base* wm_base, const std::uint32_t serial)
+        {
+            xdg_wm_base_pong(wm_base, serial);
+        }
+
+        constexpr xdg_wm_base_listener wm_base_listener{
+            .ping = wm_base_ping
+        };
+
+        output_state* find_output(const wl_output* output) noexcept
+        {
+            const auto it = std::find_if(g_context.outputs.begin(), g_context.outputs.end(),
+                                         [output](const auto& entry) { return entry->output == output; });
+            return it == g_context.outputs.end() ? nullptr : it->get();
+        }
+
+        // A surface renders at the scale of the densest output it is on, and keeps its scale while on none.
+        void update_scale(window_state& state)
+        {
+            float scale = 0.0f;
+            for (const wl_output* output : state.outputs)
+            {
+                if (const auto* entry = find_output(output); entry != nullptr && entry->done)
+                {
+                    scale = std::max(scale, entry->current.scale);
+                }
+            }
+            if (scale == 0.0f || scale == state.scale)
+            {
+                return;
+            }
+
+            state.scale = scale;
+            state.events.push(dpi_changed_event{
+                .scale = scale,
+                .timestamp = platform_clock::now()
+            });
+        }
+
+        void output_geometry(void* data, wl_output*, const std::int32_t x, const std::int32_t y, std::int32_t,
+                             std::int32_t, std::int32_t, const char* make, const char* model, const std::int32_t transform)
+        {
+            auto* entry = static_cast<output_state*>(data);
+            entry->pending.x = x;
+            entry->pending.y = y;
+            entry->make_model = std::string{make} + ' ' + model;
+            entry->transform = transform;
+        }
+
+        void output_mode(void* data, wl_output*, const std::uint32_t flags, const std::int32_t width,
+                         const std::int32_t height, const std::int32_t refresh)
+        {
+            auto* entry = static_cast<output_state*>(data);
+            if ((flags & WL_OUTPUT_MODE_CURRENT) == 0)
+            {
+                return;
+            }
+            entry->pending.width = static_cast<std::uint32_t>(width);
+            entry->pending.height = static_cast<std::uint32_t>(height);
+            // Reported in millihertz.
+            entry->pending.refresh_rate = refresh / 1000.0;
+        }
+
+        void output_done(void* data, wl_output*)
+        {
+            auto* entry = static_cast<output_state*>(data);
+            entry->current = entry->pending;
+            entry->current.name = entry->description.empty() ? entry->make_model : entry->description;
+            // Modes are listed unrotated; a display turned on its side is taller than it is wide.
+            if ((entry->transform & 1) != 0)
+            {
+                std::swap(entry->current.width, entry->current.height);
+            }
+            entry->done = true;
+            g_context.displays_changed = true;
+
+            for (auto& [surface, state] : g_context.windows)
+            {
+                if (std::ranges::find(state->outputs, entry->output) != state->outputs.end())
+                {
+                    update_scale(*state);
+                }
+            }
+        }
+
+        void output_scale(void* data, wl_output*, const std::int32_t factor)
+        {
+            static_cast<output_state*>(data)->pending.scale = static_cast<float>(factor);
+        }
+
+        void output_name(void*, wl_output*, const char*)
+        {
+        }
+
+        void output_description(void* data, wl_output*, const char* description)
+        {
+            static_cast<output_state*>(data)->description = description;
+        }
+
+        constexpr wl_output_listener output_listener{
+            .geometry = output_geometry,
+            .mode = output_mode,
+            .done = output_done,
+            .scale = output_scale,
+            .name = output_name,
+            .description = output_description
+        };
+
+        void release_output(wl_output* output) noexcept
+        {
+            if (wl_output_get_version(output) >= WL_OUTPUT_RELEASE_SINCE_VERSION)
+            {
+                wl_output_release(output);
+            }
+            else
+            {
+                wl_output_destroy(output);
+            }
+        }
+
+        void surface_enter(void* data, wl_surface*, wl_output* output)
+        {
+            auto* state = static_cast<window_state*>(data);
+            state->outputs.push_back(output);
+            update_scale(*state);
+        }
+
+        void surface_leave(void* data, wl_surface*, wl_output* output)
+        {
+            auto* state = static_cast<window_state*>(data);
+            std::erase(state->outputs, output);
+            update_scale(*state);
+        }
+
+        constexpr wl_surface_listener surface_listener{
+            .enter = surface_enter,
+            .leave = surface_leave
+        };
+
+        void registry_global(void*, wl_registry* registry, const std::uint32_t name, const char* interface,
+                             const std::uint32_t version)
+        {
+            if (std::strcmp(interface, wl_compositor_interface.name) == 0)
+            {
+                g_context.compositor = static_cast<wl_compositor*>(
+                    wl_registry_bind(registry, name, &wl_compositor_interface, std::min(version, 4U)));
+            }
+            else if (std::strcmp(interface, wl_shm_interface.name) == 0)
+            {
+                g_context.shm = static_cast<wl_shm*>(wl_registry_bind(registry, name, &wl_shm_interface, 1));
+            }
+            else if (std::strcmp(interface, xdg_wm_base_interface.name) == 0)
+            {
+                g_context.wm_base = static_cast<xdg_wm_base*>(
+                    wl_registry_bind(registry, name, &xdg_wm_base_interface, 1));
+                xdg_wm_base_add_listener(g_context.wm_base, &wm_base_listener, nullptr);
+            }
+            else if (std::strcmp(interface, wl_seat_interface.name) == 0 && g_context.seat == nullptr)
+            {
+                g_context.seat = static_cast<wl_seat*>(
+                    wl_registry_bind(registry, name, &wl_seat_interface, std::min(version, 4U)));
+                wl_seat_add_listener(g_context.seat, &seat_listener, nullptr);
+            }
+            else if (std::strcmp(interface, zwp_relative_pointer_manager_v1_interface.name) == 0)
+            {
+                g_context.relative_pointer_manager = static_cast<zwp_relative_pointer_manager_v1*>(
+                    wl_registry_bind(registry, name, &zwp_relative_pointer_manager_v1_interface, 1));
+            }
+            else if (std::strcmp(interface, zwp_pointer_constraints_v1_interface.name) == 0)
+            {
+                g_context.pointer_constraints = static_cast<zwp_pointer_constraints_v1*>(
+                    wl_registry_bind(registry, name, &zwp_pointer_constraints_v1_interface, 1));
+            }
+            else if (std::strcmp(interface, wl_output_interface.name) == 0 && version >= 2)
+            {
+                // Version 2 brings done, without which a mode change cannot be told from the first half of one.
+                auto entry = std::make_unique<output_state>();
+                entry->global = name;
+                entry->pending.id = name;
+                entry->output = static_cast<wl_output*>(
+                    wl_registry_bind(registry, name, &wl_output_interface, std::min(version, 4U)));
+                wl_output_add_listener(entry->output, &output_listener, entry.get());
+                g_context.outputs.push_back(std::move(entry));
+            }
+        }
+
+        void registry_global_remove(void*, wl_registry*, const std::uint32_t name)
+        {
+            const auto it = std::find_if(g_context.outputs.begin(), g_context.outputs.end(),
+                                         [name](const auto& entry) { return entry->global == name; });
+            if (it == g_context.outputs.end())
+            {
+                return;
+            }
+
+            wl_output* output = (*it)->output;
+            g_context.outputs.erase(it);
+            for (auto& [surface, state] : g_context.windows)
+            {
+                std::erase(state->outputs, output);
+            }
+            release_output(output);
+            g_context.displays_changed = true;
+        }
+
+        constexpr wl_registry_listener registry_listener{
+            .global = registry_global,
+            .global_remove = registry_global_remove
+        };
+
+        void toplevel_configure(void* data, xdg_toplevel*, const std::int32_t width, const std::int32_t height,
+                                wl_array*)
+        {
+            // Zero means the compositor leaves the size up to us, so keep whatever we have.
+            auto* state = static_cast<window_state*>(data);
+            if (width > 0 && height > 0)
+            {
+                state->pending_client = {
+                    .width = static_cast<std::uint32_t>(width),
+                    .height = static_cast<std::uint32_t>(height)
+                };
+            }
+        }
+
+        void toplevel_close(void* data, xdg_toplevel*)
+        {
+            static_cast<window_state*>(data)->close_requested = true;
+        }
+
+        constexpr xdg_toplevel_listener toplevel_listener{
+            .configure = toplevel_configure,
+            .close = toplevel_close
+        };
+
+        void shell_surface_configure(void* data, xdg_surface* shell_surface, const std::uint32_t serial)
+        {
+            auto* state = static_cast<window_state*>(data);
+            xdg_surface_ack_configure(shell_surface, serial);
+            if (state->pending_client.width != state->client.width || state->pending_client.height != state->client.height)
+            {
+                state->client = state->pending_client;
+                state->events.push(resize_event{
+                    .width = state->client.width,
+                    .height = state->client.height,
+                    .timestamp = platform_clock::now()
+                });
+            }
+        }
+
+        constexpr xdg_surface_listener shell_surface_listener{
+            .configure = shell_surface_configure
+        };
+
+        void destroy_context() noexcept
+        {
+            for (const auto& entry : g_context.outputs)
+            {
+                release_output(entry->output);
+            }
+            if (g_context.relative_pointer != nullptr)
+            {
+                zwp_relative_pointer_v1_destroy(g_context.relative_pointer);
+            }
+            if (g_context.pointer_constraints != nullptr)
+            {
+                zwp_pointer_constraints_v1_destroy(g_context.pointer_constraints);
+            }
+            if (g_context.relative_pointer_manager != nullptr)
+            {
+                zwp_relative_pointer_manager_v1_destroy(g_context.relative_pointer_manager);
+            }
+            if (g_context.pointer != nullptr)
+            {
+                wl_pointer_release(g_context.pointer);
+            }
+            if (g_context.keyboard != nullptr)
+            {
+                wl_keyboard_release(g_context.keyboard);
+            }
+            if (g_context.seat != nullptr)
+            {
+                wl_seat_destroy(g_context.seat);
+            }
+            if (g_context.cursor_surface != nullptr)
+            {
+                wl_surface_destroy(g_context.cursor_surface);
+            }
+            if (g_context.cursor_theme != nullptr)
+            {
+                wl_cursor_theme_destroy(g_context.cursor_theme);
+            }
+            if (g_context.shm != nullptr)
+            {
+                wl_shm_destroy(g_context.shm);
+            }
+            if (g_context.wm_base != nullptr)
+            {
+                xdg_wm_base_destroy(g_context.wm_base);
+            }
+            if (g_context.compositor != nullptr)
+            {
+                wl_compositor_destroy(g_context.compositor);
+            }
+            if (g_context.registry != nullptr)
+            {
+                wl_registry_destroy(g_context.registry);
+            }
+            xkb_keymap_unref(g_context.keymap);
+            xkb_context_unref(g_context.xkb);
+            if (g_context.display != nullptr)
+            {
+                wl_display_disconnect(g_context.display);
+            }
+            g_context = {};
+        }
+
+        wayland_context& acquire_context()
+        {
+            if (g_context.references++ != 0)
+            {
+                return g_context;
+            }
+
+            g_context.display = wl_display_connect(nullptr);
+            if (g_context.display == nullptr)
+            {
+                g_context = {};
+                throw except::window_error{"Failed to connect to the Wayland display."};
+            }
+
+            g_context.xkb = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+            g_context.registry = wl_display_get_registry(g_context.display);
+            wl_registry_add_listener(g_context.registry, &registry_listener, nullptr);
+
+            // The first round-trip collects globals; the second delivers the seat capabilities and keymap.
+            wl_display_roundtrip(g_context.display);
+            wl_display_roundtrip(g_context.display);
+
+            if (g_context.compositor == nullptr || g_context.wm_base == nullptr)
+            {
+                destroy_context();
+                throw except::window_error{"Wayland compositor does not provide wl_compositor and xdg_wm_base."};
+            }
+            // The outputs announced so far are the starting layout, not a change to it.
+            g_context.displays_changed = false;
+            return g_context;
+        }
+
+        void release_context() noexcept
+        {
+            if (g_context.references == 0 || --g_context.references != 0)
+            {
+                return;
+            }
+            destroy_context();
+        }
+
+        // Holds the connection open for queries made while no window might exist.
+        struct context_reference
+        {
+            wayland_context& context = acquire_context();
+
+            context_reference() = default;
+            context_reference(const context_reference&) = delete;
+            context_reference& operator=(const context_reference&) = delete;
+
+            ~context_reference()
+            {
+                release_context();
+            }
+        };
+
+        // Wayland has no primary display; the first output the compositor announced stands in for it.
+        std::vector<display_info> query_displays(const wayland_context& context)
+        {
+            std::vector<display_info> displays;
+            for (const auto& entry : context.outputs)
+            {
+                if (entry->done)
+                {
+                    displays.push_back(entry->current);
+                    displays.back().primary = displays.size() == 1;
+                }
+            }
+            return displays;
+        }
+
+        // Waits until deadline for one of descriptors, the display's own last, to become readable, then reads and
+        // dispatches whatever reached the display. Returns the index of the first ready descriptor. The prepare/read
+        // protocol keeps this safe against other threads reading the same display.
+        std::optional<std::size_t> read_display(wl_display* display, const std::span<const int> descriptors,
+                                                const platform_clock::time_point deadline)
+        {
+            while (wl_display_prepare_read(display) != 0)
+            {
+                wl_display_dispatch_pending(display);
+            }
+            {
+                const section_timer os_timer{timed_section::os};
+                wl_display_flush(display);
+            }
+
+            std::optional<std::size_t> ready;
+            try
+            {
+                ready = wait_readable(descriptors, deadline);
+            }
+            catch (...)
+            {
+                wl_display_cancel_read(display);
+                throw;
+            }
+
+            if (ready == descriptors.size() - 1)
+            {
+                const section_timer os_timer{timed_section::os};
+                wl_display_read_events(display);
+            }
+            else
+            {
+                wl_display_cancel_read(display);
+            }
+            wl_display_dispatch_pending(display);
+            return ready;
+        }
+    } // namespace
+
+    std::vector<display_info> enumerate_displays()
+    {
+        const context_reference reference;
+        return query_displays(reference.context);
+    }
+
+    // The state lives inside impl, so a window takes one allocation besides its event ring.
+    struct window::impl
+    {
+        explicit impl(const window_options& options)
+            : state(options)
+        {
+        }
+
+        window_state state;
+    };
+
+    window::window(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    window window::create(const std::string_view title, const std::uint32_t width, const std::uint32_t height,
+                          const window_options& options)
+    {
+        if (width == 0 || height == 0)
+        {
+            throw except::window_error{"Window dimensions must be greater than zero."};
+        }
+
+        // Everything that can throw before the surface exists goes first, so nothing is left to undo.
+        const native_string native_title{title};
+        auto impl = std::make_unique<window::impl>(options);
+        auto& context = acquire_context();
+        auto* state = &impl->state;
+
+        state->client = {
+            .width = width,
+            .height = height
+        };
+        state->pending_client = state->client;
+        state->surface = wl_compositor_create_surface(context.compositor);
+        wl_surface_add_listener(state->surface, &surface_listener, state);
+        state->shell_surface = xdg_wm_base_get_xdg_surface(context.wm_base, state->surface);
+        xdg_surface_add_listener(state->shell_surface, &shell_surface_listener, state);
+        state->toplevel = xdg_surface_get_toplevel(state->shell_surface);
+        xdg_toplevel_add_listener(state->toplevel, &toplevel_listener, state);
+        xdg_toplevel_set_title(state->toplevel, native_title.c_str());
+
+        // From here ~window destroys the surface and releases the context if registering it throws.
+        window created{std::move(impl)};
+        context.windows.emplace(state->surface, state);
+
+        // The initial bufferless commit asks the compositor for the first configure.
+        wl_surface_commit(state->surface);
+        wl_display_roundtrip(context.display);
+
+        return created;
+    }
+
+    window::~window()
+    {
+        if (m_impl == nullptr || m_impl->state.surface == nullptr)
+        {
+            return;
+        }
+
+        auto* state = &m_impl->state;
+        if (state->cursor == cursor_mode::captured_hidden)
+        {
+            set_cursor_mode(cursor_mode::normal);
+        }
+        if (g_context.pointer_focus == state)
+        {
+            g_context.pointer_focus = nullptr;
+        }
+        if (g_context.keyboard_focus == state)
+        {
+            g_context.keyboard_focus = nullptr;
+        }
+        g_context.windows.erase(state->surface);
+        xdg_toplevel_destroy(state->toplevel);
+        xdg_surface_destroy(state->shell_surface);
+        wl_surface_destroy(state->surface);
+        wl_display_flush(g_context.display);
+        release_context();
+    }
+
+    window::window(window&&) noexcept = default;
+
+    window& window::operator=(window&& other) noexcept
+    {
+        if (this != &other)
+        {
+            window discarded{std::move(m_impl)};
+            m_impl = std::move(other.m_impl);
+        }
+        return *this;
+    }
+
+    bool window::is_open() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.is_open;
+    }
+
+    void window::request_close() const noexcept
+    {
+        if (m_impl != nullptr && m_impl->state.is_open)
+        {
+            m_impl->state.close_requested = true;
+        }
+    }
+
+    void window::show() const noexcept
+    {
+        // xdg-shell maps a toplevel once the renderer attaches its first buffer; all we can do here is commit.
+        if (m_impl != nullptr && m_impl->state.surface != nullptr)
+        {
+            wl_surface_commit(m_impl->state.surface);
+            wl_display_flush(g_context.display);
+        }
+    }
+
+    void window::set_title(const std::string_view title) const
+    {
+        if (m_impl == nullptr || m_impl->state.toplevel == nullptr)
+        {
+            throw except::window_error{"Cannot set the title of an invalid window."};
+        }
+
+        const native_string native_title{title};
+        xdg_toplevel_set_title(m_impl->state.toplevel, native_title.c_str());
+        wl_display_flush(g_context.display);
+    }
+
+    void window::pump_messages()
+    {
+        wl_display* display = g_context.display;
+        if (display == nullptr)
+        {
+            return;
+        }
+
+        // Read whatever is on the socket in one go without blocking, then dispatch the whole batch.
+        const section_timer pump_timer{timed_section::pump};
+        const int descriptor = wl_display_get_fd(display);
+        read_display(display, std::span{&descriptor, 1}, platform_clock::time_point::min());
+
+        const bool displays_changed = std::exchange(g_context.displays_changed, false);
+        for (auto& [surface, state] : g_context.windows)
+        {
+            if (displays_changed)
+            {
+                state->events.push(display_changed_event{.timestamp = platform_clock::now()});
+            }
+            if (state->close_requested && state->is_open)
+            {
+                state->close_requested = false;
+                state->is_open = false;
+                state->events.push(close_event{.timestamp = platform_clock::now()});
+            }
+            state->events.flush();
+        }
+    }
+
+    void window::flush_events()
+    {
+        // pump_messages() already publishes for every window on the connection.
+    }
+
+    bool window::pumps_on_own_thread() const noexcept
+    {
+        return false;
+    }
+
+    std::optional<std::size_t> window::wait_any(const std::span<const native_wait_handle> handles,
+                                                const platform_clock::duration timeout)
+    {
+        const auto deadline = deadline_after(timeout);
+        pump_messages();
+        if (m_impl == nullptr || g_context.display == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        // The display goes last so the indexes of handles come back unchanged. A closed window gets no more input, so
+        // only the handles are left to wait on. A frame loop passes a handle or two; only a long list needs the heap.
+        auto& state = m_impl->state;
+        const std::size_t count = handles.size() + (state.is_open ? 1 : 0);
+        std::array<int, 8> inline_descriptors{};
+        std::vector<int> heap_descriptors;
+        if (count > inline_descriptors.size())
+        {
+            heap_descriptors.resize(count);
+        }
+        const std::span<int> descriptors = heap_descriptors.empty() ? std::span{inline_descriptors}.first(count)
+                                                                    : std::span<int>{heap_descriptors};
+        std::ranges::copy(handles, descriptors.begin());
+        if (state.is_open)
+        {
+            descriptors.back() = wl_display_get_fd(g_context.display);
+        }
+
+        for (;;)
+        {
+            const auto ready_at = state.consumer.ready_at(state.events);
+            if (ready_at <= platform_clock::now())
+            {
+                return handles.size();
+            }
+            if (descriptors.empty())
+            {
+                return std::nullopt;
+            }
+
+            // Input for a sibling window wakes us too, and the loop goes back to sleep.
+            const auto until = std::min(deadline, ready_at);
+            const auto ready = state.is_open ? read_display(g_context.display, descriptors, until)
+                                             : wait_readable(descriptors, until);
+            if (ready.has_value() && *ready < handles.size())
+            {
+                return ready;
+            }
+            pump_messages();
+            if (!ready.has_value() && platform_clock::now() >= deadline)
+            {
+                return state.consumer.ready_at(state.events) <= platform_clock::now() ? std::optional{handles.size()}
+                                                                                       : std::nullopt;
+            }
+        }
+    }
+
+    native_wait_handle window::wait_handle() const noexcept
+    {
+        return g_context.display == nullptr ? invalid_wait_handle : wl_display_get_fd(g_context.display);
+    }
+
+    std::optional<event> window::poll_event()
+    {
+        pump_messages();
+        if (m_impl == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        return m_impl->state.consumer.poll(m_impl->state.events);
+    }
+
+    std::size_t window::drain_events(const std::span<event> out)
+    {
+        pump_messages();
+        return drain_queued(out);
+    }
+
+    std::size_t window::drain_queued(const std::span<event> out)
+    {
+        if (m_impl == nullptr)
+        {
+            return 0;
+        }
+
+        return m_impl->state.consumer.drain(m_impl->state.events, out);
+    }
+
+    window_size window::size() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return m_impl->state.client;
+    }
+
+    float window::scale() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return 1.0f;
+        }
+
+        return m_impl->state.scale;
+    }
+
+    display_info window::display() const
+    {
+        if (m_impl == nullptr || m_impl->state.surface == nullptr)
+        {
+            throw except::window_error{"Cannot query the display of an invalid window."};
+        }
+
+        // The compositor decides where a surface goes and only says which outputs it ended up on.
+        const auto displays = query_displays(g_context);
+        for (const wl_output* output : m_impl->state.outputs)
+        {
+            if (const auto* entry = find_output(output); entry != nullptr && entry->done)
+            {
+                const auto it = std::ranges::find(displays, entry->current.id, &display_info::id);
+                return *it;
+            }
+        }
+        if (displays.empty())
+        {
+            throw except::window_error{"The Wayland compositor announced no outputs."};
+        }
+        return displays.front();
+    }
+
+    const keyboard_state& window::keyboard() const noexcept
+    {
+        static const keyboard_state released{};
+        if (m_impl == nullptr)
+        {
+            return released;
+        }
+
+        return m_impl->state.consumer.keyboard;
+    }
+
+    void window::record_input(input_recorder* recorder) noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.consumer.recorder = recorder;
+        }
+    }
+
+    void window::replay_input(input_replayer* replayer) noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.consumer.replayer = replayer;
+        }
+    }
+
+    event_queue_stats window::event_stats() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return m_impl->state.events.stats();
+    }
+
+    void window::set_event_coalescing(const bool enabled) const noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.events.set_coalescing(enabled);
+        }
+    }
+
+    bool window::event_coalescing() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.events.coalescing();
+    }
+
+    void window::set_cursor_mode(const cursor_mode mode) const
+    {
+        if (m_impl == nullptr || m_impl->state.surface == nullptr)
+        {
+            throw except::window_error{"Cannot set cursor mode on an invalid window."};
+        }
+        if (m_impl->state.cursor == mode)
+        {
+            return;
+        }
+
+        auto& context = g_context;
+        auto* state = &m_impl->state;
+
+        if (mode == cursor_mode::captured_hidden)
+        {
+            if (context.pointer == nullptr || context.relative_pointer_manager == nullptr ||
+                context.pointer_constraints == nullptr)
+            {
+                throw except::window_error{
+                    "Captured cursor mode requires a pointer, zwp_relative_pointer_manager_v1 and "
+                    "zwp_pointer_constraints_v1."};
+            }
+
+            // The lock keeps the cursor in place while relative motion keeps reporting deltas, so there is
+            // no warp-to-center and no synthetic motion to filter out.
+            state->locked_pointer = zwp_pointer_constraints_v1_lock_pointer(
+                context.pointer_constraints,
+                state->surface,
+                context.pointer,
+                nullptr,
+                ZWP_POINTER_CONSTRAINTS_V1_LIFETIME_PERSISTENT);
+            if (context.relative_pointer == nullptr)
+            {
+                context.relative_pointer = zwp_relative_pointer_manager_v1_get_relative_pointer(
+                    context.relative_pointer_manager,
+                    context.pointer);
+                zwp_relative_pointer_v1_add_listener(context.relative_pointer, &relative_pointer_listener, nullptr);
+            }
+            state->delta_remainder_x = 0.0;
+            state->delta_remainder_y = 0.0;
+            context.captured = state;
+            if (context.pointer_focus == state)
+            {
+                hide_cursor();
+            }
+        }
+        else
+        {
+            if (state->locked_pointer != nullptr)
+            {
+                zwp_locked_pointer_v1_destroy(state->locked_pointer);
+                state->locked_pointer = nullptr;
+            }
+            if (context.captured == state)
+            {
+                context.captured = nullptr;
+                zwp_relative_pointer_v1_destroy(context.relative_pointer);
+                context.relative_pointer = nullptr;
+            }
+            if (context.pointer_focus == state)
+            {
+                show_default_cursor();
+            }
+        }
+
+        state->cursor = mode;
+        wl_display_flush(context.display);
+    }
+
+    cursor_mode window::get_cursor_mode() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return cursor_mode::normal;
+        }
+        return m_impl->state.cursor;
+    }
+
+    void* window::native_handle() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return nullptr;
+        }
+
+        return m_impl->state.surface;
+    }
+
+    window::native_wayland_handle window::native_wayland() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return {
+            .display = g_context.display,
+            .surface = m_impl->state.surface
+        };
+    }
+} // namespace detri
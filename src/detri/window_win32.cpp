@@ -1,21 +1,302 @@
 #include "detri/window.hpp"
+#include "detri/event_consumer.hpp"
+#include "detri/high_resolution_timer.hpp"
+#include "detri/key_translation.hpp"
+#include "detri/native_string.hpp"
 #include "detri/platform_exceptions.hpp"
+#include "detri/thread_counters.hpp"
+#include "detri/unicode.hpp"
 
+#include <shellscalingapi.h>
+
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstddef>
+#include <exception>
 #include <expected>
+#include <future>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <optional>
-#include <queue>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace detri
 {
     namespace
     {
-        std::atomic<native_message_hook> g_native_message_hook{nullptr};
+        // The message hook chain is read-copy-update: a pump reads whichever version is published without locking, and
+        // add/remove publish a copy and retire the old version, which is freed once every thread that could have been
+        // reading it has left. Those threads announce themselves with the epoch they entered in.
+        struct message_hook_entry
+        {
+            message_hook_id id;
+            native_message_hook hook;
+            message_filter filter;
+        };
+
+        struct message_hook_chain
+        {
+            std::vector<message_hook_entry> hooks;
+        };
+
+        struct retired_hook_chain
+        {
+            // Readers that entered before this epoch may still hold chain.
+            std::uint64_t epoch {};
+            std::unique_ptr<const message_hook_chain> chain;
+        };
+
+        struct hook_reader
+        {
+            // The epoch this thread entered the chain in, or 0 while it is outside.
+            std::atomic<std::uint64_t> epoch {0};
+            // Only the owner touches this: a hook that sends a message re-enters the chain on the same thread.
+            std::uint32_t depth {};
+        };
+
+        std::atomic<const message_hook_chain*> g_hook_chain {nullptr};
+        std::atomic<std::uint64_t> g_hook_epoch {1};
+
+        // Every thread that has entered the chain, until it exits. Only registration and the writers' scans take the
+        // lock; a pump entering and leaving the chain touches nothing but its own record.
+        std::mutex g_hook_readers_lock;
+        std::vector<hook_reader*> g_hook_readers;
+
+        // The union of every hook's filter, one word per 64 system messages and a last one for WM_USER and up, so a
+        // message no hook wants is turned away before the chain is entered. A hook being added may miss a message
+        // that races with it; one being removed may still draw a message into the chain, which then finds nothing.
+        constexpr std::size_t hook_filter_words = message_filter{}.system.size() + 1;
+        std::array<std::atomic<std::uint64_t>, hook_filter_words> g_hooked_messages {};
+
+        // Serializes publishing, which also owns the retired versions. Never held while waiting on a reader, so a hook
+        // can add or remove while another pump thread's hook does the same.
+        std::mutex g_hook_writer;
+        std::vector<retired_hook_chain> g_retired_hook_chains;
+        message_hook_id g_next_hook_id {1};
+
+        // Registers the thread's reader on first use and unlinks it when the thread exits, so threads that come and go
+        // do not grow the list writers scan.
+        class hook_reader_registration
+        {
+        public:
+            hook_reader_registration()
+            {
+                const std::scoped_lock lock{g_hook_readers_lock};
+                g_hook_readers.push_back(&m_reader);
+            }
+
+            ~hook_reader_registration()
+            {
+                const std::scoped_lock lock{g_hook_readers_lock};
+                std::erase(g_hook_readers, &m_reader);
+            }
+
+            hook_reader_registration(const hook_reader_registration&) = delete;
+
+            hook_reader_registration& operator=(const hook_reader_registration&) = delete;
+
+            hook_reader& reader() noexcept
+            {
+                return m_reader;
+            }
+
+        private:
+            hook_reader m_reader;
+        };
+
+        hook_reader& this_hook_reader()
+        {
+            thread_local hook_reader_registration registration;
+            return registration.reader();
+        }
+
+        class hook_read_section
+        {
+        public:
+            hook_read_section()
+                : m_reader(this_hook_reader())
+            {
+                if (m_reader.depth++ == 0)
+                {
+                    // Sequentially consistent so a writer that swaps the chain after our load is sure to see us.
+                    m_reader.epoch.store(g_hook_epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+                }
+            }
+
+            ~hook_read_section()
+            {
+                if (--m_reader.depth == 0)
+                {
+                    m_reader.epoch.store(0, std::memory_order_release);
+                }
+            }
+
+            hook_read_section(const hook_read_section&) = delete;
+
+            hook_read_section& operator=(const hook_read_section&) = delete;
+
+        private:
+            hook_reader& m_reader;
+        };
+
+        bool message_hooked(const UINT message) noexcept
+        {
+            const std::size_t word = message < WM_USER ? message / 64 : hook_filter_words - 1;
+            const std::uint64_t bit = message < WM_USER ? std::uint64_t{1} << (message % 64) : 1;
+            return (g_hooked_messages[word].load(std::memory_order_relaxed) & bit) != 0;
+        }
+
+        void publish_hooked_messages(const message_hook_chain* chain) noexcept
+        {
+            std::array<std::uint64_t, hook_filter_words> words{};
+            if (chain != nullptr)
+            {
+                for (const auto& entry : chain->hooks)
+                {
+                    for (std::size_t i = 0; i < entry.filter.system.size(); ++i)
+                    {
+                        words[i] |= entry.filter.system[i];
+                    }
+                    words.back() |= entry.filter.user ? 1 : 0;
+                }
+            }
+            for (std::size_t i = 0; i < words.size(); ++i)
+            {
+                g_hooked_messages[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        // The epoch the longest-reading thread other than skip entered in, or UINT64_MAX if none is inside the chain.
+        std::uint64_t oldest_hook_reader(const hook_reader* const skip)
+        {
+            const std::scoped_lock lock{g_hook_readers_lock};
+            std::uint64_t oldest = UINT64_MAX;
+            for (const hook_reader* reader : g_hook_readers)
+            {
+                const std::uint64_t entered = reader->epoch.load(std::memory_order_seq_cst);
+                if (reader != skip && entered != 0)
+                {
+                    oldest = std::min(oldest, entered);
+                }
+            }
+            return oldest;
+        }
+
+        // Called with g_hook_writer held. Frees the retired versions no thread can still be reading, including the
+        // calling thread when it publishes from inside a hook.
+        void reclaim_hook_chains()
+        {
+            const std::uint64_t oldest = oldest_hook_reader(nullptr);
+            std::erase_if(g_retired_hook_chains, [oldest](const retired_hook_chain& retired) {
+                return retired.epoch <= oldest;
+            });
+        }
+
+        // Called with g_hook_writer held. Publishes next and retires the version it replaces without waiting for
+        // anyone. Returns the new epoch: once every other thread is outside the chain or entered at or after it, none
+        // can still be running a hook that next left out.
+        std::uint64_t replace_hook_chain(std::unique_ptr<const message_hook_chain>&& next)
+        {
+            const auto* const previous = g_hook_chain.exchange(next.release(), std::memory_order_seq_cst);
+            const std::uint64_t epoch = g_hook_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+            if (previous != nullptr)
+            {
+                g_retired_hook_chains.push_back({.epoch = epoch, .chain = std::unique_ptr<const message_hook_chain>{previous}});
+            }
+            reclaim_hook_chains();
+            return epoch;
+        }
+
+        // Runs the hooks that want message, in the order they were added. True if one consumed it, with the value
+        // the window procedure returns in result.
+        bool run_message_hooks(HWND hwnd, const UINT message, const WPARAM wparam, const LPARAM lparam, LRESULT& result)
+        {
+            if (!message_hooked(message))
+            {
+                return false;
+            }
+
+            const section_timer hook_timer{timed_section::message_hook};
+            const hook_read_section section;
+            const auto* const chain = g_hook_chain.load(std::memory_order_seq_cst);
+            if (chain == nullptr)
+            {
+                return false;
+            }
+            for (const auto& entry : chain->hooks)
+            {
+                if (!entry.filter.contains(message))
+                {
+                    continue;
+                }
+                if (const LRESULT value = entry.hook(hwnd, message, wparam, lparam); value != 0)
+                {
+                    result = value;
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    message_hook_id add_message_hook(const native_message_hook hook, const message_filter& filter)
+    {
+        if (hook == nullptr)
+        {
+            throw except::window_error{"Cannot add a null message hook."};
+        }
+
+        const std::scoped_lock lock{g_hook_writer};
+        auto next = std::make_unique<message_hook_chain>();
+        if (const auto* const current = g_hook_chain.load(std::memory_order_relaxed); current != nullptr)
+        {
+            next->hooks = current->hooks;
+        }
+        const message_hook_id id = g_next_hook_id++;
+        next->hooks.push_back({.id = id, .hook = hook, .filter = filter});
+        // Publish the chain before its filter so a message let in by the new bits finds the hook.
+        const auto* const chain = next.get();
+        replace_hook_chain(std::move(next));
+        publish_hooked_messages(chain);
+        return id;
     }
 
-    void set_native_message_hook(native_message_hook hook) noexcept
+    void remove_message_hook(const message_hook_id id)
     {
-        g_native_message_hook.store(hook, std::memory_order_release);
+        std::uint64_t epoch = 0;
+        {
+            const std::scoped_lock lock{g_hook_writer};
+            const auto* const current = g_hook_chain.load(std::memory_order_relaxed);
+            if (current == nullptr || std::ranges::none_of(current->hooks, [id](const message_hook_entry& entry) { return entry.id == id; }))
+            {
+                return;
+            }
+
+            auto next = std::make_unique<message_hook_chain>();
+            std::ranges::copy_if(current->hooks, std::back_inserter(next->hooks), [id](const message_hook_entry& entry) {
+                return entry.id != id;
+            });
+            epoch = replace_hook_chain(std::move(next));
+        }
+
+        // Wait without the writer lock, so a hook on another thread that adds or removes while we wait is not stuck
+        // behind us. Our own reading further up the stack is left to finish.
+        const hook_reader* const self = &this_hook_reader();
+        while (oldest_hook_reader(self) < epoch)
+        {
+            std::this_thread::yield();
+        }
+
+        // Narrow the filter only once no thread can still be running the removed hook. Whatever was published since
+        // is current, so take the filter from that.
+        const std::scoped_lock lock{g_hook_writer};
+        publish_hooked_messages(g_hook_chain.load(std::memory_order_relaxed));
+        reclaim_hook_chains();
     }
 
     LRESULT CALLBACK window_proc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
@@ -24,138 +305,13 @@ namespace detri
     {
         constexpr auto window_class_name = L"platform.window";
 
-        key map_key(const WPARAM wparam) noexcept
-        {
-            switch (wparam)
-            {
-                case VK_ESCAPE:
-                    return key::escape;
-                case VK_RETURN:
-                    return key::enter;
-                case VK_TAB:
-                    return key::tab;
-                case VK_BACK:
-                    return key::backspace;
-                case VK_SPACE:
-                    return key::space;
-                case VK_LEFT:
-                    return key::left;
-                case VK_RIGHT:
-                    return key::right;
-                case VK_UP:
-                    return key::up;
-                case VK_DOWN:
-                    return key::down;
-                case VK_LCONTROL:
-                    return key::left_control;
-                case VK_RCONTROL:
-                    return key::right_control;
-                case VK_CONTROL:
-                    return key::left_control;
-                case VK_LSHIFT:
-                    return key::left_shift;
-                case VK_RSHIFT:
-                    return key::right_shift;
-                case 'A':
-                    return key::a;
-                case 'B':
-                    return key::b;
-                case 'C':
-                    return key::c;
-                case 'D':
-                    return key::d;
-                case 'E':
-                    return key::e;
-                case 'F':
-                    return key::f;
-                case 'G':
-                    return key::g;
-                case 'H':
-                    return key::h;
-                case 'I':
-                    return key::i;
-                case 'J':
-                    return key::j;
-                case 'K':
-                    return key::k;
-                case 'L':
-                    return key::l;
-                case 'M':
-                    return key::m;
-                case 'N':
-                    return key::n;
-                case 'O':
-                    return key::o;
-                case 'P':
-                    return key::p;
-                case 'Q':
-                    return key::q;
-                case 'R':
-                    return key::r;
-                case 'S':
-                    return key::s;
-                case 'T':
-                    return key::t;
-                case 'U':
-                    return key::u;
-                case 'V':
-                    return key::v;
-                case 'W':
-                    return key::w;
-                case 'X':
-                    return key::x;
-                case 'Y':
-                    return key::y;
-                case 'Z':
-                    return key::z;
-                case '0':
-                    return key::zero;
-                case '1':
-                    return key::one;
-                case '2':
-                    return key::two;
-                case '3':
-                    return key::three;
-                case '4':
-                    return key::four;
-                case '5':
-                    return key::five;
-                case '6':
-                    return key::six;
-                case '7':
-                    return key::seven;
-                case '8':
-                    return key::eight;
-                case '9':
-                    return key::nine;
-                case VK_F1:
-                    return key::f1;
-                case VK_F2:
-                    return key::f2;
-                case VK_F3:
-                    return key::f3;
-                case VK_F4:
-                    return key::f4;
-                case VK_F5:
-                    return key::f5;
-                case VK_F6:
-                    return key::f6;
-                case VK_F7:
-                    return key::f7;
-                case VK_F8:
-                    return key::f8;
-                case VK_F9:
-                    return key::f9;
-                case VK_F10:
-                    return key::f10;
-                case VK_F11:
-                    return key::f11;
-                case VK_F12:
-                    return key::f12;
-                default:
-                    return key::unknown;
-            }
-        }
+        // Sent by the owning thread to a threaded window so the work runs on the thread that created the HWND.
+        constexpr UINT destroy_window_message = WM_APP + 0x100;
+        constexpr UINT set_cursor_mode_message = WM_APP + 0x101;
+
+        // While a threaded window sits in the modal size/move loop our pump never returns to flush coalesced events,
+        // so a timer does it instead.
+        constexpr UINT_PTR size_move_flush_timer = 1;
 
         mouse_button map_mouse_button(const UINT message, const WPARAM wparam) noexcept
         {
@@ -215,18 +371,478 @@ namespace detri
 
         struct window_state
         {
+            explicit window_state(const window_options& options)
+                : events(options.event_capacity, options.overflow_policy)
+            {
+                events.set_coalescing(options.coalesce_events);
+            }
+
             HWND hwnd{};
             HINSTANCE instance{};
-            bool is_open{true};
+            // Written by the pump thread and read by the owner when the window is threaded.
+            std::atomic<bool> is_open{true};
             cursor_mode cursor{cursor_mode::normal};
+            bool raw_input{false};
             bool suppress_next_mouse_move{false};
-            std::queue<event> events;
+            event_queue events;
+            // Only touched by the thread that consumes events.
+            event_consumer consumer;
+            alignas(8) std::array<std::byte, 64 * sizeof(RAWINPUT)> raw_buffer{};
+            bool threaded{false};
+            std::thread pump_thread;
+            // Set by a threaded window's pump thread each time it publishes, so the owner can sleep until it does.
+            HANDLE events_published{};
+            high_resolution_timer wait_timer;
+            // Written by whichever thread handles WM_DPICHANGED.
+            std::atomic<UINT> dpi{USER_DEFAULT_SCREEN_DPI};
         };
+
+        // For a threaded window, also wakes an owner blocked in wait_for_events_or_timeout().
+        void publish_events(window_state& state)
+        {
+            state.events.flush();
+            if (state.events_published != nullptr)
+            {
+                SetEvent(state.events_published);
+            }
+        }
+
+        struct cursor_mode_request
+        {
+            cursor_mode mode;
+            std::exception_ptr error;
+        };
+
+        constexpr USHORT hid_usage_page_generic = 0x01;
+        constexpr USHORT hid_usage_generic_mouse = 0x02;
+
+        bool register_raw_mouse(HWND hwnd) noexcept
+        {
+            const RAWINPUTDEVICE device{
+                .usUsagePage = hid_usage_page_generic,
+                .usUsage = hid_usage_generic_mouse,
+                .dwFlags = 0,
+                .hwndTarget = hwnd
+            };
+            return RegisterRawInputDevices(&device, 1, sizeof(device)) != 0;
+        }
+
+        void unregister_raw_mouse() noexcept
+        {
+            const RAWINPUTDEVICE device{
+                .usUsagePage = hid_usage_page_generic,
+                .usUsage = hid_usage_generic_mouse,
+                .dwFlags = RIDEV_REMOVE,
+                .hwndTarget = nullptr
+            };
+            RegisterRawInputDevices(&device, 1, sizeof(device));
+        }
+
+        void read_raw_mouse(window_state& state, const RAWINPUT& input, const platform_clock::time_point timestamp)
+        {
+            if (input.header.dwType != RIM_TYPEMOUSE)
+            {
+                return;
+            }
+
+            // Absolute packets come from tablets and remote-desktop sessions and carry no relative motion.
+            const RAWMOUSE& mouse = input.data.mouse;
+            if ((mouse.usFlags & MOUSE_MOVE_ABSOLUTE) != 0 || (mouse.lLastX == 0 && mouse.lLastY == 0))
+            {
+                return;
+            }
+
+            state.events.push(mouse_delta_event{
+                .dx = static_cast<std::int32_t>(mouse.lLastX),
+                .dy = static_cast<std::int32_t>(mouse.lLastY),
+                .timestamp = timestamp
+            });
+        }
+
+        // Pulls every raw packet that queued up behind the current WM_INPUT in one call, so a 1000 Hz+ mouse costs
+        // one message dispatch per pump instead of one per packet.
+        void drain_raw_input_buffer(window_state& state, const platform_clock::time_point timestamp)
+        {
+            for (;;)
+            {
+                UINT size = static_cast<UINT>(state.raw_buffer.size());
+                auto* input = reinterpret_cast<RAWINPUT*>(state.raw_buffer.data());
+                const UINT count = GetRawInputBuffer(input, &size, sizeof(RAWINPUTHEADER));
+                if (count == 0 || count == static_cast<UINT>(-1))
+                {
+                    return;
+                }
+
+                for (UINT i = 0; i < count; ++i)
+                {
+                    read_raw_mouse(state, *input, timestamp);
+                    input = NEXTRAWINPUTBLOCK(input);
+                }
+            }
+        }
+
+        // Must run on the thread that owns state.hwnd: ShowCursor keeps a per-thread display count.
+        void apply_cursor_mode(window_state& state, const cursor_mode mode)
+        {
+            if (state.cursor == mode)
+            {
+                return;
+            }
+
+            state.cursor = mode;
+            HWND hwnd = state.hwnd;
+
+            if (mode == cursor_mode::captured_hidden)
+            {
+                while (ShowCursor(FALSE) >= 0)
+                {
+                }
+
+                RECT client{};
+                if (GetClientRect(hwnd, &client) == 0)
+                {
+                    throw except::window_error{"GetClientRect failed while enabling captured cursor mode."};
+                }
+                POINT tl{client.left, client.top};
+                POINT br{client.right, client.bottom};
+                ClientToScreen(hwnd, &tl);
+                ClientToScreen(hwnd, &br);
+                RECT clip_rect{tl.x, tl.y, br.x, br.y};
+                if (ClipCursor(&clip_rect) == 0)
+                {
+                    throw except::window_error{"ClipCursor failed while enabling captured cursor mode."};
+                }
+
+                const std::int32_t center_x = (client.right - client.left) / 2;
+                const std::int32_t center_y = (client.bottom - client.top) / 2;
+                POINT center{
+                    .x = center_x,
+                    .y = center_y
+                };
+                ClientToScreen(hwnd, &center);
+                state.raw_input = register_raw_mouse(hwnd);
+                state.suppress_next_mouse_move = !state.raw_input;
+                SetCursorPos(center.x, center.y);
+            }
+            else
+            {
+                if (state.raw_input)
+                {
+                    unregister_raw_mouse();
+                    state.raw_input = false;
+                }
+                ClipCursor(nullptr);
+                while (ShowCursor(TRUE) < 0)
+                {
+                }
+                state.suppress_next_mouse_move = false;
+            }
+        }
+
+        // Makes the calling thread per-monitor DPI aware for the scope. A window keeps the awareness of the thread
+        // that created it, so one created under this works in real pixels and gets WM_DPICHANGED whatever the
+        // process manifest says, and monitor queries made under it are not virtualized.
+        struct per_monitor_dpi_scope
+        {
+            DPI_AWARENESS_CONTEXT previous = SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+
+            per_monitor_dpi_scope() = default;
+            per_monitor_dpi_scope(const per_monitor_dpi_scope&) = delete;
+            per_monitor_dpi_scope& operator=(const per_monitor_dpi_scope&) = delete;
+
+            ~per_monitor_dpi_scope()
+            {
+                if (previous != nullptr)
+                {
+                    SetThreadDpiAwarenessContext(previous);
+                }
+            }
+        };
+
+        float scale_for_dpi(const UINT dpi) noexcept
+        {
+            return static_cast<float>(dpi) / static_cast<float>(USER_DEFAULT_SCREEN_DPI);
+        }
+
+        UINT monitor_dpi(HMONITOR monitor) noexcept
+        {
+            UINT dpi_x = USER_DEFAULT_SCREEN_DPI;
+            UINT dpi_y = USER_DEFAULT_SCREEN_DPI;
+            return SUCCEEDED(GetDpiForMonitor(monitor, MDT_EFFECTIVE_DPI, &dpi_x, &dpi_y)) ? dpi_x : USER_DEFAULT_SCREEN_DPI;
+        }
+
+        // The window rectangle whose client area is width x height at dpi.
+        RECT window_rect_for_client(const std::uint32_t width, const std::uint32_t height, const UINT dpi) noexcept
+        {
+            RECT rectangle{
+                .left = 0,
+                .top = 0,
+                .right = static_cast<LONG>(width),
+                .bottom = static_cast<LONG>(height)
+            };
+            AdjustWindowRectExForDpi(&rectangle, WS_OVERLAPPEDWINDOW, FALSE, 0, dpi);
+            return rectangle;
+        }
+
+        // What only the display configuration API knows about a display, keyed by its GDI device name.
+        struct display_path
+        {
+            std::wstring device_name;
+            std::wstring monitor_name;
+            double refresh_rate{};
+            bool hdr_supported{};
+            bool hdr_enabled{};
+        };
+
+        std::vector<display_path> query_display_paths()
+        {
+            std::vector<DISPLAYCONFIG_PATH_INFO> paths;
+            std::vector<DISPLAYCONFIG_MODE_INFO> modes;
+            UINT32 path_count = 0;
+            UINT32 mode_count = 0;
+            LONG result = ERROR_INSUFFICIENT_BUFFER;
+            // The configuration can change between sizing the buffers and filling them.
+            while (result == ERROR_INSUFFICIENT_BUFFER)
+            {
+                if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &path_count, &mode_count) != ERROR_SUCCESS)
+                {
+                    return {};
+                }
+                paths.resize(path_count);
+                modes.resize(mode_count);
+                result = QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &path_count, paths.data(), &mode_count, modes.data(), nullptr);
+            }
+            if (result != ERROR_SUCCESS)
+            {
+                return {};
+            }
+            paths.resize(path_count);
+
+            std::vector<display_path> displays;
+            displays.reserve(paths.size());
+            for (const auto& path : paths)
+            {
+                DISPLAYCONFIG_SOURCE_DEVICE_NAME source{};
+                source.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+                source.header.size = sizeof(source);
+                source.header.adapterId = path.sourceInfo.adapterId;
+                source.header.id = path.sourceInfo.id;
+                if (DisplayConfigGetDeviceInfo(&source.header) != ERROR_SUCCESS)
+                {
+                    continue;
+                }
+
+                // Kept as the exact fraction the mode is timed at, e.g. 60000/1001.
+                display_path entry{.device_name = source.viewGdiDeviceName};
+                const auto& rate = path.targetInfo.refreshRate;
+                if (rate.Denominator != 0)
+                {
+                    entry.refresh_rate = static_cast<double>(rate.Numerator) / static_cast<double>(rate.Denominator);
+                }
+
+                DISPLAYCONFIG_TARGET_DEVICE_NAME target{};
+                target.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_NAME;
+                target.header.size = sizeof(target);
+                target.header.adapterId = path.targetInfo.adapterId;
+                target.header.id = path.targetInfo.id;
+                if (DisplayConfigGetDeviceInfo(&target.header) == ERROR_SUCCESS)
+                {
+                    entry.monitor_name = target.monitorFriendlyDeviceName;
+                }
+
+                DISPLAYCONFIG_GET_ADVANCED_COLOR_INFO color{};
+                color.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_ADVANCED_COLOR_INFO;
+                color.header.size = sizeof(color);
+                color.header.adapterId = path.targetInfo.adapterId;
+                color.header.id = path.targetInfo.id;
+                if (DisplayConfigGetDeviceInfo(&color.header) == ERROR_SUCCESS)
+                {
+                    entry.hdr_supported = color.advancedColorSupported != 0;
+                    entry.hdr_enabled = color.advancedColorEnabled != 0;
+                }
+                displays.push_back(std::move(entry));
+            }
+            return displays;
+        }
+
+        // Call under per_monitor_dpi_scope, or a DPI-unaware thread sees scaled-down monitors.
+        display_info describe_monitor(HMONITOR monitor, const std::vector<display_path>& paths)
+        {
+            MONITORINFOEXW info{};
+            info.cbSize = sizeof(info);
+            if (GetMonitorInfoW(monitor, &info) == 0)
+            {
+                throw except::window_error{"Failed to query a display. Windows error code: " + std::to_string(GetLastError())};
+            }
+
+            const std::wstring_view device_name{info.szDevice};
+            const auto path = std::ranges::find(paths, device_name, &display_path::device_name);
+            const std::wstring_view name = path != paths.end() && !path->monitor_name.empty()
+                ? std::wstring_view{path->monitor_name}
+                : device_name;
+            display_info display{
+                .id = std::hash<std::wstring_view>{}(device_name),
+                .name = to_utf8(std::u16string_view{reinterpret_cast<const char16_t*>(name.data()), name.size()}),
+                .x = info.rcMonitor.left,
+                .y = info.rcMonitor.top,
+                .width = static_cast<std::uint32_t>(info.rcMonitor.right - info.rcMonitor.left),
+                .height = static_cast<std::uint32_t>(info.rcMonitor.bottom - info.rcMonitor.top),
+                .refresh_rate = path != paths.end() ? path->refresh_rate : 0.0,
+                .scale = scale_for_dpi(monitor_dpi(monitor)),
+                .primary = (info.dwFlags & MONITORINFOF_PRIMARY) != 0,
+                .hdr_supported = path != paths.end() && path->hdr_supported,
+                .hdr_enabled = path != paths.end() && path->hdr_enabled
+            };
+
+            // Without a display configuration path only the whole-hertz rate is known; 0 and 1 mean the default.
+            DEVMODEW mode{};
+            mode.dmSize = sizeof(mode);
+            if (display.refresh_rate == 0.0 && EnumDisplaySettingsW(info.szDevice, ENUM_CURRENT_SETTINGS, &mode) != 0 &&
+                mode.dmDisplayFrequency > 1)
+            {
+                display.refresh_rate = mode.dmDisplayFrequency;
+            }
+            return display;
+        }
+
+        BOOL CALLBACK collect_monitor(HMONITOR monitor, HDC, LPRECT, const LPARAM data) noexcept
+        {
+            try
+            {
+                reinterpret_cast<std::vector<HMONITOR>*>(data)->push_back(monitor);
+                return TRUE;
+            }
+            catch (...)
+            {
+                return FALSE;
+            }
+        }
+
+        // PeekMessageW also delivers sent messages, and DefWindowProcW is where the OS runs its modal size/move and
+        // menu loops, so both count as time in the OS.
+        bool peek_message(MSG& message) noexcept
+        {
+            const section_timer timer{timed_section::os};
+            return PeekMessageW(&message, nullptr, 0, 0, PM_REMOVE) != 0;
+        }
+
+        LRESULT default_window_proc(HWND hwnd, const UINT message, const WPARAM wparam, const LPARAM lparam)
+        {
+            const section_timer timer{timed_section::os};
+            return DefWindowProcW(hwnd, message, wparam, lparam);
+        }
+
+        void create_native_window(window_state& state, const wchar_t* title, const std::uint32_t width,
+                                  const std::uint32_t height)
+        {
+            HINSTANCE instance = GetModuleHandleW(nullptr);
+            register_window_class(instance);
+            state.instance = instance;
+
+            // New windows open on the primary display unless the shell places them elsewhere, so the frame is sized
+            // for its DPI and corrected below for any other.
+            const per_monitor_dpi_scope dpi_scope;
+            const UINT initial_dpi = monitor_dpi(MonitorFromPoint(POINT{0, 0}, MONITOR_DEFAULTTOPRIMARY));
+            const RECT rectangle = window_rect_for_client(width, height, initial_dpi);
+
+            const HWND hwnd = CreateWindowExW(
+                0,
+                window_class_name,
+                title,
+                WS_OVERLAPPEDWINDOW,
+                CW_USEDEFAULT,
+                CW_USEDEFAULT,
+                rectangle.right - rectangle.left,
+                rectangle.bottom - rectangle.top,
+                nullptr,
+                nullptr,
+                instance,
+                &state
+            );
+
+            if (hwnd == nullptr)
+            {
+                throw except::window_error{"Failed to create window. Windows error code: " + std::to_string(GetLastError())};
+            }
+
+            const UINT dpi = GetDpiForWindow(hwnd);
+            state.dpi = dpi;
+            if (dpi != initial_dpi)
+            {
+                const RECT adjusted = window_rect_for_client(width, height, dpi);
+                SetWindowPos(hwnd, nullptr, 0, 0, adjusted.right - adjusted.left, adjusted.bottom - adjusted.top,
+                             SWP_NOMOVE | SWP_NOZORDER | SWP_NOACTIVATE);
+            }
+        }
+
+        // Body of a threaded window's pump thread. The window is created here so its messages are queued to this
+        // thread; the loop exits on the WM_QUIT posted from WM_DESTROY. title belongs to create(), which waits on
+        // created, so it is not touched after that.
+        void run_pump_thread(window_state& state, const wchar_t* title, const std::uint32_t width,
+                             const std::uint32_t height, std::promise<void>& created)
+        {
+            try
+            {
+                create_native_window(state, title, width, height);
+            }
+            catch (...)
+            {
+                created.set_exception(std::current_exception());
+                return;
+            }
+            created.set_value();
+
+            MSG message{};
+            for (;;)
+            {
+                {
+                    const section_timer pump_timer{timed_section::pump};
+                    while (peek_message(message))
+                    {
+                        if (message.message == WM_QUIT)
+                        {
+                            publish_events(state);
+                            return;
+                        }
+                        TranslateMessage(&message);
+                        DispatchMessageW(&message);
+                    }
+                    publish_events(state);
+                }
+                WaitMessage();
+            }
+        }
     } // namespace
 
+    std::vector<display_info> enumerate_displays()
+    {
+        const per_monitor_dpi_scope dpi_scope;
+        std::vector<HMONITOR> monitors;
+        if (EnumDisplayMonitors(nullptr, nullptr, collect_monitor, reinterpret_cast<LPARAM>(&monitors)) == 0)
+        {
+            throw except::window_error{"Failed to enumerate displays."};
+        }
+
+        const auto paths = query_display_paths();
+        std::vector<display_info> displays;
+        displays.reserve(monitors.size());
+        for (HMONITOR monitor : monitors)
+        {
+            displays.push_back(describe_monitor(monitor, paths));
+        }
+        std::stable_partition(displays.begin(), displays.end(), [](const display_info& info) { return info.primary; });
+        return displays;
+    }
+
+    // The state lives inside impl, so a window takes one allocation besides its event ring.
     struct window::impl
     {
-        std::unique_ptr<window_state> state{std::make_unique<window_state>()};
+        explicit impl(const window_options& options)
+            : state(options)
+        {
+        }
+
+        window_state state;
     };
 
     window::window(std::unique_ptr<impl>&& impl) noexcept
@@ -252,62 +868,124 @@ namespace detri
             return DefWindowProcW(hwnd, message, wparam, lparam);
         }
 
-        if (const auto hook = g_native_message_hook.load(std::memory_order_acquire); hook != nullptr)
+        if (LRESULT hooked = 0; run_message_hooks(hwnd, message, wparam, lparam, hooked))
         {
-            (void)hook(
-                hwnd,
-                static_cast<std::uint32_t>(message),
-                static_cast<std::uintptr_t>(wparam),
-                static_cast<std::intptr_t>(lparam));
+            return hooked;
         }
 
+        // Taken at dispatch rather than from GetMessageTime(), whose tick-count resolution (10-16 ms) is coarser than
+        // the delay between the OS posting a message and us pumping it.
+        const auto timestamp = platform_clock::now();
+
         switch (message)
         {
             case WM_CLOSE:
                 state->is_open = false;
-                state->events.emplace(close_event{});
+                state->events.push(close_event{.timestamp = timestamp});
                 DestroyWindow(hwnd);
                 return 0;
             case WM_DESTROY:
                 state->is_open = false;
+                if (state->threaded)
+                {
+                    PostQuitMessage(0);
+                }
+                return 0;
+            case destroy_window_message:
+                apply_cursor_mode(*state, cursor_mode::normal);
+                DestroyWindow(hwnd);
                 return 0;
+            case set_cursor_mode_message:
+            {
+                auto* request = reinterpret_cast<cursor_mode_request*>(lparam);
+                try
+                {
+                    apply_cursor_mode(*state, request->mode);
+                }
+                catch (...)
+                {
+                    request->error = std::current_exception();
+                }
+                return 0;
+            }
             case WM_SIZE:
-                state->events.emplace(resize_event{
+                state->events.push(resize_event{
                     .width = static_cast<std::uint32_t>(LOWORD(lparam)),
-                    .height = static_cast<std::uint32_t>(HIWORD(lparam))
+                    .height = static_cast<std::uint32_t>(HIWORD(lparam)),
+                    .timestamp = timestamp
                 });
                 return 0;
+            case WM_DPICHANGED:
+            {
+                // Queued ahead of the resize that moving to the suggested rectangle causes, so the new scale is known
+                // by the time the new size is.
+                const UINT dpi = HIWORD(wparam);
+                state->dpi = dpi;
+                state->events.push(dpi_changed_event{.scale = scale_for_dpi(dpi), .timestamp = timestamp});
+                const auto* suggested = reinterpret_cast<const RECT*>(lparam);
+                SetWindowPos(hwnd, nullptr, suggested->left, suggested->top, suggested->right - suggested->left,
+                             suggested->bottom - suggested->top, SWP_NOZORDER | SWP_NOACTIVATE);
+                return 0;
+            }
+            case WM_DISPLAYCHANGE:
+                state->events.push(display_changed_event{.timestamp = timestamp});
+                return 0;
             case WM_ENTERSIZEMOVE:
-                state->events.emplace(resize_begin_event{});
+                state->events.push(resize_begin_event{.timestamp = timestamp});
+                if (state->threaded)
+                {
+                    publish_events(*state);
+                    SetTimer(hwnd, size_move_flush_timer, USER_TIMER_MINIMUM, nullptr);
+                }
                 return 0;
             case WM_EXITSIZEMOVE:
-                state->events.emplace(resize_end_event{});
+                if (state->threaded)
+                {
+                    KillTimer(hwnd, size_move_flush_timer);
+                }
+                state->events.push(resize_end_event{.timestamp = timestamp});
+                return 0;
+            case WM_TIMER:
+                if (wparam == size_move_flush_timer)
+                {
+                    publish_events(*state);
+                    return 0;
+                }
+                return default_window_proc(hwnd, message, wparam, lparam);
+            case WM_KILLFOCUS:
+                // Keys still held send their WM_KEYUP to whichever window has focus now.
+                state->events.push(focus_lost_event{.timestamp = timestamp});
                 return 0;
             case WM_KEYDOWN:
             case WM_SYSKEYDOWN:
-                state->events.emplace(key_event{
-                    .value = map_key(wparam),
+                state->events.push(key_event{
+                    .value = key_translation::from_win32_message(wparam, lparam),
                     .pressed = true,
-                    .repeated = (lparam & (1LL << 30)) != 0
+                    .repeated = (lparam & (1LL << 30)) != 0,
+                    .timestamp = timestamp
                 });
                 return 0;
             case WM_KEYUP:
             case WM_SYSKEYUP:
-                state->events.emplace(key_event{
-                    .value = map_key(wparam),
+                state->events.push(key_event{
+                    .value = key_translation::from_win32_message(wparam, lparam),
                     .pressed = false,
-                    .repeated = false
+                    .repeated = false,
+                    .timestamp = timestamp
                 });
                 return 0;
             case WM_MOUSEMOVE:
             {
                 const std::int32_t x = GET_X_LPARAM(lparam);
                 const std::int32_t y = GET_Y_LPARAM(lparam);
-                state->events.emplace(mouse_move_event{
+                state->events.push(mouse_move_event{
                     .x = x,
-                    .y = y
+                    .y = y,
+                    .timestamp = timestamp
                 });
-                if (state->cursor == cursor_mode::captured_hidden)
+                // With raw input registered, deltas come from WM_INPUT; the re-centering below is only the fallback
+                // for when RegisterRawInputDevices was refused.
+                if (state->cursor == cursor_mode::captured_hidden && !state->raw_input)
                 {
                     if (state->suppress_next_mouse_move)
                     {
@@ -324,9 +1002,10 @@ namespace detri
                         const std::int32_t dy = y - center_y;
                         if (dx != 0 || dy != 0)
                         {
-                            state->events.emplace(mouse_delta_event{
+                            state->events.push(mouse_delta_event{
                                 .dx = dx,
-                                .dy = dy
+                                .dy = dy,
+                                .timestamp = timestamp
                             });
                             POINT center{
                                 .x = center_x,
@@ -340,6 +1019,22 @@ namespace detri
                 }
                 return 0;
             }
+            case WM_INPUT:
+            {
+                if (state->raw_input)
+                {
+                    RAWINPUT input{};
+                    UINT size = sizeof(input);
+                    if (GetRawInputData(reinterpret_cast<HRAWINPUT>(lparam), RID_INPUT, &input, &size,
+                                        sizeof(RAWINPUTHEADER)) != static_cast<UINT>(-1))
+                    {
+                        read_raw_mouse(*state, input, timestamp);
+                    }
+                    drain_raw_input_buffer(*state, timestamp);
+                }
+                // DefWindowProcW releases the raw input handle for foreground (RIM_INPUT) packets.
+                return default_window_proc(hwnd, message, wparam, lparam);
+            }
             case WM_LBUTTONDOWN:
             case WM_LBUTTONUP:
             case WM_RBUTTONDOWN:
@@ -348,161 +1043,273 @@ namespace detri
             case WM_MBUTTONUP:
             case WM_XBUTTONDOWN:
             case WM_XBUTTONUP:
-                state->events.emplace(mouse_button_event{
+                state->events.push(mouse_button_event{
                     .button = map_mouse_button(message, wparam),
                     .pressed = message == WM_LBUTTONDOWN || message == WM_RBUTTONDOWN || message == WM_MBUTTONDOWN ||
                                message == WM_XBUTTONDOWN,
                     .x = GET_X_LPARAM(lparam),
-                    .y = GET_Y_LPARAM(lparam)
+                    .y = GET_Y_LPARAM(lparam),
+                    .timestamp = timestamp
                 });
                 return 0;
             default:
-                return DefWindowProcW(hwnd, message, wparam, lparam);
+                return default_window_proc(hwnd, message, wparam, lparam);
         }
     }
 
-    window window::create(const std::string& title, const std::uint32_t width, const std::uint32_t height)
+    window window::create(const std::string_view title, const std::uint32_t width, const std::uint32_t height,
+                          const window_options& options)
     {
-        const auto wide_title = to_wstring(title);
+        const native_string native_title{title};
         if (width == 0 || height == 0)
         {
             throw except::window_error{"Window dimensions must be greater than zero."};
         }
 
-        auto impl = std::make_unique<window::impl>();
-        HINSTANCE instance = GetModuleHandleW(nullptr);
-        register_window_class(instance);
-        impl->state->instance = instance;
-
-        RECT rectangle{};
-        rectangle.left = 0;
-        rectangle.top = 0;
-        rectangle.right = static_cast<LONG>(width);
-        rectangle.bottom = static_cast<LONG>(height);
-        AdjustWindowRectEx(&rectangle, WS_OVERLAPPEDWINDOW, FALSE, 0);
-
-        impl->state->hwnd = CreateWindowExW(
-            0,
-            window_class_name,
-            wide_title.c_str(),
-            WS_OVERLAPPEDWINDOW,
-            CW_USEDEFAULT,
-            CW_USEDEFAULT,
-            rectangle.right - rectangle.left,
-            rectangle.bottom - rectangle.top,
-            nullptr,
-            nullptr,
-            instance,
-            impl->state.get()
-        );
+        auto impl = std::make_unique<window::impl>(options);
 
-        if (impl->state->hwnd == nullptr)
+        if (!options.threaded_pump)
         {
-            throw except::window_error{"Failed to create window. Windows error code: " + std::to_string(GetLastError())};
+            create_native_window(impl->state, native_title.c_str(), width, height);
+            return window{std::move(impl)};
         }
 
-        return window{std::move(impl)};
-    }
-
-    std::wstring to_wstring(const std::string& str)
-    {
-        if (str.empty())
+        impl->state.threaded = true;
+        impl->state.events_published = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        if (impl->state.events_published == nullptr)
         {
-            return {};
+            throw except::window_error{"Failed to create an event. Windows error code: " + std::to_string(GetLastError())};
         }
-        std::wstring wstr;
-
-        const int required_size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0);
+        std::promise<void> created;
+        auto created_future = created.get_future();
+        impl->state.pump_thread = std::thread(
+            [state = &impl->state, title = native_title.c_str(), width, height,
+             created = std::move(created)]() mutable {
+                run_pump_thread(*state, title, width, height, created);
+            });
 
-        if (required_size == 0)
+        try
         {
-            throw except::string_conversion_error{"Couldn't convert UTF-8 to UTF-16. Windows error code: " + std::to_string(GetLastError())};
+            created_future.get();
         }
-
-        wstr.resize(required_size);
-
-        int converted_size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &wstr[0], required_size);
-
-        if (converted_size == 0)
+        catch (...)
         {
-            throw except::string_conversion_error{"Couldn't convert UTF-8 to UTF-16. Windows error code: " + std::to_string(GetLastError())};
+            impl->state.pump_thread.join();
+            CloseHandle(impl->state.events_published);
+            throw;
         }
 
-        return wstr;
+        return window{std::move(impl)};
     }
 
     window::~window()
     {
-        if (m_impl != nullptr && m_impl->state != nullptr && m_impl->state->hwnd != nullptr && IsWindow(m_impl->state->hwnd)
-            != 0)
+        if (m_impl != nullptr && m_impl->state.hwnd != nullptr && IsWindow(m_impl->state.hwnd) != 0)
         {
-            if (m_impl->state->cursor == cursor_mode::captured_hidden)
+            if (m_impl->state.threaded)
             {
-                set_cursor_mode(cursor_mode::normal);
+                SendMessageW(m_impl->state.hwnd, destroy_window_message, 0, 0);
             }
-            DestroyWindow(m_impl->state->hwnd);
+            else
+            {
+                apply_cursor_mode(m_impl->state, cursor_mode::normal);
+                DestroyWindow(m_impl->state.hwnd);
+            }
+        }
+
+        if (m_impl != nullptr && m_impl->state.pump_thread.joinable())
+        {
+            m_impl->state.pump_thread.join();
+        }
+        if (m_impl != nullptr && m_impl->state.events_published != nullptr)
+        {
+            CloseHandle(m_impl->state.events_published);
         }
     }
 
     window::window(window&&) noexcept = default;
 
-    window& window::operator=(window&&) noexcept = default;
+    window& window::operator=(window&& other) noexcept
+    {
+        if (this != &other)
+        {
+            window discarded{std::move(m_impl)};
+            m_impl = std::move(other.m_impl);
+        }
+        return *this;
+    }
 
     bool window::is_open() const noexcept
     {
-        return m_impl != nullptr && m_impl->state != nullptr && m_impl->state->is_open;
+        return m_impl != nullptr && m_impl->state.is_open;
     }
 
     void window::request_close() const noexcept
     {
-        if (m_impl != nullptr && m_impl->state != nullptr && m_impl->state->hwnd != nullptr && IsWindow(m_impl->state->hwnd)
-            != 0)
+        if (m_impl != nullptr && m_impl->state.hwnd != nullptr && IsWindow(m_impl->state.hwnd) != 0)
         {
-            PostMessageW(m_impl->state->hwnd, WM_CLOSE, 0, 0);
+            PostMessageW(m_impl->state.hwnd, WM_CLOSE, 0, 0);
         }
     }
 
     void window::show() const noexcept
     {
-        if (m_impl != nullptr && m_impl->state != nullptr && m_impl->state->hwnd != nullptr)
+        if (m_impl != nullptr && m_impl->state.hwnd != nullptr)
+        {
+            ShowWindow(m_impl->state.hwnd, SW_SHOW);
+            UpdateWindow(m_impl->state.hwnd);
+        }
+    }
+
+    void window::set_title(const std::string_view title) const
+    {
+        if (m_impl == nullptr || m_impl->state.hwnd == nullptr)
+        {
+            throw except::window_error{"Cannot set the title of an invalid window."};
+        }
+
+        // A threaded window's title is set by its pump thread, which SetWindowTextW waits on through WM_SETTEXT.
+        const native_string native_title{title};
+        if (SetWindowTextW(m_impl->state.hwnd, native_title.c_str()) == 0)
         {
-            ShowWindow(m_impl->state->hwnd, SW_SHOW);
-            UpdateWindow(m_impl->state->hwnd);
+            throw except::window_error{"Failed to set window title. Windows error code: " + std::to_string(GetLastError())};
         }
     }
 
     void window::pump_messages()
     {
+        // A threaded window's messages are queued to its own thread, which publishes events as they arrive.
+        if (m_impl != nullptr && m_impl->state.threaded)
+        {
+            return;
+        }
+
+        const section_timer pump_timer{timed_section::pump};
         MSG message{};
-        while (PeekMessageW(&message, nullptr, 0, 0, PM_REMOVE) != 0)
+        while (peek_message(message))
         {
             TranslateMessage(&message);
             DispatchMessageW(&message);
         }
+
+        if (m_impl != nullptr)
+        {
+            m_impl->state.events.flush();
+        }
+    }
+
+    void window::flush_events()
+    {
+        // A threaded window's own pump thread is the only producer for its queue.
+        if (m_impl != nullptr && !m_impl->state.threaded)
+        {
+            m_impl->state.events.flush();
+        }
+    }
+
+    bool window::pumps_on_own_thread() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.threaded;
+    }
+
+    std::optional<std::size_t> window::wait_any(const std::span<const native_wait_handle> handles,
+                                                const platform_clock::duration timeout)
+    {
+        const auto deadline = deadline_after(timeout);
+        pump_messages();
+        if (m_impl == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        // A threaded window's input shows up as its published event, which goes last so the indexes of handles come
+        // back unchanged; an inline window's arrives on this thread's message queue. A closed window gets no more
+        // input, so only the handles are left to wait on.
+        auto& state = m_impl->state;
+        std::array<HANDLE, MAXIMUM_WAIT_OBJECTS> objects{};
+        if (handles.size() >= objects.size())
+        {
+            throw except::window_error{"Too many handles to wait on."};
+        }
+        std::copy(handles.begin(), handles.end(), objects.begin());
+        std::size_t count = handles.size();
+        if (state.threaded && state.is_open)
+        {
+            objects[count++] = state.events_published;
+        }
+
+        for (;;)
+        {
+            const auto ready_at = state.consumer.ready_at(state.events);
+            if (ready_at <= platform_clock::now())
+            {
+                return handles.size();
+            }
+
+            // Messages for other windows on the thread and ones that queue no event wake us too, and the loop goes
+            // back to sleep.
+            const bool messages = !state.threaded && state.is_open;
+            if (count == 0 && !messages)
+            {
+                return std::nullopt;
+            }
+            const auto ready = wait_objects(std::span{objects.data(), count}, std::min(deadline, ready_at),
+                                            state.wait_timer, messages);
+            if (ready.has_value() && *ready < handles.size())
+            {
+                return ready;
+            }
+            pump_messages();
+            if (!ready.has_value() && platform_clock::now() >= deadline)
+            {
+                return state.consumer.ready_at(state.events) <= platform_clock::now() ? std::optional{handles.size()}
+                                                                                       : std::nullopt;
+            }
+        }
+    }
+
+    native_wait_handle window::wait_handle() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.threaded ? m_impl->state.events_published
+                                                                                         : invalid_wait_handle;
     }
 
     std::optional<event> window::poll_event()
     {
         pump_messages();
-        if (m_impl == nullptr || m_impl->state == nullptr || m_impl->state->events.empty())
+        if (m_impl == nullptr)
         {
             return std::nullopt;
         }
 
-        event next_event = m_impl->state->events.front();
-        m_impl->state->events.pop();
-        return next_event;
+        return m_impl->state.consumer.poll(m_impl->state.events);
+    }
+
+    std::size_t window::drain_events(const std::span<event> out)
+    {
+        pump_messages();
+        return drain_queued(out);
+    }
+
+    std::size_t window::drain_queued(const std::span<event> out)
+    {
+        if (m_impl == nullptr)
+        {
+            return 0;
+        }
+
+        return m_impl->state.consumer.drain(m_impl->state.events, out);
     }
 
     window_size window::size() const noexcept
     {
-        if (m_impl == nullptr || m_impl->state == nullptr || m_impl->state->hwnd == nullptr)
+        if (m_impl == nullptr || m_impl->state.hwnd == nullptr)
         {
             return {};
         }
 
         RECT client_rect{};
-        if (GetClientRect(m_impl->state->hwnd, &client_rect) == 0)
+        if (GetClientRect(m_impl->state.hwnd, &client_rect) == 0)
         {
             return {};
         }
@@ -515,68 +1322,105 @@ namespace detri
         };
     }
 
-    void window::set_cursor_mode(const cursor_mode mode) const
+    float window::scale() const noexcept
     {
-        if (m_impl == nullptr || m_impl->state == nullptr || m_impl->state->hwnd == nullptr)
+        if (m_impl == nullptr)
         {
-            throw except::window_error{"Cannot set cursor mode on an invalid window."};
+            return 1.0f;
         }
-        if (m_impl->state->cursor == mode)
+
+        return scale_for_dpi(m_impl->state.dpi.load(std::memory_order_relaxed));
+    }
+
+    display_info window::display() const
+    {
+        if (m_impl == nullptr || m_impl->state.hwnd == nullptr)
         {
-            return;
+            throw except::window_error{"Cannot query the display of an invalid window."};
         }
 
-        m_impl->state->cursor = mode;
-        HWND hwnd = m_impl->state->hwnd;
+        const per_monitor_dpi_scope dpi_scope;
+        return describe_monitor(MonitorFromWindow(m_impl->state.hwnd, MONITOR_DEFAULTTONEAREST), query_display_paths());
+    }
 
-        if (mode == cursor_mode::captured_hidden)
+    const keyboard_state& window::keyboard() const noexcept
+    {
+        static const keyboard_state released{};
+        if (m_impl == nullptr)
         {
-            while (ShowCursor(FALSE) >= 0)
-            {
-            }
+            return released;
+        }
 
-            RECT client{};
-            if (GetClientRect(hwnd, &client) == 0)
-            {
-                throw except::window_error{"GetClientRect failed while enabling captured cursor mode."};
-            }
-            POINT tl{client.left, client.top};
-            POINT br{client.right, client.bottom};
-            ClientToScreen(hwnd, &tl);
-            ClientToScreen(hwnd, &br);
-            RECT clip_rect{tl.x, tl.y, br.x, br.y};
-            if (ClipCursor(&clip_rect) == 0)
-            {
-                throw except::window_error{"ClipCursor failed while enabling captured cursor mode."};
-            }
+        return m_impl->state.consumer.keyboard;
+    }
 
-            const std::int32_t center_x = (client.right - client.left) / 2;
-            const std::int32_t center_y = (client.bottom - client.top) / 2;
-            POINT center{
-                .x = center_x,
-                .y = center_y
-            };
-            ClientToScreen(hwnd, &center);
-            m_impl->state->suppress_next_mouse_move = true;
-            SetCursorPos(center.x, center.y);
+    void window::record_input(input_recorder* recorder) noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.consumer.recorder = recorder;
         }
-        else
+    }
+
+    void window::replay_input(input_replayer* replayer) noexcept
+    {
+        if (m_impl != nullptr)
         {
-            ClipCursor(nullptr);
-            while (ShowCursor(TRUE) < 0)
-            {
-            }
-            m_impl->state->suppress_next_mouse_move = false;
+            m_impl->state.consumer.replayer = replayer;
+        }
+    }
+
+    event_queue_stats window::event_stats() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return m_impl->state.events.stats();
+    }
+
+    void window::set_event_coalescing(const bool enabled) const noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.events.set_coalescing(enabled);
+        }
+    }
+
+    bool window::event_coalescing() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.events.coalescing();
+    }
+
+    void window::set_cursor_mode(const cursor_mode mode) const
+    {
+        if (m_impl == nullptr || m_impl->state.hwnd == nullptr)
+        {
+            throw except::window_error{"Cannot set cursor mode on an invalid window."};
+        }
+
+        if (!m_impl->state.threaded)
+        {
+            apply_cursor_mode(m_impl->state, mode);
+            return;
+        }
+
+        cursor_mode_request request{.mode = mode, .error = nullptr};
+        SendMessageW(m_impl->state.hwnd, set_cursor_mode_message, 0, reinterpret_cast<LPARAM>(&request));
+        if (request.error != nullptr)
+        {
+            std::rethrow_exception(request.error);
         }
     }
 
     cursor_mode window::get_cursor_mode() const noexcept
     {
-        if (m_impl == nullptr || m_impl->state == nullptr)
+        if (m_impl == nullptr)
         {
             return cursor_mode::normal;
         }
-        return m_impl->state->cursor;
+        return m_impl->state.cursor;
     }
 
     void* window::native_handle() const noexcept
@@ -586,20 +1430,20 @@ namespace detri
             return nullptr;
         }
 
-        return m_impl->state == nullptr ? nullptr : m_impl->state->hwnd;
+        return m_impl->state.hwnd;
     }
 
-#if defined(_WIN32)
+#ifdef DETRI_PLATFORM_WIN32
     window::native_win32_handle window::native_win32() const noexcept
     {
-        if (m_impl == nullptr || m_impl->state == nullptr)
+        if (m_impl == nullptr)
         {
             return {};
         }
 
         return {
-            .hwnd = m_impl->state->hwnd,
-            .hinstance = m_impl->state->instance
+            .hwnd = m_impl->state.hwnd,
+            .hinstance = m_impl->state.instance
         };
     }
 #endif
@@ -0,0 +1,1173 @@
+#include "detri/window.hpp"
+#include "detri/event_consumer.hpp"
+#include "detri/high_resolution_timer.hpp"
+#include "detri/key_translation.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "detri/thread_counters.hpp"
+
+#include <xcb/xcb.h>
+#include <xcb/randr.h>
+#include <xcb/xcb_keysyms.h>
+#include <xcb/xinput.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace detri
+{
+    namespace
+    {
+        mouse_button map_mouse_button(const xcb_button_t button) noexcept
+        {
+            switch (button)
+            {
+                case XCB_BUTTON_INDEX_1:
+                    return mouse_button::left;
+                case XCB_BUTTON_INDEX_2:
+                    return mouse_button::middle;
+                case XCB_BUTTON_INDEX_3:
+                    return mouse_button::right;
+                case 8:
+                    return mouse_button::x1;
+                case 9:
+                    return mouse_button::x2;
+                default:
+                    return mouse_button::unknown;
+            }
+        }
+
+        // The X server stamps input with its own millisecond clock, which on Linux is CLOCK_MONOTONIC like
+        // platform_clock. A remote or otherwise unrelated server clock shows up as an implausible age and falls back
+        // to the time we dispatched the event.
+        platform_clock::time_point server_timestamp(const xcb_timestamp_t milliseconds) noexcept
+        {
+            const auto now = platform_clock::now();
+            const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
+            const std::uint32_t age = static_cast<std::uint32_t>(now_ms.count()) - milliseconds;
+            if (age >= 1000)
+            {
+                return now;
+            }
+            return platform_clock::time_point{now_ms - std::chrono::milliseconds{age}};
+        }
+
+        struct window_state
+        {
+            explicit window_state(const window_options& options)
+                : events(options.event_capacity, options.overflow_policy)
+            {
+                events.set_coalescing(options.coalesce_events);
+            }
+
+            xcb_window_t window{XCB_NONE};
+            window_size client{};
+            double delta_remainder_x{};
+            double delta_remainder_y{};
+            bool is_open{true};
+            bool close_requested{false};
+            cursor_mode cursor{cursor_mode::normal};
+            event_queue events;
+            // Only touched by the thread that consumes events.
+            event_consumer consumer;
+        };
+
+        // One connection is shared by every window on the process, the same way every HWND on a thread shares one
+        // Win32 message queue. Pumping any window drains the whole connection and routes events by window id.
+        struct xcb_context
+        {
+            xcb_connection_t* connection{};
+            xcb_screen_t* screen{};
+            xcb_key_symbols_t* key_symbols{};
+            xcb_atom_t wm_protocols{XCB_NONE};
+            xcb_atom_t wm_delete_window{XCB_NONE};
+            // EWMH's UTF-8 title; WM_NAME is Latin-1.
+            xcb_atom_t net_wm_name{XCB_NONE};
+            xcb_atom_t utf8_string{XCB_NONE};
+            xcb_cursor_t hidden_cursor{XCB_NONE};
+            std::uint8_t xinput_opcode{};
+            bool has_xinput2{false};
+            // RandR 1.5, for monitors. Without it the whole screen counts as one display.
+            std::uint8_t randr_first_event{};
+            bool has_randr{false};
+            // X11 has one scale for every monitor, from the Xft.dpi resource desktops set for their scaling factor.
+            float scale{1.0f};
+            // Set while dispatching and acted on once at the end of the pump, since one change arrives as a burst.
+            bool displays_changed{false};
+            bool resources_changed{false};
+            window_state* captured{};
+            std::unordered_map<xcb_window_t, window_state*> windows;
+            std::uint32_t references{};
+        };
+
+        xcb_context g_context;
+
+        xcb_atom_t intern_atom(xcb_connection_t* connection, const char* name)
+        {
+            const auto cookie = xcb_intern_atom(connection, 0, static_cast<std::uint16_t>(std::strlen(name)), name);
+            auto* reply = xcb_intern_atom_reply(connection, cookie, nullptr);
+            if (reply == nullptr)
+            {
+                throw except::window_error{std::string{"Failed to intern X11 atom "} + name + "."};
+            }
+            const xcb_atom_t atom = reply->atom;
+            std::free(reply);
+            return atom;
+        }
+
+        // X11 takes the title as counted UTF-8, so it goes out as given without a copy. Window managers that predate
+        // _NET_WM_NAME read WM_NAME, where anything beyond ASCII shows up garbled.
+        void set_window_title(const xcb_context& context, const xcb_window_t id, const std::string_view title)
+        {
+            const auto length = static_cast<std::uint32_t>(title.size());
+            xcb_change_property(context.connection, XCB_PROP_MODE_REPLACE, id, context.net_wm_name, context.utf8_string,
+                                8, length, title.data());
+            xcb_change_property(context.connection, XCB_PROP_MODE_REPLACE, id, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                                length, title.data());
+        }
+
+        void query_xinput2(xcb_context& context)
+        {
+            const auto* extension = xcb_get_extension_data(context.connection, &xcb_input_id);
+            if (extension == nullptr || extension->present == 0)
+            {
+                return;
+            }
+
+            const auto cookie = xcb_input_xi_query_version(context.connection, 2, 0);
+            auto* reply = xcb_input_xi_query_version_reply(context.connection, cookie, nullptr);
+            if (reply == nullptr)
+            {
+                return;
+            }
+            context.has_xinput2 = reply->major_version >= 2;
+            context.xinput_opcode = extension->major_opcode;
+            std::free(reply);
+        }
+
+        void query_randr(xcb_context& context)
+        {
+            const auto* extension = xcb_get_extension_data(context.connection, &xcb_randr_id);
+            if (extension == nullptr || extension->present == 0)
+            {
+                return;
+            }
+
+            const auto cookie = xcb_randr_query_version(context.connection, 1, 5);
+            auto* reply = xcb_randr_query_version_reply(context.connection, cookie, nullptr);
+            if (reply == nullptr)
+            {
+                return;
+            }
+            context.has_randr = reply->major_version > 1 || reply->minor_version >= 5;
+            context.randr_first_event = extension->first_event;
+            std::free(reply);
+
+            if (context.has_randr)
+            {
+                xcb_randr_select_input(context.connection, context.screen->root,
+                                       XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE | XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE |
+                                           XCB_RANDR_NOTIFY_MASK_CRTC_CHANGE);
+            }
+        }
+
+        float read_xft_scale(const xcb_context& context)
+        {
+            const auto cookie = xcb_get_property(context.connection, 0, context.screen->root, XCB_ATOM_RESOURCE_MANAGER,
+                                                 XCB_ATOM_STRING, 0, 16 * 1024);
+            auto* reply = xcb_get_property_reply(context.connection, cookie, nullptr);
+            if (reply == nullptr)
+            {
+                return 1.0f;
+            }
+
+            const std::string_view resources{static_cast<const char*>(xcb_get_property_value(reply)),
+                                             static_cast<std::size_t>(xcb_get_property_value_length(reply))};
+            constexpr std::string_view name = "Xft.dpi:";
+            float scale = 1.0f;
+            for (std::size_t line = 0; line < resources.size();)
+            {
+                const std::size_t end = std::min(resources.find('\n', line), resources.size());
+                const auto entry = resources.substr(line, end - line);
+                if (entry.starts_with(name))
+                {
+                    const std::string value{entry.substr(name.size())};
+                    if (const double dpi = std::strtod(value.c_str(), nullptr); dpi > 0.0)
+                    {
+                        scale = static_cast<float>(dpi / 96.0);
+                    }
+                    break;
+                }
+                line = end + 1;
+            }
+            std::free(reply);
+            return scale;
+        }
+
+        xcb_context& acquire_context()
+        {
+            if (g_context.references != 0)
+            {
+                ++g_context.references;
+                return g_context;
+            }
+
+            int screen_index = 0;
+            g_context.connection = xcb_connect(nullptr, &screen_index);
+            if (const int error = xcb_connection_has_error(g_context.connection); error != 0)
+            {
+                xcb_disconnect(g_context.connection);
+                g_context = {};
+                throw except::window_error{"Failed to connect to the X server. XCB error code: " + std::to_string(error)};
+            }
+
+            // Only counted once set up, so a failure here leaves nothing open for the next window to inherit.
+            try
+            {
+                auto screens = xcb_setup_roots_iterator(xcb_get_setup(g_context.connection));
+                for (int i = 0; i < screen_index; ++i)
+                {
+                    xcb_screen_next(&screens);
+                }
+                g_context.screen = screens.data;
+                g_context.key_symbols = xcb_key_symbols_alloc(g_context.connection);
+                g_context.wm_protocols = intern_atom(g_context.connection, "WM_PROTOCOLS");
+                g_context.wm_delete_window = intern_atom(g_context.connection, "WM_DELETE_WINDOW");
+                g_context.net_wm_name = intern_atom(g_context.connection, "_NET_WM_NAME");
+                g_context.utf8_string = intern_atom(g_context.connection, "UTF8_STRING");
+                query_xinput2(g_context);
+                query_randr(g_context);
+
+                // Desktops announce a new scaling factor by rewriting RESOURCE_MANAGER on the root window.
+                constexpr std::uint32_t root_events = XCB_EVENT_MASK_PROPERTY_CHANGE;
+                xcb_change_window_attributes(g_context.connection, g_context.screen->root, XCB_CW_EVENT_MASK, &root_events);
+                g_context.scale = read_xft_scale(g_context);
+            }
+            catch (...)
+            {
+                if (g_context.key_symbols != nullptr)
+                {
+                    xcb_key_symbols_free(g_context.key_symbols);
+                }
+                xcb_disconnect(g_context.connection);
+                g_context = {};
+                throw;
+            }
+
+            g_context.references = 1;
+            return g_context;
+        }
+
+        void release_context() noexcept
+        {
+            if (g_context.references == 0 || --g_context.references != 0)
+            {
+                return;
+            }
+
+            if (g_context.hidden_cursor != XCB_NONE)
+            {
+                xcb_free_cursor(g_context.connection, g_context.hidden_cursor);
+            }
+            xcb_key_symbols_free(g_context.key_symbols);
+            xcb_disconnect(g_context.connection);
+            g_context = {};
+        }
+
+        // Holds the connection open for queries made while no window might exist.
+        struct context_reference
+        {
+            xcb_context& context = acquire_context();
+
+            context_reference() = default;
+            context_reference(const context_reference&) = delete;
+            context_reference& operator=(const context_reference&) = delete;
+
+            ~context_reference()
+            {
+                release_context();
+            }
+        };
+
+        std::string atom_name(const xcb_context& context, const xcb_atom_t atom)
+        {
+            auto* reply = xcb_get_atom_name_reply(context.connection, xcb_get_atom_name(context.connection, atom), nullptr);
+            if (reply == nullptr)
+            {
+                return {};
+            }
+            std::string name{xcb_get_atom_name_name(reply), static_cast<std::size_t>(xcb_get_atom_name_name_length(reply))};
+            std::free(reply);
+            return name;
+        }
+
+        double mode_refresh_rate(const xcb_randr_mode_info_t& mode) noexcept
+        {
+            double lines = mode.vtotal;
+            if ((mode.mode_flags & XCB_RANDR_MODE_FLAG_DOUBLE_SCAN) != 0)
+            {
+                lines *= 2.0;
+            }
+            if ((mode.mode_flags & XCB_RANDR_MODE_FLAG_INTERLACE) != 0)
+            {
+                lines /= 2.0;
+            }
+            if (mode.htotal == 0 || lines == 0.0)
+            {
+                return 0.0;
+            }
+            return static_cast<double>(mode.dot_clock) / (static_cast<double>(mode.htotal) * lines);
+        }
+
+        // The refresh rate of the mode output's CRTC is showing, from its pixel clock and total raster size.
+        double output_refresh_rate(const xcb_context& context, const xcb_randr_get_screen_resources_current_reply_t* resources,
+                                   const xcb_randr_output_t output)
+        {
+            auto* output_info = xcb_randr_get_output_info_reply(
+                context.connection, xcb_randr_get_output_info(context.connection, output, resources->config_timestamp), nullptr);
+            if (output_info == nullptr)
+            {
+                return 0.0;
+            }
+            const xcb_randr_crtc_t crtc = output_info->crtc;
+            std::free(output_info);
+            if (crtc == XCB_NONE)
+            {
+                return 0.0;
+            }
+
+            auto* crtc_info = xcb_randr_get_crtc_info_reply(
+                context.connection, xcb_randr_get_crtc_info(context.connection, crtc, resources->config_timestamp), nullptr);
+            if (crtc_info == nullptr)
+            {
+                return 0.0;
+            }
+            const xcb_randr_mode_t mode = crtc_info->mode;
+            std::free(crtc_info);
+
+            const xcb_randr_mode_info_t* modes = xcb_randr_get_screen_resources_current_modes(resources);
+            const int count = xcb_randr_get_screen_resources_current_modes_length(resources);
+            for (int i = 0; i < count; ++i)
+            {
+                if (modes[i].id == mode)
+                {
+                    return mode_refresh_rate(modes[i]);
+                }
+            }
+            return 0.0;
+        }
+
+        std::vector<display_info> query_displays(const xcb_context& context)
+        {
+            std::vector<display_info> displays;
+            if (context.has_randr)
+            {
+                auto* resources = xcb_randr_get_screen_resources_current_reply(
+                    context.connection, xcb_randr_get_screen_resources_current(context.connection, context.screen->root),
+                    nullptr);
+                auto* monitors = xcb_randr_get_monitors_reply(
+                    context.connection, xcb_randr_get_monitors(context.connection, context.screen->root, 1), nullptr);
+                if (monitors != nullptr)
+                {
+                    for (auto it = xcb_randr_get_monitors_monitors_iterator(monitors); it.rem != 0; xcb_randr_monitor_info_next(&it))
+                    {
+                        const auto* monitor = it.data;
+                        display_info info{
+                            .id = monitor->name,
+                            .name = atom_name(context, monitor->name),
+                            .x = monitor->x,
+                            .y = monitor->y,
+                            .width = monitor->width,
+                            .height = monitor->height,
+                            .scale = context.scale,
+                            .primary = monitor->primary != 0
+                        };
+                        if (resources != nullptr && monitor->nOutput != 0)
+                        {
+                            info.refresh_rate = output_refresh_rate(context, resources, xcb_randr_monitor_info_outputs(monitor)[0]);
+                        }
+                        displays.push_back(std::move(info));
+                    }
+                }
+                std::free(monitors);
+                std::free(resources);
+            }
+
+            if (displays.empty())
+            {
+                displays.push_back({
+                    .id = context.screen->root,
+                    .name = "X11 screen",
+                    .width = context.screen->width_in_pixels,
+                    .height = context.screen->height_in_pixels,
+                    .scale = context.scale,
+                    .primary = true
+                });
+            }
+            std::stable_partition(displays.begin(), displays.end(), [](const display_info& info) { return info.primary; });
+            return displays;
+        }
+
+        xcb_cursor_t hidden_cursor(xcb_context& context)
+        {
+            if (context.hidden_cursor == XCB_NONE)
+            {
+                const xcb_pixmap_t pixmap = xcb_generate_id(context.connection);
+                xcb_create_pixmap(context.connection, 1, pixmap, context.screen->root, 1, 1);
+                context.hidden_cursor = xcb_generate_id(context.connection);
+                xcb_create_cursor(context.connection, context.hidden_cursor, pixmap, pixmap, 0, 0, 0, 0, 0, 0, 0, 0);
+                xcb_free_pixmap(context.connection, pixmap);
+            }
+            return context.hidden_cursor;
+        }
+
+        void select_raw_motion(xcb_context& context, const bool enabled)
+        {
+            struct
+            {
+                xcb_input_event_mask_t head;
+                std::uint32_t mask;
+            } event_mask{};
+            event_mask.head.deviceid = XCB_INPUT_DEVICE_ALL_MASTER;
+            event_mask.head.mask_len = 1;
+            event_mask.mask = enabled ? XCB_INPUT_XI_EVENT_MASK_RAW_MOTION : 0;
+            xcb_input_xi_select_events(context.connection, context.screen->root, 1, &event_mask.head);
+        }
+
+        window_state* find_window(const xcb_context& context, const xcb_window_t window) noexcept
+        {
+            const auto it = context.windows.find(window);
+            return it == context.windows.end() ? nullptr : it->second;
+        }
+
+        void handle_raw_motion(const xcb_context& context, const xcb_ge_generic_event_t* generic)
+        {
+            if (context.captured == nullptr)
+            {
+                return;
+            }
+
+            const auto* raw = reinterpret_cast<const xcb_input_raw_motion_event_t*>(generic);
+            const std::uint32_t* valuator_mask = xcb_input_raw_button_press_valuator_mask(raw);
+            const int mask_words = xcb_input_raw_button_press_valuator_mask_length(raw);
+            const xcb_input_fp3232_t* values = xcb_input_raw_button_press_axisvalues_raw(raw);
+
+            double axes[2]{};
+            for (int word = 0, value_index = 0; word < mask_words; ++word)
+            {
+                for (std::uint32_t bit = 0; bit < 32; ++bit)
+                {
+                    if ((valuator_mask[word] & (1U << bit)) == 0)
+                    {
+                        continue;
+                    }
+                    const std::uint32_t axis = static_cast<std::uint32_t>(word) * 32U + bit;
+                    if (axis < 2)
+                    {
+                        axes[axis] = values[value_index].integral + values[value_index].frac / 4294967296.0;
+                    }
+                    ++value_index;
+                }
+            }
+
+            // High-resolution devices report fractional raw motion; carry the remainder so it is not truncated away.
+            auto* state = context.captured;
+            state->delta_remainder_x += axes[0];
+            state->delta_remainder_y += axes[1];
+            const auto dx = static_cast<std::int32_t>(state->delta_remainder_x);
+            const auto dy = static_cast<std::int32_t>(state->delta_remainder_y);
+            state->delta_remainder_x -= dx;
+            state->delta_remainder_y -= dy;
+            if (dx != 0 || dy != 0)
+            {
+                context.captured->events.push(mouse_delta_event{
+                    .dx = dx,
+                    .dy = dy,
+                    .timestamp = server_timestamp(raw->time)
+                });
+            }
+        }
+
+        // X11 reports auto-repeat as a release immediately followed by a press with the same keycode and timestamp.
+        bool is_repeat_release(const xcb_key_release_event_t* release, const xcb_generic_event_t* next) noexcept
+        {
+            if (next == nullptr || (next->response_type & ~0x80) != XCB_KEY_PRESS)
+            {
+                return false;
+            }
+            const auto* press = reinterpret_cast<const xcb_key_press_event_t*>(next);
+            return press->detail == release->detail && press->time == release->time && press->event == release->event;
+        }
+
+        void dispatch_event(xcb_context& context, const xcb_generic_event_t* generic, xcb_generic_event_t*& lookahead)
+        {
+            switch (generic->response_type & ~0x80)
+            {
+                case XCB_CLIENT_MESSAGE:
+                {
+                    const auto* message = reinterpret_cast<const xcb_client_message_event_t*>(generic);
+                    auto* state = find_window(context, message->window);
+                    if (state != nullptr && message->type == context.wm_protocols &&
+                        message->data.data32[0] == context.wm_delete_window)
+                    {
+                        state->close_requested = true;
+                    }
+                    return;
+                }
+                case XCB_CONFIGURE_NOTIFY:
+                {
+                    const auto* configure = reinterpret_cast<const xcb_configure_notify_event_t*>(generic);
+                    auto* state = find_window(context, configure->window);
+                    if (state != nullptr && (configure->width != state->client.width || configure->height != state->client.height))
+                    {
+                        state->client = {
+                            .width = configure->width,
+                            .height = configure->height
+                        };
+                        state->events.push(resize_event{
+                            .width = configure->width,
+                            .height = configure->height,
+                            .timestamp = platform_clock::now()
+                        });
+                    }
+                    return;
+                }
+                case XCB_KEY_PRESS:
+                case XCB_KEY_RELEASE:
+                {
+                    const auto* key_message = reinterpret_cast<const xcb_key_press_event_t*>(generic);
+                    auto* state = find_window(context, key_message->event);
+                    if (state == nullptr)
+                    {
+                        return;
+                    }
+
+                    const bool pressed = (generic->response_type & ~0x80) == XCB_KEY_PRESS;
+                    bool repeated = false;
+                    if (!pressed)
+                    {
+                        if (lookahead == nullptr)
+                        {
+                            lookahead = xcb_poll_for_queued_event(context.connection);
+                        }
+                        if (is_repeat_release(key_message, lookahead))
+                        {
+                            std::free(lookahead);
+                            lookahead = nullptr;
+                            repeated = true;
+                        }
+                    }
+
+                    // X keycodes are evdev codes offset by 8 under both the evdev and libinput drivers.
+                    const auto keysym = xcb_key_symbols_get_keysym(context.key_symbols, key_message->detail, 0);
+                    state->events.push(key_event{
+                        .value = key_translation::from_x11_keysym(keysym, key_message->detail - 8U),
+                        .pressed = pressed || repeated,
+                        .repeated = repeated,
+                        .timestamp = server_timestamp(key_message->time)
+                    });
+                    return;
+                }
+                case XCB_FOCUS_OUT:
+                {
+                    // Also sent while a window manager grabs the keyboard, e.g. for alt-tab: either way the releases
+                    // of keys still held go elsewhere. Focus moving to a child or following the pointer is no loss.
+                    const auto* focus = reinterpret_cast<const xcb_focus_out_event_t*>(generic);
+                    auto* state = find_window(context, focus->event);
+                    if (state != nullptr && focus->detail != XCB_NOTIFY_DETAIL_INFERIOR &&
+                        focus->detail != XCB_NOTIFY_DETAIL_POINTER)
+                    {
+                        state->events.push(focus_lost_event{.timestamp = platform_clock::now()});
+                    }
+                    return;
+                }
+                case XCB_BUTTON_PRESS:
+                case XCB_BUTTON_RELEASE:
+                {
+                    const auto* button = reinterpret_cast<const xcb_button_press_event_t*>(generic);
+                    auto* state = find_window(context, button->event);
+                    const auto mapped = map_mouse_button(button->detail);
+                    if (state == nullptr || mapped == mouse_button::unknown)
+                    {
+                        return;
+                    }
+                    state->events.push(mouse_button_event{
+                        .button = mapped,
+                        .pressed = (generic->response_type & ~0x80) == XCB_BUTTON_PRESS,
+                        .x = button->event_x,
+                        .y = button->event_y,
+                        .timestamp = server_timestamp(button->time)
+                    });
+                    return;
+                }
+                case XCB_MOTION_NOTIFY:
+                {
+                    const auto* motion = reinterpret_cast<const xcb_motion_notify_event_t*>(generic);
+                    if (auto* state = find_window(context, motion->event); state != nullptr)
+                    {
+                        state->events.push(mouse_move_event{
+                            .x = motion->event_x,
+                            .y = motion->event_y,
+                            .timestamp = server_timestamp(motion->time)
+                        });
+                    }
+                    return;
+                }
+                case XCB_PROPERTY_NOTIFY:
+                {
+                    const auto* property = reinterpret_cast<const xcb_property_notify_event_t*>(generic);
+                    if (property->window == context.screen->root && property->atom == XCB_ATOM_RESOURCE_MANAGER)
+                    {
+                        context.resources_changed = true;
+                    }
+                    return;
+                }
+                case XCB_GE_GENERIC:
+                {
+                    const auto* ge = reinterpret_cast<const xcb_ge_generic_event_t*>(generic);
+                    if (context.has_xinput2 && ge->extension == context.xinput_opcode && ge->event_type == XCB_INPUT_RAW_MOTION)
+                    {
+                        handle_raw_motion(context, ge);
+                    }
+                    return;
+                }
+                default:
+                {
+                    const auto type = generic->response_type & ~0x80;
+                    if (context.has_randr && (type == context.randr_first_event + XCB_RANDR_SCREEN_CHANGE_NOTIFY ||
+                                              type == context.randr_first_event + XCB_RANDR_NOTIFY))
+                    {
+                        context.displays_changed = true;
+                    }
+                    return;
+                }
+            }
+        }
+
+        // Tells every window about display and scale changes the pump just saw, once each however many notifications
+        // they came as.
+        void publish_display_changes(xcb_context& context)
+        {
+            const bool displays_changed = std::exchange(context.displays_changed, false);
+            bool scale_changed = false;
+            if (std::exchange(context.resources_changed, false))
+            {
+                const float scale = read_xft_scale(context);
+                scale_changed = scale != context.scale;
+                context.scale = scale;
+            }
+            if (!displays_changed && !scale_changed)
+            {
+                return;
+            }
+
+            const auto now = platform_clock::now();
+            for (auto& [id, state] : context.windows)
+            {
+                if (displays_changed)
+                {
+                    state->events.push(display_changed_event{.timestamp = now});
+                }
+                if (scale_changed)
+                {
+                    state->events.push(dpi_changed_event{.scale = context.scale, .timestamp = now});
+                }
+            }
+        }
+    } // namespace
+
+    std::vector<display_info> enumerate_displays()
+    {
+        const context_reference reference;
+        return query_displays(reference.context);
+    }
+
+    // The state lives inside impl, so a window takes one allocation besides its event ring.
+    struct window::impl
+    {
+        explicit impl(const window_options& options)
+            : state(options)
+        {
+        }
+
+        window_state state;
+    };
+
+    window::window(std::unique_ptr<impl>&& impl) noexcept
+        : m_impl(std::move(impl))
+    {
+    }
+
+    window window::create(const std::string_view title, const std::uint32_t width, const std::uint32_t height,
+                          const window_options& options)
+    {
+        if (width == 0 || height == 0)
+        {
+            throw except::window_error{"Window dimensions must be greater than zero."};
+        }
+
+        auto impl = std::make_unique<window::impl>(options);
+        auto& context = acquire_context();
+
+        const xcb_window_t id = xcb_generate_id(context.connection);
+        constexpr std::uint32_t value_mask = XCB_CW_EVENT_MASK;
+        const std::uint32_t values[] = {
+            XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_BUTTON_PRESS |
+            XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION | XCB_EVENT_MASK_STRUCTURE_NOTIFY |
+            XCB_EVENT_MASK_FOCUS_CHANGE
+        };
+        const auto cookie = xcb_create_window_checked(
+            context.connection,
+            XCB_COPY_FROM_PARENT,
+            id,
+            context.screen->root,
+            0,
+            0,
+            static_cast<std::uint16_t>(width),
+            static_cast<std::uint16_t>(height),
+            0,
+            XCB_WINDOW_CLASS_INPUT_OUTPUT,
+            context.screen->root_visual,
+            value_mask,
+            values
+        );
+        if (auto* error = xcb_request_check(context.connection, cookie); error != nullptr)
+        {
+            const auto code = error->error_code;
+            std::free(error);
+            release_context();
+            throw except::window_error{"Failed to create window. X11 error code: " + std::to_string(code)};
+        }
+
+        set_window_title(context, id, title);
+        xcb_change_property(context.connection, XCB_PROP_MODE_REPLACE, id, context.wm_protocols, XCB_ATOM_ATOM, 32, 1,
+                            &context.wm_delete_window);
+
+        impl->state.window = id;
+        impl->state.client = {
+            .width = width,
+            .height = height
+        };
+        auto* state = &impl->state;
+
+        // From here ~window destroys the X window and releases the context if registering it throws.
+        window created{std::move(impl)};
+        context.windows.emplace(id, state);
+
+        return created;
+    }
+
+    window::~window()
+    {
+        if (m_impl == nullptr || m_impl->state.window == XCB_NONE)
+        {
+            return;
+        }
+
+        if (m_impl->state.cursor == cursor_mode::captured_hidden)
+        {
+            set_cursor_mode(cursor_mode::normal);
+        }
+        g_context.windows.erase(m_impl->state.window);
+        xcb_destroy_window(g_context.connection, m_impl->state.window);
+        xcb_flush(g_context.connection);
+        release_context();
+    }
+
+    window::window(window&&) noexcept = default;
+
+    window& window::operator=(window&& other) noexcept
+    {
+        if (this != &other)
+        {
+            window discarded{std::move(m_impl)};
+            m_impl = std::move(other.m_impl);
+        }
+        return *this;
+    }
+
+    bool window::is_open() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.is_open;
+    }
+
+    void window::request_close() const noexcept
+    {
+        if (m_impl != nullptr && m_impl->state.is_open)
+        {
+            m_impl->state.close_requested = true;
+        }
+    }
+
+    void window::show() const noexcept
+    {
+        if (m_impl != nullptr && m_impl->state.window != XCB_NONE)
+        {
+            xcb_map_window(g_context.connection, m_impl->state.window);
+            xcb_flush(g_context.connection);
+        }
+    }
+
+    void window::set_title(const std::string_view title) const
+    {
+        if (m_impl == nullptr || m_impl->state.window == XCB_NONE)
+        {
+            throw except::window_error{"Cannot set the title of an invalid window."};
+        }
+
+        set_window_title(g_context, m_impl->state.window, title);
+        xcb_flush(g_context.connection);
+    }
+
+    void window::pump_messages()
+    {
+        if (g_context.connection == nullptr)
+        {
+            return;
+        }
+
+        // A single read from the socket pulls in everything the server has sent so far; the rest of the batch is
+        // served from XCB's in-process queue without further syscalls.
+        const section_timer pump_timer{timed_section::pump};
+        xcb_generic_event_t* lookahead = nullptr;
+        xcb_generic_event_t* next = nullptr;
+        {
+            const section_timer os_timer{timed_section::os};
+            next = xcb_poll_for_event(g_context.connection);
+        }
+        while (next != nullptr)
+        {
+            dispatch_event(g_context, next, lookahead);
+            std::free(next);
+            next = lookahead != nullptr ? std::exchange(lookahead, nullptr) : xcb_poll_for_queued_event(g_context.connection);
+        }
+        publish_display_changes(g_context);
+
+        for (auto& [id, state] : g_context.windows)
+        {
+            if (state->close_requested && state->is_open)
+            {
+                state->close_requested = false;
+                state->is_open = false;
+                state->events.push(close_event{.timestamp = platform_clock::now()});
+            }
+            state->events.flush();
+        }
+
+        // The server will not answer requests still sitting in our output buffer, so nobody may sleep on the socket
+        // with any left there.
+        const section_timer os_timer{timed_section::os};
+        xcb_flush(g_context.connection);
+    }
+
+    void window::flush_events()
+    {
+        // pump_messages() already publishes for every window on the connection.
+    }
+
+    bool window::pumps_on_own_thread() const noexcept
+    {
+        return false;
+    }
+
+    std::optional<std::size_t> window::wait_any(const std::span<const native_wait_handle> handles,
+                                                const platform_clock::duration timeout)
+    {
+        const auto deadline = deadline_after(timeout);
+        pump_messages();
+        if (m_impl == nullptr || g_context.connection == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        // The connection goes last so the indexes of handles come back unchanged. A closed window gets no more input,
+        // so only the handles are left to wait on. A frame loop passes a handle or two; only a long list needs the heap.
+        auto& state = m_impl->state;
+        const std::size_t count = handles.size() + (state.is_open ? 1 : 0);
+        std::array<int, 8> inline_descriptors{};
+        std::vector<int> heap_descriptors;
+        if (count > inline_descriptors.size())
+        {
+            heap_descriptors.resize(count);
+        }
+        const std::span<int> descriptors = heap_descriptors.empty() ? std::span{inline_descriptors}.first(count)
+                                                                    : std::span<int>{heap_descriptors};
+        std::ranges::copy(handles, descriptors.begin());
+        if (state.is_open)
+        {
+            descriptors.back() = xcb_get_file_descriptor(g_context.connection);
+        }
+
+        for (;;)
+        {
+            const auto ready_at = state.consumer.ready_at(state.events);
+            if (ready_at <= platform_clock::now())
+            {
+                return handles.size();
+            }
+            if (descriptors.empty())
+            {
+                return std::nullopt;
+            }
+
+            // The pump emptied XCB's in-process queue, so the socket is all that is left to wait on. Input for a
+            // sibling window wakes us too, and the loop goes back to sleep.
+            const auto ready = wait_readable(descriptors, std::min(deadline, ready_at));
+            if (ready.has_value() && *ready < handles.size())
+            {
+                return ready;
+            }
+            pump_messages();
+            if (!ready.has_value() && platform_clock::now() >= deadline)
+            {
+                return state.consumer.ready_at(state.events) <= platform_clock::now() ? std::optional{handles.size()}
+                                                                                       : std::nullopt;
+            }
+        }
+    }
+
+    native_wait_handle window::wait_handle() const noexcept
+    {
+        return g_context.connection == nullptr ? invalid_wait_handle : xcb_get_file_descriptor(g_context.connection);
+    }
+
+    std::optional<event> window::poll_event()
+    {
+        pump_messages();
+        if (m_impl == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        return m_impl->state.consumer.poll(m_impl->state.events);
+    }
+
+    std::size_t window::drain_events(const std::span<event> out)
+    {
+        pump_messages();
+        return drain_queued(out);
+    }
+
+    std::size_t window::drain_queued(const std::span<event> out)
+    {
+        if (m_impl == nullptr)
+        {
+            return 0;
+        }
+
+        return m_impl->state.consumer.drain(m_impl->state.events, out);
+    }
+
+    window_size window::size() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        // Kept current from ConfigureNotify, so this never costs a server round-trip.
+        return m_impl->state.client;
+    }
+
+    float window::scale() const noexcept
+    {
+        return g_context.scale;
+    }
+
+    display_info window::display() const
+    {
+        if (m_impl == nullptr || m_impl->state.window == XCB_NONE)
+        {
+            throw except::window_error{"Cannot query the display of an invalid window."};
+        }
+
+        auto displays = query_displays(g_context);
+        auto* origin = xcb_translate_coordinates_reply(
+            g_context.connection,
+            xcb_translate_coordinates(g_context.connection, m_impl->state.window, g_context.screen->root, 0, 0),
+            nullptr);
+        if (origin == nullptr)
+        {
+            return displays.front();
+        }
+
+        // The display the window overlaps most, the primary one if it is off every display.
+        const std::int64_t left = origin->dst_x;
+        const std::int64_t top = origin->dst_y;
+        std::free(origin);
+        const std::int64_t right = left + m_impl->state.client.width;
+        const std::int64_t bottom = top + m_impl->state.client.height;
+        std::size_t best = 0;
+        std::int64_t best_area = 0;
+        for (std::size_t i = 0; i < displays.size(); ++i)
+        {
+            const auto& candidate = displays[i];
+            const std::int64_t width = std::min<std::int64_t>(right, candidate.x + std::int64_t{candidate.width}) -
+                                       std::max<std::int64_t>(left, candidate.x);
+            const std::int64_t height = std::min<std::int64_t>(bottom, candidate.y + std::int64_t{candidate.height}) -
+                                        std::max<std::int64_t>(top, candidate.y);
+            if (width > 0 && height > 0 && width * height > best_area)
+            {
+                best = i;
+                best_area = width * height;
+            }
+        }
+        return std::move(displays[best]);
+    }
+
+    const keyboard_state& window::keyboard() const noexcept
+    {
+        static const keyboard_state released{};
+        if (m_impl == nullptr)
+        {
+            return released;
+        }
+
+        return m_impl->state.consumer.keyboard;
+    }
+
+    void window::record_input(input_recorder* recorder) noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.consumer.recorder = recorder;
+        }
+    }
+
+    void window::replay_input(input_replayer* replayer) noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.consumer.replayer = replayer;
+        }
+    }
+
+    event_queue_stats window::event_stats() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return m_impl->state.events.stats();
+    }
+
+    void window::set_event_coalescing(const bool enabled) const noexcept
+    {
+        if (m_impl != nullptr)
+        {
+            m_impl->state.events.set_coalescing(enabled);
+        }
+    }
+
+    bool window::event_coalescing() const noexcept
+    {
+        return m_impl != nullptr && m_impl->state.events.coalescing();
+    }
+
+    void window::set_cursor_mode(const cursor_mode mode) const
+    {
+        if (m_impl == nullptr || m_impl->state.window == XCB_NONE)
+        {
+            throw except::window_error{"Cannot set cursor mode on an invalid window."};
+        }
+        if (m_impl->state.cursor == mode)
+        {
+            return;
+        }
+
+        auto& context = g_context;
+        const xcb_window_t id = m_impl->state.window;
+
+        if (mode == cursor_mode::captured_hidden)
+        {
+            if (!context.has_xinput2)
+            {
+                throw except::window_error{"Captured cursor mode requires the XInput2 extension."};
+            }
+
+            const xcb_cursor_t cursor = hidden_cursor(context);
+            xcb_change_window_attributes(context.connection, id, XCB_CW_CURSOR, &cursor);
+
+            const auto cookie = xcb_grab_pointer(
+                context.connection,
+                0,
+                id,
+                XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE,
+                XCB_GRAB_MODE_ASYNC,
+                XCB_GRAB_MODE_ASYNC,
+                id,
+                cursor,
+                XCB_CURRENT_TIME
+            );
+            auto* reply = xcb_grab_pointer_reply(context.connection, cookie, nullptr);
+            const bool grabbed = reply != nullptr && reply->status == XCB_GRAB_STATUS_SUCCESS;
+            std::free(reply);
+            if (!grabbed)
+            {
+                constexpr std::uint32_t default_cursor = XCB_NONE;
+                xcb_change_window_attributes(context.connection, id, XCB_CW_CURSOR, &default_cursor);
+                throw except::window_error{"xcb_grab_pointer failed while enabling captured cursor mode."};
+            }
+
+            // Raw motion is reported before pointer acceleration and keeps flowing while the pointer is pinned to
+            // the edge of the confine window, so no re-centering warp is needed.
+            select_raw_motion(context, true);
+            m_impl->state.delta_remainder_x = 0.0;
+            m_impl->state.delta_remainder_y = 0.0;
+            context.captured = &m_impl->state;
+        }
+        else
+        {
+            select_raw_motion(context, false);
+            xcb_ungrab_pointer(context.connection, XCB_CURRENT_TIME);
+            constexpr std::uint32_t default_cursor = XCB_NONE;
+            xcb_change_window_attributes(context.connection, id, XCB_CW_CURSOR, &default_cursor);
+            if (context.captured == &m_impl->state)
+            {
+                context.captured = nullptr;
+            }
+        }
+
+        m_impl->state.cursor = mode;
+        xcb_flush(context.connection);
+    }
+
+    cursor_mode window::get_cursor_mode() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return cursor_mode::normal;
+        }
+        return m_impl->state.cursor;
+    }
+
+    void* window::native_handle() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return nullptr;
+        }
+
+        return reinterpret_cast<void*>(static_cast<std::uintptr_t>(m_impl->state.window));
+    }
+
+    window::native_xcb_handle window::native_xcb() const noexcept
+    {
+        if (m_impl == nullptr)
+        {
+            return {};
+        }
+
+        return {
+            .connection = g_context.connection,
+            .window = m_impl->state.window
+        };
+    }
+} // namespace detri
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace detri
+{
+    // Chase-Lev deque of pointers (Chase & Lev 2005, with the C11 orderings from Lê et al. 2013). The owning thread
+    // pushes and pops at the bottom, LIFO, so it keeps working on the freshest, cache-hot tasks; any other thread
+    // steals the oldest from the top. Grows on demand; outgrown buffers are kept until destruction because a thief
+    // may still be reading from one.
+    template <typename T>
+    class work_stealing_deque
+    {
+    public:
+        explicit work_stealing_deque(const std::size_t capacity = 256)
+        {
+            m_buffers.push_back(std::make_unique<buffer>(std::bit_ceil(std::max<std::size_t>(capacity, 2))));
+            m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        work_stealing_deque(const work_stealing_deque&) = delete;
+
+        work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+        // Owner only.
+        void push(T* value)
+        {
+            const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            const std::int64_t top = m_top.load(std::memory_order_acquire);
+            buffer* slots = m_buffer.load(std::memory_order_relaxed);
+            if (bottom - top > static_cast<std::int64_t>(slots->mask))
+            {
+                slots = grow(slots, top, bottom);
+            }
+            slots->at(bottom).store(value, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // Owner only. nullptr when empty or when a thief won the race for the last element.
+        T* pop() noexcept
+        {
+            const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            buffer* slots = m_buffer.load(std::memory_order_relaxed);
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* value = slots->at(bottom).load(std::memory_order_relaxed);
+            if (top == bottom)
+            {
+                // Last element: settle it with the thieves through top.
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    value = nullptr;
+                }
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return value;
+        }
+
+        // Any thread. nullptr when empty or when it lost a race, in which case trying again may succeed.
+        T* steal() noexcept
+        {
+            std::int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom)
+            {
+                return nullptr;
+            }
+
+            buffer* slots = m_buffer.load(std::memory_order_acquire);
+            T* value = slots->at(top).load(std::memory_order_relaxed);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return value;
+        }
+
+        // A snapshot; only exact when no other thread is touching the deque.
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct buffer
+        {
+            explicit buffer(const std::size_t capacity)
+                : mask(capacity - 1), slots(std::make_unique<std::atomic<T*>[]>(capacity))
+            {
+            }
+
+            std::atomic<T*>& at(const std::int64_t index) noexcept
+            {
+                return slots[static_cast<std::size_t>(index) & mask];
+            }
+
+            std::size_t mask;
+            std::unique_ptr<std::atomic<T*>[]> slots;
+        };
+
+        buffer* grow(buffer* current, const std::int64_t top, const std::int64_t bottom)
+        {
+            auto next = std::make_unique<buffer>((current->mask + 1) * 2);
+            for (std::int64_t i = top; i < bottom; ++i)
+            {
+                next->at(i).store(current->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            buffer* published = next.get();
+            m_buffers.push_back(std::move(next));
+            m_buffer.store(published, std::memory_order_release);
+            return published;
+        }
+
+        // Thieves and the owner hammer different ends; keep them off each other's cache line.
+        alignas(64) std::atomic<std::int64_t> m_top {0};
+        alignas(64) std::atomic<std::int64_t> m_bottom {0};
+        alignas(64) std::atomic<buffer*> m_buffer {nullptr};
+        std::vector<std::unique_ptr<buffer>> m_buffers;
+    };
+}
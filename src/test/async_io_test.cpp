@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "detri/async_io.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "test_check.hpp"
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+namespace
+{
+    using detri::test::check;
+
+    constexpr std::size_t file_size = 256 * 1024 + 123;
+
+    std::byte pattern(const std::size_t offset)
+    {
+        return static_cast<std::byte>((offset * 7 + offset / 251) & 0xFF);
+    }
+
+    std::filesystem::path write_test_file()
+    {
+        const auto path = std::filesystem::temp_directory_path() / "detri_async_io.bin";
+        std::vector<std::byte> contents(file_size);
+        for (std::size_t i = 0; i < contents.size(); ++i)
+        {
+            contents[i] = pattern(i);
+        }
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+        return path;
+    }
+
+    bool matches(const std::span<const std::byte> bytes, const std::uint64_t offset)
+    {
+        for (std::size_t i = 0; i < bytes.size(); ++i)
+        {
+            if (bytes[i] != pattern(offset + i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Waits until every read in flight has been reaped into out.
+    std::size_t reap_all(detri::async_io& io, std::vector<detri::async_read_completion>& out)
+    {
+        std::array<detri::async_read_completion, 8> batch{};
+        while (io.in_flight() != 0)
+        {
+            const std::size_t count = io.wait(batch, std::chrono::seconds{5});
+            if (count == 0)
+            {
+                break;
+            }
+            out.insert(out.end(), batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(count));
+        }
+        return out.size();
+    }
+
+    void test_batched_reads(const std::filesystem::path& path, const detri::async_io_backend backend)
+    {
+        auto io = detri::async_io::create({.backend = backend, .queue_depth = 8});
+        check(backend == detri::async_io_backend::automatic || io.backend() == backend, "requested backend is used");
+
+        const auto file = io.open(path);
+        check(file.size() == file_size, "file size is reported");
+
+        constexpr std::size_t chunk = 64 * 1024;
+        std::vector<std::vector<std::byte>> buffers(5, std::vector<std::byte>(chunk));
+        std::vector<detri::async_read> reads;
+        for (std::size_t i = 0; i < buffers.size(); ++i)
+        {
+            reads.push_back({.file = &file, .offset = i * chunk, .buffer = buffers[i], .user_data = 100 + i});
+        }
+        check(io.submit(reads) == reads.size(), "the whole batch fits in the queue");
+
+        std::vector<detri::async_read_completion> completions;
+        check(reap_all(io, completions) == reads.size(), "every read completes");
+
+        std::array<bool, 5> seen{};
+        for (const auto& completion : completions)
+        {
+            const std::size_t index = completion.user_data - 100;
+            check(index < seen.size() && !seen[index], "user_data comes back once per read");
+            if (index >= seen.size())
+            {
+                continue;
+            }
+            seen[index] = true;
+
+            const std::size_t expected = std::min(chunk, file_size - std::min(file_size, index * chunk));
+            check(!completion.error, "read succeeds");
+            check(completion.bytes_read == expected, "reads are short only at the end of the file");
+            check(matches(std::span{buffers[index]}.first(completion.bytes_read), index * chunk), "read data matches");
+        }
+    }
+
+    void test_queue_depth(const std::filesystem::path& path, const detri::async_io_backend backend)
+    {
+        auto io = detri::async_io::create({.backend = backend, .queue_depth = 2});
+        const auto file = io.open(path);
+
+        std::array<std::array<std::byte, 16>, 3> buffers{};
+        const std::array<detri::async_read, 3> reads{
+            detri::async_read{.file = &file, .offset = 0, .buffer = buffers[0], .user_data = 0},
+            detri::async_read{.file = &file, .offset = 16, .buffer = buffers[1], .user_data = 1},
+            detri::async_read{.file = &file, .offset = 32, .buffer = buffers[2], .user_data = 2}
+        };
+        check(io.submit(reads) == 2, "submit stops at the queue depth");
+        check(io.in_flight() == 2, "accepted reads are in flight");
+        check(io.submit(std::span{reads}.subspan(2)) == 0, "a full queue accepts nothing");
+
+        std::vector<detri::async_read_completion> completions;
+        reap_all(io, completions);
+        check(completions.size() == 2 && io.in_flight() == 0, "reaping frees the queue");
+        check(io.submit(std::span{reads}.subspan(2)) == 1, "freed slots take new reads");
+        completions.clear();
+        reap_all(io, completions);
+        check(completions.size() == 1 && matches(buffers[2], 32), "the late read lands");
+    }
+
+    void test_end_of_file(const std::filesystem::path& path, const detri::async_io_backend backend)
+    {
+        auto io = detri::async_io::create({.backend = backend});
+        const auto file = io.open(path);
+
+        std::array<std::byte, 64> buffer{};
+        const detri::async_read read{.file = &file, .offset = file_size + 10, .buffer = buffer, .user_data = 7};
+        check(io.submit(std::span{&read, 1}) == 1, "read past the end is accepted");
+
+        std::vector<detri::async_read_completion> completions;
+        reap_all(io, completions);
+        check(completions.size() == 1 && completions[0].user_data == 7, "read past the end completes");
+        check(completions.size() == 1 && completions[0].bytes_read == 0 && !completions[0].error,
+              "read past the end returns nothing without an error");
+
+        std::array<detri::async_read_completion, 4> out{};
+        const auto start = std::chrono::steady_clock::now();
+        check(io.wait(out, std::chrono::seconds{5}) == 0, "wait with nothing in flight returns nothing");
+        check(std::chrono::steady_clock::now() - start < std::chrono::seconds{1}, "wait with nothing in flight does not block");
+        check(io.poll(out) == 0, "poll with nothing in flight returns nothing");
+
+        // duration::max() is the documented way to wait without a limit.
+        check(io.submit(std::span{&read, 1}) == 1, "a second read is accepted");
+        check(io.wait(out, detri::platform_clock::duration::max()) == 1, "an unlimited wait returns the completion");
+        check(io.wait(out, detri::platform_clock::duration::max()) == 0, "an unlimited wait with nothing in flight returns");
+    }
+
+    bool handle_signaled(const detri::async_io_wait_handle handle, const int timeout_ms)
+    {
+#ifdef _WIN32
+        return WaitForSingleObject(handle, static_cast<DWORD>(timeout_ms)) == WAIT_OBJECT_0;
+#else
+        pollfd entry{.fd = handle, .events = POLLIN, .revents = 0};
+        return ::poll(&entry, 1, timeout_ms) == 1;
+#endif
+    }
+
+    // The handle is what a message loop waits on next to its own, so it must fire on completion and go quiet once
+    // everything has been reaped.
+    void test_wait_handle(const std::filesystem::path& path, const detri::async_io_backend backend)
+    {
+        auto io = detri::async_io::create({.backend = backend});
+        const auto file = io.open(path);
+
+        std::array<std::byte, 32> buffer{};
+        const detri::async_read read{.file = &file, .offset = 64, .buffer = buffer, .user_data = 1};
+        io.submit(std::span{&read, 1});
+        check(handle_signaled(io.wait_handle(), 5000), "wait handle fires when a read completes");
+
+        std::array<detri::async_read_completion, 4> out{};
+        check(io.poll(out) == 1 && matches(buffer, 64), "poll after the wakeup reaps the read");
+        check(!handle_signaled(io.wait_handle(), 0), "wait handle is quiet once everything is reaped");
+    }
+
+    void test_errors()
+    {
+        auto io = detri::async_io::create();
+        bool threw = false;
+        try
+        {
+            (void)io.open(std::filesystem::temp_directory_path() / "detri_async_io_missing.bin");
+        }
+        catch (const detri::except::async_io_error&)
+        {
+            threw = true;
+        }
+        check(threw, "opening a missing file throws async_io_error");
+
+        threw = false;
+        try
+        {
+            (void)detri::async_io::create({.queue_depth = 0});
+        }
+        catch (const detri::except::async_io_error&)
+        {
+            threw = true;
+        }
+        check(threw, "a zero queue depth throws async_io_error");
+
+        auto moved = std::move(io);
+        std::array<detri::async_read_completion, 4> out{};
+        check(io.in_flight() == 0 && io.poll(out) == 0 && io.wait(out, std::chrono::seconds{5}) == 0,
+              "a moved-from async_io has nothing in flight");
+        threw = false;
+        try
+        {
+            (void)io.submit({});
+        }
+        catch (const detri::except::async_io_error&)
+        {
+            threw = true;
+        }
+        check(threw, "submitting to a moved-from async_io throws async_io_error");
+    }
+}
+
+int main()
+{
+    const auto path = write_test_file();
+
+    std::vector<detri::async_io_backend> backends{detri::async_io_backend::automatic, detri::async_io_backend::thread_pool};
+    if (detri::async_io::create().backend() != detri::async_io_backend::thread_pool)
+    {
+        backends.push_back(detri::async_io::create().backend());
+    }
+    for (const auto backend : backends)
+    {
+        test_batched_reads(path, backend);
+        test_queue_depth(path, backend);
+        test_end_of_file(path, backend);
+        test_wait_handle(path, backend);
+    }
+    test_errors();
+
+    std::filesystem::remove(path);
+
+    return detri::test::report();
+}
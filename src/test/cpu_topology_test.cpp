@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <bit>
+#include <set>
+#include <thread>
+
+#include "detri/cpu_topology.hpp"
+#include "detri/job_system.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "test_check.hpp"
+
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+namespace
+{
+    using detri::test::check;
+
+    void test_structure(const detri::cpu_topology& topology)
+    {
+        check(!topology.cores.empty(), "at least one core");
+        check(topology.package_count >= 1, "at least one package");
+        check(!topology.numa_nodes.empty(), "at least one NUMA node");
+        check(std::has_single_bit(topology.cache_line_size), "cache line size is a power of two");
+
+        std::set<detri::logical_processor> seen;
+        bool unique = true;
+        for (const auto& core : topology.cores)
+        {
+            check(!core.logical_processors.empty(), "every core has a logical processor");
+            check(core.package < topology.package_count, "core package indexes a package");
+            for (const auto& processor : core.logical_processors)
+            {
+                unique = seen.insert(processor).second && unique;
+            }
+        }
+        check(unique, "every logical processor belongs to exactly one core");
+        check(seen.size() == topology.logical_processor_count(), "logical_processor_count counts every sibling");
+
+        std::size_t in_nodes = 0;
+        for (const auto& node : topology.numa_nodes)
+        {
+            in_nodes += node.logical_processors.size();
+        }
+        check(in_nodes == seen.size(), "NUMA nodes cover every logical processor once");
+
+        for (std::size_t i = 0; i < topology.caches.size(); ++i)
+        {
+            const auto& cache = topology.caches[i];
+            check(cache.level >= 1 && cache.level <= 4, "cache levels are plausible");
+            check(i == 0 || topology.caches[i - 1].level <= cache.level, "caches are sorted by level");
+            check(std::ranges::all_of(cache.shared_by, [&seen](const auto& processor) { return seen.contains(processor); }),
+                  "caches are shared by known logical processors");
+        }
+    }
+
+    void test_affinity_and_priority(const detri::cpu_topology& topology)
+    {
+        // On a thread of its own, since lowering the priority is one-way without privileges on Linux.
+        std::thread worker{[&topology] {
+            const auto& core = topology.cores.front().logical_processors;
+            bool pinned = true;
+            try
+            {
+                detri::set_current_thread_affinity(core);
+            }
+            catch (const detri::except::platform_exception&)
+            {
+                // The first core may be outside this process's cpuset.
+                pinned = false;
+            }
+#ifndef _WIN32
+            if (pinned)
+            {
+                const auto cpu = static_cast<std::uint32_t>(sched_getcpu());
+                check(std::ranges::any_of(core, [cpu](const auto& processor) { return processor.number == cpu; }),
+                      "a pinned thread runs on its core");
+            }
+#endif
+
+            bool lowered = true;
+            try
+            {
+                detri::set_current_thread_priority(detri::thread_priority::normal);
+                detri::set_current_thread_priority(detri::thread_priority::below_normal);
+            }
+            catch (const detri::except::platform_exception&)
+            {
+                lowered = false;
+            }
+            check(lowered, "a thread can lower its own priority");
+        }};
+        worker.join();
+
+        bool threw = false;
+        try
+        {
+            detri::set_current_thread_affinity({});
+        }
+        catch (const detri::except::platform_exception&)
+        {
+            threw = true;
+        }
+        check(threw, "an empty affinity set throws");
+    }
+
+    void test_pinned_job_system(const detri::cpu_topology& topology)
+    {
+        auto jobs = detri::job_system::create({.pin_to_physical_cores = true});
+        check(jobs.worker_count() == topology.cores.size(), "pinned job system starts one worker per physical core");
+
+        int result = 0;
+        jobs.wait(jobs.spawn([&result] { result = 42; }));
+        check(result == 42, "pinned workers run jobs");
+    }
+}
+
+int main()
+{
+    const auto topology = detri::cpu_topology::query();
+    test_structure(topology);
+    test_affinity_and_priority(topology);
+    test_pinned_job_system(topology);
+
+    return detri::test::report();
+}
@@ -0,0 +1,108 @@
+#include <thread>
+
+#include "detri/event_queue.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    detri::event key(const detri::key value)
+    {
+        return detri::key_event{.value = value, .pressed = true};
+    }
+
+    void test_capacity_rounds_up()
+    {
+        detri::event_queue queue{5};
+        check(queue.capacity() == 8, "capacity rounds up to a power of two");
+        check(queue.empty(), "new queue is empty");
+        check(!queue.pop().has_value(), "pop on an empty queue returns nothing");
+    }
+
+    void test_drop_oldest()
+    {
+        detri::event_queue queue{4, detri::event_overflow_policy::drop_oldest};
+        for (const auto value : {detri::key::a, detri::key::b, detri::key::c, detri::key::d, detri::key::e})
+        {
+            queue.push(key(value));
+        }
+
+        check(queue.stats().dropped == 1, "one event is dropped on overflow");
+        auto first = queue.pop();
+        check(first && std::get<detri::key_event>(*first).value == detri::key::b, "oldest event was the one dropped");
+        int remaining = 0;
+        while (queue.pop())
+        {
+            ++remaining;
+        }
+        check(remaining == 3, "the rest of the queue survives");
+    }
+
+    void test_coalesce_on_overflow()
+    {
+        detri::event_queue queue{2, detri::event_overflow_policy::coalesce};
+        queue.push(key(detri::key::a));
+        queue.push(key(detri::key::b));
+        queue.push(detri::mouse_delta_event{.dx = 1, .dy = 2});
+        queue.push(detri::mouse_delta_event{.dx = 3, .dy = 4});
+        queue.push(detri::mouse_delta_event{.dx = 5, .dy = 6});
+        check(queue.stats().coalesced == 2, "deltas merge while the queue is full");
+        check(queue.stats().dropped == 0, "nothing is dropped while merging");
+
+        check(queue.pop().has_value(), "first key is still queued");
+        queue.flush();
+        check(queue.pop().has_value(), "second key is still queued");
+        auto merged = queue.pop();
+        check(merged && std::holds_alternative<detri::mouse_delta_event>(*merged), "held delta is published on flush");
+        check(merged && std::get<detri::mouse_delta_event>(*merged).dx == 9, "merged dx is the sum");
+        check(merged && std::get<detri::mouse_delta_event>(*merged).dy == 12, "merged dy is the sum");
+    }
+
+    void test_single_producer_single_consumer()
+    {
+        constexpr std::int32_t count = 200000;
+        detri::event_queue queue{64, detri::event_overflow_policy::drop_oldest};
+
+        std::thread producer([&queue] {
+            for (std::int32_t i = 1; i <= count; ++i)
+            {
+                queue.push(detri::mouse_move_event{.x = i, .y = -i});
+            }
+        });
+
+        std::int32_t last = 0;
+        std::int64_t received = 0;
+        bool ordered = true;
+        bool intact = true;
+        while (last != count)
+        {
+            detri::event value;
+            if (!queue.try_pop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            const auto& move = std::get<detri::mouse_move_event>(value);
+            ordered = ordered && move.x > last;
+            intact = intact && move.y == -move.x;
+            last = move.x;
+            ++received;
+        }
+        producer.join();
+
+        check(ordered, "events arrive in order across threads");
+        check(intact, "events are never torn");
+        check(received + static_cast<std::int64_t>(queue.stats().dropped) == count, "every event is either received or counted as dropped");
+    }
+}
+
+int main()
+{
+    test_capacity_rounds_up();
+    test_drop_oldest();
+    test_coalesce_on_overflow();
+    test_single_producer_single_consumer();
+
+    return detri::test::report();
+}
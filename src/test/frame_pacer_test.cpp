@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "detri/frame_pacer.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    using namespace std::chrono_literals;
+    using clock = detri::platform_clock;
+
+    clock::duration median(std::vector<clock::duration> values)
+    {
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        return values[values.size() / 2];
+    }
+
+    void test_precise_sleep()
+    {
+        std::vector<clock::duration> lateness;
+        bool early = false;
+        for (int i = 0; i < 20; ++i)
+        {
+            const auto deadline = clock::now() + 2ms;
+            detri::precise_sleep_until(deadline);
+            const auto woke = clock::now();
+            early = early || woke < deadline;
+            lateness.push_back(woke - deadline);
+        }
+        check(!early, "precise_sleep_until never returns early");
+        // Loose enough for a loaded CI machine; the spin tail keeps it in the tens of microseconds on an idle one.
+        check(median(lateness) < 1ms, "precise_sleep_until lands close to its deadline");
+
+        const auto before = clock::now();
+        detri::precise_sleep_until(before - 1s);
+        detri::precise_sleep_for(-1s);
+        check(clock::now() - before < 1ms, "a deadline in the past returns straight away");
+    }
+
+    void test_steady_frames()
+    {
+        auto pacer = detri::frame_pacer::create({.frame_time = 5ms});
+        check(pacer.frame_time() == 5ms, "frame_time is what was asked for");
+
+        std::vector<clock::time_point> boundaries;
+        std::vector<clock::duration> lateness;
+        for (int i = 0; i < 20; ++i)
+        {
+            const auto expected = pacer.next_frame();
+            const auto boundary = pacer.wait();
+            check(boundary >= expected, "a frame never starts before its boundary");
+            check(clock::now() >= boundary, "wait returns at or after the boundary it reports");
+            boundaries.push_back(boundary);
+            lateness.push_back(pacer.last_lateness());
+        }
+
+        bool spaced = true;
+        for (std::size_t i = 1; i < boundaries.size(); ++i)
+        {
+            spaced = spaced && boundaries[i] - boundaries[i - 1] >= 5ms;
+        }
+        check(spaced, "boundaries are at least a frame time apart");
+        check(median(lateness) < 1ms, "frames start close to their boundary");
+    }
+
+    void test_overrun()
+    {
+        auto pacer = detri::frame_pacer::create({.frame_time = 5ms});
+        (void)pacer.wait();
+        std::this_thread::sleep_for(12ms);
+
+        const auto before = clock::now();
+        const auto boundary = pacer.wait();
+        check(clock::now() - before < 2ms, "an overrun frame does not wait");
+        check(pacer.missed_frames() >= 2, "missed boundaries are counted");
+        check(pacer.next_frame() == boundary + 5ms, "the schedule restarts from the overrun");
+
+        pacer.set_frame_time(10ms);
+        check(pacer.next_frame() == boundary + 10ms, "a new frame time applies to the frame in progress");
+
+        const auto reset_at = clock::now();
+        pacer.reset();
+        check(pacer.next_frame() >= reset_at + 10ms && pacer.next_frame() <= clock::now() + 10ms,
+              "reset restarts the schedule from now");
+    }
+
+    void test_invalid_frame_time()
+    {
+        bool threw = false;
+        try
+        {
+            (void)detri::frame_pacer::create({.frame_time = clock::duration::zero()});
+        }
+        catch (const detri::except::platform_exception&)
+        {
+            threw = true;
+        }
+        check(threw, "a zero frame time throws");
+
+        auto pacer = detri::frame_pacer::create();
+        threw = false;
+        try
+        {
+            pacer.set_frame_time(-1ms);
+        }
+        catch (const detri::except::platform_exception&)
+        {
+            threw = true;
+        }
+        check(threw, "a negative frame time throws");
+        check(pacer.frame_time() == clock::duration{16'666'667}, "a rejected frame time leaves the old one");
+    }
+}
+
+int main()
+{
+    test_precise_sleep();
+    test_steady_frames();
+    test_overrun();
+    test_invalid_frame_time();
+
+    return detri::test::report();
+}
@@ -0,0 +1,115 @@
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "detri/input_recording.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    std::filesystem::path log_path(const char* name)
+    {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+    void test_round_trip()
+    {
+        const auto path = log_path("detri_input_round_trip.log");
+        const auto start = detri::platform_clock::now();
+        {
+            auto recorder = detri::input_recorder::create(path);
+            recorder.record(detri::key_event{.value = detri::key::numpad_enter, .pressed = true, .repeated = true,
+                                             .timestamp = start});
+            recorder.record(detri::mouse_button_event{.button = detri::mouse_button::x2, .pressed = true, .x = -5,
+                                                      .y = 7, .timestamp = start + std::chrono::milliseconds(3)});
+            const detri::event batch[] = {
+                detri::mouse_delta_event{.dx = 12, .dy = -34, .timestamp = start + std::chrono::milliseconds(5)},
+                detri::resize_event{.width = 1920, .height = 1080, .timestamp = start + std::chrono::milliseconds(9)},
+                detri::dpi_changed_event{.scale = 1.5f, .timestamp = start + std::chrono::milliseconds(9)},
+                detri::close_event{.timestamp = start + std::chrono::milliseconds(10)}
+            };
+            recorder.record(batch);
+            check(recorder.recorded() == 6, "recorder counts every event");
+        }
+
+        check(std::filesystem::file_size(path) < 16 + 6 * sizeof(detri::event), "records are smaller than events");
+
+        auto replayer = detri::input_replayer::open(path);
+        const auto key = replayer.next();
+        check(key && std::holds_alternative<detri::key_event>(*key), "first record is the key");
+        check(key && std::get<detri::key_event>(*key).value == detri::key::numpad_enter, "key value survives");
+        check(key && std::get<detri::key_event>(*key).pressed && std::get<detri::key_event>(*key).repeated,
+              "key flags survive");
+
+        const auto button = replayer.next();
+        check(button && std::get<detri::mouse_button_event>(*button).button == detri::mouse_button::x2,
+              "button survives");
+        check(button && std::get<detri::mouse_button_event>(*button).x == -5, "negative coordinates survive");
+        check(key && button && detri::event_timestamp(*button) - detri::event_timestamp(*key) ==
+                                   std::chrono::milliseconds(3),
+              "recorded spacing is kept");
+
+        std::array<detri::event, 8> rest{};
+        check(replayer.next_many(rest) == 4, "the batch replays in one call");
+        check(std::get<detri::mouse_delta_event>(rest[0]).dy == -34, "delta survives");
+        check(std::get<detri::resize_event>(rest[1]).width == 1920, "resize survives");
+        check(std::get<detri::dpi_changed_event>(rest[2]).scale == 1.5f, "scale survives");
+        check(std::holds_alternative<detri::close_event>(rest[3]), "close survives");
+        check(replayer.finished() && !replayer.next().has_value(), "replay ends after the last record");
+
+        replayer.rewind();
+        check(!replayer.finished() && replayer.next().has_value(), "rewind starts over");
+
+        std::filesystem::remove(path);
+    }
+
+    void test_truncated_log()
+    {
+        const auto path = log_path("detri_input_truncated.log");
+        {
+            auto recorder = detri::input_recorder::create(path);
+            recorder.record(detri::mouse_move_event{.x = 1, .y = 2, .timestamp = detri::platform_clock::now()});
+            recorder.record(detri::mouse_move_event{.x = 3, .y = 4, .timestamp = detri::platform_clock::now()});
+        }
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+        auto replayer = detri::input_replayer::open(path);
+        check(replayer.next().has_value(), "complete records still replay");
+        check(!replayer.next().has_value() && replayer.finished(), "a cut-off record ends the replay");
+        std::filesystem::remove(path);
+    }
+
+    void test_rejects_foreign_files()
+    {
+        const auto path = log_path("detri_input_foreign.log");
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << "definitely not an input log";
+        }
+
+        bool threw = false;
+        try
+        {
+            (void)detri::input_replayer::open(path);
+        }
+        catch (const detri::except::input_recording_error&)
+        {
+            threw = true;
+        }
+        check(threw, "a file without the header is rejected");
+        std::filesystem::remove(path);
+    }
+}
+
+int main()
+{
+    test_round_trip();
+    test_truncated_log();
+    test_rejects_foreign_files();
+
+    return detri::test::report();
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "detri/event_queue.hpp"
+#include "detri/instrumentation.hpp"
+#include "test_check.hpp"
+
+#ifdef DETRI_PLATFORM_HEADLESS
+#include "detri/window.hpp"
+#endif
+
+namespace
+{
+    using detri::test::check;
+
+    constexpr std::size_t key_index = detri::event{detri::key_event{}}.index();
+    constexpr std::size_t move_index = detri::event{detri::mouse_move_event{}}.index();
+
+    void fill(detri::event_queue& queue)
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            queue.push(detri::key_event{.value = detri::key::a, .pressed = true});
+        }
+        queue.push(detri::mouse_move_event{.x = 1});
+        queue.push(detri::mouse_move_event{.x = 2});
+    }
+
+    void test_disabled()
+    {
+        detri::event_queue queue{16};
+        fill(queue);
+        check(queue.stats().pushed == 0 && queue.stats().high_water == 0, "an uninstrumented queue counts nothing");
+        check(detri::thread_counters().events[key_index] == 0, "an uninstrumented build records no events");
+
+        std::array<detri::platform_counters, 4> all{};
+        check(detri::read_counters(all) == 0, "an uninstrumented build has no threads to report");
+    }
+
+    void test_event_counts()
+    {
+        detri::reset_thread_counters();
+        detri::event_queue queue{16};
+        queue.set_coalescing(true);
+        fill(queue);
+        queue.flush();
+
+        const auto stats = queue.stats();
+        check(stats.pushed == 7, "the queue counts every push, coalesced ones included");
+        check(stats.high_water == 6, "the queue remembers its deepest point");
+
+        const auto counters = detri::thread_counters();
+        check(counters.thread == std::this_thread::get_id(), "the counters name their thread");
+        check(counters.events[key_index] == 5 && counters.events[move_index] == 2, "events are counted by type");
+        check(counters.queue_high_water == 6, "the thread's high water follows its queues");
+
+        detri::reset_thread_counters();
+        check(detri::thread_counters().events[key_index] == 0, "reset zeroes the calling thread's counters");
+    }
+
+    std::size_t count_listed(const std::thread::id thread)
+    {
+        std::array<detri::platform_counters, 64> all{};
+        const std::size_t threads = detri::read_counters(all);
+        const auto end = all.begin() + static_cast<std::ptrdiff_t>(std::min(threads, all.size()));
+        return static_cast<std::size_t>(std::count_if(all.begin(), end, [thread](const detri::platform_counters& counters) {
+            return counters.thread == thread && counters.events[key_index] == 5;
+        }));
+    }
+
+    void test_other_threads()
+    {
+        std::atomic<bool> recorded{false};
+        std::atomic<bool> read{false};
+        std::thread producer{[&] {
+            detri::event_queue queue{16};
+            fill(queue);
+            recorded.store(true);
+            recorded.notify_one();
+            read.wait(false);
+        }};
+        recorded.wait(false);
+        const auto id = producer.get_id();
+        check(count_listed(id) == 1, "a live thread's counters are listed");
+        read.store(true);
+        read.notify_one();
+        producer.join();
+        check(count_listed(id) == 0, "an exited thread drops out of the list");
+
+        std::array<detri::platform_counters, 64> all{};
+        const std::size_t before = detri::read_counters(all);
+        for (int i = 0; i < 8; ++i)
+        {
+            std::thread{[] {
+                detri::event_queue queue{16};
+                fill(queue);
+            }}.join();
+        }
+        check(detri::read_counters(all) == before, "threads that come and go reuse the blocks they leave");
+
+        std::thread{[] {
+            check(detri::thread_counters().events[key_index] == 0, "a reused block starts from zero");
+        }}.join();
+    }
+
+#ifdef DETRI_PLATFORM_HEADLESS
+    void test_pump_timing()
+    {
+        detri::reset_thread_counters();
+        auto win = detri::window::create("Instrumented", 320, 240);
+        for (int i = 0; i < 10; ++i)
+        {
+            win.pump_messages();
+        }
+
+        const auto pump = detri::thread_counters().pump;
+        std::uint64_t bucketed = 0;
+        for (const auto count : pump.buckets)
+        {
+            bucketed += count;
+        }
+        check(pump.count == 10 && bucketed == 10, "every pump lands in the histogram once");
+        check(pump.longest <= pump.total, "no pump outlasts all of them together");
+    }
+#endif
+}
+
+int main()
+{
+    if constexpr (detri::instrumentation_enabled)
+    {
+        test_event_counts();
+        test_other_threads();
+#ifdef DETRI_PLATFORM_HEADLESS
+        test_pump_timing();
+#endif
+    }
+    else
+    {
+        test_disabled();
+    }
+
+    return detri::test::report();
+}
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "detri/job_system.hpp"
+#include "detri/platform.hpp"
+#include "detri/work_stealing_deque.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    void test_deque_single_thread()
+    {
+        detri::work_stealing_deque<int> deque{2};
+        std::vector<int> values(10);
+        for (int& value : values)
+        {
+            deque.push(&value);
+        }
+        check(deque.steal() == &values[0], "steal takes the oldest element");
+        check(deque.pop() == &values[9], "pop takes the newest element");
+
+        int remaining = 0;
+        while (deque.pop() != nullptr)
+        {
+            ++remaining;
+        }
+        check(remaining == 8, "the deque grows past its initial capacity without losing elements");
+        check(deque.empty() && deque.steal() == nullptr, "an emptied deque has nothing to steal");
+    }
+
+    // The owner pushes and pops while thieves steal; every element must come out exactly once.
+    void test_deque_concurrent_steal()
+    {
+        constexpr int count = 200'000;
+        constexpr int thieves = 3;
+        detri::work_stealing_deque<int> deque{64};
+        std::vector<int> values(count);
+        auto taken = std::make_unique<std::atomic<int>[]>(count);
+        std::atomic<bool> done{false};
+
+        const auto take = [&](int* value) {
+            taken[value - values.data()].fetch_add(1, std::memory_order_relaxed);
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < thieves; ++i)
+        {
+            threads.emplace_back([&] {
+                while (!done.load(std::memory_order_acquire) || !deque.empty())
+                {
+                    if (int* value = deque.steal())
+                    {
+                        take(value);
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            deque.push(&values[i]);
+            if (i % 3 == 0)
+            {
+                if (int* value = deque.pop())
+                {
+                    take(value);
+                }
+            }
+        }
+        while (int* value = deque.pop())
+        {
+            take(value);
+        }
+        done.store(true, std::memory_order_release);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        bool exactly_once = true;
+        for (int i = 0; i < count; ++i)
+        {
+            exactly_once = exactly_once && taken[i].load() == 1;
+        }
+        check(exactly_once, "every element is taken exactly once under contention");
+    }
+
+    int fibonacci(detri::job_system& jobs, const int n)
+    {
+        if (n < 12)
+        {
+            return n < 2 ? n : fibonacci(jobs, n - 1) + fibonacci(jobs, n - 2);
+        }
+        int left = 0;
+        const auto child = jobs.spawn([&jobs, &left, n] { left = fibonacci(jobs, n - 1); });
+        const int right = fibonacci(jobs, n - 2);
+        jobs.wait(child);
+        return left + right;
+    }
+
+    void test_fork_join()
+    {
+        auto jobs = detri::job_system::create();
+        check(jobs.worker_count() == detri::processor_count(), "one worker per logical processor by default");
+
+        int result = 0;
+        const auto root = jobs.spawn([&jobs, &result] { result = fibonacci(jobs, 24); });
+        jobs.wait(root);
+        check(root.done(), "a waited-for job is done");
+        check(result == 46368, "nested fork/join computes the right result");
+    }
+
+    void test_parallel_for()
+    {
+        auto jobs = detri::job_system::create({.worker_count = 4});
+        constexpr std::size_t count = 100'000;
+        auto hits = std::make_unique<std::atomic<int>[]>(count);
+
+        jobs.parallel_for(0, count, 1000, [&hits](const std::size_t first, const std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                hits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        bool exactly_once = true;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            exactly_once = exactly_once && hits[i].load() == 1;
+        }
+        check(exactly_once, "parallel_for visits every index exactly once");
+
+        bool called = false;
+        jobs.parallel_for(5, 5, 1, [&called](std::size_t, std::size_t) { called = true; });
+        check(!called, "an empty range does nothing");
+    }
+
+    void test_continuations()
+    {
+        auto jobs = detri::job_system::create({.worker_count = 3});
+        std::atomic<int> finished{0};
+        std::atomic<int> seen_by_continuation{-1};
+
+        std::vector<detri::job_handle> parents;
+        for (int i = 0; i < 8; ++i)
+        {
+            parents.push_back(jobs.spawn([&finished] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                finished.fetch_add(1);
+            }));
+        }
+        const auto continuation = jobs.spawn_after(parents, [&finished, &seen_by_continuation] {
+            seen_by_continuation = finished.load();
+        });
+        const auto chained = jobs.spawn_after({continuation}, [] {});
+        jobs.wait(chained);
+        check(continuation.done(), "a chained continuation runs after the one it follows");
+        check(seen_by_continuation == 8, "a continuation runs only after all of its dependencies");
+
+        const auto late = jobs.spawn_after({continuation}, [] {});
+        jobs.wait(late);
+        check(late.done(), "a continuation of an already finished job runs straight away");
+    }
+
+    void test_exceptions_and_shutdown()
+    {
+        std::atomic<int> ran{0};
+        {
+            auto jobs = detri::job_system::create({.worker_count = 2});
+            const auto failing = jobs.spawn([] { throw std::runtime_error{"job failed"}; });
+            bool rethrown = false;
+            try
+            {
+                jobs.wait(failing);
+            }
+            catch (const std::runtime_error&)
+            {
+                rethrown = true;
+            }
+            check(rethrown, "wait rethrows what the job threw");
+
+            for (int i = 0; i < 100; ++i)
+            {
+                jobs.spawn([&ran] { ran.fetch_add(1); });
+            }
+        }
+        check(ran == 100, "destroying the system runs every job already spawned");
+    }
+
+    void test_move_assignment()
+    {
+        std::atomic<int> ran{0};
+        auto jobs = detri::job_system::create({.worker_count = 2});
+        for (int i = 0; i < 50; ++i)
+        {
+            jobs.spawn([&ran] { ran.fetch_add(1); });
+        }
+
+        // Assigning over a live system shuts its workers down first, as destroying it would.
+        jobs = detri::job_system::create({.worker_count = 3});
+        check(ran == 50, "assigning over a system runs every job it had spawned");
+        check(jobs.worker_count() == 3, "the assigned system takes over");
+
+        const auto job = jobs.spawn([&ran] { ran.fetch_add(1); });
+        jobs.wait(job);
+        check(ran == 51, "the assigned system runs new jobs");
+    }
+}
+
+int main()
+{
+    test_deque_single_thread();
+    test_deque_concurrent_steal();
+    test_fork_join();
+    test_parallel_for();
+    test_continuations();
+    test_exceptions_and_shutdown();
+    test_move_assignment();
+
+    check(detri::processor_count() >= 1, "processor_count is at least one");
+    check(detri::processor_count() <= std::max(1U, std::thread::hardware_concurrency()),
+          "processor_count never exceeds the online processors");
+
+    return detri::test::report();
+}
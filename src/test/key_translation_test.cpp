@@ -0,0 +1,72 @@
+#include <cstdint>
+
+#include "detri/key_translation.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    namespace translation = detri::key_translation;
+
+    constexpr std::int64_t win32_lparam(const std::uint32_t scancode, const bool extended)
+    {
+        return static_cast<std::int64_t>(scancode << 16) | (extended ? 1LL << 24 : 0);
+    }
+
+    void test_win32()
+    {
+        check(translation::from_win32_virtual_key('Q') == detri::key::q, "letters come from the virtual key");
+        check(translation::from_win32_virtual_key(0x7B) == detri::key::f12, "VK_F12 maps to f12");
+        check(translation::from_win32_message(0x10, win32_lparam(0x2A, false)) == detri::key::left_shift,
+              "VK_SHIFT with the left scancode is left_shift");
+        check(translation::from_win32_message(0x10, win32_lparam(0x36, false)) == detri::key::right_shift,
+              "VK_SHIFT with the right scancode is right_shift");
+        check(translation::from_win32_message(0x11, win32_lparam(0x1D, true)) == detri::key::right_control,
+              "extended VK_CONTROL is right_control");
+        check(translation::from_win32_message(0x12, win32_lparam(0x38, false)) == detri::key::left_alt,
+              "VK_MENU is left_alt");
+        check(translation::from_win32_message(0x24, win32_lparam(0x47, true)) == detri::key::home,
+              "extended VK_HOME is the navigation key");
+        check(translation::from_win32_message(0x24, win32_lparam(0x47, false)) == detri::key::numpad_7,
+              "VK_HOME from the keypad is numpad_7");
+        check(translation::from_win32_message(0x0D, win32_lparam(0x1C, true)) == detri::key::numpad_enter,
+              "extended VK_RETURN is numpad_enter");
+        check(translation::from_win32_message(0x2E, win32_lparam(0x53, true)) == detri::key::delete_,
+              "VK_DELETE maps to delete_");
+        check(translation::from_win32_message(0xFF, win32_lparam(0xFF, true)) == detri::key::unknown,
+              "unmapped codes are unknown");
+    }
+
+    void test_x11()
+    {
+        check(translation::from_x11_keysym(0x0061) == detri::key::a, "XK_a maps to a");
+        check(translation::from_x11_keysym(0x0041) == detri::key::a, "XK_A maps to a");
+        check(translation::from_x11_keysym(0xFFC9) == detri::key::f12, "XK_F12 maps to f12");
+        check(translation::from_x11_keysym(0xFFEA) == detri::key::right_alt, "XK_Alt_R maps to right_alt");
+        check(translation::from_x11_keysym(0xFFB5) == detri::key::numpad_5, "XK_KP_5 maps to numpad_5");
+        check(translation::from_x11_keysym(0x01000061) == detri::key::unknown, "other keysym pages are unknown");
+        check(translation::from_x11_keysym(0xFF95, 71) == detri::key::numpad_7,
+              "KP_Home falls back to the keypad position");
+        check(translation::from_x11_keysym(0x0071, 30) == detri::key::q, "the keysym wins over the position");
+    }
+
+    void test_evdev()
+    {
+        check(translation::from_evdev_code(1) == detri::key::escape, "KEY_ESC maps to escape");
+        check(translation::from_evdev_code(30) == detri::key::a, "KEY_A maps to a");
+        check(translation::from_evdev_code(68) == detri::key::f10, "KEY_F10 maps to f10");
+        check(translation::from_evdev_code(88) == detri::key::f12, "KEY_F12 maps to f12");
+        check(translation::from_evdev_code(126) == detri::key::right_system, "KEY_RIGHTMETA maps to right_system");
+        check(translation::from_evdev_code(0x1000) == detri::key::unknown, "codes past the table are unknown");
+    }
+}
+
+int main()
+{
+    test_win32();
+    test_x11();
+    test_evdev();
+
+    return detri::test::report();
+}
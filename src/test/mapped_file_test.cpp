@@ -0,0 +1,107 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+#include "detri/mapped_file.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    std::filesystem::path temp_path(const char* name)
+    {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+    std::string_view as_text(const std::span<const std::byte> bytes)
+    {
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+
+    template <typename Function>
+    bool throws_mapped_file_error(Function&& function)
+    {
+        try
+        {
+            function();
+        }
+        catch (const detri::except::mapped_file_error&)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    void test_read_only()
+    {
+        const auto path = temp_path("detri_mapped_read_only.bin");
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << "header:payload:trailer";
+        }
+
+        const auto file = detri::mapped_file::open(path, {.hint = detri::mapped_access_hint::sequential});
+        check(file.size() == 22, "whole file is mapped by default");
+        check(as_text(file.bytes()) == "header:payload:trailer", "mapped bytes match the file");
+        check(file.view().writable_bytes().empty(), "read-only views are not writable");
+
+        const auto payload = file.view(7, 7);
+        check(as_text(payload.bytes()) == "payload", "sub-range views see their slice");
+        check(payload.file_offset() == 7, "views know their file offset");
+        check(as_text(payload.subview(0, 3).bytes()) == "pay", "views nest");
+        payload.advise(detri::mapped_access_hint::will_need);
+        check(throws_mapped_file_error([&file] { (void)file.view(20, 5); }), "views past the end are rejected");
+
+        // An offset that is not page-aligned still maps; the mapping is widened internally.
+        const auto slice = detri::mapped_file::open(path, {.offset = 15, .length = 7, .huge_pages = true});
+        check(as_text(slice.bytes()) == "trailer", "unaligned range mapping sees the requested bytes");
+        check(slice.view().file_offset() == 15, "range mapping keeps its file offset");
+        check(throws_mapped_file_error([&path] { (void)detri::mapped_file::open(path, {.offset = 30}); }),
+              "ranges past the end of the file are rejected");
+
+        std::filesystem::remove(path);
+    }
+
+    void test_read_write()
+    {
+        const auto path = temp_path("detri_mapped_read_write.bin");
+        {
+            auto file = detri::mapped_file::create(path, detri::mapped_file::page_size() + 16);
+            check(file.access() == detri::mapped_file_access::read_write, "created files are writable");
+            const auto tail = file.view(detri::mapped_file::page_size(), 16).writable_bytes();
+            check(tail.size() == 16, "writable view covers the range");
+            std::memcpy(tail.data(), "written via map!", 16);
+            file.flush();
+        }
+
+        const auto reopened = detri::mapped_file::open(path);
+        check(as_text(reopened.view(detri::mapped_file::page_size(), 16).bytes()) == "written via map!",
+              "writes through the mapping reach the file");
+        std::filesystem::remove(path);
+    }
+
+    void test_empty_and_missing()
+    {
+        const auto path = temp_path("detri_mapped_empty.bin");
+        {
+            std::ofstream file{path, std::ios::binary};
+        }
+        const auto empty = detri::mapped_file::open(path);
+        check(empty.size() == 0 && empty.bytes().empty(), "empty files map to an empty view");
+        std::filesystem::remove(path);
+
+        check(throws_mapped_file_error([&path] { (void)detri::mapped_file::open(path); }), "missing files throw");
+    }
+}
+
+int main()
+{
+    test_read_only();
+    test_read_write();
+    test_empty_and_missing();
+
+    return detri::test::report();
+}
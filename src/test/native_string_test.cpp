@@ -0,0 +1,117 @@
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include "detri/native_string.hpp"
+#include "detri/platform_exceptions.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    std::size_t g_allocations = 0;
+
+    // The same text spelled in both encodings; native_string should produce whichever the OS takes.
+    bool converts_to(const std::string_view utf8, const std::u16string_view utf16)
+    {
+        const detri::native_string converted{utf8};
+        if (converted.c_str()[converted.size()] != detri::native_char{})
+        {
+            return false;
+        }
+#ifdef _WIN32
+        return converted.view() == std::wstring_view{reinterpret_cast<const wchar_t*>(utf16.data()), utf16.size()};
+#else
+        (void)utf16;
+        return converted.view() == utf8;
+#endif
+    }
+
+    bool rejects(const std::string_view utf8)
+    {
+        try
+        {
+            const detri::native_string converted{utf8};
+            return false;
+        }
+        catch (const detri::except::string_conversion_error&)
+        {
+            return true;
+        }
+    }
+
+    void test_conversion()
+    {
+        check(converts_to("", u""), "empty text converts to an empty string");
+        check(converts_to("Tool", u"Tool"), "short ASCII converts");
+        check(converts_to("Asset browser - textures/environment", u"Asset browser - textures/environment"),
+              "ASCII longer than one vector converts");
+        check(converts_to("Caf\xC3\xA9 \xE6\x97\xA5\xE6\x9C\xAC \xF0\x9F\x8E\xAE", u"Caf\u00E9 \u65E5\u672C \U0001F3AE"),
+              "two-, three- and four-byte sequences convert");
+        check(converts_to("Scene editor (\xE2\x9C\x93 saved) - level 3, sector 12",
+                          u"Scene editor (\u2713 saved) - level 3, sector 12"),
+              "ASCII after a multi-byte sequence converts");
+
+        const std::string long_title(detri::native_string::inline_capacity * 2, 'x');
+        const std::u16string long_wide(long_title.size(), u'x');
+        check(converts_to(long_title, long_wide), "text past the inline capacity converts");
+    }
+
+    void test_invalid()
+    {
+        check(rejects("\x80"), "a lone continuation byte is rejected");
+        check(rejects("ab\xC3"), "a truncated sequence is rejected");
+        check(rejects("\xC0\xAF"), "an overlong encoding is rejected");
+        check(rejects("\xED\xA0\x80"), "an encoded surrogate is rejected");
+        check(rejects("\xF4\x90\x80\x80"), "a code point past U+10FFFF is rejected");
+    }
+
+    void test_allocations()
+    {
+        const std::string_view title = "Material editor - \xC3\xA9" "clairage";
+        const std::size_t before = g_allocations;
+        {
+            const detri::native_string converted{title};
+            check(converted.size() != 0, "the title converts");
+        }
+        check(g_allocations == before, "a title within the inline capacity converts without allocating");
+
+        const std::string long_title(detri::native_string::inline_capacity, 'x');
+        const std::size_t before_long = g_allocations;
+        {
+            const detri::native_string converted{long_title};
+        }
+        check(g_allocations == before_long + 1, "a longer title takes exactly one allocation");
+    }
+}
+
+void* operator new(const std::size_t size)
+{
+    ++g_allocations;
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main()
+{
+    test_conversion();
+    test_invalid();
+    test_allocations();
+
+    return detri::test::report();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// What every test executable shares: a failed check is printed and counted, and main returns report() so the test
+// runner sees the failure.
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace detri::test
+{
+    inline int g_failures = 0;
+
+    inline void check(const bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            ++g_failures;
+        }
+    }
+
+    // EXIT_FAILURE, after saying how many checks failed, if any did.
+    inline int report()
+    {
+        if (g_failures != 0)
+        {
+            std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
@@ -0,0 +1,280 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "detri/platform_exceptions.hpp"
+#include "detri/unicode.hpp"
+#include "detri/unicode_kernels.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    // Longer than a 32-byte block on each side, so a sequence placed at every offset into it lands on every position
+    // within a block and across every block boundary.
+    const std::string g_padding(80, 'p');
+
+    // Encoded by hand, independently of the library.
+    void append_utf8(std::string& text, const char32_t code_point)
+    {
+        if (code_point < 0x80)
+        {
+            text += static_cast<char>(code_point);
+        }
+        else if (code_point < 0x800)
+        {
+            text += static_cast<char>(0xC0 | code_point >> 6);
+            text += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else if (code_point < 0x10000)
+        {
+            text += static_cast<char>(0xE0 | code_point >> 12);
+            text += static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+            text += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else
+        {
+            text += static_cast<char>(0xF0 | code_point >> 18);
+            text += static_cast<char>(0x80 | (code_point >> 12 & 0x3F));
+            text += static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+            text += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+    }
+
+    void append_utf16(std::u16string& text, const char32_t code_point)
+    {
+        if (code_point < 0x10000)
+        {
+            text += static_cast<char16_t>(code_point);
+        }
+        else
+        {
+            text += static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10));
+            text += static_cast<char16_t>(0xDC00 + (code_point & 0x3FF));
+        }
+    }
+
+    // Mostly ASCII runs of random length, broken up by code points of every encoded length.
+    std::u32string random_code_points(std::mt19937& random, const std::size_t count)
+    {
+        const auto between = [&](const unsigned first, const unsigned last) {
+            return static_cast<char32_t>(std::uniform_int_distribution<unsigned>(first, last)(random));
+        };
+        std::u32string code_points;
+        while (code_points.size() < count)
+        {
+            switch (std::uniform_int_distribution<int>(0, 9)(random))
+            {
+                case 0:
+                    code_points += between(0x80, 0x7FF);
+                    break;
+                case 1:
+                    code_points += between(0x800, 0xD7FF);
+                    break;
+                case 2:
+                    code_points += between(0xE000, 0xFFFF);
+                    break;
+                case 3:
+                    code_points += between(0x10000, 0x10FFFF);
+                    break;
+                default:
+                    code_points.append(std::uniform_int_distribution<std::size_t>(1, 70)(random), between(0, 0x7F));
+                    break;
+            }
+        }
+        return code_points;
+    }
+
+    template <typename Convert>
+    bool throws_conversion_error(Convert&& convert)
+    {
+        try
+        {
+            convert();
+            return false;
+        }
+        catch (const detri::except::string_conversion_error&)
+        {
+            return true;
+        }
+    }
+
+    void test_round_trips(const detri::unicode_kernels& kernels)
+    {
+        std::mt19937 random{42};
+        for (std::size_t length = 0; length < 300; length += 7)
+        {
+            const std::u32string code_points = random_code_points(random, length);
+            std::string utf8;
+            std::u16string utf16;
+            for (const char32_t code_point : code_points)
+            {
+                append_utf8(utf8, code_point);
+                append_utf16(utf16, code_point);
+            }
+
+            check(detri::valid_utf8(kernels, utf8), "well-formed UTF-8 validates");
+            check(detri::valid_utf16(kernels, utf16), "well-formed UTF-16 validates");
+            check(detri::utf16_length(kernels, utf8) == utf16.size(), "the UTF-16 length of UTF-8 is exact");
+            check(detri::utf32_length(kernels, utf8) == code_points.size(), "the UTF-32 length of UTF-8 is exact");
+
+            std::u16string to_utf16(utf8.size(), u'\0');
+            to_utf16.resize(detri::utf8_to_utf16(kernels, utf8, to_utf16));
+            check(to_utf16 == utf16, "UTF-8 converts to UTF-16");
+
+            std::u32string to_utf32(utf8.size(), U'\0');
+            to_utf32.resize(detri::utf8_to_utf32(kernels, utf8, to_utf32));
+            check(to_utf32 == code_points, "UTF-8 converts to UTF-32");
+
+            std::string from_utf16(utf16.size() * 3, '\0');
+            from_utf16.resize(detri::utf16_to_utf8(kernels, utf16, from_utf16));
+            check(from_utf16 == utf8, "UTF-16 converts to UTF-8");
+
+            std::string from_utf32(code_points.size() * 4, '\0');
+            from_utf32.resize(detri::utf32_to_utf8(kernels, code_points, from_utf32));
+            check(from_utf32 == utf8, "UTF-32 converts to UTF-8");
+        }
+    }
+
+    void test_malformed_utf8(const detri::unicode_kernels& kernels)
+    {
+        const std::vector<std::string_view> malformed {
+            "\x80", "\xBF", "\xC3", "\xE6\x97", "\xF0\x9F\x8E", "\xC3\x28", "\xE6\x28\xA5", "\xF0\x9F\x28\xAE",
+            "\xC0\xAF", "\xC1\xBF", "\xE0\x80\xAF", "\xE0\x9F\xBF", "\xF0\x80\x80\xAF", "\xF0\x8F\xBF\xBF",
+            "\xED\xA0\x80", "\xED\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xF8\x88\x80\x80\x80", "\xFF",
+            "\xC3\xA9\xA9", "\xE6\x97\xA5\x80",
+        };
+        const std::vector<std::string_view> well_formed {
+            "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEE\x80\x80", "\xEF\xBF\xBF", "\xF0\x90\x80\x80",
+            "\xF4\x8F\xBF\xBF", "\xC3\xA9\xE6\x97\xA5\xF0\x9F\x8E\xAE",
+        };
+
+        for (std::size_t offset = 0; offset <= 70; ++offset)
+        {
+            bool all_rejected = true;
+            bool all_thrown = true;
+            for (const std::string_view sequence : malformed)
+            {
+                const std::string text = g_padding.substr(0, offset) + std::string{sequence} + g_padding;
+                const std::string at_end = g_padding.substr(0, offset) + std::string{sequence};
+                all_rejected = all_rejected && !detri::valid_utf8(kernels, text) && !detri::valid_utf8(kernels, at_end);
+                std::u16string out(text.size(), u'\0');
+                all_thrown = all_thrown &&
+                             throws_conversion_error([&] { (void)detri::utf8_to_utf16(kernels, text, out); });
+            }
+            check(all_rejected, "malformed UTF-8 is rejected at every offset");
+            check(all_thrown, "converting malformed UTF-8 throws at every offset");
+
+            bool all_accepted = true;
+            for (const std::string_view sequence : well_formed)
+            {
+                const std::string text = g_padding.substr(0, offset) + std::string{sequence} + g_padding;
+                const std::string at_end = g_padding.substr(0, offset) + std::string{sequence};
+                all_accepted = all_accepted && detri::valid_utf8(kernels, text) && detri::valid_utf8(kernels, at_end);
+            }
+            check(all_accepted, "boundary code points are accepted at every offset");
+        }
+    }
+
+    // Corrupting one byte anywhere must change the verdict exactly when the scalar path says it does.
+    void test_against_scalar(const detri::unicode_kernels& kernels)
+    {
+        std::mt19937 random{7};
+        std::string utf8;
+        for (const char32_t code_point : random_code_points(random, 2000))
+        {
+            append_utf8(utf8, code_point);
+        }
+
+        bool agrees = true;
+        for (int trial = 0; trial < 2000; ++trial)
+        {
+            std::string corrupted = utf8;
+            corrupted[std::uniform_int_distribution<std::size_t>(0, corrupted.size() - 1)(random)] =
+                static_cast<char>(std::uniform_int_distribution<int>(0x80, 0xFF)(random));
+            const std::size_t length = std::uniform_int_distribution<std::size_t>(0, corrupted.size())(random);
+            const std::string_view text{corrupted.data(), length};
+            const bool scalar_verdict = detri::valid_utf8(detri::scalar_unicode_kernels(), text);
+            agrees = agrees && detri::valid_utf8(kernels, text) == scalar_verdict;
+        }
+        check(agrees, "validation agrees with the scalar path on corrupted text");
+    }
+
+    void test_malformed_utf16_and_utf32(const detri::unicode_kernels& kernels)
+    {
+        const std::u16string padding(40, u'p');
+        bool rejected = true;
+        const std::vector<std::u16string_view> unpaired {u"\xD800", u"\xDC00", u"\xD800p", u"\xDFFF\xD800"};
+        for (const std::u16string_view sequence : unpaired)
+        {
+            for (std::size_t offset = 0; offset <= 35; ++offset)
+            {
+                const std::u16string text = padding.substr(0, offset) + std::u16string{sequence} + padding;
+                const std::u16string at_end = padding.substr(0, offset) + std::u16string{sequence};
+                std::string out(text.size() * 3, '\0');
+                rejected = rejected && !detri::valid_utf16(kernels, text) && !detri::valid_utf16(kernels, at_end) &&
+                           throws_conversion_error([&] { (void)detri::utf16_to_utf8(kernels, text, out); });
+            }
+        }
+        check(rejected, "unpaired surrogates are rejected");
+
+        for (const char32_t code_point : {char32_t{0xD800}, char32_t{0xDFFF}, char32_t{0x110000}, char32_t{0xFFFFFFFF}})
+        {
+            const std::u32string text = std::u32string(40, U'p') + code_point;
+            std::string out(text.size() * 4, '\0');
+            check(!detri::valid_utf32(text), "surrogates and code points past U+10FFFF are not valid UTF-32");
+            check(throws_conversion_error([&] { (void)detri::utf32_to_utf8(kernels, text, out); }),
+                  "converting them from UTF-32 throws");
+        }
+    }
+
+    void test_output_too_small(const detri::unicode_kernels& kernels)
+    {
+        const std::string utf8 = g_padding + "\xF0\x9F\x8E\xAE" + g_padding;
+        std::u16string exact(detri::utf16_length(kernels, utf8), u'\0');
+        check(detri::utf8_to_utf16(kernels, utf8, exact) == exact.size(), "the exact length is enough");
+
+        std::u16string short_by_one(exact.size() - 1, u'\0');
+        check(throws_conversion_error([&] { (void)detri::utf8_to_utf16(kernels, utf8, short_by_one); }),
+              "one unit short of the exact length throws");
+
+        std::string narrow(g_padding.size() - 1, '\0');
+        const std::u16string ascii(g_padding.size(), u'p');
+        check(throws_conversion_error([&] { (void)detri::utf16_to_utf8(kernels, ascii, narrow); }),
+              "ASCII that does not fit throws");
+    }
+
+    void test_allocating_helpers()
+    {
+        const std::string_view utf8 = "Caf\xC3\xA9 \xE6\x97\xA5\xE6\x9C\xAC \xF0\x9F\x8E\xAE";
+        const std::u16string_view utf16 = u"Caf\u00E9 \u65E5\u672C \U0001F3AE";
+        const std::u32string_view utf32 = U"Caf\u00E9 \u65E5\u672C \U0001F3AE";
+        check(detri::to_utf16(utf8) == utf16, "to_utf16 converts");
+        check(detri::to_utf32(utf8) == utf32, "to_utf32 converts");
+        check(detri::to_utf8(utf16) == utf8, "to_utf8 converts UTF-16");
+        check(detri::to_utf8(utf32) == utf8, "to_utf8 converts UTF-32");
+        check(detri::to_utf16("").empty(), "empty text converts to empty text");
+        check(throws_conversion_error([] { (void)detri::to_utf16("ab\xC3"); }), "to_utf16 rejects malformed text");
+        check(detri::unicode_instruction_set() == detri::supported_unicode_kernels().back()->name,
+              "the public functions run on the best supported kernels");
+    }
+}
+
+int main()
+{
+    for (const detri::unicode_kernels* kernels : detri::supported_unicode_kernels())
+    {
+        std::printf("Testing the %.*s kernels\n", static_cast<int>(kernels->name.size()), kernels->name.data());
+        test_round_trips(*kernels);
+        test_malformed_utf8(*kernels);
+        test_against_scalar(*kernels);
+        test_malformed_utf16_and_utf32(*kernels);
+        test_output_too_small(*kernels);
+    }
+    test_allocating_helpers();
+
+    return detri::test::report();
+}
@@ -0,0 +1,377 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <thread>
+
+#include "detri/platform_exceptions.hpp"
+#include "detri/window.hpp"
+#include "test_check.hpp"
+
+#ifndef _WIN32
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using detri::test::check;
+
+    void test_create_and_size()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        win.show();
+        check(win.is_open(), "window is open after create");
+        check(win.size().width == 640 && win.size().height == 480, "size matches create arguments");
+        check(win.native_handle() == nullptr, "headless window has no native handle");
+        check(!win.poll_event().has_value(), "fresh window has no events");
+
+        bool threw = false;
+        try
+        {
+            (void)detri::window::create("Empty", 0, 480);
+        }
+        catch (const detri::except::window_error&)
+        {
+            threw = true;
+        }
+        check(threw, "zero-sized window is rejected");
+    }
+
+    void test_title()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        check(win.title() == "Headless", "the title is the one create was given");
+        win.set_title("Headless - frame 1");
+        check(win.title() == "Headless - frame 1", "set_title replaces the title");
+    }
+
+    void test_injected_events_are_fifo()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        win.inject_event(detri::key_event{.value = detri::key::w, .pressed = true});
+        win.inject_event(detri::mouse_move_event{.x = 10, .y = 20});
+        win.inject_resize({.width = 800, .height = 600});
+
+        auto first = win.poll_event();
+        check(first && std::holds_alternative<detri::key_event>(*first), "first event is key_event");
+        check(first && std::get<detri::key_event>(*first).value == detri::key::w, "key value round-trips");
+
+        auto second = win.poll_event();
+        check(second && std::holds_alternative<detri::mouse_move_event>(*second), "second event is mouse_move_event");
+
+        auto third = win.poll_event();
+        check(third && std::holds_alternative<detri::resize_event>(*third), "third event is resize_event");
+        check(win.size().width == 800 && win.size().height == 600, "inject_resize updates size");
+
+        check(!win.poll_event().has_value(), "queue is drained");
+    }
+
+    void test_drain_events()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        for (std::int32_t i = 0; i < 100; ++i)
+        {
+            win.inject_event(detri::mouse_move_event{.x = i, .y = i});
+        }
+
+        std::array<detri::event, 64> batch;
+        check(win.drain_events(batch) == 64, "drain fills the whole span");
+        check(std::get<detri::mouse_move_event>(batch[0]).x == 0, "drain starts with the oldest event");
+        check(win.drain_events(batch) == 36, "second drain returns the remainder");
+        check(std::get<detri::mouse_move_event>(batch[35]).x == 99, "drain ends with the newest event");
+        check(win.drain_events(batch) == 0, "queue is empty after draining");
+
+        for (std::int32_t i = 0; i < 100; ++i)
+        {
+            win.inject_event(detri::mouse_move_event{.x = i, .y = i});
+        }
+        std::int32_t visited = 0;
+        bool ordered = true;
+        win.for_each_event([&](const detri::event& value) {
+            ordered = ordered && std::get<detri::mouse_move_event>(value).x == visited;
+            ++visited;
+        });
+        check(visited == 100, "for_each_event visits every queued event");
+        check(ordered, "for_each_event visits events in order");
+    }
+
+    void test_coalescing()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        win.set_event_coalescing(true);
+        check(win.event_coalescing(), "coalescing can be enabled");
+
+        for (std::int32_t i = 1; i <= 10; ++i)
+        {
+            win.inject_event(detri::mouse_move_event{.x = i, .y = i});
+        }
+        win.inject_event(detri::key_event{.value = detri::key::space, .pressed = true});
+        for (std::int32_t i = 1; i <= 4; ++i)
+        {
+            win.inject_event(detri::mouse_delta_event{.dx = i, .dy = -i});
+        }
+        win.inject_resize({.width = 100, .height = 100});
+        win.inject_resize({.width = 200, .height = 150});
+
+        std::array<detri::event, 16> batch;
+        const auto count = win.drain_events(batch);
+        check(count == 4, "runs collapse to one event each");
+        check(std::get<detri::mouse_move_event>(batch[0]).x == 10, "mouse moves keep the latest position");
+        check(std::holds_alternative<detri::key_event>(batch[1]), "non-motion events are never merged");
+        check(std::get<detri::mouse_delta_event>(batch[2]).dx == 10, "mouse deltas are summed");
+        check(std::get<detri::mouse_delta_event>(batch[2]).dy == -10, "mouse deltas are summed on both axes");
+        check(std::get<detri::resize_event>(batch[3]).width == 200, "resizes keep the latest size");
+        check(win.event_stats().coalesced == 9 + 3 + 1, "every merge is counted");
+        check(win.event_stats().dropped == 0, "nothing is dropped");
+    }
+
+    void test_timestamps()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        const auto before = detri::platform_clock::now();
+        win.inject_event(detri::key_event{.value = detri::key::a, .pressed = true});
+        const auto recorded = detri::platform_clock::time_point{std::chrono::seconds{42}};
+        win.inject_event(detri::mouse_move_event{.x = 1, .y = 2, .timestamp = recorded});
+        const auto after = detri::platform_clock::now();
+
+        auto first = win.poll_event();
+        check(first && detri::event_timestamp(*first) >= before, "unstamped events get a timestamp on injection");
+        check(first && detri::event_timestamp(*first) <= after, "injection timestamp comes from platform_clock");
+        auto second = win.poll_event();
+        check(second && detri::event_timestamp(*second) == recorded, "stamped events keep their timestamp");
+        check(after >= before, "platform_clock is monotonic");
+    }
+
+    void test_keyboard_state()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        win.inject_event(detri::key_event{.value = detri::key::w, .pressed = true});
+        win.inject_event(detri::key_event{.value = detri::key::left_shift, .pressed = true});
+        win.inject_event(detri::key_event{.value = detri::key::left_shift, .pressed = false});
+        win.for_each_event([](const detri::event&) {});
+
+        const auto& keyboard = win.keyboard();
+        check(keyboard.is_down(detri::key::w), "pressed key is down");
+        check(keyboard.was_pressed(detri::key::w), "pressed key reports the press edge");
+        check(!keyboard.is_down(detri::key::left_shift), "tapped key is up again");
+        check(keyboard.was_pressed(detri::key::left_shift) && keyboard.was_released(detri::key::left_shift),
+              "a tap within one frame reports both edges");
+        check(!keyboard.is_down(detri::key::right_shift), "sides are tracked separately");
+
+        const detri::keyboard_state snapshot = win.keyboard();
+        win.inject_event(detri::key_event{.value = detri::key::w, .pressed = true, .repeated = true});
+        while (win.poll_event())
+        {
+        }
+        check(keyboard.is_down(detri::key::w), "held key stays down across frames");
+        check(!keyboard.was_pressed(detri::key::w), "auto-repeat is not a new press");
+        check(!keyboard.was_released(detri::key::left_shift), "edges reset on the next frame");
+        check(snapshot.was_pressed(detri::key::w), "snapshot keeps the frame it was taken in");
+
+        win.inject_event(detri::key_event{.value = detri::key::w, .pressed = false});
+        (void)win.poll_event();
+        check(!keyboard.is_down(detri::key::w) && keyboard.was_released(detri::key::w), "release is reported");
+        check(!keyboard.any_down(), "nothing is held after the release");
+    }
+
+    void test_focus_lost()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        const auto& keyboard = win.keyboard();
+
+        win.inject_event(detri::key_event{.value = detri::key::w, .pressed = true});
+        (void)win.poll_event();
+        check(keyboard.is_down(detri::key::w), "the key is held before focus goes");
+
+        // Alt-tab away: the release goes to another window, so only the focus loss arrives.
+        win.inject_event(detri::focus_lost_event{});
+        auto lost = win.poll_event();
+        check(lost && std::holds_alternative<detri::focus_lost_event>(*lost), "focus loss is handed out");
+        check(!keyboard.is_down(detri::key::w) && keyboard.was_released(detri::key::w),
+              "a key held when focus is lost reads as released");
+
+        // Within one batch the focus loss only drops what was held before it.
+        win.inject_event(detri::key_event{.value = detri::key::a, .pressed = true});
+        win.inject_event(detri::focus_lost_event{});
+        win.inject_event(detri::key_event{.value = detri::key::d, .pressed = true});
+        std::array<detri::event, 8> batch;
+        check(win.drain_events(batch) == 3, "the batch holds both keys and the focus loss");
+        check(!keyboard.is_down(detri::key::a) && keyboard.is_down(detri::key::d),
+              "focus loss applies in order with key events");
+    }
+
+    void test_record_and_replay()
+    {
+        const auto path = std::filesystem::temp_directory_path() / "detri_headless_replay.log";
+        {
+            auto recorder = detri::input_recorder::create(path);
+            auto win = detri::window::create("Headless", 640, 480);
+            win.record_input(&recorder);
+            win.inject_event(detri::key_event{.value = detri::key::space, .pressed = true});
+            win.inject_event(detri::mouse_move_event{.x = 3, .y = 4});
+            win.for_each_event([](const detri::event&) {});
+            win.record_input(nullptr);
+            check(recorder.recorded() == 2, "recorder sees what the window hands out");
+        }
+
+        auto replayer = detri::input_replayer::open(path);
+        auto win = detri::window::create("Headless", 640, 480);
+        win.replay_input(&replayer);
+        win.inject_event(detri::close_event{});
+
+        auto first = win.poll_event();
+        check(first && std::holds_alternative<detri::key_event>(*first), "replayed events come first");
+        check(win.keyboard().is_down(detri::key::space), "replayed keys update the keyboard state");
+        auto second = win.poll_event();
+        check(second && std::get<detri::mouse_move_event>(*second).x == 3, "replay keeps the recorded order");
+        auto third = win.poll_event();
+        check(third && std::holds_alternative<detri::close_event>(*third), "live events follow the replay");
+        win.replay_input(nullptr);
+
+        std::filesystem::remove(path);
+    }
+
+    void test_request_close()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        win.request_close();
+        check(win.is_open(), "close is deferred until the next pump");
+
+        auto event = win.poll_event();
+        check(event && std::holds_alternative<detri::close_event>(*event), "request_close queues close_event");
+        check(!win.is_open(), "window is closed after close_event");
+
+        // A window destroyed on another thread with its close still posted must not be left for this thread's pump.
+        auto moved = detri::window::create("Headless", 640, 480);
+        moved.request_close();
+        std::thread{[doomed = std::move(moved)] {}}.join();
+        auto other = detri::window::create("Headless", 640, 480);
+        check(!other.poll_event().has_value() && other.is_open(), "a close posted by a destroyed window goes with it");
+
+        // Closes are posted to the requesting thread's queue, so another thread's pump leaves them alone.
+        other.request_close();
+        std::thread{[] {
+            auto elsewhere = detri::window::create("Headless", 640, 480);
+            (void)elsewhere.poll_event();
+        }}.join();
+        check(other.is_open(), "another thread's pump does not dispatch this thread's closes");
+        check(other.poll_event().has_value() && !other.is_open(), "this thread's pump does");
+    }
+
+    void test_wait_for_events()
+    {
+        using namespace std::chrono_literals;
+        auto win = detri::window::create("Headless", 640, 480);
+
+        auto start = detri::platform_clock::now();
+        check(!win.wait_for_events_or_timeout(5ms), "an idle wait times out with nothing to poll");
+        check(detri::platform_clock::now() - start >= 5ms, "an idle wait sleeps out its timeout");
+
+        win.inject_event(detri::key_event{.value = detri::key::a, .pressed = true});
+        start = detri::platform_clock::now();
+        check(win.wait_for_events_or_timeout(1s), "a wait with input queued reports it");
+        check(detri::platform_clock::now() - start < 500ms, "a wait with input queued returns straight away");
+        check(win.poll_event().has_value(), "the input is still there to poll");
+
+        win.request_close();
+        check(win.wait_for_events_or_timeout(1s), "a requested close ends the wait");
+        (void)win.poll_event();
+        check(!win.wait_for_events_or_timeout(detri::platform_clock::duration::max()),
+              "a closed window never sleeps");
+    }
+
+    void test_wait_any()
+    {
+        using namespace std::chrono_literals;
+        auto win = detri::window::create("Headless", 640, 480);
+        check(win.wait_handle() == detri::invalid_wait_handle, "a headless window has nothing for the OS to wait on");
+
+#ifdef _WIN32
+        const HANDLE handle = CreateEventW(nullptr, TRUE, TRUE, nullptr);
+#else
+        const int handle = eventfd(1, 0);
+#endif
+        const detri::native_wait_handle handles[] = {handle};
+        check(win.wait_any(handles, 1s) == 0U, "a ready handle ends the wait with its index");
+
+        win.inject_event(detri::key_event{.value = detri::key::b, .pressed = true});
+        check(win.wait_any(handles, 1s) == 1U, "queued input is reported as handles.size()");
+        const auto event = win.wait_event(1s);
+        check(event && std::holds_alternative<detri::key_event>(*event), "wait_event hands out the queued event");
+
+#ifdef _WIN32
+        ResetEvent(handle);
+#else
+        std::uint64_t value = 0;
+        (void)read(handle, &value, sizeof(value));
+#endif
+        const auto start = detri::platform_clock::now();
+        check(!win.wait_any(handles, 5ms).has_value(), "a wait with nothing ready times out");
+        check(detri::platform_clock::now() - start >= 5ms, "a wait on handles sleeps out its timeout");
+        check(!win.wait_event(1ms).has_value(), "wait_event times out with nothing queued");
+
+#ifdef _WIN32
+        CloseHandle(handle);
+#else
+        close(handle);
+#endif
+    }
+
+    void test_displays()
+    {
+        const auto displays = detri::enumerate_displays();
+        check(displays.size() == 1 && displays[0].primary, "headless reports one primary display");
+        check(displays[0].refresh_interval() == std::chrono::nanoseconds{16'666'666}, "60 Hz is one 60th of a second");
+
+        auto win = detri::window::create("Headless", 640, 480);
+        check(win.scale() == 1.0f, "a new window renders at scale 1");
+        check(win.display().id == displays[0].id, "the window is on the only display");
+
+        win.inject_scale(2.0f);
+        const auto changed = win.poll_event();
+        check(changed && std::holds_alternative<detri::dpi_changed_event>(*changed) &&
+                  std::get<detri::dpi_changed_event>(*changed).scale == 2.0f,
+              "a scale change queues dpi_changed_event");
+        check(win.scale() == 2.0f && win.display().scale == 2.0f, "scale follows the change");
+    }
+
+    void test_cursor_mode()
+    {
+        auto win = detri::window::create("Headless", 640, 480);
+        check(win.get_cursor_mode() == detri::cursor_mode::normal, "cursor starts normal");
+        win.inject_raw_motion(5, 5);
+        check(!win.poll_event().has_value(), "raw motion is ignored while the cursor is not captured");
+
+        win.set_cursor_mode(detri::cursor_mode::captured_hidden);
+        check(win.get_cursor_mode() == detri::cursor_mode::captured_hidden, "cursor mode is stored");
+
+        win.inject_raw_motion(3, -7);
+        win.inject_raw_motion(0, 0);
+        auto delta = win.poll_event();
+        check(delta && std::holds_alternative<detri::mouse_delta_event>(*delta), "raw motion becomes mouse_delta_event");
+        check(delta && std::get<detri::mouse_delta_event>(*delta).dx == 3, "raw dx is passed through unaccelerated");
+        check(delta && std::get<detri::mouse_delta_event>(*delta).dy == -7, "raw dy is passed through unaccelerated");
+        check(!win.poll_event().has_value(), "empty raw packets produce no event");
+    }
+}
+
+int main()
+{
+    test_create_and_size();
+    test_title();
+    test_injected_events_are_fifo();
+    test_drain_events();
+    test_coalescing();
+    test_timestamps();
+    test_keyboard_state();
+    test_focus_lost();
+    test_record_and_replay();
+    test_request_close();
+    test_wait_for_events();
+    test_wait_any();
+    test_displays();
+    test_cursor_mode();
+
+    return detri::test::report();
+}
@@ -1,13 +1,61 @@
-#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
 
+#include "detri/frame_pacer.hpp"
 #include "detri/window.hpp"
 
-int main()
+// Interactive check. Drag the window edges around, then close it: the longest gap between frames, overall and while
+// a resize was in progress, is printed on exit. Pass --threaded to move the message loop onto its own thread and
+// compare. Frames are paced to the refresh rate of the display the window is on, including after it moves to another.
+// On Windows a message hook counts the key messages it sees on the way.
+#ifdef DETRI_PLATFORM_WIN32
+namespace
 {
-    auto win = detri::window::create("Test Window", 640, 480);
+    std::atomic<std::uint64_t> g_hooked_key_messages {0};
+
+    LRESULT CALLBACK count_key_messages(HWND, UINT, WPARAM, LPARAM)
+    {
+        g_hooked_key_messages.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    const bool threaded = argc > 1 && std::string_view{argv[1]} == "--threaded";
+
+#ifdef DETRI_PLATFORM_WIN32
+    const auto key_hook = detri::add_message_hook(count_key_messages, detri::message_filter::of({WM_KEYDOWN, WM_KEYUP}));
+#endif
+    auto win = detri::window::create("Test Window", 640, 480, {.threaded_pump = threaded});
     win.show();
+
+    using clock = detri::platform_clock;
+    auto last_frame = clock::now();
+    clock::duration longest_frame {};
+    clock::duration longest_resize_frame {};
+    bool resizing = false;
+    std::uint64_t frames = 0;
+    auto pacer = detri::frame_pacer::create();
+    const auto pace_to_display = [&win, &pacer] {
+        if (const auto interval = win.display().refresh_interval(); interval > clock::duration::zero())
+        {
+            pacer.set_frame_time(interval);
+        }
+    };
+    pace_to_display();
+    clock::duration worst_lateness {};
+
     while (win.is_open())
     {
+        // With the inline pump a whole drag happens inside one poll_event() call, so count any frame that saw the
+        // resize, not just the ones between begin and end.
+        bool resize_frame = resizing;
         while (auto event = win.poll_event())
         {
             if (std::holds_alternative<detri::close_event>(*event))
@@ -15,8 +63,42 @@ int main()
                 win.request_close();
                 break;
             }
+            if (std::holds_alternative<detri::dpi_changed_event>(*event) ||
+                std::holds_alternative<detri::display_changed_event>(*event))
+            {
+                pace_to_display();
+            }
+            resize_frame = resize_frame || std::holds_alternative<detri::resize_begin_event>(*event);
+            resizing = (resizing || std::holds_alternative<detri::resize_begin_event>(*event)) &&
+                       !std::holds_alternative<detri::resize_end_event>(*event);
+        }
+
+        const auto now = clock::now();
+        const auto gap = now - last_frame;
+        last_frame = now;
+        ++frames;
+        longest_frame = std::max(longest_frame, gap);
+        if (resize_frame)
+        {
+            longest_resize_frame = std::max(longest_resize_frame, gap);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        pacer.wait();
+        worst_lateness = std::max(worst_lateness, pacer.last_lateness());
     }
+
+    const auto to_ms = [](const clock::duration value) {
+        return std::chrono::duration<double, std::milli>(value).count();
+    };
+    std::printf("%s pump: %llu frames, longest frame %.1f ms, longest frame during resize %.1f ms, latest frame start "
+                "%.3f ms, %llu frames missed\n",
+                threaded ? "threaded" : "inline", static_cast<unsigned long long>(frames), to_ms(longest_frame),
+                to_ms(longest_resize_frame), to_ms(worst_lateness),
+                static_cast<unsigned long long>(pacer.missed_frames()));
+#ifdef DETRI_PLATFORM_WIN32
+    detri::remove_message_hook(key_hook);
+    std::printf("message hook saw %llu key messages\n",
+                static_cast<unsigned long long>(g_hooked_key_messages.load(std::memory_order_relaxed)));
+#endif
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,163 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "detri/platform_exceptions.hpp"
+#include "detri/window_system.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+    using detri::test::check;
+
+    using clock = detri::platform_clock;
+
+    clock::time_point at(const std::int64_t microseconds)
+    {
+        return clock::time_point{std::chrono::microseconds{microseconds}};
+    }
+
+    detri::mouse_move_event move(const std::int32_t x, const std::int64_t microseconds)
+    {
+        return {.x = x, .y = 0, .timestamp = at(microseconds)};
+    }
+
+    void test_windows()
+    {
+        auto system = detri::window_system::create();
+        const auto first = system.create_window("First", 640, 480);
+        const auto second = system.create_window("Second", 320, 240);
+        check(first != second, "every window gets its own id");
+        check(system.window_count() == 2, "both windows are counted");
+        check(system.get(second).size().width == 320, "get finds the window an id names");
+
+        system.destroy_window(first);
+        check(!system.contains(first) && system.contains(second), "destroy removes only that window");
+        check(system.window_count() == 1, "a destroyed window is no longer counted");
+
+        bool threw = false;
+        try
+        {
+            (void)system.get(first);
+        }
+        catch (const detri::except::window_error&)
+        {
+            threw = true;
+        }
+        check(threw, "get with a stale id throws");
+
+        const auto third = system.create_window("Third", 640, 480);
+        check(third != first, "ids are never reused");
+    }
+
+    void test_merged_order()
+    {
+        auto system = detri::window_system::create();
+        const auto left = system.create_window("Left", 640, 480);
+        const auto right = system.create_window("Right", 640, 480);
+
+        system.get(left).inject_event(move(1, 10));
+        system.get(left).inject_event(move(3, 30));
+        system.get(right).inject_event(move(2, 20));
+        system.get(right).inject_event(move(4, 40));
+
+        std::vector<std::int32_t> order;
+        bool routed = true;
+        while (auto value = system.poll_event())
+        {
+            const auto x = std::get<detri::mouse_move_event>(value->value).x;
+            order.push_back(x);
+            routed = routed && value->window == (x % 2 == 1 ? left : right);
+        }
+        check(order == std::vector<std::int32_t>{1, 2, 3, 4}, "events from every window merge in timestamp order");
+        check(routed, "every event names the window it was queued for");
+
+        // A window's own order wins over its timestamps, which a replay can take out of order.
+        system.get(left).inject_event(move(5, 500));
+        system.get(left).inject_event(move(7, 100));
+        system.get(right).inject_event(move(6, 300));
+        order.clear();
+        while (auto value = system.poll_event())
+        {
+            order.push_back(std::get<detri::mouse_move_event>(value->value).x);
+        }
+        check(order == std::vector<std::int32_t>{6, 5, 7}, "a window's events keep their queue order");
+    }
+
+    void test_drain_and_close()
+    {
+        auto system = detri::window_system::create();
+        const auto left = system.create_window("Left", 640, 480);
+        const auto right = system.create_window("Right", 640, 480);
+        for (std::int32_t i = 0; i < 100; ++i)
+        {
+            system.get(i % 2 == 0 ? left : right).inject_event(move(i, i + 1));
+        }
+
+        std::array<detri::window_event, 64> batch;
+        check(system.drain_events(batch) == 64, "drain fills the whole span");
+        check(std::get<detri::mouse_move_event>(batch[0].value).x == 0, "drain starts with the oldest event");
+        check(system.drain_events(batch) == 36, "a second drain returns the remainder");
+        check(std::get<detri::mouse_move_event>(batch[35].value).x == 99, "drain ends with the newest event");
+        check(system.drain_events(batch) == 0, "the stream is empty once drained");
+
+        system.get(right).inject_event(detri::key_event{.value = detri::key::q, .pressed = true});
+        system.get(right).request_close();
+        auto key = system.poll_event();
+        check(key && key->window == right, "key input is routed to its window");
+        check(system.get(right).keyboard().is_down(detri::key::q), "the window's keyboard state follows the stream");
+        auto close = system.poll_event();
+        check(close && close->window == right && std::holds_alternative<detri::close_event>(close->value),
+              "a requested close comes out of the shared pump");
+        check(!system.get(right).is_open() && system.get(left).is_open(), "only the requested window closes");
+
+        system.get(left).inject_event(move(1, 1));
+        system.get(left).inject_event(move(2, 2));
+        (void)system.poll_event();
+        system.destroy_window(left);
+        check(!system.poll_event().has_value(), "destroying a window discards its events still in the stream");
+    }
+
+    void test_threaded_first()
+    {
+        // A threaded window pumps on a thread of its own, so the shared pump has to go through an inline window even
+        // when the threaded one was created first.
+        auto system = detri::window_system::create();
+        const auto threaded = system.create_window("Threaded", 640, 480, {.threaded_pump = true});
+        const auto left = system.create_window("Left", 640, 480, {.coalesce_events = true});
+        const auto right = system.create_window("Right", 640, 480);
+
+        system.get(threaded).inject_event(move(1, 10));
+        system.get(left).inject_event(move(2, 20));
+        system.get(right).request_close();
+
+        std::vector<std::int32_t> order;
+        bool closed = false;
+        while (auto value = system.poll_event())
+        {
+            if (const auto* moved = std::get_if<detri::mouse_move_event>(&value->value))
+            {
+                order.push_back(moved->x);
+            }
+            closed = closed || (value->window == right && std::holds_alternative<detri::close_event>(value->value));
+        }
+        check(order == std::vector<std::int32_t>{1, 2}, "threaded and inline windows both reach the stream");
+        check(closed && !system.get(right).is_open(), "an inline window's close is pumped behind a threaded window");
+        check(system.get(threaded).is_open() && system.get(left).is_open(), "pumping closes no other window");
+
+        system.get(threaded).request_close();
+        auto close = system.poll_event();
+        check(close && close->window == threaded && std::holds_alternative<detri::close_event>(close->value),
+              "a threaded window's close comes out of its own pump");
+    }
+}
+
+int main()
+{
+    test_windows();
+    test_merged_order();
+    test_drain_and_close();
+    test_threaded_first();
+
+    return detri::test::report();
+}
@@ -0,0 +1,60 @@
+#include <chrono>
+#include <thread>
+
+#include "detri/platform_exceptions.hpp"
+#include "detri/window.hpp"
+#include "test_check.hpp"
+
+// Meant to run against a headless weston (see cmake/DetriRunUnderWeston.cmake), which may not expose a pointer.
+namespace
+{
+    using detri::test::check;
+
+    void settle(detri::window& win)
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            win.pump_messages();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+int main()
+{
+    auto win = detri::window::create("Wayland Test Window", 320, 240);
+    win.show();
+    settle(win);
+
+    check(win.is_open(), "window is open after show");
+    check(win.native_wayland().display != nullptr, "window exposes its wl_display");
+    check(win.native_wayland().surface != nullptr, "window exposes its wl_surface");
+    check(win.size().width != 0 && win.size().height != 0, "window has a non-zero size");
+
+    try
+    {
+        win.set_cursor_mode(detri::cursor_mode::captured_hidden);
+        check(win.get_cursor_mode() == detri::cursor_mode::captured_hidden, "pointer lock is requested");
+        win.set_cursor_mode(detri::cursor_mode::normal);
+        check(win.get_cursor_mode() == detri::cursor_mode::normal, "pointer lock is released");
+    }
+    catch (const detri::except::window_error&)
+    {
+        check(win.get_cursor_mode() == detri::cursor_mode::normal, "failed capture leaves the cursor mode unchanged");
+    }
+
+    const auto displays = detri::enumerate_displays();
+    check(!displays.empty() && displays.front().width != 0, "the compositor's output is listed");
+    check(win.scale() >= 1.0f, "the window scale is at least 1");
+
+    win.request_close();
+    bool closed = false;
+    while (auto event = win.poll_event())
+    {
+        closed = closed || std::holds_alternative<detri::close_event>(*event);
+    }
+    check(closed, "request_close queues close_event");
+    check(!win.is_open(), "window is closed after close_event");
+
+    return detri::test::report();
+}
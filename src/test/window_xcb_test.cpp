@@ -0,0 +1,54 @@
+#include <chrono>
+#include <thread>
+
+#include "detri/window.hpp"
+#include "test_check.hpp"
+
+// Meant to run under Xvfb (see CMakeLists.txt), so it must not depend on a window manager being present.
+namespace
+{
+    using detri::test::check;
+
+    void settle(detri::window& win)
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            win.pump_messages();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+int main()
+{
+    auto win = detri::window::create("XCB Test Window", 320, 240);
+    win.show();
+    settle(win);
+
+    check(win.is_open(), "window is open after show");
+    check(win.native_handle() != nullptr, "window has a native handle");
+    check(win.native_xcb().connection != nullptr, "window exposes its XCB connection");
+    check(win.size().width == 320 && win.size().height == 240, "size matches create arguments");
+
+    win.set_cursor_mode(detri::cursor_mode::captured_hidden);
+    check(win.get_cursor_mode() == detri::cursor_mode::captured_hidden, "pointer grab succeeds");
+    win.set_cursor_mode(detri::cursor_mode::normal);
+    check(win.get_cursor_mode() == detri::cursor_mode::normal, "pointer grab is released");
+
+    const auto displays = detri::enumerate_displays();
+    check(!displays.empty() && displays.front().primary, "the primary display is listed first");
+    check(!displays.empty() && displays.front().width == 1024 && displays.front().height == 768,
+          "the display has the screen's resolution");
+    check(win.display().width != 0 && win.scale() > 0.0f, "the window knows its display and scale");
+
+    win.request_close();
+    bool closed = false;
+    while (auto event = win.poll_event())
+    {
+        closed = closed || std::holds_alternative<detri::close_event>(*event);
+    }
+    check(closed, "request_close queues close_event");
+    check(!win.is_open(), "window is closed after close_event");
+
+    return detri::test::report();
+}